@@ -0,0 +1,166 @@
+/*
+**  Copyright (C) 2018 SoftBank Robotics Europe
+**  See COPYING for the license
+*/
+
+/*
+ * Collects the messages that the processes of the machine log through a
+ * qi::log::SharedMemoryLogHandler, then filters, formats and writes them
+ * to the console, to a rotating file or to the journal.
+ */
+
+#include <atomic>
+#include <csignal>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <boost/program_options.hpp>
+
+#include <qi/clock.hpp>
+#include <qi/log.hpp>
+#include <qi/log/rotatingfileloghandler.hpp>
+#include <qi/log/sharedmemoryloghandler.hpp>
+#ifdef WITH_SYSTEMD
+# include <qi/log/journaldloghandler.hpp>
+#endif
+
+namespace po = boost::program_options;
+
+namespace
+{
+  std::atomic<bool> stopRequested{false};
+
+  void requestStop(int)
+  {
+    stopRequested = true;
+  }
+
+  void printRecord(const qi::log::DeferredLogRecord& record, const char* msg, bool context)
+  {
+    std::cout << qi::toISO8601String(record.systemDate) << " "
+              << qi::log::logLevelToString(record.level, false) << " "
+              << record.category << ": ";
+    if (context)
+      std::cout << record.file << "(" << record.line << ") " << record.function << " ";
+    std::cout << msg << "\n";
+  }
+}
+
+int main(int argc, char* argv[])
+{
+  po::options_description desc("qilogcollector [options]");
+  desc.add_options()
+    ("help,h", "Print this help.")
+    ("name,n", po::value<std::string>()->default_value(qi::log::defaultSharedMemoryLogName),
+     "Name of the shared memory segment.")
+    ("size,s", po::value<std::size_t>()->default_value(4 * 1024 * 1024),
+     "Size of the ring in bytes.")
+    ("log-level,L", po::value<int>()->default_value(qi::LogLevel_Info),
+     "Only keep messages up to this level: [0-6] (0: silent, 1: fatal, 2: error, "
+     "3: warning, 4: info, 5: verbose, 6: debug).")
+    ("filters,f", po::value<std::string>(),
+     "Category filtering rules, see QI_LOG_FILTERS, for example 'qi.*=debug:-qi.foo'.")
+    ("context,c", "Print the file, line and function of each message on the console.")
+    ("file", po::value<std::string>(), "Write the messages to this file, rotating it.")
+    ("max-file-size", po::value<std::size_t>()->default_value(10 * 1024 * 1024),
+     "Size at which the file is rotated.")
+    ("rotated-files", po::value<unsigned int>()->default_value(5),
+     "Number of rotated files to keep.")
+#ifdef WITH_SYSTEMD
+    ("journald", "Write the messages to the journal.")
+#endif
+    ("quiet,q", "Do not write the messages to the console.");
+
+  po::variables_map vm;
+  try
+  {
+    po::store(po::command_line_parser(argc, argv).options(desc).run(), vm);
+    po::notify(vm);
+  }
+  catch (const po::error& e)
+  {
+    std::cerr << e.what() << std::endl << desc << std::endl;
+    return EXIT_FAILURE;
+  }
+  if (vm.count("help"))
+  {
+    std::cout << desc << std::endl;
+    return EXIT_SUCCESS;
+  }
+
+  // Filtering is done with the rules of qi::log, applied to the categories
+  // of the collected messages.
+  qi::log::setLogLevel(static_cast<qi::LogLevel>(vm["log-level"].as<int>()));
+  if (vm.count("filters"))
+    qi::log::addFilters(vm["filters"].as<std::string>());
+
+  std::vector<qi::log::Handler> outputs;
+  std::unique_ptr<qi::log::RotatingFileLogHandler> file;
+  if (vm.count("file"))
+  {
+    qi::log::RotatingFileLogHandlerConfig config;
+    config.maxFileSize = vm["max-file-size"].as<std::size_t>();
+    config.maxRotatedFiles = vm["rotated-files"].as<unsigned int>();
+    file.reset(new qi::log::RotatingFileLogHandler(vm["file"].as<std::string>(), config));
+    qi::log::RotatingFileLogHandler* handler = file.get();
+    outputs.push_back([handler](const qi::LogLevel verb, const qi::Clock::time_point date,
+                                const qi::SystemClock::time_point systemDate,
+                                const char* category, const char* msg, const char* file,
+                                const char* fct, const int line) {
+      handler->log(verb, date, systemDate, category, msg, file, fct, line);
+    });
+  }
+#ifdef WITH_SYSTEMD
+  if (vm.count("journald"))
+    outputs.push_back(qi::log::makeJournaldLogHandler());
+#endif
+  const bool console = !vm.count("quiet");
+  const bool context = vm.count("context") != 0;
+
+  std::unique_ptr<qi::log::SharedMemoryLogReader> reader;
+  try
+  {
+    reader.reset(new qi::log::SharedMemoryLogReader(vm["name"].as<std::string>(),
+                                                    vm["size"].as<std::size_t>()));
+  }
+  catch (const std::exception& e)
+  {
+    std::cerr << e.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  std::signal(SIGINT, &requestStop);
+  std::signal(SIGTERM, &requestStop);
+
+  qi::log::DeferredLogRecord record;
+  int pid = 0;
+  qi::uint64_t dropped = 0;
+  while (!stopRequested)
+  {
+    if (!reader->next(record, pid, qi::MilliSeconds(100)))
+    {
+      std::cout.flush();
+      const qi::uint64_t newDropped = reader->droppedMessageCount();
+      if (newDropped != dropped)
+      {
+        std::cerr << (newDropped - dropped) << " log messages were dropped" << std::endl;
+        dropped = newDropped;
+      }
+      continue;
+    }
+    if (!qi::log::isVisible(record.category, record.level))
+      continue;
+
+    const std::string msg = "[" + std::to_string(pid) + "] " + qi::log::formatMessage(record);
+    if (console)
+      printRecord(record, msg.c_str(), context);
+    for (auto& output : outputs)
+      output(record.level, record.date, record.systemDate, record.category, msg.c_str(),
+             record.file, record.function, record.line);
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,92 @@
+/*
+**  Copyright (C) 2018 SoftBank Robotics Europe
+**  See COPYING for the license
+*/
+
+/*
+ * Prints the messages of binary log files written by
+ * qi::log::BinaryFileLogHandler, formatting them on the way.
+ */
+
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <boost/program_options.hpp>
+
+#include <qi/clock.hpp>
+#include <qi/log.hpp>
+#include <qi/log/binaryfileloghandler.hpp>
+
+namespace po = boost::program_options;
+
+namespace
+{
+  void printRecord(const qi::log::DeferredLogRecord& record, bool context)
+  {
+    std::cout << qi::toISO8601String(record.systemDate) << " "
+              << qi::log::logLevelToString(record.level, false) << " "
+              << record.category << ": ";
+    if (context)
+      std::cout << record.file << "(" << record.line << ") " << record.function << " ";
+    std::cout << qi::log::formatMessage(record) << "\n";
+  }
+}
+
+int main(int argc, char* argv[])
+{
+  po::options_description desc("qilogdecode [options] FILE...");
+  desc.add_options()
+    ("help,h", "Print this help.")
+    ("context,c", "Print the file, line and function of each message.")
+    ("log-level,L", po::value<int>()->default_value(qi::LogLevel_Debug),
+     "Only print messages up to this level: [0-6] (0: silent, 1: fatal, 2: error, "
+     "3: warning, 4: info, 5: verbose, 6: debug).")
+    ("file", po::value<std::vector<std::string>>(), "Binary log file to decode.");
+
+  po::positional_options_description pos;
+  pos.add("file", -1);
+
+  po::variables_map vm;
+  try
+  {
+    po::store(po::command_line_parser(argc, argv).options(desc).positional(pos).run(), vm);
+    po::notify(vm);
+  }
+  catch (const po::error& e)
+  {
+    std::cerr << e.what() << std::endl << desc << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  if (vm.count("help") || !vm.count("file"))
+  {
+    std::cout << desc << std::endl;
+    return vm.count("help") ? EXIT_SUCCESS : EXIT_FAILURE;
+  }
+
+  const bool context = vm.count("context") != 0;
+  const int maxLevel = vm["log-level"].as<int>();
+  int status = EXIT_SUCCESS;
+  for (const auto& path : vm["file"].as<std::vector<std::string>>())
+  {
+    try
+    {
+      qi::log::BinaryLogFileReader reader(path);
+      qi::log::DeferredLogRecord record;
+      while (reader.next(record))
+      {
+        if (record.level <= maxLevel)
+          printRecord(record, context);
+      }
+    }
+    catch (const std::exception& e)
+    {
+      std::cerr << e.what() << std::endl;
+      status = EXIT_FAILURE;
+    }
+  }
+  std::cout.flush();
+  return status;
+}
@@ -16,6 +16,11 @@
 
 // #include <locale>  TODO: Use these includes when they become available on all platforms,
 // #include <codecvt> instead of replaced by boost.locale
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
 #include <type_traits>
 
 #include <ka/typetraits.hpp>
@@ -105,6 +110,32 @@
   while (false)
 #endif
 
+#if defined(NO_QI_LOG_DETAILED_CONTEXT) || defined(NDEBUG)
+#  define _QI_LOG_DEFERRED(Type, ...)                                     \
+  do                                                                      \
+  {                                                                       \
+    if (::qi::log::isVisible(_QI_LOG_CATEGORY_GET(), ::qi::Type))          \
+      ::qi::log::detail::logDeferred(::qi::Type, _QI_LOG_CATEGORY_GET(),  \
+                                     "", __FUNCTION__, 0, __VA_ARGS__);   \
+  }                                                                       \
+  while (false)
+#else
+#  define _QI_LOG_DEFERRED(Type, ...)                                     \
+  do                                                                      \
+  {                                                                       \
+    if (::qi::log::isVisible(_QI_LOG_CATEGORY_GET(), ::qi::Type))          \
+      ::qi::log::detail::logDeferred(::qi::Type, _QI_LOG_CATEGORY_GET(),  \
+                                     __FILE__, __FUNCTION__, __LINE__,    \
+                                     __VA_ARGS__);                        \
+  }                                                                       \
+  while (false)
+#endif
+
+// Maximum size of the encoded arguments of a message with deferred formatting.
+#ifndef QI_LOG_DEFERRED_ARGS_MAX_SIZE
+#  define QI_LOG_DEFERRED_ARGS_MAX_SIZE 256
+#endif
+
 /* Tricky, we do not want to hit category_get if a category is specified
 * Usual glitch of off-by-one list size: put argument 'TypeCased' in the vaargs
 * Basically we want variadic macro, but it does not exist, so emulate it using _QI_LOG_EMPTY.
@@ -209,18 +240,35 @@ namespace qi {
 
       struct Category
       {
+        // Number of subscribers whose level is in packedLevels.
+        enum { PackedSubscribers = 15 };
+        // Value of the level of a subscriber in packedLevels if it has none.
+        enum { NoPackedLevel = 0xF };
+
         Category()
-          : maxLevel(qi::LogLevel_Silent)
+          : packedLevels(~qi::uint64_t(0xF))
         {}
 
         Category(const std::string &name)
           : name(name)
-          , maxLevel(qi::LogLevel_Silent)
+          , packedLevels(~qi::uint64_t(0xF))
         {}
 
         std::string               name;
-        qi::LogLevel              maxLevel; //max level among all subscribers
-        std::vector<qi::LogLevel> levels;   //level by subscribers
+        // Levels readable with a single load: bits 0-3 hold the max level
+        // among all subscribers, bits 4(n+1) to 4(n+1)+3 the level of
+        // subscriber n < PackedSubscribers, or NoPackedLevel.
+        std::atomic<qi::uint64_t> packedLevels;
+        std::vector<qi::LogLevel> levels;   //level by subscribers, guarded by the log mutex
+        // Copy of `levels` published on each change, read with
+        // std::atomic_load by the dispatch of the messages, which must not
+        // take the log mutex.
+        std::shared_ptr<const std::vector<qi::LogLevel>> levelsSnapshot;
+
+        qi::LogLevel maxLevel() const
+        {
+          return static_cast<qi::LogLevel>(packedLevels.load(std::memory_order_relaxed) & 0xF);
+        }
 
         void setLevel(SubscriberId sub, qi::LogLevel level);
       };
@@ -244,12 +292,173 @@ namespace qi {
         // return std::wstring_convert<std::codecvt_utf8<wchar_t>, wchar_t>().to_bytes(str);
         return boost::locale::conv::utf_to_utf<char>(str.c_str(), str.c_str() + str.size());
       }
+
+      /// Tags of the arguments of messages with deferred formatting. Each
+      /// argument is encoded as its tag followed by its value in native byte
+      /// order: 1 byte for bools and chars, 8 bytes for numbers and pointers,
+      /// and a 32 bits length followed by the characters for strings.
+      enum DeferredArgTag
+      {
+        DeferredArgTag_Bool    = 'b',
+        DeferredArgTag_Char    = 'c',
+        DeferredArgTag_Int     = 'i',
+        DeferredArgTag_UInt    = 'u',
+        DeferredArgTag_Double  = 'd',
+        DeferredArgTag_Pointer = 'p',
+        DeferredArgTag_String  = 's',
+      };
+
+      /// Encodes arguments in a fixed-size buffer. Strings are truncated to
+      /// the room left, and arguments which do not fit at all are skipped.
+      class DeferredArgWriter
+      {
+      public:
+        DeferredArgWriter(char* buffer, std::size_t capacity)
+          : _buffer(buffer)
+          , _capacity(capacity)
+          , _size(0)
+        {
+        }
+
+        void write(DeferredArgTag tag, const void* value, std::size_t size)
+        {
+          if (_size + 1 + size > _capacity)
+            return;
+          _buffer[_size] = static_cast<char>(tag);
+          std::memcpy(_buffer + _size + 1, value, size);
+          _size += 1 + size;
+        }
+
+        void writeString(const char* str, std::size_t length)
+        {
+          const std::size_t header = 1 + sizeof(qi::uint32_t);
+          if (_size + header > _capacity)
+            return;
+          length = (std::min)(length, _capacity - _size - header);
+          const qi::uint32_t length32 = static_cast<qi::uint32_t>(length);
+          _buffer[_size] = static_cast<char>(DeferredArgTag_String);
+          std::memcpy(_buffer + _size + 1, &length32, sizeof(length32));
+          std::memcpy(_buffer + _size + header, str, length);
+          _size += header + length;
+        }
+
+        std::size_t size() const { return _size; }
+
+      private:
+        char* _buffer;
+        std::size_t _capacity;
+        std::size_t _size;
+      };
+
+      inline void encodeDeferredArg(DeferredArgWriter& w, bool v)
+      {
+        w.write(DeferredArgTag_Bool, &v, 1);
+      }
+
+      inline void encodeDeferredArg(DeferredArgWriter& w, char v)
+      {
+        w.write(DeferredArgTag_Char, &v, 1);
+      }
+
+      inline void encodeDeferredArg(DeferredArgWriter& w, const char* v)
+      {
+        if (!v)
+          v = "(null)";
+        w.writeString(v, std::strlen(v));
+      }
+
+      inline void encodeDeferredArg(DeferredArgWriter& w, char* v)
+      {
+        encodeDeferredArg(w, static_cast<const char*>(v));
+      }
+
+      inline void encodeDeferredArg(DeferredArgWriter& w, const std::string& v)
+      {
+        w.writeString(v.data(), v.size());
+      }
+
+      template <typename T>
+      typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value>::type
+        encodeDeferredArg(DeferredArgWriter& w, T v)
+      {
+        const qi::int64_t value = v;
+        w.write(DeferredArgTag_Int, &value, sizeof(value));
+      }
+
+      template <typename T>
+      typename std::enable_if<std::is_integral<T>::value && std::is_unsigned<T>::value>::type
+        encodeDeferredArg(DeferredArgWriter& w, T v)
+      {
+        const qi::uint64_t value = v;
+        w.write(DeferredArgTag_UInt, &value, sizeof(value));
+      }
+
+      template <typename T>
+      typename std::enable_if<std::is_enum<T>::value>::type
+        encodeDeferredArg(DeferredArgWriter& w, T v)
+      {
+        const qi::int64_t value = static_cast<qi::int64_t>(v);
+        w.write(DeferredArgTag_Int, &value, sizeof(value));
+      }
+
+      template <typename T>
+      typename std::enable_if<std::is_floating_point<T>::value>::type
+        encodeDeferredArg(DeferredArgWriter& w, T v)
+      {
+        const double value = v;
+        w.write(DeferredArgTag_Double, &value, sizeof(value));
+      }
+
+      template <typename T>
+      void encodeDeferredArg(DeferredArgWriter& w, T* v)
+      {
+        const qi::uint64_t value = reinterpret_cast<std::uintptr_t>(v);
+        w.write(DeferredArgTag_Pointer, &value, sizeof(value));
+      }
+
+      inline void encodeDeferredArgs(DeferredArgWriter&)
+      {
+      }
+
+      template <typename T, typename... Args>
+      void encodeDeferredArgs(DeferredArgWriter& w, const T& arg, const Args&... args)
+      {
+        encodeDeferredArg(w, arg);
+        encodeDeferredArgs(w, args...);
+      }
+
+      /// Logs a message whose arguments are already encoded.
+      QI_API void logDeferredEncoded(const qi::LogLevel verb,
+                                     CategoryType category,
+                                     const char* file,
+                                     const char* fct,
+                                     const int line,
+                                     const char* format,
+                                     const char* args,
+                                     std::size_t argsSize);
+
+      /// The format is taken by reference to an array so that only literals,
+      /// which outlive the message, can be used.
+      template <std::size_t N, typename... Args>
+      void logDeferred(const qi::LogLevel verb,
+                       CategoryType category,
+                       const char* file,
+                       const char* fct,
+                       const int line,
+                       const char (&format)[N],
+                       const Args&... args)
+      {
+        char buffer[QI_LOG_DEFERRED_ARGS_MAX_SIZE];
+        DeferredArgWriter writer(buffer, sizeof(buffer));
+        encodeDeferredArgs(writer, args...);
+        logDeferredEncoded(verb, category, file, fct, line, format, buffer, writer.size());
+      }
     } // namespace detail
 
     //inlined for perf
     inline bool isVisible(CategoryType category, qi::LogLevel level)
     {
-      return category && level <= category->maxLevel;
+      return category && level <= category->maxLevel();
     }
 
     using CategoryType = detail::Category*;
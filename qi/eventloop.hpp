@@ -13,6 +13,7 @@
 
 # include <boost/thread/synchronized_value.hpp>
 # include <boost/function.hpp>
+# include <vector>
 
 # include <qi/types.hpp>
 # include <qi/api.hpp>
@@ -59,6 +60,14 @@ namespace qi
     EventLoop(std::string name, int nthreads, int minThreads, int maxThreads,
               bool spawnOnOverload);
 
+    /**
+     * \see EventLoop(std::string, int, int, int, bool)
+     * \param cpus CPUs on which the threads of the event loop are pinned,
+     *   including the ones spawned on overload. No pinning if empty.
+     */
+    EventLoop(std::string name, int nthreads, int minThreads, int maxThreads,
+              bool spawnOnOverload, std::vector<int> cpus);
+
     /// \brief Default destructor.
     ~EventLoop() override;
 
@@ -200,10 +209,22 @@ namespace qi
     ) override;
   };
 
-  /// \brief Returns the global eventloop, created on demand on first call.
+  /**
+   * \brief Returns the global eventloop, created on demand on first call.
+   *
+   * Its threads are pinned to the CPUs listed in the environment variable
+   * QI_EVENTLOOP_CPUS (for instance "1-3,6") if it is set. Otherwise, if
+   * QI_EVENTLOOP_NETWORK_CPUS is set, they are pinned to the remaining CPUs so
+   * that compute work does not disturb the network thread.
+   */
   QI_API EventLoop* getEventLoop();
 
-  /// \brief Returns the global network eventloop, created on demand on first call.
+  /**
+   * \brief Returns the global network eventloop, created on demand on first call.
+   *
+   * Its thread is pinned to the CPUs listed in the environment variable
+   * QI_EVENTLOOP_NETWORK_CPUS if it is set.
+   */
   QI_API EventLoop* getNetworkEventLoop();
 
   /**
@@ -15,6 +15,7 @@
 #ifndef _QI_LOG_HPP_
 # define _QI_LOG_HPP_
 
+# include <map>
 # include <string>
 # include <sstream>
 # include <cstdarg>
@@ -72,20 +73,39 @@
 #if defined(NO_QI_DEBUG) || defined(NDEBUG)
 # define qiLogDebug(...) ::qi::log::detail::qiFalse() && false < qi::log::detail::NullStream().self()
 # define qiLogDebugF(Msg, ...) do {} while(0)
+# define qiLogDebugB(...) do {} while(0)
 #else
 # define qiLogDebug(...)   _QI_LOG_MESSAGE_STREAM(LogLevel_Debug,   Debug ,  __VA_ARGS__)
 # define qiLogDebugF(Msg, ...)   _QI_LOG_MESSAGE(LogLevel_Debug,   _QI_LOG_FORMAT(Msg, __VA_ARGS__))
+# define qiLogDebugB(...)   _QI_LOG_DEFERRED(LogLevel_Debug, __VA_ARGS__)
 #endif
 
+/**
+ * \verbatim
+ * The qiLog*B() macros log with deferred formatting: the format, which must be
+ * a string literal, and the raw arguments are recorded, and the message is
+ * only formatted by the log thread, if ever. Binary handlers store them
+ * without formatting at all. Arguments can be of arithmetic, enumeration,
+ * pointer or string types. The category is the one given to qiLogCategory().
+ *
+ * .. code-block:: cpp
+ *
+ *     qiLogCategory("foo.bar");
+ *     qiLogInfoB("position %1% reached in %2%ms", pos, ms);
+ * \endverbatim
+ */
+
 /**
  * \brief Log in verbose mode. This level is not shown by default.
  */
 #if defined(NO_QI_VERBOSE)
 # define qiLogVerbose(...) ::qi::log::detail::qiFalse() && false < qi::log::detail::NullStream().self()
 # define qiLogVerboseF(Msg, ...) do {} while(0)
+# define qiLogVerboseB(...) do {} while(0)
 #else
 # define qiLogVerbose(...) _QI_LOG_MESSAGE_STREAM(LogLevel_Verbose, Verbose, __VA_ARGS__)
 # define qiLogVerboseF(Msg, ...)   _QI_LOG_MESSAGE(LogLevel_Verbose,   _QI_LOG_FORMAT(Msg, __VA_ARGS__))
+# define qiLogVerboseB(...)   _QI_LOG_DEFERRED(LogLevel_Verbose, __VA_ARGS__)
 #endif
 
 /**
@@ -94,9 +114,11 @@
 #if defined(NO_QI_INFO)
 # define qiLogInfo(...) ::qi::log::detail::qiFalse() && false < qi::log::detail::NullStream().self()
 # define qiLogInfoF(Msg, ...) do {} while(0)
+# define qiLogInfoB(...) do {} while(0)
 #else
 # define qiLogInfo(...)    _QI_LOG_MESSAGE_STREAM(LogLevel_Info,    Info,    __VA_ARGS__)
 # define qiLogInfoF(Msg, ...)   _QI_LOG_MESSAGE(LogLevel_Info,   _QI_LOG_FORMAT(Msg, __VA_ARGS__))
+# define qiLogInfoB(...)   _QI_LOG_DEFERRED(LogLevel_Info, __VA_ARGS__)
 #endif
 
 /**
@@ -105,9 +127,11 @@
 #if defined(NO_QI_WARNING)
 # define qiLogWarning(...) ::qi::log::detail::qiFalse() && false < qi::log::detail::NullStream().self()
 # define qiLogWarningF(Msg, ...) do {} while(0)
+# define qiLogWarningB(...) do {} while(0)
 #else
 # define qiLogWarning(...) _QI_LOG_MESSAGE_STREAM(LogLevel_Warning, Warning, __VA_ARGS__)
 # define qiLogWarningF(Msg, ...)   _QI_LOG_MESSAGE(LogLevel_Warning,   _QI_LOG_FORMAT(Msg, __VA_ARGS__))
+# define qiLogWarningB(...)   _QI_LOG_DEFERRED(LogLevel_Warning, __VA_ARGS__)
 #endif
 
 /**
@@ -116,9 +140,11 @@
 #if defined(NO_QI_ERROR)
 # define qiLogError(...)   ::qi::log::detail::qiFalse() && false < qi::log::detail::NullStream().self()
 # define qiLogErrorF(Msg, ...) do {} while(0)
+# define qiLogErrorB(...) do {} while(0)
 #else
 # define qiLogError(...)   _QI_LOG_MESSAGE_STREAM(LogLevel_Error,   Error,   __VA_ARGS__)
 # define qiLogErrorF(Msg, ...)   _QI_LOG_MESSAGE(LogLevel_Error,   _QI_LOG_FORMAT(Msg, __VA_ARGS__))
+# define qiLogErrorB(...)   _QI_LOG_DEFERRED(LogLevel_Error, __VA_ARGS__)
 #endif
 
 /**
@@ -127,9 +153,11 @@
 #if defined(NO_QI_FATAL)
 # define qiLogFatal(...)  ::qi::log::detail::qiFalse() && false < qi::log::detail::NullStream().self()
 # define qiLogFatalF(Msg, ...) do {} while(0)
+# define qiLogFatalB(...) do {} while(0)
 #else
 # define qiLogFatal(...)   _QI_LOG_MESSAGE_STREAM(LogLevel_Fatal,   Fatal,   __VA_ARGS__)
 # define qiLogFatalF(Msg, ...)   _QI_LOG_MESSAGE(LogLevel_Fatal,   _QI_LOG_FORMAT(Msg, __VA_ARGS__))
+# define qiLogFatalB(...)   _QI_LOG_DEFERRED(LogLevel_Fatal, __VA_ARGS__)
 #endif
 
 
@@ -242,6 +270,63 @@ namespace qi {
                              const char*,
                              int>;
 
+    /**
+     * \brief A log message as seen by binary handlers.
+     *
+     * Messages logged with deferred formatting have a `format` and `message`
+     * holds the `messageSize` bytes of their encoded arguments: use
+     * formatMessage() to get their text. Otherwise `message` is the text.
+     */
+    struct DeferredLogRecord
+    {
+      qi::LogLevel                level;
+      qi::Clock::time_point       date;
+      qi::SystemClock::time_point systemDate;
+      const char*                 category;
+      const char*                 file;
+      const char*                 function;
+      int                         line;
+      const char*                 format;
+      const char*                 message;
+      std::size_t                 messageSize;
+    };
+
+    /**
+     * \brief Boost delegate to a log function receiving messages before they
+     *        are formatted.
+     */
+    using BinaryHandler = boost::function<void (const DeferredLogRecord&)>;
+
+    /// What happens to a message for a queued handler whose queue is full.
+    enum class QueueFullPolicy
+    {
+      Drop,  ///< The message is dropped for this handler and counted.
+      Block, ///< The logging waits until the handler makes room.
+    };
+
+    /// Queue of a handler called by its own thread, see addHandler().
+    struct HandlerQueueConfig
+    {
+      /// Maximum number of messages waiting for the handler.
+      std::size_t     size = 4096;
+      QueueFullPolicy policy = QueueFullPolicy::Drop;
+    };
+
+    /// Statistics of a log handler, see handlerStats().
+    struct HandlerStats
+    {
+      /// Number of messages the handler was called with.
+      qi::uint64_t handled = 0;
+      /// Number of messages dropped because the queue of the handler was full.
+      qi::uint64_t dropped = 0;
+      /// Number of messages waiting in the queue of the handler.
+      std::size_t  queued = 0;
+      /// Mean and maximum delay between the logging of a message and the
+      /// return of the handler called with it.
+      qi::Duration meanLatency = qi::Duration::zero();
+      qi::Duration maxLatency = qi::Duration::zero();
+    };
+
     /// Environment variables used by qi::log.
     /// Use qi::os::getenv() to get their value.
     namespace env {
@@ -536,9 +621,27 @@ namespace qi {
      */
     QI_API void setSynchronousLog(bool sync);
 
+    /**
+     * \brief Set the size of the buffer of each thread logging asynchronously.
+     * \param size Size in bytes, rounded up to a power of two.
+     *
+     * When the buffer of a thread is full, its new messages are dropped until
+     * the log thread catches up. Only applies to threads which did not log
+     * asynchronously yet. Can also be set with the QI_LOG_BUFFER_SIZE
+     * environment variable, defaults to 256 KiB.
+     */
+    QI_API void setAsynchronousBufferSize(std::size_t size);
+
+    /**
+     * \return The number of asynchronous log messages dropped because the
+     * buffer of their thread was full.
+     */
+    QI_API qi::uint64_t droppedMessageCount();
+
     /**
      * \brief Add a log handler for this process' logs.
      * \warning Handlers are usually called synchronously, they must not block.
+     * Handlers which may be slow should be given their own queue.
      * \param name Name of the handler, useful to remove handler (prefer lowercase).
      * \param fct Boost delegate to log handler function.
      * \param defaultLevel default log verbosity.
@@ -560,6 +663,57 @@ namespace qi {
                                       qi::log::logFuncHandler fct,
                                       qi::LogLevel defaultLevel = LogLevel_Info);
 
+    /**
+     * \brief Add a log handler receiving messages before they are formatted.
+     * \param name Name of the handler, useful to remove it with removeHandler().
+     * \param fct Boost delegate to the log handler function.
+     * \param defaultLevel default log verbosity.
+     * \return New log subscriber id added.
+     */
+    QI_API SubscriberId addBinaryHandler(const std::string& name,
+                                         BinaryHandler fct,
+                                         qi::LogLevel defaultLevel = LogLevel_Info);
+
+    /**
+     * \brief Add a log handler called by its own thread.
+     * \param name Name of the handler, useful to remove handler (prefer lowercase).
+     * \param fct Boost delegate to log handler function.
+     * \param defaultLevel default log verbosity.
+     * \param queue size of the queue of the handler and what to do when it is full.
+     * \return New log subscriber id added.
+     *
+     * Messages are copied into the queue of the handler, so that a slow
+     * handler delays neither the other handlers nor the logging threads. It
+     * only blocks the logging, if ever, with QueueFullPolicy::Block.
+     *
+     * \warning With QueueFullPolicy::Block, a handler which logs while
+     * synchronous logging is enabled may deadlock.
+     */
+    QI_API SubscriberId addHandler(const std::string& name,
+                                   qi::log::Handler fct,
+                                   qi::LogLevel defaultLevel,
+                                   HandlerQueueConfig queue);
+
+    /**
+     * \copybrief addHandler(const std::string&, qi::log::Handler, qi::LogLevel, HandlerQueueConfig)
+     * \see addBinaryHandler(const std::string&, BinaryHandler, qi::LogLevel)
+     */
+    QI_API SubscriberId addBinaryHandler(const std::string& name,
+                                         BinaryHandler fct,
+                                         qi::LogLevel defaultLevel,
+                                         HandlerQueueConfig queue);
+
+    /**
+     * \return The statistics of each handler, by name.
+     */
+    QI_API std::map<std::string, HandlerStats> handlerStats();
+
+    /**
+     * \return The text of the message, formatting it if it was logged with
+     * deferred formatting.
+     */
+    QI_API std::string formatMessage(const DeferredLogRecord& record);
+
     /**
      * \brief Remove a log handler.
      * \param name Name of the handler.
@@ -0,0 +1,99 @@
+#pragma once
+/*
+**  Copyright (C) 2018 SoftBank Robotics Europe
+**  See COPYING for the license
+*/
+
+#ifndef _QI_LOG_BINARYFILELOGHANDLER_HPP_
+#define _QI_LOG_BINARYFILELOGHANDLER_HPP_
+
+#include <memory>
+#include <boost/noncopyable.hpp>
+#include <qi/log.hpp>
+
+namespace qi
+{
+namespace log
+{
+  struct PrivateBinaryFileLogHandler;
+  struct PrivateBinaryLogFileReader;
+
+  /**
+   * \includename{qi/log/binaryfileloghandler.hpp}
+   *
+   * This class writes all logs to a file in a compact binary form, without
+   * formatting the messages logged with deferred formatting. Use
+   * BinaryLogFileReader, or the qilogdecode tool, to read it back.
+   *
+   * Strings (formats, categories, files and functions) are written once, the
+   * first time they are used, and then referred to by an id. Writes are
+   * buffered: the file is only flushed when the buffer is full, on messages
+   * of warning level or worse, on flush() and on destruction.
+   *
+   * Register it with qi::log::addBinaryHandler:
+   *
+   * \verbatim
+   * .. code-block:: cpp
+   *
+   *     qi::log::BinaryFileLogHandler handler("/var/log/app.qilog");
+   *     qi::log::addBinaryHandler("binaryfile",
+   *         boost::bind(&qi::log::BinaryFileLogHandler::log, &handler, _1));
+   * \endverbatim
+   */
+  class QI_API BinaryFileLogHandler : private boost::noncopyable
+  {
+  public:
+    /**
+     * \brief Opens the file, truncating it.
+     * \param filePath the path to the file where log messages will be written.
+     *
+     * If the file could not be opened, it logs a warning and every log call
+     * will silently fail.
+     */
+    explicit BinaryFileLogHandler(const std::string& filePath);
+
+    /// \brief Flushes and closes the file.
+    virtual ~BinaryFileLogHandler();
+
+    /// \brief Writes a log message to the file.
+    void log(const DeferredLogRecord& record);
+
+    /// \brief Writes the buffered messages to the file.
+    void flush();
+
+  private:
+    std::unique_ptr<PrivateBinaryFileLogHandler> _p;
+  };
+
+  /**
+   * \includename{qi/log/binaryfileloghandler.hpp}
+   *
+   * Reads the messages written by a BinaryFileLogHandler.
+   */
+  class QI_API BinaryLogFileReader : private boost::noncopyable
+  {
+  public:
+    /// \throw std::runtime_error if the file cannot be opened or is not a
+    /// binary log file of a compatible version.
+    explicit BinaryLogFileReader(const std::string& filePath);
+    ~BinaryLogFileReader();
+
+    /**
+     * \brief Reads the next message.
+     * \return false at the end of the file, or if the rest of the file is
+     * truncated or corrupted.
+     *
+     * The pointers of the record remain valid until the next call.
+     * Dates are only meaningful if the file was written by a process of the
+     * same machine.
+     */
+    bool next(DeferredLogRecord& record);
+
+  private:
+    std::unique_ptr<PrivateBinaryLogFileReader> _p;
+  };
+
+}
+}
+
+#endif // _QI_LOG_BINARYFILELOGHANDLER_HPP_
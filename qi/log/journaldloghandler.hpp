@@ -33,7 +33,7 @@ namespace log
      * The returned handler is not thread-safe, which is fine: libqi does not
      * call its log handlers concurrently.
      */
-    Handler makeJournaldLogHandler();
+    QI_API Handler makeJournaldLogHandler();
 }; // !log
 }; // !qi
 
@@ -0,0 +1,117 @@
+#pragma once
+/*
+**  Copyright (C) 2018 SoftBank Robotics Europe
+**  See COPYING for the license
+*/
+
+#ifndef _QI_LOG_ROTATINGFILELOGHANDLER_HPP_
+#define _QI_LOG_ROTATINGFILELOGHANDLER_HPP_
+
+#include <memory>
+#include <string>
+#include <boost/noncopyable.hpp>
+#include <qi/clock.hpp>
+#include <qi/log.hpp>
+
+namespace qi
+{
+namespace log
+{
+  struct PrivateRotatingFileLogHandler;
+
+  struct QI_API RotatingFileLogHandlerConfig
+  {
+    /// Size of the buffers in which log lines are gathered before being
+    /// written in a single call.
+    std::size_t bufferSize = 64 * 1024;
+    /// Maximum number of full buffers waiting to be written. When they are
+    /// all waiting, logging blocks until the writer catches up.
+    std::size_t maxPendingBuffers = 16;
+    /// Maximum delay between the logging of a message and its flush to the
+    /// file.
+    qi::Duration flushInterval = qi::Seconds(1);
+    /// Messages of this level or worse are flushed without delay.
+    qi::LogLevel flushLevel = qi::LogLevel_Warning;
+    /// The file is rotated when it reaches this size, 0 to disable.
+    std::size_t maxFileSize = 10 * 1024 * 1024;
+    /// The file is rotated when it has been written for this long, 0 to
+    /// disable.
+    qi::Duration maxFileAge = qi::Duration::zero();
+    /// Number of rotated files to keep, the oldest are removed.
+    unsigned int maxRotatedFiles = 5;
+    /// Gzip rotated files in the background. Ignored, with a warning, if
+    /// libqi was built without zlib.
+    bool compressRotatedFiles = false;
+  };
+
+  /**
+   * \includename{qi/log/rotatingfileloghandler.hpp}
+   *
+   * \verbatim
+   * This class writes the logs to a file, in batches, from a background
+   * thread: log() only appends the formatted line to a buffer, which is
+   * written when it is full, when a message of level
+   * *RotatingFileLogHandlerConfig::flushLevel* or worse is logged, or at the
+   * latest every *RotatingFileLogHandlerConfig::flushInterval*.
+   *
+   * When the file gets too big or too old, it is renamed to *filePath*.N,
+   * where N increases with each rotation, and a new file is started. Only the
+   * last *RotatingFileLogHandlerConfig::maxRotatedFiles* rotated files are
+   * kept. They can be compressed to *filePath*.N.gz by another background
+   * thread.
+   * \endverbatim
+   */
+  class QI_API RotatingFileLogHandler : private boost::noncopyable
+  {
+  public:
+    /**
+     * \brief Opens the file, appending to it, and starts the writer thread.
+     * \param filePath path to the file.
+     * \param config buffering and rotation settings.
+     *
+     * \verbatim
+     * .. warning::
+     *
+     *      If the file could not be opened, it logs a warning and every log call
+     *      will silently fail.
+     * \endverbatim
+     */
+    explicit RotatingFileLogHandler(const std::string& filePath,
+                                    RotatingFileLogHandlerConfig config = {});
+
+    /**
+     * \brief Writes the pending logs, waits for the compressions in progress
+     * and closes the file.
+     */
+    virtual ~RotatingFileLogHandler();
+
+    /**
+     * \brief Buffers the log message.
+     * \param verb verbosity of the log message.
+     * \param date qi::Clock date at which the log message was issued.
+     * \param systemDate qi::SystemClock date at which the log message was issued.
+     * \param category will be used in future for filtering
+     * \param msg message to log.
+     * \param file filename in the sources from which this log message was issued.
+     * \param fct function name from which this log message was issued.
+     * \param line line number in the issuer file.
+     */
+    void log(const qi::LogLevel verb,
+             const qi::Clock::time_point date,
+             const qi::SystemClock::time_point systemDate,
+             const char* category,
+             const char* msg,
+             const char* file,
+             const char* fct,
+             const int line);
+
+    /// \brief Blocks until every message logged so far is written and flushed.
+    void flush();
+
+  private:
+    std::unique_ptr<PrivateRotatingFileLogHandler> _p;
+  };
+}
+}
+
+#endif // _QI_LOG_ROTATINGFILELOGHANDLER_HPP_
@@ -0,0 +1,120 @@
+#pragma once
+/*
+**  Copyright (C) 2018 SoftBank Robotics Europe
+**  See COPYING for the license
+*/
+
+#ifndef _QI_LOG_SHAREDMEMORYLOGHANDLER_HPP_
+#define _QI_LOG_SHAREDMEMORYLOGHANDLER_HPP_
+
+#include <memory>
+#include <string>
+#include <boost/noncopyable.hpp>
+#include <qi/clock.hpp>
+#include <qi/log.hpp>
+
+namespace qi
+{
+namespace log
+{
+  struct PrivateSharedMemoryLogHandler;
+  struct PrivateSharedMemoryLogReader;
+
+  /// Name of the shared memory segment used when none is given.
+  QI_API extern char const * const defaultSharedMemoryLogName;
+
+  /**
+   * \includename{qi/log/sharedmemoryloghandler.hpp}
+   *
+   * \verbatim
+   * This class sends all logs to a collector process, the qilogcollector
+   * tool, through a ring in shared memory: log() only copies the unformatted
+   * message in the ring, formatting, filtering and writing to files or to the
+   * journal are left to the collector, for all the processes of the machine.
+   *
+   * Messages are dropped, and counted, if the ring is full or if no collector
+   * has created the shared memory segment yet. The handler attaches to the
+   * segment as soon as it exists.
+   *
+   * Register it with qi::log::addBinaryHandler, so that the messages logged
+   * with deferred formatting are not formatted in this process:
+   *
+   * .. code-block:: cpp
+   *
+   *     qi::log::SharedMemoryLogHandler handler;
+   *     qi::log::addBinaryHandler("sharedmemory",
+   *         boost::bind(&qi::log::SharedMemoryLogHandler::log, &handler, _1));
+   * \endverbatim
+   */
+  class QI_API SharedMemoryLogHandler : private boost::noncopyable
+  {
+  public:
+    /// \param name name of the shared memory segment created by the collector.
+    explicit SharedMemoryLogHandler(const std::string& name = defaultSharedMemoryLogName);
+    virtual ~SharedMemoryLogHandler();
+
+    /// \brief Copies a log message in the ring. Never blocks.
+    void log(const DeferredLogRecord& record);
+
+    /// \brief Whether the handler is attached to the segment of a collector.
+    bool isAttached() const;
+
+    /// \brief Number of messages of this process dropped because the ring
+    /// was full or because no collector was running.
+    qi::uint64_t droppedMessageCount() const;
+
+  private:
+    std::unique_ptr<PrivateSharedMemoryLogHandler> _p;
+  };
+
+  /**
+   * \includename{qi/log/sharedmemoryloghandler.hpp}
+   *
+   * Creates the shared memory segment and reads the messages written in it by
+   * the SharedMemoryLogHandler of any process. There must be only one reader
+   * per segment.
+   */
+  class QI_API SharedMemoryLogReader : private boost::noncopyable
+  {
+  public:
+    /**
+     * \brief Creates the segment, or reuses it if it already exists, so that
+     * the messages logged while no reader was running are not lost. A created
+     * segment is only accessible to the user running the reader.
+     * \param name name of the shared memory segment.
+     * \param size size of the ring in bytes, rounded up to a power of two, at
+     * most 4 GiB. Ignored if a compatible segment already exists.
+     * \throw std::runtime_error if the segment cannot be created.
+     */
+    explicit SharedMemoryLogReader(const std::string& name = defaultSharedMemoryLogName,
+                                   std::size_t size = 4 * 1024 * 1024);
+
+    /// \brief Unmaps the segment, which stays available to a next reader.
+    ~SharedMemoryLogReader();
+
+    /**
+     * \brief Waits for the next message.
+     * \param record receives the message. Its pointers remain valid until the
+     * next call.
+     * \param pid receives the identifier of the process which logged it.
+     * \param timeout maximum delay to wait for a message.
+     * \return false if no message arrived in time.
+     */
+    bool next(DeferredLogRecord& record, int& pid, qi::Duration timeout = qi::Duration::zero());
+
+    /// \brief Total number of messages dropped by the handlers of all
+    /// processes because the ring was full, or lost because a process died
+    /// while writing one.
+    qi::uint64_t droppedMessageCount() const;
+
+    /// \brief Removes the segment. The handlers attached to it keep writing
+    /// in it until they are destroyed, but no reader will see their messages.
+    static void remove(const std::string& name = defaultSharedMemoryLogName);
+
+  private:
+    std::unique_ptr<PrivateSharedMemoryLogReader> _p;
+  };
+}
+}
+
+#endif // _QI_LOG_SHAREDMEMORYLOGHANDLER_HPP_
@@ -0,0 +1,79 @@
+#pragma once
+/*
+**  Copyright (C) 2018 SoftBank Robotics Europe
+**  See COPYING for the license
+*/
+
+#ifndef _QIMESSAGING_CALLSCHEDULING_HPP_
+#define _QIMESSAGING_CALLSCHEDULING_HPP_
+
+#include <cstddef>
+
+#include <boost/function.hpp>
+
+#include <qi/api.hpp>
+#include <qi/clock.hpp>
+#include <qi/types.hpp>
+#include <qi/url.hpp>
+
+namespace qi
+{
+  /// Beginning of the error of the calls rejected because the queues of a
+  /// service are full.
+  QI_API extern char const * const serviceOverloadedError;
+
+  /**
+   * \includename{qi/messaging/callscheduling.hpp}
+   *
+   * Limits the calls that the clients of a session can have in progress on
+   * each of its services, so that a client cannot starve the others.
+   *
+   * The calls beyond the limits wait in a queue per client. When a call
+   * finishes, the clients which have calls waiting are served in turn, each
+   * one starting up to its weight of calls before the next one. The calls
+   * beyond the sizes of the queues fail with serviceOverloadedError.
+   *
+   * A limit of 0 disables it. Calls are only scheduled if at least one of the
+   * in-flight limits is set.
+   */
+  struct QI_API CallSchedulingConfig
+  {
+    /// Maximum number of calls of one client in progress on a service.
+    unsigned int maxInFlightCallsPerClient = 0;
+    /// Maximum number of calls of all the clients in progress on a service.
+    unsigned int maxInFlightCalls = 0;
+    /// Maximum number of calls of one client waiting on a service.
+    unsigned int maxQueuedCallsPerClient = 0;
+    /// Maximum number of calls of all the clients waiting on a service.
+    unsigned int maxQueuedCalls = 0;
+    /// Weight of a client given its address, 1 for all clients if not set.
+    boost::function<unsigned int (const qi::Url&)> clientWeight;
+
+    bool enabled() const
+    {
+      return maxInFlightCallsPerClient != 0 || maxInFlightCalls != 0;
+    }
+  };
+
+  /// Counters of the calls scheduled on a service, see Session::callSchedulingStats.
+  struct QI_API CallSchedulingStats
+  {
+    /// Calls started, either at once or after waiting.
+    qi::uint64_t started = 0;
+    /// Calls which had to wait before starting.
+    qi::uint64_t delayed = 0;
+    /// Calls rejected with serviceOverloadedError.
+    qi::uint64_t rejected = 0;
+    /// Calls currently in progress.
+    std::size_t inFlight = 0;
+    /// Calls currently waiting.
+    std::size_t waiting = 0;
+    /// Clients currently having calls in progress or waiting.
+    std::size_t clients = 0;
+    /// Total and maximum delays of the calls which had to wait.
+    qi::Duration totalQueueDelay = qi::Duration::zero();
+    qi::Duration maxQueueDelay = qi::Duration::zero();
+  };
+}
+
+#endif  // _QIMESSAGING_CALLSCHEDULING_HPP_
@@ -23,6 +23,7 @@ public:
   using ListenStatus = ServiceDirectoryProxy::ListenStatus;
   using ConnectionStatus = ServiceDirectoryProxy::ConnectionStatus;
   using Status = ServiceDirectoryProxy::Status;
+  using ForwardingMode = ServiceDirectoryProxy::ForwardingMode;
 
   /**
    * @param enforceAuth If set to true, reject clients that try to skip the authentication step. If
@@ -53,6 +54,9 @@ public:
 
   qi::Future<void> attachToServiceDirectory(const Url& serviceDirectoryUrl);
 
+  /// @see ServiceDirectoryProxy::setForwardingMode
+  Future<ForwardingMode> setForwardingMode(ForwardingMode mode);
+
   void close();
 };
 }
@@ -0,0 +1,48 @@
+#pragma once
+/*
+**  Copyright (C) 2018 SoftBank Robotics Europe
+**  See COPYING for the license
+*/
+
+#ifndef _QIMESSAGING_MESSAGEPRIORITY_HPP_
+#define _QIMESSAGING_MESSAGEPRIORITY_HPP_
+
+#include <boost/noncopyable.hpp>
+
+#include <qi/api.hpp>
+#include <qi/type/typeobject.hpp>
+
+namespace qi
+{
+  /// @return the priority of the calls and posts made on remote objects by
+  /// the current thread, MessagePriority_Normal unless a
+  /// ScopedMessagePriority is alive.
+  QI_API MessagePriority currentMessagePriority();
+
+  /**
+   * \includename{qi/messaging/messagepriority.hpp}
+   *
+   * Sets the priority of the calls and posts made on remote objects by the
+   * current thread while it is alive.
+   *
+   * \code{.cpp}
+   * {
+   *   qi::ScopedMessagePriority urgent(qi::MessagePriority_High);
+   *   motion.async<void>("stop");
+   * }
+   * \endcode
+   *
+   * The priority of the signals is set with SignalBase::setMessagePriority.
+   */
+  class QI_API ScopedMessagePriority : private boost::noncopyable
+  {
+  public:
+    explicit ScopedMessagePriority(MessagePriority priority);
+    ~ScopedMessagePriority();
+
+  private:
+    MessagePriority _previous;
+  };
+}
+
+#endif  // _QIMESSAGING_MESSAGEPRIORITY_HPP_
@@ -0,0 +1,56 @@
+#pragma once
+/*
+**  Copyright (C) 2018 SoftBank Robotics Europe
+**  See COPYING for the license
+*/
+
+#ifndef _QIMESSAGING_SERVICECACHE_HPP_
+#define _QIMESSAGING_SERVICECACHE_HPP_
+
+#include <cstddef>
+
+#include <qi/api.hpp>
+#include <qi/types.hpp>
+
+namespace qi
+{
+  /**
+   * \includename{qi/messaging/servicecache.hpp}
+   *
+   * Keeps a copy of the service infos of the service directory a session is
+   * connected to, so that looking a service up or waiting for it does not
+   * need a round trip to the service directory.
+   *
+   * The copy is filled once connected, then kept up to date with the
+   * serviceAdded and serviceRemoved events of the service directory. The
+   * endpoints a service adds after its registration are only seen once a
+   * connection to it fails, which drops its info from the copy.
+   */
+  struct QI_API ServiceCacheConfig
+  {
+    bool enabled = false;
+  };
+
+  /// Counters of the service info cache of a session, see Session::serviceCacheStats.
+  struct QI_API ServiceCacheStats
+  {
+    /// True once the cache was filled, until the session disconnects.
+    bool synchronized = false;
+    /// Services known, and those whose info is still being fetched.
+    std::size_t services = 0;
+    std::size_t pending = 0;
+    /// Lookups answered by the cache, and those sent to the service directory.
+    qi::uint64_t hits = 0;
+    qi::uint64_t misses = 0;
+    /// Times the cache was filled, i.e. once per connection.
+    qi::uint64_t synchronizations = 0;
+    /// Infos fetched after a serviceAdded event or a miss.
+    qi::uint64_t fetches = 0;
+    /// Fetched infos dropped because the service was removed meanwhile.
+    qi::uint64_t discarded = 0;
+    /// Infos dropped because a connection to their service failed.
+    qi::uint64_t invalidations = 0;
+  };
+}
+
+#endif  // _QIMESSAGING_SERVICECACHE_HPP_
@@ -74,6 +74,13 @@ public:
     Starting,           ///< The proxy started connection to the service directory.
   };
 
+  enum class ForwardingMode
+  {
+    Mirroring, ///< Every message is decoded and passed to a local proxy of the service.
+    Raw,       ///< The messages are forwarded with their payload as is, unless they may
+               ///  carry object references.
+  };
+
   using ServiceFilter = std::function<bool(boost::string_ref)>;
 
   struct Status
@@ -121,11 +128,19 @@ public:
   /// @returns The previous filter
   Future<ServiceFilter> setServiceFilter(ServiceFilter filter
      = ka::constant_function(false));
+
+  /// In the raw mode, the calls, posts, events and cancellations crossing the proxy are
+  /// forwarded with only their header rewritten. The messages which may carry object references
+  /// are still decoded, as in the mirroring mode.
+  /// Applies to the services mirrored afterwards.
+  /// @returns The previous mode
+  Future<ForwardingMode> setForwardingMode(ForwardingMode mode);
 };
 
 QI_API std::ostream& operator<<(std::ostream&, ServiceDirectoryProxy::IdValidationStatus);
 QI_API std::ostream& operator<<(std::ostream&, ServiceDirectoryProxy::ListenStatus);
 QI_API std::ostream& operator<<(std::ostream&, ServiceDirectoryProxy::ConnectionStatus);
+QI_API std::ostream& operator<<(std::ostream&, ServiceDirectoryProxy::ForwardingMode);
 
 }
 
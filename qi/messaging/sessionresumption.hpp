@@ -0,0 +1,39 @@
+#pragma once
+/*
+**  Copyright (C) 2018 SoftBank Robotics Europe
+**  See COPYING for the license
+*/
+
+#ifndef _QIMESSAGING_SESSIONRESUMPTION_HPP_
+#define _QIMESSAGING_SESSIONRESUMPTION_HPP_
+
+#include <qi/api.hpp>
+#include <qi/clock.hpp>
+
+namespace qi
+{
+  /**
+   * \includename{qi/messaging/sessionresumption.hpp}
+   *
+   * Lets a client which lost its socket to a service reconnect and get back
+   * its remote objects, their event subscriptions and their metaObjects in a
+   * single round trip, instead of fetching them all again.
+   *
+   * Both sessions must enable it. The service keeps the state of a
+   * disconnected client for `gracePeriod`, and the client tries to reconnect
+   * for as long. The calls pending when the socket was lost fail, and the
+   * events triggered until the client is back are lost.
+   */
+  struct QI_API SessionResumptionConfig
+  {
+    /// Zero disables the resumption.
+    qi::MilliSeconds gracePeriod{0};
+
+    bool enabled() const
+    {
+      return gracePeriod > qi::MilliSeconds::zero();
+    }
+  };
+}
+
+#endif  // _QIMESSAGING_SESSIONRESUMPTION_HPP_
@@ -0,0 +1,46 @@
+#pragma once
+/*
+**  Copyright (C) 2018 SoftBank Robotics Europe
+**  See COPYING for the license
+*/
+
+#ifndef _QIMESSAGING_SOCKETPOOL_HPP_
+#define _QIMESSAGING_SOCKETPOOL_HPP_
+
+#include <cstddef>
+
+#include <qi/api.hpp>
+
+namespace qi
+{
+  /**
+   * \includename{qi/messaging/socketpool.hpp}
+   *
+   * Number of sockets a session opens to each endpoint of the services it
+   * uses, so that a large message does not delay all the others.
+   *
+   * With more than one socket, the last one is the bulk lane: it carries the
+   * calls whose arguments, or whose last reply, are at least
+   * `bulkPayloadThreshold` bytes. The other calls are spread over the other
+   * sockets. Events, signal registrations and the calls which may carry
+   * objects always use the first socket.
+   *
+   * The calls of a client made on different sockets may be received out of
+   * order by the service.
+   */
+  struct QI_API SocketPoolConfig
+  {
+    /// Sockets per endpoint, including the first one. 1 disables the pool.
+    unsigned int socketsPerEndpoint = 1;
+    /// Minimum size of the payload of the calls sent on the bulk lane, 0
+    /// disables the bulk lane so that all the sockets are used for all calls.
+    std::size_t bulkPayloadThreshold = 256 * 1024;
+
+    bool enabled() const
+    {
+      return socketsPerEndpoint > 1;
+    }
+  };
+}
+
+#endif  // _QIMESSAGING_SOCKETPOOL_HPP_
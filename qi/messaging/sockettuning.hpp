@@ -0,0 +1,64 @@
+#pragma once
+/*
+**  Copyright (C) 2018 SoftBank Robotics Europe
+**  See COPYING for the license
+*/
+
+#ifndef _QIMESSAGING_SOCKETTUNING_HPP_
+#define _QIMESSAGING_SOCKETTUNING_HPP_
+
+#include <map>
+
+#include <qi/api.hpp>
+#include <qi/url.hpp>
+
+namespace qi
+{
+  /// Options of a TCP socket, see SocketTuningConfig.
+  struct QI_API SocketTuning
+  {
+    /// Sizes of the send and receive buffers of the kernel (SO_SNDBUF and
+    /// SO_RCVBUF) in bytes, 0 to keep the defaults of the system.
+    int sendBufferSize = 0;
+    int receiveBufferSize = 0;
+    /// Sends each message at once, instead of waiting for the previous
+    /// segments to be acknowledged (TCP_NODELAY).
+    bool noDelay = true;
+    /// While messages are queued behind the one being sent, holds the partial
+    /// segments until the queue is empty (TCP_CORK), so that a burst of small
+    /// messages goes in full segments. A message sent alone is not delayed.
+    /// Linux only.
+    bool corkBatches = false;
+    /// Time in microseconds the reads and polls of the socket busy wait for
+    /// packets on the device queue (SO_BUSY_POLL), 0 to disable. Going above
+    /// the net.core.busy_read sysctl requires CAP_NET_ADMIN. Linux only.
+    unsigned int busyPollMicroseconds = 0;
+    /// Acceptors listening to each endpoint, among which the kernel spreads
+    /// the incoming connections (SO_REUSEPORT). 1 disables it. Not available
+    /// on Windows.
+    unsigned int acceptors = 1;
+  };
+
+  /**
+   * \includename{qi/messaging/sockettuning.hpp}
+   *
+   * Options of the TCP sockets a session opens and accepts.
+   *
+   * The sockets connecting to an URL of `urls`, or accepted on an URL of
+   * `urls` the session listens to, use its options instead of the defaults.
+   * The URLs must match exactly, the port included.
+   */
+  struct QI_API SocketTuningConfig
+  {
+    SocketTuning defaults;
+    std::map<Url, SocketTuning> urls;
+
+    const SocketTuning& forUrl(const Url& url) const
+    {
+      const auto it = urls.find(url);
+      return it == urls.end() ? defaults : it->second;
+    }
+  };
+}
+
+#endif  // _QIMESSAGING_SOCKETTUNING_HPP_
@@ -0,0 +1,36 @@
+#pragma once
+/*
+**  Copyright (C) 2018 SoftBank Robotics Europe
+**  See COPYING for the license
+*/
+
+#ifndef _QIMESSAGING_TLSOFFLOAD_HPP_
+#define _QIMESSAGING_TLSOFFLOAD_HPP_
+
+#include <qi/api.hpp>
+
+namespace qi
+{
+  /**
+   * \includename{qi/messaging/tlsoffload.hpp}
+   *
+   * Hands the encryption of the messages a session sends on `tcps://`
+   * connections to the kernel (Linux kernel TLS) once the TLS handshake is
+   * done. The messages are then written to the socket as they are, instead
+   * of being copied and encrypted into TLS records by OpenSSL.
+   *
+   * Only the sending side is offloaded: received messages are still
+   * decrypted by OpenSSL, so a peer needs no support for it. The kernel
+   * supports TLS 1.2 with AES-GCM, so enabling the offload disables TLS 1.3
+   * on the connections the session opens and accepts.
+   *
+   * A connection whose kernel lacks TLS support (the `tls` module), or whose
+   * negotiated cipher cannot be offloaded, keeps encrypting in user space.
+   */
+  struct QI_API TlsOffloadConfig
+  {
+    bool enabled = false;
+  };
+}
+
+#endif  // _QIMESSAGING_TLSOFFLOAD_HPP_
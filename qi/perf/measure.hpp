@@ -9,6 +9,10 @@
 #ifndef _QI_PERF_UTILS_HPP_
 #define _QI_PERF_UTILS_HPP_
 
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
 #include <qi/api.hpp>
 
 namespace qi
@@ -17,6 +21,17 @@ namespace qi
   {
     // Get the number of fd currently open. Works only for linux.
     QI_API int getNumFD();
+
+    // Get the value of `sorted` (in increasing order) below which `ratio` of
+    // the values lie, using the nearest rank. Returns 0 if `sorted` is empty.
+    template <typename T>
+    T percentile(const std::vector<T>& sorted, double ratio)
+    {
+      if (sorted.empty())
+        return T(0);
+      const auto index = static_cast<std::size_t>(ratio * (sorted.size() - 1) + 0.5);
+      return sorted[std::min(index, sorted.size() - 1)];
+    }
   }
 }
 
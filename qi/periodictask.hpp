@@ -6,6 +6,7 @@
 # define _QI_PERIODICTASK_HPP_
 
 # include <string>
+# include <vector>
 
 # include <boost/function.hpp>
 # include <boost/utility.hpp>
@@ -121,6 +122,32 @@ namespace qi
      */
     void compensateCallbackTime(bool compensate);
 
+    /**
+     * If argument is true, calls are scheduled on absolute deadlines
+     * (first call + n * period) instead of relatively to the previous call,
+     * so that neither the call duration nor the scheduling latency accumulate
+     * into drift. Deadlines that were entirely missed are skipped. A trigger()
+     * restarts the sequence of deadlines from the triggered call.
+     *
+     * When enabled, compensateCallbackTime() has no effect.
+     */
+    void useAbsoluteDeadlines(bool enable);
+
+    /**
+     * \brief Run the callback on a thread owned by the task instead of the
+     * global event loop.
+     * \param cpus CPUs the thread is pinned to. No pinning if empty.
+     * \param realtimePriority If strictly positive, the thread is switched to
+     * the SCHED_FIFO policy with this priority. This is only supported on
+     * POSIX systems and usually requires privileges: failures are logged and
+     * the thread keeps running with its default policy.
+     *
+     * \warning This must be called while the task is stopped. It has no effect
+     * if a strand is set, the calls being scheduled on that strand.
+     */
+    void setDedicatedThread(const std::vector<int>& cpus = std::vector<int>(),
+                            int realtimePriority = 0);
+
     /// \brief Set name for debugging and tracking purpose.
     /// \param name Name of the periodic task.
     void setName(const std::string& name);
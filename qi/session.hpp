@@ -10,6 +10,13 @@
 #include <qi/api.hpp>
 #include <qi/clock.hpp>
 #include <qi/messaging/serviceinfo.hpp>
+#include <qi/messaging/callscheduling.hpp>
+#include <qi/messaging/socketpool.hpp>
+#include <qi/messaging/sessionresumption.hpp>
+#include <qi/messaging/servicecache.hpp>
+#include <qi/messaging/tlsoffload.hpp>
+#include <qi/messaging/sockettuning.hpp>
+#include <qi/messaging/messagepriority.hpp>
 #include <qi/messaging/authproviderfactory.hpp>
 #include <qi/messaging/clientauthenticatorfactory.hpp>
 #include <qi/future.hpp>
@@ -43,6 +50,18 @@ namespace qi {
 
     boost::optional<Url> connectUrl;
     std::vector<Url> listenUrls;
+    /// Limits of the calls of the clients to the services registered by the session.
+    CallSchedulingConfig callScheduling;
+    /// Sockets opened to each endpoint of the services used by the session.
+    SocketPoolConfig socketPool;
+    /// Resumption of the sessions of the clients whose socket was lost.
+    SessionResumptionConfig sessionResumption;
+    /// Copy of the service infos of the service directory.
+    ServiceCacheConfig serviceCache;
+    /// Encryption by the kernel of the messages sent on tcps:// connections.
+    TlsOffloadConfig tlsOffload;
+    /// Options of the TCP sockets opened and accepted by the session.
+    SocketTuningConfig socketTuning;
   };
 
   /** A Session allows you to interconnect services on the same machine or over
@@ -139,8 +158,20 @@ namespace qi {
     qi::FutureSync<void> listenStandalone(const std::vector<qi::Url> &addresses);
 
     qi::FutureSync<unsigned int> registerService(const std::string &name, AnyObject object);
+    /// Registers the services in one request to the service directory, which
+    /// adds all or none of them. Returns their ids in the order of `services`.
+    qi::FutureSync<std::vector<unsigned int>> registerServices(
+        const std::vector<std::pair<std::string, AnyObject>>& services);
     qi::FutureSync<void>         unregisterService(unsigned int serviceId);
 
+    /// Counters of the calls scheduled on a service registered by this
+    /// session, see SessionConfig::callScheduling. Throws if the session has
+    /// no such service.
+    CallSchedulingStats callSchedulingStats(unsigned int serviceId) const;
+
+    /// Counters of the copy of the service infos of the service directory,
+    /// see SessionConfig::serviceCache.
+    ServiceCacheStats serviceCacheStats() const;
 
     void setAuthProviderFactory(AuthProviderFactoryPtr);
     void setClientAuthenticatorFactory(ClientAuthenticatorFactoryPtr);
@@ -7,6 +7,8 @@
 #ifndef _QI_SIGNAL_HPP_
 #define _QI_SIGNAL_HPP_
 
+#include <deque>
+#include <stdexcept>
 #include <boost/function.hpp>
 #include <boost/scoped_ptr.hpp>
 #include <qi/atomic.hpp>
@@ -35,6 +37,51 @@ namespace qi {
 
   using SignalLink = qi::uint64_t;
 
+  /** Tells what to do with the deliveries of a subscriber that are waiting for
+   * their execution context, when the subscriber is slower than the signal.
+   *
+   * - all(): every trigger is delivered (default).
+   * - bounded(n): at most n deliveries are kept pending, the oldest ones are
+   *   dropped.
+   * - latestOnly(): pending deliveries collapse to the newest one, which suits
+   *   state-like signals. This is bounded(1).
+   *
+   * The deliveries of a subscriber with a bounded policy are executed in
+   * order, one at a time.
+   *
+   * \includename{qi/signal.hpp}
+   */
+  class DeliveryPolicy
+  {
+  public:
+    static DeliveryPolicy all() { return DeliveryPolicy(0); }
+    static DeliveryPolicy latestOnly() { return DeliveryPolicy(1); }
+    static DeliveryPolicy bounded(std::size_t maxPending)
+    {
+      if (maxPending == 0)
+        throw std::invalid_argument("DeliveryPolicy: bound must be greater than zero");
+      return DeliveryPolicy(maxPending);
+    }
+
+    bool isBounded() const { return _maxPending != 0; }
+
+    /// @return the maximum number of pending deliveries, 0 if unbounded.
+    std::size_t maxPending() const { return _maxPending; }
+
+    friend bool operator==(const DeliveryPolicy& a, const DeliveryPolicy& b)
+    {
+      return a._maxPending == b._maxPending;
+    }
+    friend bool operator!=(const DeliveryPolicy& a, const DeliveryPolicy& b)
+    {
+      return !(a == b);
+    }
+
+  private:
+    explicit DeliveryPolicy(std::size_t maxPending) : _maxPending(maxPending) {}
+    std::size_t _maxPending;
+  };
+
 
   /// SignalBase provides a signal subscription mechanism called "connection".
   /// Derived classes can customize the subscription step by setting
@@ -130,6 +177,16 @@ namespace qi {
     virtual void trigger(const GenericFunctionParameters& params, MetaCallType callType = MetaCallType_Auto);
     /// Set the MetaCallType used by operator()().
     void setCallType(MetaCallType callType);
+
+    /// Set the delivery policy of the subscribers that do not have their own,
+    /// including the ones connected remotely. Defaults to DeliveryPolicy::all().
+    void setDeliveryPolicy(DeliveryPolicy policy);
+    DeliveryPolicy deliveryPolicy() const;
+
+    /// Set the priority of the messages which carry the triggers of the
+    /// signal to its remote subscribers. Defaults to MessagePriority_Normal.
+    void setMessagePriority(MessagePriority priority);
+    MessagePriority messagePriority() const;
     /// Trigger the signal with given arguments, and call type set by setCallType()
     void operator()(
       qi::AutoAnyReference p1 = qi::AutoAnyReference(),
@@ -297,6 +354,17 @@ QI_WARNING_POP()
 
     SignalSubscriber setCallType(MetaCallType ct);
 
+    /// Set how the pending asynchronous deliveries to this subscriber are
+    /// handled. Overrides the policy of the signal.
+    SignalSubscriber setDeliveryPolicy(DeliveryPolicy policy);
+    DeliveryPolicy deliveryPolicy() const;
+
+    /// @return the number of deliveries dropped because of the delivery policy.
+    qi::uint64_t droppedDeliveries() const;
+
+    /// @return the message priority of the signal, for remote subscribers.
+    MessagePriority messagePriority() const;
+
     /// @return the identifier of the subscription (aka link)
     SignalLink link() const;
     operator SignalLink() const;
@@ -320,6 +388,11 @@ QI_WARNING_POP()
     template<typename Args>
     void callWithValueOrPtr(const Args& args, MetaCallType callType);
 
+    // Queue a delivery according to a bounded delivery policy.
+    void postBounded(std::shared_ptr<GenericFunctionParameters> args,
+                     ExecutionContext* executionContext);
+    void drainPendingDeliveries();
+
   public:
     QI_API_DEPRECATED_MSG("please use link() instead or cast to qi::SignalLink")
     SignalLink linkId;
@@ -355,6 +428,22 @@ QI_WARNING_POP()
 
     // ExecutionContext on which to schedule the call
     std::atomic<ExecutionContext*> executionContext{nullptr};
+
+    // Delivery policy, 0 meaning unbounded. Unless explicitly set, it is
+    // inherited from the signal.
+    std::atomic<std::size_t> maxPendingDeliveries{0};
+    std::atomic<bool> hasOwnDeliveryPolicy{false};
+
+    // Priority of the messages sent to a remote subscriber, inherited from
+    // the signal.
+    std::atomic<MessagePriority> messagePriority{MessagePriority_Normal};
+
+    // Deliveries waiting for the execution context, only used with a bounded
+    // delivery policy.
+    boost::mutex pendingMutex;
+    std::deque<std::shared_ptr<GenericFunctionParameters>> pendingDeliveries;
+    bool draining = false;
+    std::atomic<qi::uint64_t> droppedDeliveries{0};
   };
 } // qi
 
@@ -29,6 +29,21 @@
 namespace qi
 {
 
+/// A call made by GenericObject::callBatch(): a method name, or signature
+/// 'name::(args)', and the arguments to pass to it.
+struct BatchCall
+{
+  template <typename... Args>
+  explicit BatchCall(std::string methodName, Args&&... args)
+    : method(std::move(methodName))
+    , arguments{AnyValue::from(std::forward<Args>(args))...}
+  {
+  }
+
+  std::string method;
+  std::vector<AnyValue> arguments;
+};
+
 /* ObjectValue
  *  static version wrapping class C: Type<C>
  *  dynamic version: Type<DynamicObject>
@@ -81,6 +96,18 @@ public:
   qi::Future<AnyReference> metaCall(unsigned int method, const GenericFunctionParameters& params, MetaCallType callType = MetaCallType_Auto, Signature returnSignature = Signature());
   //@}
 
+  /**
+   * Make several calls at once. Remote objects send them in a single message
+   * if the other end supports it, and receive all the results in a single
+   * reply, instead of exchanging one message per call.
+   * @return one future per call, in the order of \p calls. A failed call only
+   * sets an error on its own future.
+   */
+  //@{
+  std::vector<qi::Future<AnyReference>> metaCallBatch(const MetaCallBatch& calls);
+  std::vector<qi::Future<AnyValue>> callBatch(const std::vector<BatchCall>& calls);
+  //@}
+
   /// Find method named name callable with arguments parameters
   int findMethod(const std::string& name, const GenericFunctionParameters& parameters);
 
@@ -148,6 +175,9 @@ private:
       const MetaCallType callType,
       const Signature& returnSignature);
 
+  /// Common batch call algorithm, without unwrapping the returned futures.
+  std::vector<Future<AnyReference>> metaCallBatchNoUnwrap(const MetaCallBatch& calls);
+
   /// Finds a method or throws a nicely formatted error message.
   std::string makeFindMethodErrorMessage(
       const std::string& nameWithOptionalSignature,
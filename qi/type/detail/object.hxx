@@ -74,6 +74,14 @@ namespace detail {
     {
       return go()->metaCall(nameWithOptionalSignature, params, callType, returnSignature);
     }
+    inline std::vector<qi::Future<AnyReference>> metaCallBatch(const MetaCallBatch& calls) const
+    {
+      return go()->metaCallBatch(calls);
+    }
+    inline std::vector<qi::Future<AnyValue>> callBatch(const std::vector<BatchCall>& calls) const
+    {
+      return go()->callBatch(calls);
+    }
     inline void metaPost(unsigned int event, const GenericFunctionParameters& params) const
     {
       return go()->metaPost(event, params);
@@ -34,7 +34,7 @@ inline AnyObject Proxy::asObject() const
 * So it need a type of its own, we cannot pretend it's a AnyObject.
 */
 template<class InterfaceType, class ProxyType>
-class TypeProxy: public ObjectTypeInterface
+class TypeProxy: public ObjectTypeInterface, public ObjectTypeBatchCallInterface
 {
 public:
   /* We need a per-instance offset from effective type to Proxy.
@@ -63,6 +63,11 @@ public:
     Proxy* ptr = toProxy(instance);
     return ptr->asObject().metaCall(method, params, callType, returnSignature);
   }
+  std::vector<qi::Future<AnyReference>> metaCallBatch(void* instance, AnyObject context, const MetaCallBatch& calls) override
+  {
+    Proxy* ptr = toProxy(instance);
+    return ptr->asObject().metaCallBatch(calls);
+  }
   void metaPost(void* instance, AnyObject context, unsigned int signal, const GenericFunctionParameters& params) override
   {
     Proxy* ptr = toProxy(instance);
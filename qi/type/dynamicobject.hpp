@@ -64,6 +64,8 @@ namespace qi
     virtual qi::Future<void> metaDisconnect(SignalLink linkId);
     virtual qi::Future<AnyValue> metaProperty(AnyObject context, unsigned int id);
     virtual qi::Future<void> metaSetProperty(AnyObject context, unsigned int id, AnyValue val);
+    /// Makes the calls one by one with metaCall(), see ObjectTypeInterface::metaCallBatch.
+    virtual std::vector<qi::Future<AnyReference>> metaCallBatch(AnyObject context, const MetaCallBatch& calls);
 
     void setThreadingModel(ObjectThreadingModel model);
     ObjectThreadingModel threadingModel() const;
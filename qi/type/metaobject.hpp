@@ -118,6 +118,16 @@ namespace qi {
     */
     std::vector<CompatibleMethod> findCompatibleMethod(const std::string &nameOrSignature) const;
 
+    /// Statistics of the cache of the overloads chosen by findMethod() from
+    /// the types of the arguments, when a method is called by name.
+    struct OverloadCacheStats
+    {
+      qi::uint64_t hits;
+      qi::uint64_t misses;
+      std::size_t  size;
+    };
+    OverloadCacheStats overloadCacheStats() const;
+
     /**
     *   @param name The member's name.
     *   @param uid The uid's name.
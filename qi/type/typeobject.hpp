@@ -29,10 +29,27 @@ namespace qi {
     /// Force an asynchronous call in an other thread
     MetaCallType_Queued = 2,
   };
+
+  /** Priority of the messages of a call or of a signal on a socket.
+   *  The messages waiting to be sent on a socket are sent by decreasing
+   *  priority, and in order among the messages of the same priority.
+   *  The reply of a call has the priority of the call.
+   */
+  enum MessagePriority {
+    /// Sent after all the other messages, for bulk transfers
+    MessagePriority_Low    = 0,
+    MessagePriority_Normal = 1,
+    /// Sent before all the other messages, for latency sensitive calls
+    MessagePriority_High   = 2,
+  };
   class SignalSubscriber;
   class Manageable;
   using SignalLink = qi::uint64_t;
 
+  /// Method ids and arguments of calls made together, see
+  /// GenericObject::metaCallBatch().
+  using MetaCallBatch = std::vector<std::pair<unsigned int, GenericFunctionParameters>>;
+
   /* We will have 2 implementations for 2 classes of C++ class:
    * - DynamicObject: Use DynamicObjectBuilder
    * - T: Use ObjectTypeBuilder
@@ -62,10 +79,29 @@ namespace qi {
     virtual TypeKind kind() { return TypeKind_Object;}
     static const auto INHERITS_FAILED = PTRDIFF_MAX;
 
+    /// Makes the calls of \p calls, asynchronously, and returns one future per
+    /// call. Bounces to ObjectTypeBatchCallInterface::metaCallBatch() if the
+    /// type implements it, makes the calls with metaCallOneByOne() otherwise.
+    std::vector<qi::Future<AnyReference>> metaCallBatch(void* instance, AnyObject context, const MetaCallBatch& calls);
+    /// Makes the calls of \p calls one by one with metaCall().
+    std::vector<qi::Future<AnyReference>> metaCallOneByOne(void* instance, AnyObject context, const MetaCallBatch& calls);
+
     /// @return INHERITS_FAILED if there is no inheritance, or the pointer offset
     std::ptrdiff_t inherits(TypeInterface* other);
   };
 
+  /** Implemented by the object types that make the calls of a batch
+   *  together. Separate from ObjectTypeInterface so that the virtual
+   *  functions of ObjectTypeInterface and of its subclasses keep their slots.
+   */
+  class QI_API ObjectTypeBatchCallInterface
+  {
+  public:
+    virtual ~ObjectTypeBatchCallInterface() = default;
+    /// See ObjectTypeInterface::metaCallBatch().
+    virtual std::vector<qi::Future<AnyReference>> metaCallBatch(void* instance, AnyObject context, const MetaCallBatch& calls) = 0;
+  };
+
 }
 
 #endif  // _QITYPE_TYPEOBJECT_HPP_
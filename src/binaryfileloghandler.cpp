@@ -0,0 +1,310 @@
+/*
+**  Copyright (C) 2018 SoftBank Robotics Europe
+**  See COPYING for the license
+*/
+
+#include <qi/log/binaryfileloghandler.hpp>
+
+#include <boost/filesystem.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <qi/log.hpp>
+#include <qi/os.hpp>
+
+qiLogCategory("qi.log.binaryfileloghandler");
+
+/* File format, all integers in the byte order of the writer:
+ *
+ * header:  "QILOGBIN" version:u32 byteOrderMark:u32
+ * string:  'S' id:u32 size:u32 chars[size]
+ * message: 'M' level:u8 date:i64 systemDate:i64 (nanoseconds)
+ *          category:u32 file:u32 function:u32 (string ids) line:i32
+ *          format:u32 (string id, 0 if the message is text)
+ *          size:u32 message[size] (text, or arguments encoded as described
+ *                                  by qi::log::detail::DeferredArgTag)
+ */
+
+namespace qi
+{
+namespace log
+{
+  namespace
+  {
+    const char magic[] = { 'Q', 'I', 'L', 'O', 'G', 'B', 'I', 'N' };
+    const qi::uint32_t version = 1;
+    const qi::uint32_t byteOrderMark = 0x01020304;
+    const char stringTag = 'S';
+    const char messageTag = 'M';
+    const std::size_t bufferSize = 64 * 1024;
+  }
+
+  struct PrivateBinaryFileLogHandler
+  {
+    FILE* _file;
+    boost::mutex _mutex;
+    std::vector<char> _buffer;
+    // Formats are literals, known by their address. Other strings may be
+    // copies, they are known by their content.
+    std::unordered_map<const char*, qi::uint32_t> _formatIds;
+    std::unordered_map<std::string, qi::uint32_t> _stringIds;
+    qi::uint32_t _nextId;
+
+    template <typename T>
+    void put(const T& value)
+    {
+      const char* data = reinterpret_cast<const char*>(&value);
+      _buffer.insert(_buffer.end(), data, data + sizeof(T));
+    }
+
+    void putBytes(const char* data, std::size_t size)
+    {
+      _buffer.insert(_buffer.end(), data, data + size);
+    }
+
+    qi::uint32_t defineString(const char* str, std::size_t size)
+    {
+      const qi::uint32_t id = _nextId++;
+      _buffer.push_back(stringTag);
+      put(id);
+      put(static_cast<qi::uint32_t>(size));
+      putBytes(str, size);
+      return id;
+    }
+
+    qi::uint32_t stringId(const char* str)
+    {
+      std::string key(str ? str : "");
+      auto it = _stringIds.find(key);
+      if (it != _stringIds.end())
+        return it->second;
+      const qi::uint32_t id = defineString(key.data(), key.size());
+      _stringIds.emplace(std::move(key), id);
+      return id;
+    }
+
+    qi::uint32_t formatId(const char* format)
+    {
+      if (!format)
+        return 0;
+      auto it = _formatIds.find(format);
+      if (it != _formatIds.end())
+        return it->second;
+      const qi::uint32_t id = defineString(format, std::strlen(format));
+      _formatIds.emplace(format, id);
+      return id;
+    }
+
+    void writeBuffer()
+    {
+      if (!_buffer.empty())
+        fwrite(_buffer.data(), 1, _buffer.size(), _file);
+      _buffer.clear();
+    }
+  };
+
+  BinaryFileLogHandler::BinaryFileLogHandler(const std::string& filePath)
+    : _p(new PrivateBinaryFileLogHandler)
+  {
+    _p->_file = NULL;
+    _p->_nextId = 1; // 0 means no format
+    _p->_buffer.reserve(bufferSize);
+    boost::filesystem::path fPath(filePath);
+    try
+    {
+      if (!boost::filesystem::exists(fPath.make_preferred().parent_path()))
+        boost::filesystem::create_directories(fPath.make_preferred().parent_path());
+    }
+    catch (const boost::filesystem::filesystem_error& e)
+    {
+      qiLogWarning() << e.what();
+    }
+
+    FILE* file = qi::os::fopen(fPath.make_preferred().string().c_str(), "wb");
+    if (!file)
+    {
+      qiLogWarning() << "Cannot open " << filePath;
+      return;
+    }
+    _p->_file = file;
+    _p->putBytes(magic, sizeof(magic));
+    _p->put(version);
+    _p->put(byteOrderMark);
+  }
+
+  BinaryFileLogHandler::~BinaryFileLogHandler()
+  {
+    flush();
+    if (_p->_file != NULL)
+      fclose(_p->_file);
+  }
+
+  void BinaryFileLogHandler::log(const DeferredLogRecord& record)
+  {
+    boost::mutex::scoped_lock lock(_p->_mutex);
+    if (_p->_file == NULL)
+      return;
+
+    // Strings must be defined before the message using them.
+    const qi::uint32_t category = _p->stringId(record.category);
+    const qi::uint32_t file = _p->stringId(record.file);
+    const qi::uint32_t function = _p->stringId(record.function);
+    const qi::uint32_t format = _p->formatId(record.format);
+    const std::size_t size = record.format ? record.messageSize : std::strlen(record.message);
+
+    _p->_buffer.push_back(messageTag);
+    _p->put(static_cast<qi::uint8_t>(record.level));
+    _p->put(static_cast<qi::int64_t>(record.date.time_since_epoch().count()));
+    _p->put(static_cast<qi::int64_t>(record.systemDate.time_since_epoch().count()));
+    _p->put(category);
+    _p->put(file);
+    _p->put(function);
+    _p->put(static_cast<qi::int32_t>(record.line));
+    _p->put(format);
+    _p->put(static_cast<qi::uint32_t>(size));
+    _p->putBytes(record.message, size);
+
+    if (_p->_buffer.size() >= bufferSize || record.level <= LogLevel_Warning)
+    {
+      _p->writeBuffer();
+      if (record.level <= LogLevel_Warning)
+        fflush(_p->_file);
+    }
+  }
+
+  void BinaryFileLogHandler::flush()
+  {
+    boost::mutex::scoped_lock lock(_p->_mutex);
+    if (_p->_file == NULL)
+      return;
+    _p->writeBuffer();
+    fflush(_p->_file);
+  }
+
+  struct PrivateBinaryLogFileReader
+  {
+    std::ifstream _stream;
+    std::streamoff _fileSize;
+    std::vector<std::string> _strings;
+    std::string _message;
+
+    template <typename T>
+    bool get(T& value)
+    {
+      return static_cast<bool>(_stream.read(reinterpret_cast<char*>(&value), sizeof(T)));
+    }
+
+    // Fails without allocating if the file is too short for `size` bytes.
+    bool getBytes(std::string& str, qi::uint32_t size)
+    {
+      const std::streamoff position = _stream.tellg();
+      if (position < 0 || size > _fileSize - position)
+      {
+        qiLogWarning() << "Corrupted binary log file, entry of " << size
+                       << " bytes past the end of the file";
+        return false;
+      }
+      str.resize(size);
+      return size == 0 || static_cast<bool>(_stream.read(&str[0], size));
+    }
+
+    const char* string(qi::uint32_t id) const
+    {
+      return id < _strings.size() ? _strings[id].c_str() : "";
+    }
+  };
+
+  BinaryLogFileReader::BinaryLogFileReader(const std::string& filePath)
+    : _p(new PrivateBinaryLogFileReader)
+  {
+    _p->_stream.open(boost::filesystem::path(filePath).make_preferred().string().c_str(),
+                     std::ios::in | std::ios::binary);
+    if (!_p->_stream)
+      throw std::runtime_error("Cannot open " + filePath);
+    _p->_stream.seekg(0, std::ios::end);
+    _p->_fileSize = _p->_stream.tellg();
+    _p->_stream.seekg(0, std::ios::beg);
+
+    char fileMagic[sizeof(magic)];
+    qi::uint32_t fileVersion = 0;
+    qi::uint32_t fileByteOrderMark = 0;
+    if (!_p->_stream.read(fileMagic, sizeof(fileMagic))
+        || std::memcmp(fileMagic, magic, sizeof(magic)) != 0)
+      throw std::runtime_error(filePath + " is not a binary log file");
+    if (!_p->get(fileVersion) || fileVersion != version)
+      throw std::runtime_error(filePath + ": unsupported binary log file version");
+    if (!_p->get(fileByteOrderMark) || fileByteOrderMark != byteOrderMark)
+      throw std::runtime_error(filePath + " was written with another byte order");
+  }
+
+  BinaryLogFileReader::~BinaryLogFileReader()
+  {
+  }
+
+  bool BinaryLogFileReader::next(DeferredLogRecord& record)
+  {
+    char tag = 0;
+    while (_p->_stream.get(tag))
+    {
+      if (tag == stringTag)
+      {
+        qi::uint32_t id = 0;
+        qi::uint32_t size = 0;
+        std::string str;
+        if (!_p->get(id) || !_p->get(size))
+          return false;
+        // The strings are defined once each, in the order of their ids,
+        // which start at 1.
+        const std::size_t nextId = std::max<std::size_t>(_p->_strings.size(), 1);
+        if (id != nextId)
+        {
+          qiLogWarning() << "Corrupted binary log file, string id " << id
+                         << " instead of " << nextId;
+          return false;
+        }
+        if (!_p->getBytes(str, size))
+          return false;
+        _p->_strings.resize(id + 1);
+        _p->_strings[id] = std::move(str);
+        continue;
+      }
+      if (tag != messageTag)
+      {
+        qiLogWarning() << "Corrupted binary log file, unknown entry type " << int(tag);
+        return false;
+      }
+
+      qi::uint8_t level = 0;
+      qi::int64_t date = 0;
+      qi::int64_t systemDate = 0;
+      qi::uint32_t category = 0, file = 0, function = 0, format = 0, size = 0;
+      qi::int32_t line = 0;
+      if (!_p->get(level) || !_p->get(date) || !_p->get(systemDate) || !_p->get(category)
+          || !_p->get(file) || !_p->get(function) || !_p->get(line) || !_p->get(format)
+          || !_p->get(size) || !_p->getBytes(_p->_message, size))
+        return false;
+
+      record.level = static_cast<qi::LogLevel>(level);
+      record.date = qi::Clock::time_point(qi::Clock::duration(date));
+      record.systemDate = qi::SystemClock::time_point(qi::SystemClock::duration(systemDate));
+      record.category = _p->string(category);
+      record.file = _p->string(file);
+      record.function = _p->string(function);
+      record.line = line;
+      record.format = format ? _p->string(format) : nullptr;
+      record.message = _p->_message.c_str();
+      record.messageSize = _p->_message.size();
+      return true;
+    }
+    return false;
+  }
+}
+}
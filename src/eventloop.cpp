@@ -2,6 +2,7 @@
 **  Copyright (C) 2012, 2013 Aldebaran Robotics
 **  See COPYING for the license
 */
+#include <algorithm>
 #include <thread>
 #include <system_error>
 #include <memory>
@@ -15,12 +16,16 @@
 #include <boost/algorithm/cxx11/any_of.hpp>
 #include <boost/core/ignore_unused.hpp>
 #include <boost/range/algorithm/count_if.hpp>
+#include <boost/algorithm/string/split.hpp>
+#include <boost/algorithm/string/classification.hpp>
+#include <boost/lexical_cast.hpp>
 
 #include <ka/memory.hpp>
 #include <ka/scoped.hpp>
 #include <qi/preproc.hpp>
 #include <qi/log.hpp>
 #include <qi/application.hpp>
+#include <qi/os.hpp>
 
 #include <qi/eventloop.hpp>
 #include <qi/future.hpp>
@@ -273,16 +278,19 @@ namespace qi {
   static const auto gGracePeriodEnvVar = "QI_EVENTLOOP_GRACE_PERIOD";
   static const auto gMaxTimeoutsEnvVar = "QI_EVENTLOOP_MAX_TIMEOUTS";
   static const auto gThreadMaxIdleDurationMsEnvVar = "QI_EVENTLOOP_THREAD_MAX_IDLE_DURATION";
+  static const auto gCPUsEnvVar = "QI_EVENTLOOP_CPUS";
+  static const auto gNetworkCPUsEnvVar = "QI_EVENTLOOP_NETWORK_CPUS";
   const char* const EventLoopAsio::defaultName = "MainEventLoop";
 
   EventLoopAsio::EventLoopAsio(int threadCount, int minThreadCount, int maxThreadCount,
-                               std::string name, bool spawnOnOverload)
+                               std::string name, bool spawnOnOverload, std::vector<int> cpus)
     : EventLoopPrivate(std::move(name))
     , _work(nullptr)
     , _minThreads(minThreadCount)
     , _maxThreads(maxThreadCount)
     , _workerThreads(new WorkerThreadPool())
     , _spawnOnOverload(spawnOnOverload)
+    , _cpus(std::move(cpus))
   {
     start(threadCount);
   }
@@ -407,6 +415,14 @@ namespace qi {
     return d;
   }
 
+  void EventLoopAsio::pinCurrentThread()
+  {
+    if (_cpus.empty())
+      return;
+    if (!qi::os::setCurrentThreadCPUAffinity(_cpus))
+      qiLogWarning() << _name << ": cannot set the CPU affinity of a thread";
+  }
+
   // The thread running this function is responsible for:
   // - creating threads in case of contention
   // - destroying threads that have been idle for too long
@@ -434,6 +450,7 @@ namespace qi {
   void EventLoopAsio::runPingLoop()
   {
     qi::os::setCurrentThreadName("EvLoop.mon");
+    pinCurrentThread();
     const auto timeoutDuration = MilliSeconds{ qi::os::getEnvDefault(gPingTimeoutEnvVar, 500u) };
     const auto graceDuration = MilliSeconds{ qi::os::getEnvDefault(gGracePeriodEnvVar, 0u) };
     const auto maxTimeouts = qi::os::getEnvDefault(gMaxTimeoutsEnvVar, 20u);
@@ -549,6 +566,7 @@ namespace qi {
     qiLogDebug() << this << ": run starting from pool "
       "(workerCount = " << _workerThreads->activeWorkerCount() << ")";
     qi::os::setCurrentThreadName(_name);
+    pinCurrentThread();
 
     while (true) {
       try
@@ -787,6 +805,14 @@ namespace qi {
   {
   }
 
+  EventLoop::EventLoop(std::string name, int nthreads, int minThreads, int maxThreads,
+    bool spawnOnOverload, std::vector<int> cpus)
+    : _p(std::make_shared<EventLoopAsio>(nthreads, minThreads, maxThreads, name, spawnOnOverload,
+                                         std::move(cpus)))
+    , _name(name)
+  {
+  }
+
   EventLoop::~EventLoop()
   {
     // TODO after compiler upgrades: auto p = std::atomic_exchange(&_p, {});
@@ -1012,11 +1038,70 @@ namespace qi {
 
   namespace
   {
+    // Parses a list of CPUs such as "0,2-3". Invalid items are ignored.
+    std::vector<int> parseCPUList(const std::string& str)
+    {
+      std::vector<int> cpus;
+      std::vector<std::string> items;
+      boost::algorithm::split(items, str, boost::algorithm::is_any_of(","));
+      for (const auto& item : items)
+      {
+        if (item.empty())
+          continue;
+        try
+        {
+          const auto dash = item.find('-');
+          const int first = boost::lexical_cast<int>(item.substr(0, dash));
+          const int last = dash == std::string::npos
+                               ? first
+                               : boost::lexical_cast<int>(item.substr(dash + 1));
+          if (first < 0 || last < first)
+            throw boost::bad_lexical_cast();
+          for (int cpu = first; cpu <= last; ++cpu)
+            cpus.push_back(cpu);
+        }
+        catch (const boost::bad_lexical_cast&)
+        {
+          qiLogWarning() << "Ignoring invalid CPU set item '" << item << "' in '" << str << "'";
+        }
+      }
+      return cpus;
+    }
+
+    std::vector<int> networkCPUs()
+    {
+      return parseCPUList(qi::os::getenv(gNetworkCPUsEnvVar));
+    }
+
+    // Unless specified, the threads of the global event loop avoid the CPUs of
+    // the network event loop, if any.
+    std::vector<int> poolCPUs()
+    {
+      const auto cpus = qi::os::getenv(gCPUsEnvVar);
+      if (!cpus.empty())
+        return parseCPUList(cpus);
+
+      const auto network = networkCPUs();
+      if (network.empty())
+        return {};
+      std::vector<int> remaining;
+      for (int cpu = 0; cpu < static_cast<int>(qi::os::numberOfCPUs()); ++cpu)
+      {
+        if (std::find(network.begin(), network.end(), cpu) == network.end())
+          remaining.push_back(cpu);
+      }
+      if (remaining.empty())
+        qiLogVerbose() << "No CPU left apart from " << gNetworkCPUsEnvVar
+                       << ", the global event loop is not pinned";
+      return remaining;
+    }
+
     // The initialisation is protected by a mutex,
     // We then use an atomic to prevent having a mutex on a fastpath.
     EventLoop* _getInternal(EventLoop* &ctx, int nthreads,
       const std::string& name, bool spawnOnOverload, boost::mutex& mutex,
-      std::atomic<int>& init, int minThreads, int maxThreads)
+      std::atomic<int>& init, int minThreads, int maxThreads,
+      std::vector<int> (*cpus)())
     {
       if (init.load())
         return ctx;
@@ -1030,7 +1115,7 @@ namespace qi {
             qiLogVerbose() << "Creating event loop while no qi::Application() is running";
           }
           // TODO: use make_unique once we can use C++14
-          ctx = new EventLoop(name, nthreads, minThreads, maxThreads, spawnOnOverload);
+          ctx = new EventLoop(name, nthreads, minThreads, maxThreads, spawnOnOverload, cpus());
           Application::atExit(boost::bind(&eventloop_stop, boost::ref(ctx)));
         }
       }
@@ -1045,7 +1130,8 @@ namespace qi {
     static std::atomic<int> init(0);
     // We do not decide here the min thread count, nor the max thread count.
     // Let the defaults be used (hence, min = -1, max = 0)
-    return _getInternal(ctx, nthreads, EventLoopAsio::defaultName, true, mutex, init, -1, 0);
+    return _getInternal(ctx, nthreads, EventLoopAsio::defaultName, true, mutex, init, -1, 0,
+                        &poolCPUs);
   }
 
   static EventLoop* _getNetwork(EventLoop* &ctx)
@@ -1053,7 +1139,7 @@ namespace qi {
     static boost::mutex mutex;
     static std::atomic<int> init(0);
     // This eventloop has only one thread (hence, min thread count = max thread count = 1).
-    return _getInternal(ctx, 1, "EventLoopNetwork", false, mutex, init, 1, 1);
+    return _getInternal(ctx, 1, "EventLoopNetwork", false, mutex, init, 1, 1, &networkCPUs);
   }
 
   void startEventLoop(int nthread)
@@ -68,7 +68,8 @@ namespace qi {
       bool spawnOnOverload = true);
 
     EventLoopAsio(int threadCount, int minThreadCount, int maxThreadCount,
-                  std::string name, bool spawnOnOverload);
+                  std::string name, bool spawnOnOverload,
+                  std::vector<int> cpus = std::vector<int>());
 
     ~EventLoopAsio() override;
 
@@ -99,6 +100,7 @@ namespace qi {
         const boost::system::error_code& erc, D countTask, UpdateLastWorkDate);
     void runWorkerLoop();
     void runPingLoop();
+    void pinCurrentThread();
 
     qi::Future<void> asyncCallInternal(
       qi::Duration delay, boost::function<void ()> callback,
@@ -120,6 +122,7 @@ namespace qi {
     std::atomic<int64_t> _totalTask {0};
     std::atomic<int64_t> _activeTask {0};
     const bool _spawnOnOverload;
+    const std::vector<int> _cpus;
   };
 }
 
@@ -15,8 +15,11 @@
 #include <qi/assert.hpp>
 #include <qi/log.hpp>
 #include "log_p.hpp"
+#include "loghandlerqueue_p.hpp"
+#include "logring_p.hpp"
 #include <qi/os.hpp>
 #include <list>
+#include <memory>
 #include <map>
 #include <cstring>
 #include <iomanip>
@@ -34,7 +37,7 @@
 #include <boost/unordered_map.hpp>
 #include <boost/algorithm/string.hpp>
 
-#include <boost/lockfree/queue.hpp>
+#include <boost/thread/tss.hpp>
 #include <boost/function.hpp>
 #include <boost/predef.h>
 
@@ -56,12 +59,11 @@
 #endif
 
 
-#define RTLOG_BUFFERS (128)
-
-#define CAT_SIZE 64
-#define FILE_SIZE 128
-#define FUNC_SIZE 64
-#define LOG_SIZE 2048
+// Default size in bytes of the buffer of each thread logging asynchronously.
+#define LOG_RING_DEFAULT_CAPACITY (256 * 1024)
+// Maximum number of records dispatched from a thread buffer before moving on
+// to the next one, so that a single thread cannot starve the others.
+#define LOG_RING_BATCH_SIZE 256
 
 qiLogCategory("qi.log");
 
@@ -231,17 +233,19 @@ namespace qi {
 
   namespace log {
 
-    using privateLog = struct sPrivateLog
+    struct ThreadLogRing : LogRing
     {
-      qi::LogLevel               _logLevel;
-      char                       _category[CAT_SIZE];
-      char                       _file[FILE_SIZE];
-      char                       _function[FUNC_SIZE];
-      int                        _line;
-      char                       _log[LOG_SIZE];
-      qi::Clock::time_point       _date;
-      qi::SystemClock::time_point _systemDate;
+      explicit ThreadLogRing(std::size_t capacity)
+        : LogRing(capacity)
+        , tid(qi::os::gettid())
+        , reportedDropped(0)
+      {
+      }
+
+      const int    tid;
+      qi::uint64_t reportedDropped; // only used by the consumer
     };
+    using LogRingPtr = std::shared_ptr<ThreadLogRing>;
 
     class Log
     {
@@ -252,11 +256,18 @@ namespace qi {
       struct Handler
       {
         qi::log::Handler func;
+        BinaryHandler binaryFunc; // set instead of func for binary handlers
         unsigned int index; // index of this handler in category levels
+        std::shared_ptr<LogHandlerQueue> queue; // set if called by its own thread
+        std::shared_ptr<LogHandlerCounters> counters;
       };
 
       void run();
       void printLog();
+      // Returns the buffer of the calling thread, creating it if needed.
+      LogRing& threadRing();
+      bool hasPendingLogs();
+      void notifyPendingLogs();
       // Invoke handlers who enabled given level/category
       void dispatch_unsynchronized(const qi::LogLevel,
                                    const qi::Clock::time_point date,
@@ -274,9 +285,14 @@ namespace qi {
                                    const char* file,
                                    const char* function,
                                    int line);
+      void dispatch_unsynchronized(const DeferredLogRecord& record, detail::Category& category);
       Handler* logHandler(SubscriberId id);
 
       void setSynchronousLog(bool sync);
+      SubscriberId addHandler(const std::string& name, Handler handler,
+                              qi::LogLevel defaultLevel);
+      // Waits for the queued handlers to handle their messages.
+      void waitHandlerQueues();
     public:
       bool                       LogInit;
       boost::thread              LogThread;
@@ -286,7 +302,16 @@ namespace qi {
       bool                       SyncLog;
       bool                       AsyncLogInit;
 
-      boost::lockfree::queue<privateLog*>     logs;
+      // Set by the log thread when it is about to sleep, so that producers
+      // only notify it when needed.
+      std::atomic<bool>          LogThreadWaiting;
+
+      // One buffer per thread which logged asynchronously. The buffers of
+      // threads which have exited are released once they are empty.
+      boost::mutex               RingsLock;
+      std::vector<LogRingPtr>    Rings;
+      std::atomic<std::size_t>   RingCapacity;
+      std::atomic<qi::uint64_t>  DroppedCount;
 
       using LogHandlerMap = std::map<std::string, Handler>;
       LogHandlerMap logHandlers;
@@ -325,6 +350,17 @@ namespace qi {
       return *_glCategories;
     }
 
+    // Immutable copy of the categories, replaced whenever one is added, so
+    // that categories can be looked up by name without locking.
+    using CategoryIndex = boost::unordered_map<std::string, detail::Category*>;
+    using CategoryIndexPtr = std::shared_ptr<const CategoryIndex>;
+    inline CategoryIndexPtr& _categoryIndex()
+    {
+      static CategoryIndexPtr* _glCategoryIndex;
+      QI_ONCE(_glCategoryIndex = new CategoryIndexPtr(std::make_shared<const CategoryIndex>()));
+      return *_glCategoryIndex;
+    }
+
     // protects globs and categories, both the map and the per-category vector
     inline boost::recursive_mutex& _mutex()
     {
@@ -333,13 +369,42 @@ namespace qi {
       return *_glMutex;
     }
 
+    // Gets the level of subscriber `sub` in `category`, whose packed levels
+    // are `packed`. Returns false if the subscriber has no level.
+    static bool subscriberLevel(const detail::Category& category, qi::uint64_t packed,
+                                SubscriberId sub, qi::LogLevel& level)
+    {
+      if (sub < detail::Category::PackedSubscribers)
+      {
+        const auto packedLevel = (packed >> (4 * (sub + 1))) & 0xF;
+        if (packedLevel == detail::Category::NoPackedLevel)
+          return false;
+        level = static_cast<qi::LogLevel>(packedLevel);
+        return true;
+      }
+      // Called while dispatching, with the handlers locked: taking the log
+      // mutex here would invert the order of Log::addHandler.
+      const auto levels = std::atomic_load(&category.levelsSnapshot);
+      if (!levels || sub >= levels->size())
+        return false;
+      level = (*levels)[sub];
+      return true;
+    }
+
     static int                    _glContext = 0;
     static bool                   _glInit    = false;
     static LogColor               _glColorWhen = LogColor_Auto;
 
     static Log                   *LogInstance = nullptr;
-    static privateLog             LogBuffer[RTLOG_BUFFERS];
-    static volatile unsigned long LogPush = 0;
+
+    // The value of each thread holds a reference on its LogRing. It is
+    // never destroyed, so that it can be used until the very end.
+    inline boost::thread_specific_ptr<LogRingPtr>& _threadRing()
+    {
+      static boost::thread_specific_ptr<LogRingPtr>* _glThreadRing;
+      QI_ONCE(_glThreadRing = new boost::thread_specific_ptr<LogRingPtr>());
+      return *_glThreadRing;
+    }
 
     namespace detail {
 
@@ -584,7 +649,16 @@ namespace qi {
           }
         }
         levels[sub] = level;
-        maxLevel = *std::max_element(levels.begin(), levels.end());
+        std::atomic_store(&levelsSnapshot, std::make_shared<const std::vector<qi::LogLevel>>(levels));
+
+        qi::uint64_t packed = *std::max_element(levels.begin(), levels.end());
+        for (unsigned int i = 0; i < PackedSubscribers; ++i)
+        {
+          const qi::uint64_t subLevel = i < levels.size() ? static_cast<qi::uint64_t>(levels[i])
+                                                          : static_cast<qi::uint64_t>(NoPackedLevel);
+          packed |= subLevel << (4 * (i + 1));
+        }
+        packedLevels.store(packed, std::memory_order_release);
       }
     }
 
@@ -599,6 +673,21 @@ namespace qi {
       }
     }
 
+    // Sets the level of subscriber `sub` in `cat` from the last matching
+    // rule, leaving the other subscribers untouched.
+    static void checkGlobs(detail::Category* cat, SubscriberId sub)
+    {
+      boost::recursive_mutex::scoped_lock lock(_mutex());
+      const GlobRule* last = nullptr;
+      for (const auto& g : _glGlobRules)
+      {
+        if (g.id == sub && g.matches(cat->name))
+          last = &g;
+      }
+      if (last)
+        cat->setLevel(sub, last->level);
+    }
+
     // apply a globbing rule to existing categories
     static void applyGlob(const GlobRule& g)
     {
@@ -607,10 +696,8 @@ namespace qi {
       for (CategoryMap::iterator it = c.begin(); it != c.end(); ++it)
       {
         QI_ASSERT(it->first == it->second->name);
-        if (g.matches(it->first)) {
-          detail::Category* cat = it->second;
-          checkGlobs(cat);
-        }
+        if (g.matches(it->first))
+          checkGlobs(it->second, g.id);
       }
     }
 
@@ -651,17 +738,109 @@ namespace qi {
       }
     } synchLog;
 
+    LogRing& Log::threadRing()
+    {
+      auto& ring = _threadRing();
+      if (!ring.get())
+      {
+        auto newRing = std::make_shared<ThreadLogRing>(RingCapacity.load());
+        {
+          boost::mutex::scoped_lock l(RingsLock);
+          Rings.push_back(newRing);
+        }
+        ring.reset(new LogRingPtr(std::move(newRing)));
+      }
+      return **ring;
+    }
+
+    bool Log::hasPendingLogs()
+    {
+      boost::mutex::scoped_lock l(RingsLock);
+      for (const auto& ring : Rings)
+      {
+        if (!ring->empty())
+          return true;
+      }
+      return false;
+    }
+
+    void Log::notifyPendingLogs()
+    {
+      // Pairs with the fence in run(): either the log thread sees our record
+      // before sleeping, or we see that it is waiting and wake it up.
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      if (LogThreadWaiting.load(std::memory_order_relaxed) && LogThreadWaiting.exchange(false))
+      {
+        boost::mutex::scoped_lock lock(LogWriteLock);
+        LogReadyCond.notify_one();
+      }
+    }
+
     void Log::printLog()
     {
-      privateLog* pl = nullptr;
+      std::vector<LogRingPtr> rings;
+      {
+        boost::mutex::scoped_lock l(RingsLock);
+        rings = Rings;
+      }
+
+      struct Dropped
+      {
+        qi::uint64_t count;
+        int tid;
+      };
+      std::vector<Dropped> dropped;
+
+      // Category levels are read atomically, changing filters does not
+      // block the dispatch.
+      boost::mutex::scoped_lock lockHandlers(LogInstance->LogHandlerLock);
+      const auto dispatchRecord = [this](const LogRecord& r) {
+        const DeferredLogRecord record = { r.level, r.date, r.systemDate, r.categoryName(),
+                                           r.file(), r.function(), r.line, r.format,
+                                           r.message(), r.messageSize };
+        dispatch_unsynchronized(record, r.category ? *r.category : *addCategory(r.categoryName()));
+      };
+      bool more = true;
+      while (more)
+      {
+        more = false;
+        for (const auto& ring : rings)
+        {
+          if (ring->consume(dispatchRecord, LOG_RING_BATCH_SIZE) == LOG_RING_BATCH_SIZE)
+            more = true;
+        }
+      }
 
-      boost::recursive_mutex::scoped_lock lock(_mutex(), boost::defer_lock);
-      boost::mutex::scoped_lock lockHandlers(LogInstance->LogHandlerLock, boost::defer_lock);
-      boost::lock(lock, lockHandlers);
-      while (logs.pop(pl))
+      // Report the messages dropped since last time, once the buffers have
+      // room again.
+      const auto now = qi::Clock::now();
+      const auto systemNow = qi::SystemClock::now();
+      for (auto& ring : rings)
       {
-        dispatch_unsynchronized(pl->_logLevel, pl->_date, pl->_systemDate, pl->_category, pl->_log,
-                                pl->_file, pl->_function, pl->_line);
+        const auto count = ring->dropped();
+        if (count != ring->reportedDropped)
+        {
+          std::ostringstream ss;
+          ss << (count - ring->reportedDropped) << " log messages dropped by thread "
+             << ring->tid << ", its buffer of " << ring->capacity() << " bytes was full";
+          ring->reportedDropped = count;
+          dispatch_unsynchronized(LogLevel_Warning, now, systemNow, *_QI_LOG_CATEGORY_GET(),
+                                  ss.str().c_str(), __FILE__, __FUNCTION__, __LINE__);
+        }
+      }
+      lockHandlers.unlock();
+
+      // Release the buffers of the threads which have exited.
+      boost::mutex::scoped_lock l(RingsLock);
+      for (auto it = Rings.begin(); it != Rings.end();)
+      {
+        // One reference held by `rings`, one by `Rings`.
+        const bool orphan = it->use_count() == 2
+          && std::find(rings.begin(), rings.end(), *it) != rings.end();
+        if (orphan && (*it)->empty())
+          it = Rings.erase(it);
+        else
+          ++it;
       }
     }
 
@@ -687,16 +866,44 @@ namespace qi {
                                       const char* function,
                                       int line)
     {
-      if (!logHandlers.empty())
+      const DeferredLogRecord record = { level, date, systemDate, category.name.c_str(), file,
+                                         function, line, nullptr, log, 0 };
+      dispatch_unsynchronized(record, category);
+    }
+
+    void Log::dispatch_unsynchronized(const DeferredLogRecord& record, detail::Category& category)
+    {
+      // Messages with deferred formatting are formatted at most once, and
+      // only if a text handler wants them.
+      std::string formatted;
+      const char* text = record.format ? nullptr : record.message;
+      const qi::uint64_t packed = category.packedLevels.load(std::memory_order_acquire);
+      for (auto& handler : logHandlers)
       {
-        LogHandlerMap::iterator it;
-        for (it = logHandlers.begin(); it != logHandlers.end(); ++it)
+        Handler& h = handler.second;
+        qi::LogLevel level;
+        if (subscriberLevel(category, packed, h.index, level) && level < record.level)
+          continue;
+        if (h.queue)
         {
-          Handler& h = it->second;
-          unsigned int index = h.index;
-          if (category.levels.size() <= index || category.levels[index] >= level)
-            h.func(level, date, systemDate, category.name.c_str(), log, file, function, line);
+          h.queue->push(record);
+          continue;
         }
+        if (h.binaryFunc)
+        {
+          h.binaryFunc(record);
+        }
+        else
+        {
+          if (!text)
+          {
+            formatted = formatMessage(record);
+            text = formatted.c_str();
+          }
+          h.func(record.level, record.date, record.systemDate, record.category, text, record.file,
+                 record.function, record.line);
+        }
+        h.counters->countHandled(record.date);
       }
     }
 
@@ -704,12 +911,16 @@ namespace qi {
     {
       while (LogInit)
       {
-        {
-          boost::mutex::scoped_lock lock(LogWriteLock);
-          LogReadyCond.wait(lock, []{ return !LogInstance->logs.empty(); });
-        }
-
         printLog();
+
+        boost::mutex::scoped_lock lock(LogWriteLock);
+        LogThreadWaiting = true;
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        // The timeout is only a safety net, producers wake us up as soon as
+        // there is something to log.
+        if (!hasPendingLogs())
+          LogReadyCond.wait_for(lock, boost::chrono::milliseconds(500));
+        LogThreadWaiting = false;
       }
     }
 
@@ -726,7 +937,10 @@ namespace qi {
     inline Log::Log() :
       SyncLog(true),
       AsyncLogInit(false)
-      , logs(50)
+      , LogThreadWaiting(false)
+      , RingCapacity(qi::os::getEnvParam<std::size_t>("QI_LOG_BUFFER_SIZE",
+                                                       LOG_RING_DEFAULT_CAPACITY))
+      , DroppedCount(0)
     {
       LogInit = true;
     }
@@ -744,17 +958,17 @@ namespace qi {
 
         printLog();
       }
-    }
 
-    static void my_strcpy(char *dst, const char *src, int len) {
-      if (!src)
-        src = "(null)";
-#ifdef _MSV_VER
-      strncpy_s(dst, len, src, _TRUNCATE);
-#else
-      strncpy(dst, src, len);
-      dst[len - 1] = 0;
-#endif
+      // Let the queued handlers finish before the handlers are destroyed.
+      std::vector<std::shared_ptr<LogHandlerQueue>> queues;
+      {
+        boost::mutex::scoped_lock l(LogHandlerLock);
+        for (auto& handler : logHandlers)
+          if (handler.second.queue)
+            queues.push_back(handler.second.queue);
+      }
+      for (auto& queue : queues)
+        queue->stop();
     }
 
     static void doInit(qi::LogLevel verb) {
@@ -793,7 +1007,10 @@ namespace qi {
     void flush()
     {
       if (_glInit)
+      {
         LogInstance->printLog();
+        LogInstance->waitHandlerQueues();
+      }
     }
 
     void log(const qi::LogLevel    verb,
@@ -839,9 +1056,7 @@ namespace qi {
       qi::SystemClock::time_point systemDate = qi::SystemClock::now();
       if (LogInstance->SyncLog)
       {
-        boost::recursive_mutex::scoped_lock lock(_mutex(), boost::defer_lock);
-        boost::mutex::scoped_lock lockHandlers(LogInstance->LogHandlerLock, boost::defer_lock);
-        boost::lock(lock, lockHandlers);
+        boost::mutex::scoped_lock lockHandlers(LogInstance->LogHandlerLock);
         if (category)
           LogInstance->dispatch_unsynchronized(verb, date, systemDate, *category, msg, file, fct,
                                                line);
@@ -851,21 +1066,110 @@ namespace qi {
       }
       else
       {
-        int tmpRtLogPush = ++LogPush % RTLOG_BUFFERS;
-        privateLog* pl = &(LogBuffer[tmpRtLogPush]);
-
-        pl->_logLevel = verb;
-        pl->_line = line;
-        pl->_date = date;
-        pl->_systemDate = systemDate;
-
-        my_strcpy(pl->_category, categoryStr, CAT_SIZE);
-        my_strcpy(pl->_file, file, FILE_SIZE);
-        my_strcpy(pl->_function, fct, FUNC_SIZE);
-        my_strcpy(pl->_log, msg, LOG_SIZE);
-        LogInstance->logs.push(pl);
-        LogInstance->LogReadyCond.notify_one();
+        if (!LogInstance->threadRing().push(verb, category, categoryStr, file, fct, line, date,
+                                            systemDate, msg))
+        {
+          ++LogInstance->DroppedCount;
+          return;
+        }
+        LogInstance->notifyPendingLogs();
+      }
+    }
+
+    void detail::logDeferredEncoded(const qi::LogLevel verb,
+                                    CategoryType category,
+                                    const char* file,
+                                    const char* fct,
+                                    const int line,
+                                    const char* format,
+                                    const char* args,
+                                    std::size_t argsSize)
+    {
+      if (!LogInstance)
+        return;
+      if (!LogInstance->LogInit)
+        return;
+
+      qi::Clock::time_point date = qi::Clock::now();
+      qi::SystemClock::time_point systemDate = qi::SystemClock::now();
+      if (LogInstance->SyncLog)
+      {
+        const DeferredLogRecord record = { verb, date, systemDate, category->name.c_str(), file,
+                                           fct, line, format, args, argsSize };
+        boost::mutex::scoped_lock lockHandlers(LogInstance->LogHandlerLock);
+        LogInstance->dispatch_unsynchronized(record, *category);
+      }
+      else
+      {
+        if (!LogInstance->threadRing().pushDeferred(verb, category, file, fct, line, date,
+                                                    systemDate, format, args, argsSize))
+        {
+          ++LogInstance->DroppedCount;
+          return;
+        }
+        LogInstance->notifyPendingLogs();
+      }
+    }
+
+    namespace
+    {
+      template <typename T>
+      T readDeferredArg(const char*& it, const char* end)
+      {
+        T value = T();
+        if (it + sizeof(T) <= end)
+          std::memcpy(&value, it, sizeof(T));
+        it += sizeof(T);
+        return value;
+      }
+    }
+
+    std::string formatMessage(const DeferredLogRecord& record)
+    {
+      if (!record.format)
+        return record.message;
+
+      boost::format format = detail::getFormat(record.format);
+      const char* it = record.message;
+      const char* const end = record.message + record.messageSize;
+      while (it < end)
+      {
+        switch (*it++)
+        {
+        case detail::DeferredArgTag_Bool:
+          format % (readDeferredArg<char>(it, end) != 0);
+          break;
+        case detail::DeferredArgTag_Char:
+          format % readDeferredArg<char>(it, end);
+          break;
+        case detail::DeferredArgTag_Int:
+          format % readDeferredArg<qi::int64_t>(it, end);
+          break;
+        case detail::DeferredArgTag_UInt:
+          format % readDeferredArg<qi::uint64_t>(it, end);
+          break;
+        case detail::DeferredArgTag_Double:
+          format % readDeferredArg<double>(it, end);
+          break;
+        case detail::DeferredArgTag_Pointer:
+          format % reinterpret_cast<const void*>(
+              static_cast<std::uintptr_t>(readDeferredArg<qi::uint64_t>(it, end)));
+          break;
+        case detail::DeferredArgTag_String:
+        {
+          const auto length = readDeferredArg<qi::uint32_t>(it, end);
+          const auto available = static_cast<std::size_t>(std::max(end - it, std::ptrdiff_t(0)));
+          format % std::string(it, std::min<std::size_t>(length, available));
+          it += length;
+          break;
+        }
+        default:
+          // Corrupted arguments, format what we have.
+          it = end;
+          break;
+        }
       }
+      return format.str();
     }
 
     Log::Handler* Log::logHandler(SubscriberId id)
@@ -895,20 +1199,131 @@ namespace qi {
               msg, file, fct, line);
     }
 
+    SubscriberId Log::addHandler(const std::string& name, Handler handler,
+                                 qi::LogLevel defaultLevel)
+    {
+      if (!handler.counters)
+        handler.counters = std::make_shared<LogHandlerCounters>();
+      std::shared_ptr<LogHandlerQueue> replaced;
+      SubscriberId id;
+      {
+        boost::mutex::scoped_lock l(LogHandlerLock);
+        id = ++nextIndex;
+        --id; // no postfix ++ on atomic
+        handler.index = id;
+        auto& h = logHandlers[name];
+        replaced = std::move(h.queue);
+        h = std::move(handler);
+        setLogLevel(defaultLevel, id);
+      }
+      // Outside of the lock, as the handler may be logging.
+      if (replaced)
+        replaced->stop();
+      return id;
+    }
+
+    void Log::waitHandlerQueues()
+    {
+      std::vector<std::shared_ptr<LogHandlerQueue>> queues;
+      {
+        boost::mutex::scoped_lock l(LogHandlerLock);
+        for (auto& handler : logHandlers)
+          if (handler.second.queue)
+            queues.push_back(handler.second.queue);
+      }
+      for (auto& queue : queues)
+        queue->waitEmpty();
+    }
+
+    namespace
+    {
+      LogHandlerQueue::Consumer textConsumer(Handler fct)
+      {
+        return [fct](const DeferredLogRecord& record) {
+          if (!record.format)
+          {
+            fct(record.level, record.date, record.systemDate, record.category, record.message,
+                record.file, record.function, record.line);
+            return;
+          }
+          const std::string text = formatMessage(record);
+          fct(record.level, record.date, record.systemDate, record.category, text.c_str(),
+              record.file, record.function, record.line);
+        };
+      }
+
+      std::shared_ptr<LogHandlerQueue> makeQueue(const std::string& name,
+                                                 const HandlerQueueConfig& config,
+                                                 LogHandlerQueue::Consumer consumer,
+                                                 Log::Handler& handler)
+      {
+        handler.counters = std::make_shared<LogHandlerCounters>();
+        return std::make_shared<LogHandlerQueue>(name, config, std::move(consumer),
+                                                 handler.counters);
+      }
+    }
+
     SubscriberId addHandler(const std::string& name, Handler fct,
                             qi::LogLevel defaultLevel)
     {
       if (!LogInstance)
         return -1;
-      boost::mutex::scoped_lock l(LogInstance->LogHandlerLock);
-      unsigned int id = ++LogInstance->nextIndex;
-      --id; // no postfix ++ on atomic
       Log::Handler h;
-      h.index = id;
       h.func = fct;
-      LogInstance->logHandlers[name] = h;
-      setLogLevel(defaultLevel, id);
-      return id;
+      return LogInstance->addHandler(name, std::move(h), defaultLevel);
+    }
+
+    SubscriberId addHandler(const std::string& name, Handler fct,
+                            qi::LogLevel defaultLevel, HandlerQueueConfig queue)
+    {
+      if (!LogInstance)
+        return -1;
+      Log::Handler h;
+      h.func = fct;
+      h.queue = makeQueue(name, queue, textConsumer(fct), h);
+      return LogInstance->addHandler(name, std::move(h), defaultLevel);
+    }
+
+    SubscriberId addBinaryHandler(const std::string& name, BinaryHandler fct,
+                                  qi::LogLevel defaultLevel)
+    {
+      if (!LogInstance)
+        return -1;
+      Log::Handler h;
+      h.binaryFunc = fct;
+      return LogInstance->addHandler(name, std::move(h), defaultLevel);
+    }
+
+    SubscriberId addBinaryHandler(const std::string& name, BinaryHandler fct,
+                                  qi::LogLevel defaultLevel, HandlerQueueConfig queue)
+    {
+      if (!LogInstance)
+        return -1;
+      Log::Handler h;
+      h.binaryFunc = fct;
+      h.queue = makeQueue(name, queue, fct, h);
+      return LogInstance->addHandler(name, std::move(h), defaultLevel);
+    }
+
+    std::map<std::string, HandlerStats> handlerStats()
+    {
+      std::map<std::string, HandlerStats> res;
+      if (!LogInstance)
+        return res;
+      boost::mutex::scoped_lock l(LogInstance->LogHandlerLock);
+      for (const auto& handler : LogInstance->logHandlers)
+      {
+        const Log::Handler& h = handler.second;
+        HandlerStats& stats = res[handler.first];
+        stats.handled = h.counters->handled.load();
+        stats.dropped = h.counters->dropped.load();
+        stats.queued = h.queue ? h.queue->size() : 0;
+        if (stats.handled)
+          stats.meanLatency = qi::Duration(h.counters->totalLatency.load() /
+                                           static_cast<qi::int64_t>(stats.handled));
+        stats.maxLatency = qi::Duration(h.counters->maxLatency.load());
+      }
+      return res;
     }
 
     SubscriberId addLogHandler(const std::string& name, logFuncHandler fct,
@@ -924,8 +1339,18 @@ namespace qi {
     {
       if (!LogInstance)
         return;
-      boost::mutex::scoped_lock l(LogInstance->LogHandlerLock);
-      LogInstance->logHandlers.erase(name);
+      std::shared_ptr<LogHandlerQueue> queue;
+      {
+        boost::mutex::scoped_lock l(LogInstance->LogHandlerLock);
+        auto it = LogInstance->logHandlers.find(name);
+        if (it == LogInstance->logHandlers.end())
+          return;
+        queue = std::move(it->second.queue);
+        LogInstance->logHandlers.erase(it);
+      }
+      // Outside of the lock, as the handler may be logging.
+      if (queue)
+        queue->stop();
     }
 
     void removeLogHandler(const std::string& name)
@@ -983,8 +1408,9 @@ namespace qi {
     qi::LogLevel logLevel(SubscriberId sub)
     {
       CategoryType cat = addCategory("*");
-      if (sub < cat->levels.size())
-        return cat->levels[sub];
+      qi::LogLevel level;
+      if (subscriberLevel(*cat, cat->packedLevels.load(std::memory_order_acquire), sub, level))
+        return level;
       return LogLevel_Info;
     }
 
@@ -1020,20 +1446,41 @@ namespace qi {
       LogInstance->setSynchronousLog(sync);
     }
 
+    void setAsynchronousBufferSize(std::size_t size)
+    {
+      if (LogInstance)
+        LogInstance->RingCapacity = size;
+    }
+
+    qi::uint64_t droppedMessageCount()
+    {
+      if (!LogInstance)
+        return 0;
+      return LogInstance->DroppedCount.load();
+    }
+
     CategoryType addCategory(const std::string& name)
     {
+      {
+        const CategoryIndexPtr index = std::atomic_load(&_categoryIndex());
+        const auto it = index->find(name);
+        if (it != index->end())
+          return it->second;
+      }
+
       boost::recursive_mutex::scoped_lock lock(_mutex());
       CategoryMap& c = _categories();
       CategoryMap::iterator i = c.find(name);
-      if (i == c.end())
-      {
-        detail::Category* res = new detail::Category(name);
-        c[name] = res;
-        checkGlobs(res);
-        return res;
-      }
-      else
+      if (i != c.end())
         return i->second;
+
+      detail::Category* res = new detail::Category(name);
+      c[name] = res;
+      checkGlobs(res);
+      auto index = std::make_shared<CategoryIndex>(*std::atomic_load(&_categoryIndex()));
+      (*index)[name] = res;
+      std::atomic_store(&_categoryIndex(), CategoryIndexPtr(std::move(index)));
+      return res;
     }
 
     bool isVisible(const std::string& category, qi::LogLevel level)
@@ -1105,10 +1552,10 @@ namespace qi {
           ++insertIt;
         _glGlobRules.insert(insertIt, rule);
       }
-      // Then reprocess all categories
+      // Then reprocess all categories, for this subscriber only
       CategoryMap& c = _categories();
       for (CategoryMap::iterator it = c.begin(); it != c.end(); ++it)
-        checkGlobs(it->second);
+        checkGlobs(it->second, sub);
     }
 
     namespace detail {
@@ -0,0 +1,244 @@
+#pragma once
+/*
+**  Copyright (C) 2018 SoftBank Robotics Europe
+**  See COPYING for the license
+*/
+
+#ifndef _SRC_LOGHANDLERQUEUE_P_HPP_
+#define _SRC_LOGHANDLERQUEUE_P_HPP_
+
+#include <atomic>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <string>
+
+#include <boost/function.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+
+#include <qi/clock.hpp>
+#include <qi/log.hpp>
+#include <qi/os.hpp>
+
+namespace qi
+{
+  namespace log
+  {
+    /// Statistics of a log handler, updated without locking.
+    struct LogHandlerCounters
+    {
+      std::atomic<qi::uint64_t> handled{0};
+      std::atomic<qi::uint64_t> dropped{0};
+      std::atomic<qi::int64_t>  totalLatency{0}; // in nanoseconds
+      std::atomic<qi::int64_t>  maxLatency{0};
+
+      /// To be called once the handler is done with a message logged at `date`.
+      void countHandled(const qi::Clock::time_point& date)
+      {
+        const qi::int64_t latency = (qi::Clock::now() - date).count();
+        handled.fetch_add(1, std::memory_order_relaxed);
+        totalLatency.fetch_add(latency, std::memory_order_relaxed);
+        qi::int64_t max = maxLatency.load(std::memory_order_relaxed);
+        while (latency > max && !maxLatency.compare_exchange_weak(max, latency))
+          ;
+      }
+    };
+
+    /// Bounded queue of messages for one handler, which is called by a
+    /// dedicated thread so that it cannot delay the other handlers.
+    class LogHandlerQueue
+    {
+    public:
+      using Consumer = boost::function<void (const DeferredLogRecord&)>;
+
+      LogHandlerQueue(const std::string& name,
+                      const HandlerQueueConfig& config,
+                      Consumer consumer,
+                      std::shared_ptr<LogHandlerCounters> counters)
+        : _state(std::make_shared<State>(config, std::move(consumer), std::move(counters)))
+      {
+        auto state = _state;
+        _thread = boost::thread([state, name] {
+          qi::os::setCurrentThreadName("log." + name);
+          state->run();
+        });
+      }
+
+      LogHandlerQueue(const LogHandlerQueue&) = delete;
+      LogHandlerQueue& operator=(const LogHandlerQueue&) = delete;
+
+      ~LogHandlerQueue()
+      {
+        stop();
+      }
+
+      /// Copies the record in the queue. Depending on the policy, waits for
+      /// room or drops it if the queue is full. Returns false if dropped.
+      bool push(const DeferredLogRecord& record)
+      {
+        State& s = *_state;
+        boost::unique_lock<boost::mutex> lock(s.mutex);
+        if (s.entries.size() >= s.config.size)
+        {
+          if (s.config.policy == QueueFullPolicy::Drop)
+          {
+            s.counters->dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+          }
+          while (s.entries.size() >= s.config.size && !s.stopping)
+            s.notFull.wait(lock);
+        }
+        if (s.stopping)
+          return false;
+        s.entries.emplace_back(record);
+        s.notEmpty.notify_one();
+        return true;
+      }
+
+      std::size_t size() const
+      {
+        boost::mutex::scoped_lock lock(_state->mutex);
+        return _state->entries.size();
+      }
+
+      /// Blocks until the messages pushed so far are handled.
+      void waitEmpty()
+      {
+        State& s = *_state;
+        boost::unique_lock<boost::mutex> lock(s.mutex);
+        while ((!s.entries.empty() || s.busy) && !s.stopping)
+          s.idle.wait(lock);
+      }
+
+      /// Handles the messages left and stops the thread.
+      void stop()
+      {
+        {
+          boost::mutex::scoped_lock lock(_state->mutex);
+          if (_state->stopping)
+            return;
+          _state->stopping = true;
+          _state->notEmpty.notify_one();
+          _state->notFull.notify_all();
+          _state->idle.notify_all();
+        }
+        // The handler may remove itself, its thread then finishes on its own,
+        // keeping the state alive.
+        if (_thread.get_id() == boost::this_thread::get_id())
+          _thread.detach();
+        else if (_thread.joinable())
+          _thread.join();
+      }
+
+    private:
+      struct Entry
+      {
+        explicit Entry(const DeferredLogRecord& record)
+          : level(record.level)
+          , date(record.date)
+          , systemDate(record.systemDate)
+          , category(nonNull(record.category))
+          , file(nonNull(record.file))
+          , function(nonNull(record.function))
+          , line(record.line)
+          , format(record.format)
+          , message(record.format && record.message ? std::string(record.message, record.messageSize)
+                                                    : std::string(nonNull(record.message)))
+        {
+        }
+
+        // The synchronous logging passes the pointers of the caller as is.
+        static const char* nonNull(const char* str)
+        {
+          return str ? str : "(null)";
+        }
+
+        DeferredLogRecord view() const
+        {
+          return { level, date, systemDate, category.c_str(), file.c_str(), function.c_str(),
+                   line, format, message.c_str(), message.size() };
+        }
+
+        qi::LogLevel                level;
+        qi::Clock::time_point       date;
+        qi::SystemClock::time_point systemDate;
+        std::string                 category;
+        std::string                 file;
+        std::string                 function;
+        int                         line;
+        const char*                 format; // a literal
+        std::string                 message;
+      };
+
+      struct State
+      {
+        State(HandlerQueueConfig c, Consumer f, std::shared_ptr<LogHandlerCounters> n)
+          : config(c)
+          , consumer(std::move(f))
+          , counters(std::move(n))
+          , busy(false)
+          , stopping(false)
+        {
+          if (config.size == 0)
+            config.size = 1;
+        }
+
+        void run()
+        {
+          std::deque<Entry> batch;
+          boost::unique_lock<boost::mutex> lock(mutex);
+          while (true)
+          {
+            while (entries.empty() && !stopping)
+              notEmpty.wait(lock);
+            if (entries.empty())
+              return;
+            batch.swap(entries);
+            busy = true;
+            notFull.notify_all();
+
+            lock.unlock();
+            for (const auto& entry : batch)
+            {
+              // An exception cannot be reported through the logs, which would
+              // call this very handler.
+              try
+              {
+                consumer(entry.view());
+              }
+              catch (...)
+              {
+              }
+              counters->countHandled(entry.date);
+            }
+            batch.clear();
+            lock.lock();
+
+            busy = false;
+            if (entries.empty())
+              idle.notify_all();
+          }
+        }
+
+        HandlerQueueConfig config;
+        const Consumer consumer;
+        const std::shared_ptr<LogHandlerCounters> counters;
+
+        boost::mutex mutex;
+        boost::condition_variable notEmpty;
+        boost::condition_variable notFull;
+        boost::condition_variable idle;
+        std::deque<Entry> entries;
+        bool busy;
+        bool stopping;
+      };
+
+      const std::shared_ptr<State> _state;
+      boost::thread _thread;
+    };
+  }
+}
+
+#endif  // _SRC_LOGHANDLERQUEUE_P_HPP_
@@ -0,0 +1,290 @@
+#pragma once
+/*
+**  Copyright (C) 2018 SoftBank Robotics Europe
+**  See COPYING for the license
+*/
+
+#ifndef _SRC_LOGRING_P_HPP_
+#define _SRC_LOGRING_P_HPP_
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <new>
+
+#include <qi/clock.hpp>
+#include <qi/log.hpp>
+#include <qi/types.hpp>
+
+namespace qi
+{
+  namespace log
+  {
+    /// A log entry, stored in a LogRing followed by its null-terminated
+    /// strings: category, file, function and message.
+    ///
+    /// Entries logged with deferred formatting only reference their category,
+    /// file and function, which are known to outlive them, and are followed by
+    /// their encoded arguments instead of a message.
+    struct alignas(8) LogRecord
+    {
+      qi::LogLevel                level;
+      int                         line;
+      CategoryType                category; // null if only the name is known
+      const char*                 format; // null unless formatting is deferred
+      const char*                 fileLiteral; // only if formatting is deferred
+      const char*                 functionLiteral; // only if formatting is deferred
+      qi::Clock::time_point       date;
+      qi::SystemClock::time_point systemDate;
+      qi::uint32_t                categorySize; // sizes include the terminating null
+      qi::uint32_t                fileSize;
+      qi::uint32_t                functionSize;
+      qi::uint32_t                messageSize;
+
+      const char* categoryName() const
+      {
+        return format ? category->name.c_str() : reinterpret_cast<const char*>(this + 1);
+      }
+      const char* file() const
+      {
+        return format ? fileLiteral : categoryName() + categorySize;
+      }
+      const char* function() const
+      {
+        return format ? functionLiteral : file() + fileSize;
+      }
+      const char* message() const
+      {
+        return format ? reinterpret_cast<const char*>(this + 1) : function() + functionSize;
+      }
+    };
+
+    /// Single producer, single consumer ring of variable-size log records.
+    ///
+    /// The producer never blocks nor allocates: when there is not enough room
+    /// left, the record is dropped and counted. Records are stored contiguously
+    /// so that the consumer can hand their strings out without copying them.
+    class LogRing
+    {
+    public:
+      /// \param capacity in bytes, rounded up to a power of two.
+      explicit LogRing(std::size_t capacity)
+        : _capacity(roundCapacity(capacity))
+        , _buffer(new qi::uint64_t[_capacity / sizeof(qi::uint64_t)])
+        , _head(0)
+        , _tail(0)
+        , _reservedTail(0)
+        , _dropped(0)
+      {
+      }
+
+      LogRing(const LogRing&) = delete;
+      LogRing& operator=(const LogRing&) = delete;
+
+      std::size_t capacity() const { return _capacity; }
+
+      /// Producer side. Returns false if the record was dropped.
+      bool push(qi::LogLevel level,
+                CategoryType category,
+                const char* categoryName,
+                const char* file,
+                const char* function,
+                int line,
+                const qi::Clock::time_point& date,
+                const qi::SystemClock::time_point& systemDate,
+                const char* message)
+      {
+        categoryName = nonNull(categoryName);
+        file = nonNull(file);
+        function = nonNull(function);
+        message = nonNull(message);
+
+        const std::size_t categorySize = std::strlen(categoryName) + 1;
+        const std::size_t fileSize = std::strlen(file) + 1;
+        const std::size_t functionSize = std::strlen(function) + 1;
+        const std::size_t fixedSize =
+            sizeof(Header) + sizeof(LogRecord) + categorySize + fileSize + functionSize;
+        // A record may not take more than half of the ring, longer messages
+        // are truncated.
+        const std::size_t maxSize = _capacity / 2;
+        if (fixedSize + 1 > maxSize)
+          return drop();
+        const std::size_t messageSize =
+            std::min(std::strlen(message) + 1, maxSize - fixedSize);
+
+        LogRecord* record = reserve(fixedSize + messageSize);
+        if (!record)
+          return drop();
+        record->level = level;
+        record->line = line;
+        record->category = category;
+        record->format = nullptr;
+        record->date = date;
+        record->systemDate = systemDate;
+        record->categorySize = static_cast<qi::uint32_t>(categorySize);
+        record->fileSize = static_cast<qi::uint32_t>(fileSize);
+        record->functionSize = static_cast<qi::uint32_t>(functionSize);
+        record->messageSize = static_cast<qi::uint32_t>(messageSize);
+        char* strings = const_cast<char*>(record->categoryName());
+        std::memcpy(strings, categoryName, categorySize);
+        std::memcpy(strings += categorySize, file, fileSize);
+        std::memcpy(strings += fileSize, function, functionSize);
+        std::memcpy(strings += functionSize, message, messageSize - 1);
+        strings[messageSize - 1] = '\0';
+
+        commit();
+        return true;
+      }
+
+      /// Producer side, for messages whose formatting is deferred.
+      /// `category`, `file`, `function` and `format` must outlive the ring.
+      /// Returns false if the record was dropped.
+      bool pushDeferred(qi::LogLevel level,
+                        CategoryType category,
+                        const char* file,
+                        const char* function,
+                        int line,
+                        const qi::Clock::time_point& date,
+                        const qi::SystemClock::time_point& systemDate,
+                        const char* format,
+                        const char* args,
+                        std::size_t argsSize)
+      {
+        const std::size_t fixedSize = sizeof(Header) + sizeof(LogRecord);
+        if (fixedSize + argsSize > _capacity / 2)
+          return drop();
+        LogRecord* record = reserve(fixedSize + argsSize);
+        if (!record)
+          return drop();
+        record->level = level;
+        record->line = line;
+        record->category = category;
+        record->format = format;
+        record->fileLiteral = file;
+        record->functionLiteral = function;
+        record->date = date;
+        record->systemDate = systemDate;
+        record->categorySize = record->fileSize = record->functionSize = 0;
+        record->messageSize = static_cast<qi::uint32_t>(argsSize);
+        std::memcpy(record + 1, args, argsSize);
+        commit();
+        return true;
+      }
+
+      /// Consumer side. Calls `f(const LogRecord&)` on each available record,
+      /// at most `maxCount` of them, and returns how many were consumed.
+      template <typename F>
+      std::size_t consume(F&& f, std::size_t maxCount = std::size_t(-1))
+      {
+        qi::uint64_t head = _head.load(std::memory_order_relaxed);
+        const qi::uint64_t tail = _tail.load(std::memory_order_acquire);
+        std::size_t count = 0;
+        while (head != tail && count < maxCount)
+        {
+          const Header* header = reinterpret_cast<const Header*>(at(offset(head)));
+          if (!header->padding)
+          {
+            f(*reinterpret_cast<const LogRecord*>(header + 1));
+            ++count;
+          }
+          head += header->size;
+          _head.store(head, std::memory_order_release);
+        }
+        return count;
+      }
+
+      /// Can be called from both sides.
+      bool empty() const
+      {
+        return _head.load(std::memory_order_acquire) == _tail.load(std::memory_order_acquire);
+      }
+
+      /// Number of records dropped since the creation of the ring.
+      qi::uint64_t dropped() const
+      {
+        return _dropped.load(std::memory_order_relaxed);
+      }
+
+    private:
+      struct Header
+      {
+        qi::uint32_t size; // including this header
+        qi::uint32_t padding; // non-zero if this is a filler up to the end of the buffer
+      };
+      static_assert(sizeof(Header) % sizeof(qi::uint64_t) == 0, "records must stay aligned");
+      static_assert(sizeof(LogRecord) % sizeof(qi::uint64_t) == 0, "records must stay aligned");
+
+      static std::size_t roundCapacity(std::size_t capacity)
+      {
+        std::size_t res = 4096;
+        while (res < capacity)
+          res *= 2;
+        return res;
+      }
+
+      static std::size_t align(std::size_t size)
+      {
+        return (size + sizeof(qi::uint64_t) - 1) & ~(sizeof(qi::uint64_t) - 1);
+      }
+
+      static const char* nonNull(const char* str)
+      {
+        return str ? str : "(null)";
+      }
+
+      std::size_t offset(qi::uint64_t index) const
+      {
+        return static_cast<std::size_t>(index & (_capacity - 1));
+      }
+
+      char* at(std::size_t pos) const
+      {
+        return reinterpret_cast<char*>(_buffer.get()) + pos;
+      }
+
+      // Reserves room for a record of `size` bytes, header included, or
+      // returns null if the ring is full. The record is published by commit().
+      LogRecord* reserve(std::size_t size)
+      {
+        size = align(size);
+        const qi::uint64_t tail = _tail.load(std::memory_order_relaxed);
+        const qi::uint64_t head = _head.load(std::memory_order_acquire);
+        std::size_t pos = offset(tail);
+        const std::size_t contiguous = _capacity - pos;
+        const std::size_t padding = size > contiguous ? contiguous : 0;
+        if (tail + padding + size - head > _capacity)
+          return nullptr;
+
+        if (padding)
+        {
+          new (at(pos)) Header{ static_cast<qi::uint32_t>(padding), true };
+          pos = 0;
+        }
+        new (at(pos)) Header{ static_cast<qi::uint32_t>(size), false };
+        _reservedTail = tail + padding + size;
+        return new (at(pos + sizeof(Header))) LogRecord;
+      }
+
+      void commit()
+      {
+        _tail.store(_reservedTail, std::memory_order_release);
+      }
+
+      bool drop()
+      {
+        _dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+      }
+
+      const std::size_t _capacity;
+      const std::unique_ptr<qi::uint64_t[]> _buffer;
+      std::atomic<qi::uint64_t> _head; // written by the consumer only
+      std::atomic<qi::uint64_t> _tail; // written by the producer only
+      qi::uint64_t _reservedTail; // used by the producer only
+      std::atomic<qi::uint64_t> _dropped;
+    };
+  }
+}
+
+#endif  // _SRC_LOGRING_P_HPP_
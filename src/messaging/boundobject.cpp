@@ -8,6 +8,7 @@
 #include <qi/anyobject.hpp>
 #include <qi/type/objecttypebuilder.hpp>
 #include "boundobject.hpp"
+#include "metaobjectcache.hpp"
 
 qiLogCategory("qimessaging.boundobject");
 
@@ -15,71 +16,314 @@ const auto invalidValueError = "The value is invalid.";
 
 namespace qi {
 
-  static AnyReference forwardEvent(const GenericFunctionParameters& params,
-                                   unsigned int service, unsigned int object,
-                                   unsigned int event, Signature sig,
-                                   MessageSocketPtr client,
-                                   boost::weak_ptr<ObjectHost> context,
-                                   const std::string& signature)
+  /// Sends the events of a remote subscription, applying the delivery policy
+  /// of the subscription to the events waiting in the socket send queue.
+  ///
+  /// With a bounded policy of n, at most n events are queued in the socket at
+  /// any time. Events triggered meanwhile collapse into a single one, the
+  /// newest, which is sent as soon as the socket has written a queued event.
+  class EventForwarder : public boost::enable_shared_from_this<EventForwarder>
   {
-    qiLogDebug() << "forwardEvent";
-    qi::Message msg;
-    // FIXME: would like to factor with serveresult.hpp convertAndSetValue()
-    // but we have a setValue/setValues issue
-    bool processed = false;
-    if (!signature.empty() && client->remoteCapability("MessageFlags", false))
-    {
-      qiLogDebug() << "forwardEvent attempting conversion to " << signature;
-      try
+  public:
+    explicit EventForwarder(MessageSocketPtr socket)
+      : _socket(std::move(socket))
+    {}
+
+    ~EventForwarder()
+    {
+      if (_dropped)
+        qiLogVerbose() << "Dropped " << _dropped << " events for " << _socket.get()
+                       << " because of the delivery policy";
+    }
+
+    /// `policy` is the delivery policy of the subscription when `msg` is sent.
+    void send(Message msg, const DeliveryPolicy& policy)
+    {
       {
-        GenericFunctionParameters res = params.convert(signature);
-        // invalid conversion does not throw it seems
-        bool valid = true;
-        for (unsigned i=0; i<res.size(); ++i)
+        boost::mutex::scoped_lock lock(_mutex);
+        _maxInFlight = policy.maxPending();
+        if (_maxInFlight == 0)
         {
-          if (!res[i].type())
-          {
-            valid = false;
-            break;
-          }
+          lock.unlock();
+          _socket->send(std::move(msg));
+          return;
         }
-        if (valid)
+        if (_inFlight >= _maxInFlight)
         {
-          qiLogDebug() << "forwardEvent success " << res[0].type()->infoString();
-          msg.setValues(res, "m", context, client.get());
-          msg.addFlags(Message::TypeFlag_DynamicPayload);
-          res.destroy();
-          processed = true;
+          if (_pending)
+            ++_dropped;
+          _pending = std::move(msg);
+          return;
         }
+        ++_inFlight;
       }
-      catch(const std::exception& /* e */)
+      sendTracked(std::move(msg));
+    }
+
+  private:
+    void sendTracked(Message msg)
+    {
+      boost::weak_ptr<EventForwarder> weakSelf = shared_from_this();
+      const bool sent = _socket->send(std::move(msg), [weakSelf] {
+        if (auto self = weakSelf.lock())
+          self->onSent();
+      });
+      if (!sent)
       {
-        qiLogDebug() << "forwardEvent failed to convert to forced type";
+        boost::mutex::scoped_lock lock(_mutex);
+        --_inFlight;
       }
     }
-    if (!processed)
+
+    void onSent()
+    {
+      Message next;
+      {
+        boost::mutex::scoped_lock lock(_mutex);
+        if (!_pending)
+        {
+          --_inFlight;
+          return;
+        }
+        next = std::move(*_pending);
+        _pending = boost::none;
+      }
+      // The slot of the sent message is reused by the pending one.
+      sendTracked(std::move(next));
+    }
+
+    MessageSocketPtr _socket;
+    boost::mutex _mutex;
+    std::size_t _maxInFlight = 0;
+    std::size_t _inFlight = 0;
+    boost::optional<Message> _pending;
+    qi::uint64_t _dropped = 0;
+  };
+
+  namespace
+  {
+    // Encodes the arguments of an event into the payload of `msg`, as
+    // expected by a remote end with the given capabilities.
+    void setEventValues(Message& msg, const GenericFunctionParameters& params,
+                        const Signature& sig, const std::string& forcedSignature,
+                        bool remoteHasMessageFlags, boost::weak_ptr<ObjectHost> context,
+                        StreamContext* streamContext)
     {
+      // FIXME: would like to factor with serveresult.hpp convertAndSetValue()
+      // but we have a setValue/setValues issue
+      if (!forcedSignature.empty() && remoteHasMessageFlags)
+      {
+        qiLogDebug() << "forwardEvent attempting conversion to " << forcedSignature;
+        try
+        {
+          GenericFunctionParameters res = params.convert(forcedSignature);
+          // invalid conversion does not throw it seems
+          bool valid = true;
+          for (unsigned i=0; i<res.size(); ++i)
+          {
+            if (!res[i].type())
+            {
+              valid = false;
+              break;
+            }
+          }
+          if (valid)
+          {
+            qiLogDebug() << "forwardEvent success " << res[0].type()->infoString();
+            msg.setValues(res, "m", context, streamContext);
+            msg.addFlags(Message::TypeFlag_DynamicPayload);
+            res.destroy();
+            return;
+          }
+        }
+        catch(const std::exception& /* e */)
+        {
+          qiLogDebug() << "forwardEvent failed to convert to forced type";
+        }
+      }
       try {
-        msg.setValues(params, sig, context, client.get());
+        msg.setValues(params, sig, context, streamContext);
       }
       catch (const std::exception& e)
       {
         qiLogVerbose() << "forwardEvent::setValues exception: " << e.what();
-        if (!client->remoteCapability("MessageFlags", false))
+        if (!remoteHasMessageFlags)
           throw e;
         // Delegate conversion to the remote end.
         msg.addFlags(Message::TypeFlag_DynamicPayload);
-        msg.setValues(params, "m", context, client.get());
+        msg.setValues(params, "m", context, streamContext);
       }
     }
-    msg.setService(service);
-    msg.setFunction(event);
-    msg.setType(Message::Type_Event);
-    msg.setObject(object);
-    client->send(std::move(msg));
-    return AnyReference();
   }
 
+  // Objects are registered on the socket they are sent to, so a payload
+  // that may contain some cannot be shared among sockets.
+  bool mayContainObjects(const Signature& sig)
+  {
+    switch (sig.type())
+    {
+    case Signature::Type_Object:
+    case Signature::Type_Dynamic:
+    case Signature::Type_Unknown:
+    case Signature::Type_None:
+      return true;
+    default:
+      break;
+    }
+    for (const auto& child: sig.children())
+      if (mayContainObjects(child))
+        return true;
+    return false;
+  }
+
+  /// Forwards the triggers of a signal to all the remote subscribers of this
+  /// signal through a single local subscriber.
+  ///
+  /// Unless the arguments may contain objects, the payload is encoded once
+  /// per distinct forced signature and remote capabilities, and the encoded
+  /// buffer is shared by the messages sent to all the sockets.
+  class ServiceBoundObject::EventFanOut
+  {
+  public:
+    struct Target
+    {
+      MessageSocketPtr socket;
+      SignalLink remoteLink;
+      std::string forcedSignature;
+      boost::shared_ptr<EventForwarder> forwarder;
+    };
+
+    EventFanOut(unsigned int service, unsigned int object, unsigned int event,
+                Signature signature, boost::weak_ptr<ObjectHost> context)
+      : _service(service)
+      , _object(object)
+      , _event(event)
+      , _signature(std::move(signature))
+      , _context(std::move(context))
+    {}
+
+    /// The local subscriber forwarding the events. Connecting it makes it
+    /// inherit the delivery policy and the message priority of the signal, so
+    /// they apply from the first event on.
+    void setSubscriber(const SignalSubscriber& subscriber)
+    {
+      boost::mutex::scoped_lock lock(_mutex);
+      _subscriber = subscriber;
+    }
+
+    void add(MessageSocketPtr socket, SignalLink remoteLink, std::string forcedSignature)
+    {
+      auto forwarder = boost::make_shared<EventForwarder>(socket);
+      boost::mutex::scoped_lock lock(_mutex);
+      _targets.push_back(Target{ std::move(socket), remoteLink, std::move(forcedSignature),
+                                 std::move(forwarder) });
+    }
+
+    /// @return true if there is no target left.
+    bool remove(const MessageSocketPtr& socket, SignalLink remoteLink)
+    {
+      boost::mutex::scoped_lock lock(_mutex);
+      _targets.erase(std::remove_if(_targets.begin(), _targets.end(), [&](const Target& t) {
+        return t.socket == socket && t.remoteLink == remoteLink;
+      }), _targets.end());
+      return _targets.empty();
+    }
+
+    /// The events triggered while the client was disconnected are lost.
+    void replaceSocket(const MessageSocketPtr& previous, const MessageSocketPtr& socket)
+    {
+      boost::mutex::scoped_lock lock(_mutex);
+      for (auto& target: _targets)
+      {
+        if (target.socket != previous)
+          continue;
+        target.socket = socket;
+        target.forwarder = boost::make_shared<EventForwarder>(socket);
+      }
+    }
+
+    AnyReference forward(const GenericFunctionParameters& params)
+    {
+      qiLogDebug() << "forwardEvent";
+      std::vector<Target> targets;
+      DeliveryPolicy policy = DeliveryPolicy::all();
+      MessagePriority priority = MessagePriority_Normal;
+      {
+        boost::mutex::scoped_lock lock(_mutex);
+        targets = _targets;
+        if (_subscriber)
+        {
+          policy = _subscriber->deliveryPolicy();
+          priority = _subscriber->messagePriority();
+        }
+      }
+
+      const bool shareable = !mayContainObjects(_signature);
+      // (forced signature, remote has message flags) -> encoded payload
+      using PayloadKey = std::pair<std::string, bool>;
+      struct Payload
+      {
+        qi::uint8_t flags;
+        boost::shared_ptr<const Buffer> buffer;
+      };
+      std::map<PayloadKey, Payload> payloads;
+      for (const auto& target: targets)
+      {
+        const bool messageFlags = target.socket->remoteCapability("MessageFlags", false);
+        Message msg;
+        try
+        {
+          if (shareable)
+          {
+            const PayloadKey key{ target.forcedSignature, messageFlags };
+            auto it = payloads.find(key);
+            if (it == payloads.end())
+            {
+              Message encoded;
+              setEventValues(encoded, params, _signature, target.forcedSignature, messageFlags,
+                             _context, nullptr);
+              Payload payload{ encoded.flags(),
+                               boost::make_shared<const Buffer>(encoded.extractBuffer()) };
+              it = payloads.emplace(key, std::move(payload)).first;
+            }
+            msg.setFlags(it->second.flags);
+            msg.setSharedBuffer(it->second.buffer);
+          }
+          else
+          {
+            setEventValues(msg, params, _signature, target.forcedSignature, messageFlags,
+                           _context, target.socket.get());
+          }
+        }
+        catch (const std::exception& e)
+        {
+          qiLogWarning() << "Cannot forward event " << _event << " to " << target.socket.get()
+                         << ": " << e.what();
+          continue;
+        }
+        msg.setService(_service);
+        msg.setFunction(_event);
+        msg.setType(Message::Type_Event);
+        msg.setObject(_object);
+        msg.setPriority(priority);
+        target.forwarder->send(std::move(msg), policy);
+      }
+      return AnyReference();
+    }
+
+    qi::Future<SignalLink> localLink;
+
+  private:
+    const unsigned int _service;
+    const unsigned int _object;
+    const unsigned int _event;
+    const Signature _signature;
+    const boost::weak_ptr<ObjectHost> _context;
+    boost::mutex _mutex;
+    std::vector<Target> _targets;
+    boost::optional<SignalSubscriber> _subscriber;
+  };
+
   struct ServiceBoundObject::CancelableKit
   {
     ServiceBoundObject::CancelableMap map;
@@ -141,6 +385,7 @@ namespace qi {
       ob->advertiseMethod("setProperty", &ServiceBoundObject::setProperty, MetaCallType_Queued, qi::Message::BoundObjectFunction_SetProperty);
       ob->advertiseMethod("properties",       &ServiceBoundObject::properties, MetaCallType_Direct, qi::Message::BoundObjectFunction_Properties);
       ob->advertiseMethod("registerEventWithSignature"  , &ServiceBoundObject::registerEventWithSignature, MetaCallType_Direct, qi::Message::BoundObjectFunction_RegisterEventWithSignature);
+      ob->advertiseMethod("metaObjectIndex", &ServiceBoundObject::metaObjectIndex, MetaCallType_Direct, qi::Message::BoundObjectFunction_MetaObjectIndex);
     }
     AnyObject result = ob->object(self, &AnyObject::deleteGenericObjectOnly);
     return result;
@@ -148,19 +393,7 @@ namespace qi {
 
   // Bound Method
   qi::Future<SignalLink> ServiceBoundObject::registerEvent(unsigned int objectId, unsigned int eventId, SignalLink remoteSignalLinkId) {
-    // fetch signature
-    const MetaSignal* ms = _object.metaObject().signal(eventId);
-    if (!ms)
-      throw std::runtime_error("No such signal");
-    QI_ASSERT(_currentSocket);
-    AnyFunction mc = AnyFunction::fromDynamicFunction(boost::bind(&forwardEvent, _1, _serviceId, _objectId, eventId, ms->parametersSignature(), _currentSocket, weakPtr(), ""));
-    qi::Future<SignalLink> linking = _object.connect(eventId, mc);
-    auto& linkEntry = _links[_currentSocket][remoteSignalLinkId];
-    linkEntry = RemoteSignalLink(linking, eventId);
-    return linking.andThen([=](SignalLink linkId) mutable {
-      qiLogDebug() << "SBO rl " << remoteSignalLinkId << " ll " << linkId;
-      return linkId;
-    });
+    return registerEventWithSignature(objectId, eventId, remoteSignalLinkId, std::string());
   }
 
   qi::Future<SignalLink> ServiceBoundObject::registerEventWithSignature(unsigned int objectId, unsigned int eventId, SignalLink remoteSignalLinkId, const std::string& signature) {
@@ -169,8 +402,46 @@ namespace qi {
     if (!ms)
       throw std::runtime_error("No such signal");
     QI_ASSERT(_currentSocket);
-    AnyFunction mc = AnyFunction::fromDynamicFunction(boost::bind(&forwardEvent, _1, _serviceId, _objectId, eventId, ms->parametersSignature(), _currentSocket, weakPtr(), signature));
-    qi::Future<SignalLink> linking = _object.connect(eventId, mc);
+
+    EventFanOutPtr fanOut;
+    bool created = false;
+    {
+      boost::mutex::scoped_lock lock(_eventFanOutsMutex);
+      auto& fanOutEntry = _eventFanOuts[eventId];
+      if (!fanOutEntry)
+      {
+        created = true;
+        fanOutEntry = boost::make_shared<EventFanOut>(_serviceId, _objectId, eventId,
+                                                      ms->parametersSignature(), weakPtr());
+        // The fan-out keeps the subscriber, which must not keep the fan-out.
+        boost::weak_ptr<EventFanOut> weakFanOut = fanOutEntry;
+        SignalSubscriber subscriber(AnyFunction::fromDynamicFunction(
+            [weakFanOut](const GenericFunctionParameters& params) {
+              auto fanOut = weakFanOut.lock();
+              return fanOut ? fanOut->forward(params) : AnyReference();
+            }));
+        fanOutEntry->setSubscriber(subscriber);
+        fanOutEntry->localLink = _object.connect(eventId, subscriber).async();
+      }
+      fanOut = fanOutEntry;
+      fanOut->add(_currentSocket, remoteSignalLinkId, signature);
+    }
+
+    qi::Future<SignalLink> linking = fanOut->localLink;
+    if (created)
+    {
+      // A fan-out whose local link failed would fail every later subscriber
+      // of the event: drop it, unless it was already replaced.
+      boost::weak_ptr<EventFanOut> weakFanOut = fanOut;
+      linking.connect(track([=](Future<SignalLink> link) {
+        if (!link.hasError())
+          return;
+        boost::mutex::scoped_lock lock(_eventFanOutsMutex);
+        auto it = _eventFanOuts.find(eventId);
+        if (it != _eventFanOuts.end() && it->second == weakFanOut.lock())
+          _eventFanOuts.erase(it);
+      }, this));
+    }
     auto& linkEntry = _links[_currentSocket][remoteSignalLinkId];
     linkEntry = RemoteSignalLink(linking, eventId);
     return linking.andThen([=](SignalLink linkId) mutable {
@@ -179,6 +450,27 @@ namespace qi {
     });
   }
 
+  Future<void> ServiceBoundObject::removeEventTarget(const MessageSocketPtr& socket,
+                                                     unsigned int eventId,
+                                                     SignalLink remoteSignalLinkId)
+  {
+    Future<SignalLink> localLink;
+    {
+      boost::mutex::scoped_lock lock(_eventFanOutsMutex);
+      auto it = _eventFanOuts.find(eventId);
+      if (it == _eventFanOuts.end())
+        return Future<void>{nullptr};
+      if (!it->second->remove(socket, remoteSignalLinkId))
+        return Future<void>{nullptr};
+      // That was the last remote subscriber of the event.
+      localLink = it->second->localLink;
+      _eventFanOuts.erase(it);
+    }
+    return localLink.andThen([=](SignalLink link) {
+      return _object.disconnect(link).async();
+    }).unwrap();
+  }
+
   // Bound Method
   qi::Future<void> ServiceBoundObject::unregisterEvent(unsigned int objectId, unsigned int QI_UNUSED(event), SignalLink remoteSignalLinkId) {
     ServiceSignalLinks&          sl = _links[_currentSocket];
@@ -192,13 +484,12 @@ namespace qi {
       throw std::runtime_error(ss.str());
     }
 
-    auto localSignalLinkId = it->second.localSignalLinkId;
+    const auto eventId = it->second.event;
     sl.erase(it);
+    const auto socket = _currentSocket;
     if (sl.empty())
       _links.erase(_currentSocket);
-    return localSignalLinkId.andThen([=](SignalLink link) {
-      return _object.disconnect(link).async();
-    }).unwrap();
+    return removeEventTarget(socket, eventId, remoteSignalLinkId);
   }
 
   // Bound Method
@@ -207,6 +498,17 @@ namespace qi {
     return qi::MetaObject::merge(_self.metaObject(), _object.metaObject());
   }
 
+  // Bound Method
+  std::pair<qi::uint64_t, qi::MetaObject> ServiceBoundObject::metaObjectIndex(unsigned int objectId,
+                                                                            qi::uint64_t knownHash)
+  {
+    const qi::MetaObject full = metaObject(objectId);
+    const qi::uint64_t hash = metaObjectHash(full);
+    if (hash == knownHash)
+      return std::make_pair(hash, qi::MetaObject());
+    return std::make_pair(hash, compactMetaObject(full));
+  }
+
 
   void ServiceBoundObject::terminate(unsigned int)
   {
@@ -227,8 +529,153 @@ namespace qi {
     value.destroy();
   }
 
+  namespace
+  {
+    /// Collects the replies to the calls of a Type_CallBatch message, and
+    /// sends them in a single Type_BatchReply once they are all known.
+    class BatchReply
+    {
+    public:
+      BatchReply(MessageSocketPtr socket, const MessageAddress& address, std::size_t size)
+        : _socket(std::move(socket))
+        , _address(address)
+        , _results(size)
+        , _pending(size)
+      {
+      }
+
+      /// Sets the reply to the call at `index`, sends the batch reply if it was
+      /// the last one.
+      bool setReply(std::size_t index, Message reply)
+      {
+        MessageBatchEntry& result = _results[index];
+        result.type = reply.type();
+        result.action = reply.function();
+        result.flags = reply.flags();
+        result.payload = reply.extractBuffer();
+        if (_pending.fetch_sub(1) != 1)
+          return true;
+        return send();
+      }
+
+      bool send()
+      {
+        Message batchReply(Message::Type_BatchReply, _address);
+        batchReply.setValue(AnyReference::from(_results), typeOf<MessageBatch>()->signature());
+        return _socket->send(std::move(batchReply));
+      }
+
+    private:
+      const MessageSocketPtr _socket;
+      const MessageAddress _address;
+      MessageBatch _results;
+      std::atomic<std::size_t> _pending;
+    };
+  }
+
+  void ServiceBoundObject::onCallBatch(const qi::Message &msg, MessageSocketPtr socket)
+  {
+    MessageBatch calls;
+    try
+    {
+      calls = msg.value(typeOf<MessageBatch>()->signature(), socket).to<MessageBatch>();
+    }
+    catch (const std::exception& e)
+    {
+      serverResultAdapter(qi::makeFutureError<AnyReference>(std::string("Invalid batch of calls: ") + e.what()),
+                          Signature(), _gethost(), socket, msg.address(), Signature(), CancelableKitWeak());
+      return;
+    }
+    qiLogDebug() << this << "(" << service() << '/' << _objectId << ") batch of " << calls.size()
+                 << " calls " << msg.address();
+
+    auto batch = boost::make_shared<BatchReply>(socket, msg.address(), calls.size());
+    if (calls.empty())
+    {
+      batch->send();
+      return;
+    }
+    // Each call is handled as if it came in its own message, with the id of
+    // the batch, and its reply is kept until all the calls are done.
+    for (std::size_t i = 0; i < calls.size(); ++i)
+    {
+      const MessageAddress address(msg.id(), msg.service(), msg.object(), calls[i].action);
+      if (calls[i].type != Message::Type_Call)
+      {
+        Message error(Message::Type_Error, address);
+        error.setError("Only calls can be sent in a batch");
+        batch->setReply(i, std::move(error));
+        continue;
+      }
+      Message call(Message::Type_Call, address);
+      call.setFlags(static_cast<qi::uint8_t>(calls[i].flags));
+      call.setBuffer(std::move(calls[i].payload));
+      scheduleMessage(call, socket, [batch, i](Message reply) {
+        return batch->setReply(i, std::move(reply));
+      }, false);
+    }
+  }
+
   void ServiceBoundObject::onMessage(const qi::Message &msg, MessageSocketPtr socket) {
     boost::mutex::scoped_lock lock(_callMutex);
+    if (msg.type() == Message::Type_CallBatch && msg.object() <= _objectId)
+      onCallBatch(msg, socket);
+    else
+      scheduleMessage(msg, socket, ReplySink(), true);
+  }
+
+  void ServiceBoundObject::setCallScheduling(const CallSchedulingConfig& config)
+  {
+    if (!config.enabled())
+    {
+      _scheduler.reset();
+      return;
+    }
+    // Queued calls are started under the lock taken by onMessage, as the
+    // others.
+    _scheduler = boost::make_shared<CallScheduler>(config,
+        track([this](const boost::function<void ()>& start) {
+          boost::mutex::scoped_lock lock(_callMutex);
+          start();
+        }, this));
+  }
+
+  CallSchedulingStats ServiceBoundObject::callSchedulingStats() const
+  {
+    return _scheduler ? _scheduler->stats() : CallSchedulingStats();
+  }
+
+  void ServiceBoundObject::scheduleMessage(const qi::Message &msg, MessageSocketPtr socket,
+                                           const ReplySink& sink, bool cancelable)
+  {
+    if (_scheduler && msg.type() == Message::Type_Cancel && msg.object() == _objectId)
+    {
+      // A call still waiting is dropped, the others are canceled as usual.
+      try
+      {
+        const unsigned int origMsgId = msg.value("I", socket).to<unsigned int>();
+        if (_scheduler->cancel(socket, origMsgId))
+          return;
+      }
+      catch (const std::exception&)
+      {
+        // Reported by dispatchMessage.
+      }
+    }
+    // The special functions (metaObject, events...) are never delayed.
+    if (!_scheduler || msg.type() != Message::Type_Call || msg.object() != _objectId
+        || msg.function() < Manageable::startId)
+    {
+      dispatchMessage(msg, socket, sink, cancelable);
+      return;
+    }
+    _scheduler->schedule(msg, socket, sink, [this, msg, socket, cancelable](const ReplySink& trackedSink) {
+      dispatchMessage(msg, socket, trackedSink, cancelable);
+    });
+  }
+
+  void ServiceBoundObject::dispatchMessage(const qi::Message &msg, MessageSocketPtr socket,
+                                           const ReplySink& sink, bool cancelable) {
     try {
       if (msg.version() > Message::Header::currentVersion())
       {
@@ -236,7 +683,8 @@ namespace qi {
         ss << "Cannot negotiate QiMessaging connection: "
            << "remote end doesn't support binary protocol v" << msg.version();
         serverResultAdapter(qi::makeFutureError<AnyReference>(ss.str()), Signature(),
-                            _gethost(), socket, msg.address(), Signature(), CancelableKitWeak());
+                            _gethost(), socket, msg.address(), Signature(), CancelableKitWeak(),
+                            AtomicIntPtr(), sink);
         return;
       }
 
@@ -375,10 +823,14 @@ namespace qi {
         qi::Signature sig = returnSignature.empty() ? Signature() : Signature(returnSignature);
         qi::Future<AnyReference> fut = obj.metaCall(funcId, mfp, callType, sig);
         AtomicIntPtr cancelRequested = boost::make_shared<Atomic<int> >(0);
+        // The calls of a batch share its message id and cannot be canceled.
+        CancelableKitWeak kit;
+        if (cancelable)
         {
           qiLogDebug() << this << " Registering future for " << socket.get() << ", message:" << msg.id();
           boost::mutex::scoped_lock futlock(_cancelables->guard);
           _cancelables->map[socket][msg.id()] = std::make_pair(fut, cancelRequested);
+          kit = _cancelables;
         }
         Signature retSig;
         const MetaMethod* mm = obj.metaObject().method(funcId);
@@ -388,7 +840,7 @@ namespace qi {
 
         fut.connect(boost::bind<void>
                     (&ServiceBoundObject::serverResultAdapter, _1, retSig, _gethost(), socket, msg.address(), sig,
-                     CancelableKitWeak(_cancelables), cancelRequested));
+                     kit, cancelRequested, sink));
       }
         break;
       case Message::Type_Post: {
@@ -407,14 +859,14 @@ namespace qi {
         qi::Promise<AnyReference> prom;
         prom.setError(e.what());
         serverResultAdapter(prom.future(), Signature(), _gethost(), socket, msg.address(), Signature(),
-                            CancelableKitWeak(_cancelables));
+                            CancelableKitWeak(_cancelables), AtomicIntPtr(), sink);
       }
     } catch (...) {
       if (msg.type() == Message::Type_Call) {
         qi::Promise<AnyReference> prom;
         prom.setError("Unknown error catch");
         serverResultAdapter(prom.future(), Signature(), _gethost(), socket, msg.address(), Signature(),
-                            CancelableKitWeak(_cancelables));
+                            CancelableKitWeak(_cancelables), AtomicIntPtr(), sink);
       }
     }
   }
@@ -495,6 +947,8 @@ namespace qi {
     // Disconnect event links set for this client.
     if (_onSocketDisconnectedCallback)
       _onSocketDisconnectedCallback(client, error);
+    if (_scheduler)
+      _scheduler->removeSocket(client);
     {
       boost::mutex::scoped_lock lock(_cancelables->guard);
       _cancelables->map.erase(client);
@@ -504,7 +958,7 @@ namespace qi {
     {
       for (ServiceSignalLinks::iterator jt = it->second.begin(); jt != it->second.end(); ++jt)
       {
-        _object.disconnect(jt->second.localSignalLinkId.value()).async()
+        removeEventTarget(client, jt->second.event, jt->first)
             .then([](Future<void> f) { if (f.hasError()) qiLogError() << f.error(); });
       }
       _links.erase(it);
@@ -512,8 +966,35 @@ namespace qi {
     removeRemoteReferences(client);
   }
 
-  qi::BoundAnyObject makeServiceBoundAnyObject(unsigned int serviceId, qi::AnyObject object, qi::MetaCallType mct) {
+  void ServiceBoundObject::onSocketResumed(MessageSocketPtr previous, MessageSocketPtr socket)
+  {
+    // The calls of the previous socket cannot be replied to anymore, the
+    // client already reported them as failed.
+    if (_scheduler)
+      _scheduler->removeSocket(previous);
+    {
+      boost::mutex::scoped_lock lock(_cancelables->guard);
+      _cancelables->map.erase(previous);
+    }
+    BySocketServiceSignalLinks::iterator it = _links.find(previous);
+    if (it != _links.end())
+    {
+      {
+        boost::mutex::scoped_lock lock(_eventFanOutsMutex);
+        for (const auto& fanOut : _eventFanOuts)
+          fanOut.second->replaceSocket(previous, socket);
+      }
+      ServiceSignalLinks& links = _links[socket];
+      links.insert(it->second.begin(), it->second.end());
+      _links.erase(it);
+    }
+    resumeRemoteReferences(previous, socket);
+  }
+
+  qi::BoundAnyObject makeServiceBoundAnyObject(unsigned int serviceId, qi::AnyObject object, qi::MetaCallType mct,
+                                               const CallSchedulingConfig& callScheduling) {
     boost::shared_ptr<ServiceBoundObject> ret = boost::make_shared<ServiceBoundObject>(serviceId, Message::GenericObject_Main, object, mct); // TODO ju
+    ret->setCallScheduling(callScheduling);
     return ret;
   }
 
@@ -613,7 +1094,8 @@ namespace qi {
                                                    MessageSocketPtr socket,
                                                    const qi::MessageAddress& replyaddr,
                                                    const Signature& forcedReturnSignature,
-                                                   CancelableKitWeak kit)
+                                                   CancelableKitWeak kit,
+                                                   const ReplySink& sink)
   {
     QI_ASSERT_TRUE(val.isValid());
     _removeCachedFuture(kit, socket, replyaddr.messageId);
@@ -663,7 +1145,7 @@ namespace qi {
       ret.setType(qi::Message::Type_Error);
       ret.setError("Unknown error caught while forwarding the answer");
     }
-    if (!socket->send(std::move(ret)))
+    if (!CallScheduler::sendReply(socket, sink, std::move(ret)))
     {
       // TODO: if `convertAndSetValue` transfers ownership of `val` in the object host,
       // `val.destroy()` below won't be enough. Check if it's necessary to destroy
@@ -680,7 +1162,8 @@ namespace qi {
                                                const qi::MessageAddress& replyaddr,
                                                const Signature& forcedReturnSignature,
                                                CancelableKitWeak kit,
-                                               AtomicIntPtr cancelRequested)
+                                               AtomicIntPtr cancelRequested,
+                                               const ReplySink& sink)
   {
     if(!socket->isConnected())
     {
@@ -703,7 +1186,7 @@ namespace qi {
         if (ao)
         {
           boost::function<void()> cb = boost::bind(&ServiceBoundObject::serverResultAdapterNext, val, targetSignature,
-                                                   host, socket, replyaddr, forcedReturnSignature, kit);
+                                                   host, socket, replyaddr, forcedReturnSignature, kit, sink);
           if (ao->call<bool>("isValid"))
           {
             ao->call<void>("_connect", cb);
@@ -752,7 +1235,7 @@ namespace qi {
       }
     }
     _removeCachedFuture(kit, socket, replyaddr.messageId);
-    if (!socket->send(std::move(ret)))
+    if (!CallScheduler::sendReply(socket, sink, std::move(ret)))
     {
       // TODO: Check if `val` must be destroyed here. Take into account the potential
       // transfer ownership to the object host.
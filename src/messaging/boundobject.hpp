@@ -18,6 +18,7 @@
 #include <qi/strand.hpp>
 
 #include "objecthost.hpp"
+#include "callscheduler.hpp"
 
 using AtomicBoolptr = boost::shared_ptr<qi::Atomic<bool>>;
 using AtomicIntPtr = boost::shared_ptr<qi::Atomic<int>>;
@@ -51,6 +52,9 @@ namespace qi {
     virtual ~BoundObject() {}
     virtual void onMessage(const qi::Message &msg, MessageSocketPtr socket) = 0;
     virtual void onSocketDisconnected(qi::MessageSocketPtr socket, std::string error) = 0;
+    /// The client of `previous` resumed its session on `socket`, which takes
+    /// over the state kept for `previous`.
+    virtual void onSocketResumed(qi::MessageSocketPtr previous, qi::MessageSocketPtr socket) = 0;
   };
 
   //Bound Object, represent an object bound on a server
@@ -92,6 +96,9 @@ namespace qi {
     qi::Future<SignalLink> registerEventWithSignature(unsigned int serviceId, unsigned int eventId, SignalLink linkId, const std::string& signature);
     qi::Future<void> unregisterEvent(unsigned int serviceId, unsigned int eventId, SignalLink linkId);
     qi::MetaObject metaObject(unsigned int serviceId);
+    /// Content hash of the MetaObject, and the MetaObject without its
+    /// descriptions, or an empty one if the caller already has this hash.
+    std::pair<qi::uint64_t, qi::MetaObject> metaObjectIndex(unsigned int serviceId, qi::uint64_t knownHash);
     void           terminate(unsigned int serviceId); //bound only in special cases
     qi::Future<AnyValue> property(const AnyValue& name);
     Future<void>   setProperty(const AnyValue& name, AnyValue value);
@@ -119,6 +126,11 @@ namespace qi {
     //BoundObject Interface
     virtual void onMessage(const qi::Message &msg, MessageSocketPtr socket);
     virtual void onSocketDisconnected(qi::MessageSocketPtr socket, std::string error);
+    virtual void onSocketResumed(qi::MessageSocketPtr previous, qi::MessageSocketPtr socket);
+
+    /// Limits the calls of the clients to the methods of the object.
+    void setCallScheduling(const CallSchedulingConfig& config);
+    CallSchedulingStats callSchedulingStats() const;
 
     using MessageId = unsigned int;
     void cancelCall(MessageSocketPtr origSocket, const Message& cancelMessage, MessageId origMsgId);
@@ -135,15 +147,29 @@ namespace qi {
 
     inline boost::weak_ptr<ObjectHost> _gethost() { return _owner ? *_owner : weakPtr(); }
     static void _removeCachedFuture(CancelableKitWeak kit, MessageSocketPtr sock, MessageId id);
+
+    // Receives the reply to a call instead of the socket, for the calls of a
+    // Type_CallBatch message.
+    using ReplySink = CallScheduler::ReplySink;
+    void dispatchMessage(const qi::Message &msg, MessageSocketPtr socket, const ReplySink& sink,
+                         bool cancelable);
+    // Dispatches the message, through the call scheduler if it is a call to
+    // a method of the object.
+    void scheduleMessage(const qi::Message &msg, MessageSocketPtr socket, const ReplySink& sink,
+                         bool cancelable);
+    void onCallBatch(const qi::Message &msg, MessageSocketPtr socket);
+
     static void serverResultAdapterNext(AnyReference val, Signature targetSignature,
                                         boost::weak_ptr<ObjectHost> host,
                                  MessageSocketPtr sock, const MessageAddress& replyAddr,
-                                 const Signature& forcedReturnSignature, CancelableKitWeak kit);
+                                 const Signature& forcedReturnSignature, CancelableKitWeak kit,
+                                 const ReplySink& sink);
     static void serverResultAdapter(Future<AnyReference> future, const Signature& targetSignature,
                                     boost::weak_ptr<ObjectHost> host,
                                     MessageSocketPtr sock, const MessageAddress& replyAddr,
                                     const Signature& forcedReturnSignature, CancelableKitWeak kit,
-                                    AtomicIntPtr cancelRequested = AtomicIntPtr());
+                                    AtomicIntPtr cancelRequested = AtomicIntPtr(),
+                                    const ReplySink& sink = ReplySink());
 
   private:
     // remote link id -> local link id
@@ -153,7 +179,19 @@ namespace qi {
     //Event handling (no lock needed)
     BySocketServiceSignalLinks  _links;
 
+    // event id -> remote subscribers of the event
+    class EventFanOut;
+    using EventFanOutPtr = boost::shared_ptr<EventFanOut>;
+    std::map<unsigned int, EventFanOutPtr> _eventFanOuts;
+    boost::mutex _eventFanOutsMutex;
+
+    // Removes a remote subscriber, and disconnects from the event if it was
+    // the last one.
+    Future<void> removeEventTarget(const MessageSocketPtr& socket, unsigned int eventId,
+                                   SignalLink remoteSignalLinkId);
+
     boost::mutex _callMutex;
+    boost::shared_ptr<CallScheduler> _scheduler;
   private:
     qi::MessageSocketPtr _currentSocket;
     unsigned int           _serviceId;
@@ -174,7 +212,12 @@ namespace qi {
 
   using BoundAnyObject = boost::shared_ptr<BoundObject>;
 
-  qi::BoundAnyObject makeServiceBoundAnyObject(unsigned int serviceId, qi::AnyObject object, qi::MetaCallType mct = qi::MetaCallType_Auto);
+  /// True if a value of this signature may hold object references.
+  bool mayContainObjects(const Signature& sig);
+
+  qi::BoundAnyObject makeServiceBoundAnyObject(unsigned int serviceId, qi::AnyObject object,
+                                               qi::MetaCallType mct = qi::MetaCallType_Auto,
+                                               const CallSchedulingConfig& callScheduling = {});
 
 }
 
@@ -0,0 +1,262 @@
+/*
+**  Copyright (C) 2018 SoftBank Robotics Europe
+**  See COPYING for the license
+*/
+
+#include "callscheduler.hpp"
+
+#include <algorithm>
+#include <vector>
+
+#include <qi/eventloop.hpp>
+#include <qi/log.hpp>
+
+qiLogCategory("qimessaging.callscheduler");
+
+namespace qi
+{
+  char const * const serviceOverloadedError = "Service overloaded";
+
+  CallScheduler::CallScheduler(CallSchedulingConfig config, RunQueued runQueued)
+    : _config(std::move(config))
+    , _runQueued(std::move(runQueued))
+  {
+  }
+
+  bool CallScheduler::sendReply(const MessageSocketPtr& socket, const ReplySink& sink, Message reply)
+  {
+    return sink ? sink(std::move(reply)) : socket->send(std::move(reply));
+  }
+
+  CallScheduler::ReplySink CallScheduler::trackedSink(MessageSocketPtr socket, ReplySink sink)
+  {
+    boost::weak_ptr<CallScheduler> weakSelf = shared_from_this();
+    return [weakSelf, socket, sink](Message reply) {
+      const bool sent = sendReply(socket, sink, std::move(reply));
+      if (auto self = weakSelf.lock())
+        self->onCallDone(socket);
+      return sent;
+    };
+  }
+
+  unsigned int CallScheduler::weightOf(const MessageSocketPtr& socket) const
+  {
+    if (!_config.clientWeight)
+      return 1;
+    const auto endpoint = socket->remoteEndpoint();
+    return endpoint ? std::max(1u, _config.clientWeight(*endpoint)) : 1;
+  }
+
+  CallScheduler::Client& CallScheduler::clientUnsync(const MessageSocketPtr& socket, unsigned int weight)
+  {
+    auto it = _clients.find(socket);
+    if (it != _clients.end())
+      return it->second;
+    Client& client = _clients[socket];
+    client.weight = weight;
+    ++_stats.clients;
+    return client;
+  }
+
+  void CallScheduler::removeIfIdleUnsync(std::map<MessageSocketPtr, Client>::iterator it)
+  {
+    if (it->second.inFlight == 0 && it->second.waiting.empty())
+    {
+      _clients.erase(it);
+      --_stats.clients;
+    }
+  }
+
+  bool CallScheduler::canStartUnsync(const Client& client) const
+  {
+    return !_config.maxInFlightCallsPerClient || client.inFlight < _config.maxInFlightCallsPerClient;
+  }
+
+  void CallScheduler::schedule(const Message& msg, MessageSocketPtr socket, ReplySink sink, Start start)
+  {
+    // The weight is given by user code, which must not run under the lock.
+    unsigned int weight = 1;
+    if (_config.clientWeight)
+    {
+      boost::mutex::scoped_lock lock(_mutex);
+      const bool known = _clients.count(socket) != 0;
+      lock.unlock();
+      if (!known)
+        weight = weightOf(socket);
+    }
+
+    {
+      boost::mutex::scoped_lock lock(_mutex);
+      Client& client = clientUnsync(socket, weight);
+      const bool serviceFull = _config.maxInFlightCalls && _stats.inFlight >= _config.maxInFlightCalls;
+      if (client.waiting.empty() && canStartUnsync(client) && !serviceFull)
+      {
+        ++client.inFlight;
+        ++_stats.inFlight;
+        ++_stats.started;
+      }
+      else if ((_config.maxQueuedCallsPerClient && client.waiting.size() >= _config.maxQueuedCallsPerClient)
+               || (_config.maxQueuedCalls && _stats.waiting >= _config.maxQueuedCalls))
+      {
+        ++_stats.rejected;
+        removeIfIdleUnsync(_clients.find(socket));
+        lock.unlock();
+        qiLogVerbose() << "Rejecting call " << msg.address() << ": too many calls waiting";
+        Message error(Message::Type_Error, msg.address());
+        error.setError(std::string(serviceOverloadedError) + ": too many calls waiting, try again later");
+        sendReply(socket, sink, std::move(error));
+        return;
+      }
+      else
+      {
+        if (client.waiting.empty())
+          _turns.push_back(socket);
+        client.waiting.push_back(Waiting{std::move(start), std::move(sink), qi::SteadyClock::now(),
+                                         msg.address()});
+        ++_stats.waiting;
+        ++_stats.delayed;
+        return;
+      }
+    }
+    start(trackedSink(socket, std::move(sink)));
+  }
+
+  bool CallScheduler::cancel(const MessageSocketPtr& socket, unsigned int messageId)
+  {
+    Waiting canceled;
+    {
+      boost::mutex::scoped_lock lock(_mutex);
+      auto it = _clients.find(socket);
+      if (it == _clients.end())
+        return false;
+      auto& waiting = it->second.waiting;
+      const auto call = std::find_if(waiting.begin(), waiting.end(), [&](const Waiting& w) {
+        return w.address.messageId == messageId;
+      });
+      if (call == waiting.end())
+        return false;
+      canceled = std::move(*call);
+      waiting.erase(call);
+      --_stats.waiting;
+      if (waiting.empty())
+      {
+        it->second.credit = 0;
+        _turns.erase(std::remove(_turns.begin(), _turns.end(), socket), _turns.end());
+        removeIfIdleUnsync(it);
+      }
+    }
+    qiLogDebug() << "Canceled waiting call " << canceled.address;
+    sendReply(socket, canceled.sink, Message(Message::Type_Canceled, canceled.address));
+    return true;
+  }
+
+  boost::optional<CallScheduler::Ready> CallScheduler::nextUnsync()
+  {
+    if (_config.maxInFlightCalls && _stats.inFlight >= _config.maxInFlightCalls)
+      return {};
+    // Weighted round robin: the client at the front keeps its turn for up to
+    // `weight` calls, or until it reaches its own limit.
+    for (std::size_t tried = 0; tried < _turns.size(); ++tried)
+    {
+      const MessageSocketPtr socket = _turns.front();
+      Client& client = _clients[socket];
+      if (client.credit == 0)
+        client.credit = client.weight;
+      if (!canStartUnsync(client))
+      {
+        client.credit = 0;
+        _turns.pop_front();
+        _turns.push_back(socket);
+        continue;
+      }
+
+      Ready ready{socket, std::move(client.waiting.front())};
+      client.waiting.pop_front();
+      ++client.inFlight;
+      --client.credit;
+      if (client.waiting.empty())
+      {
+        client.credit = 0;
+        _turns.pop_front();
+      }
+      else if (client.credit == 0)
+      {
+        _turns.pop_front();
+        _turns.push_back(socket);
+      }
+
+      const auto delay = qi::SteadyClock::now() - ready.call.since;
+      --_stats.waiting;
+      ++_stats.inFlight;
+      ++_stats.started;
+      _stats.totalQueueDelay += delay;
+      _stats.maxQueueDelay = std::max<qi::Duration>(_stats.maxQueueDelay, delay);
+      return ready;
+    }
+    return {};
+  }
+
+  std::vector<CallScheduler::Ready> CallScheduler::allReadyUnsync()
+  {
+    std::vector<Ready> ready;
+    while (auto next = nextUnsync())
+      ready.push_back(std::move(*next));
+    return ready;
+  }
+
+  void CallScheduler::startQueued(std::vector<Ready> ready)
+  {
+    // This may be called while the previous call is being started, so the
+    // next ones are started from the event loop.
+    for (auto& next : ready)
+    {
+      const auto runQueued = _runQueued;
+      const auto start = std::move(next.call.start);
+      const auto sink = trackedSink(next.socket, std::move(next.call.sink));
+      qi::getEventLoop()->post([runQueued, start, sink] {
+        runQueued([&] { start(sink); });
+      });
+    }
+  }
+
+  void CallScheduler::onCallDone(const MessageSocketPtr& socket)
+  {
+    std::vector<Ready> ready;
+    {
+      boost::mutex::scoped_lock lock(_mutex);
+      auto it = _clients.find(socket);
+      // The client has been removed while its call was in progress.
+      if (it == _clients.end())
+        return;
+      --it->second.inFlight;
+      --_stats.inFlight;
+      ready = allReadyUnsync();
+      removeIfIdleUnsync(it);
+    }
+    startQueued(std::move(ready));
+  }
+
+  void CallScheduler::removeSocket(const MessageSocketPtr& socket)
+  {
+    std::vector<Ready> ready;
+    {
+      boost::mutex::scoped_lock lock(_mutex);
+      auto it = _clients.find(socket);
+      if (it == _clients.end())
+        return;
+      _stats.waiting -= it->second.waiting.size();
+      _stats.inFlight -= it->second.inFlight;
+      _clients.erase(it);
+      --_stats.clients;
+      _turns.erase(std::remove(_turns.begin(), _turns.end(), socket), _turns.end());
+      ready = allReadyUnsync();
+    }
+    startQueued(std::move(ready));
+  }
+
+  CallSchedulingStats CallScheduler::stats() const
+  {
+    boost::mutex::scoped_lock lock(_mutex);
+    return _stats;
+  }
+}
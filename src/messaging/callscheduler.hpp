@@ -0,0 +1,115 @@
+#pragma once
+/*
+**  Copyright (C) 2018 SoftBank Robotics Europe
+**  See COPYING for the license
+*/
+
+#ifndef _SRC_CALLSCHEDULER_HPP_
+#define _SRC_CALLSCHEDULER_HPP_
+
+#include <deque>
+#include <map>
+#include <vector>
+
+#include <boost/enable_shared_from_this.hpp>
+#include <boost/function.hpp>
+#include <boost/optional.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include <qi/clock.hpp>
+#include <qi/messaging/callscheduling.hpp>
+
+#include "message.hpp"
+#include "messagesocket.hpp"
+
+namespace qi
+{
+  /**
+   * @brief Applies a CallSchedulingConfig to the calls of a service.
+   * @internal
+   *
+   * A started call counts as in progress until its reply is sent, so that
+   * calls returning a future are accounted for until the future finishes.
+   */
+  class CallScheduler : public boost::enable_shared_from_this<CallScheduler>
+  {
+  public:
+    /// Receives the reply of a call instead of the socket when set.
+    using ReplySink = boost::function<bool (Message)>;
+    /// Starts a call, its reply must be given to `sink`.
+    using Start = boost::function<void (ReplySink sink)>;
+    /// Runs the start of a call which had to wait.
+    using RunQueued = boost::function<void (const boost::function<void ()>& start)>;
+
+    /**
+     * @param runQueued called from the event loop to start the calls which had
+     * to wait.
+     */
+    CallScheduler(CallSchedulingConfig config, RunQueued runQueued);
+
+    /// Gives `reply` to `sink`, or sends it to `socket` if the sink is not set.
+    static bool sendReply(const MessageSocketPtr& socket, const ReplySink& sink, Message reply);
+
+    /// Starts the call of `msg` at once, makes it wait, or rejects it with a
+    /// serviceOverloadedError reply sent to `sink`, or to `socket` if the sink
+    /// is not set.
+    void schedule(const Message& msg, MessageSocketPtr socket, ReplySink sink, Start start);
+
+    /// Drops the call `messageId` of `socket` if it is waiting, and replies to
+    /// it with a Type_Canceled message.
+    /// @return whether the call was waiting.
+    bool cancel(const MessageSocketPtr& socket, unsigned int messageId);
+
+    /// Forgets the calls of a disconnected client, the replies of its calls
+    /// in progress are not expected anymore.
+    void removeSocket(const MessageSocketPtr& socket);
+
+    CallSchedulingStats stats() const;
+
+  private:
+    struct Waiting
+    {
+      Start start;
+      ReplySink sink;
+      qi::SteadyClock::time_point since;
+      MessageAddress address;
+    };
+
+    struct Client
+    {
+      std::deque<Waiting> waiting;
+      std::size_t inFlight = 0;
+      unsigned int weight = 1;
+      // Calls the client may still start before giving its turn.
+      unsigned int credit = 0;
+    };
+
+    struct Ready
+    {
+      MessageSocketPtr socket;
+      Waiting call;
+    };
+
+    ReplySink trackedSink(MessageSocketPtr socket, ReplySink sink);
+    void onCallDone(const MessageSocketPtr& socket);
+    void startQueued(std::vector<Ready> ready);
+
+    unsigned int weightOf(const MessageSocketPtr& socket) const;
+    Client& clientUnsync(const MessageSocketPtr& socket, unsigned int weight);
+    void removeIfIdleUnsync(std::map<MessageSocketPtr, Client>::iterator it);
+    bool canStartUnsync(const Client& client) const;
+    boost::optional<Ready> nextUnsync();
+    std::vector<Ready> allReadyUnsync();
+
+    const CallSchedulingConfig _config;
+    const RunQueued _runQueued;
+
+    mutable boost::mutex _mutex;
+    std::map<MessageSocketPtr, Client> _clients;
+    // Clients having calls waiting, in the order they are served.
+    std::deque<MessageSocketPtr> _turns;
+    CallSchedulingStats _stats;
+  };
+}
+
+#endif  // _SRC_CALLSCHEDULER_HPP_
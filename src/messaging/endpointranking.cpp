@@ -0,0 +1,145 @@
+/*
+**  Copyright (C) 2018 SoftBank Robotics Europe
+**  See COPYING for the license
+*/
+
+#include <algorithm>
+#include <tuple>
+
+#include <boost/algorithm/string/predicate.hpp>
+
+#include <qi/os.hpp>
+
+#include "endpointranking.hpp"
+
+namespace qi
+{
+  const qi::Duration EndpointRanking::defaultAttemptDelay = qi::MilliSeconds(250);
+  const qi::Duration EndpointRanking::minAttemptDelay = qi::MilliSeconds(10);
+  const qi::Duration EndpointRanking::minBackoff = qi::Seconds(1);
+  const qi::Duration EndpointRanking::maxBackoff = qi::Minutes(1);
+
+  namespace
+  {
+    const qi::Duration localAddressesLifetime = qi::Seconds(10);
+
+    // The IPv4 prefix of `host` up to its last byte, empty if it is not an
+    // IPv4 address.
+    std::string subnetPrefix(const std::string& host)
+    {
+      if (std::count(host.begin(), host.end(), '.') != 3
+          || host.find_first_not_of("0123456789.") != std::string::npos)
+        return {};
+      return host.substr(0, host.rfind('.') + 1);
+    }
+  }
+
+  EndpointRanking::Locality EndpointRanking::locality(const std::string& host,
+                                                      const std::vector<std::string>& localAddresses)
+  {
+    if (boost::algorithm::starts_with(host, "127.") || host == "localhost" || host == "::1"
+        || std::find(localAddresses.begin(), localAddresses.end(), host) != localAddresses.end())
+      return Locality_Machine;
+    if (boost::algorithm::starts_with(host, "169.254.") || boost::algorithm::istarts_with(host, "fe80:"))
+      return Locality_Subnet;
+    const std::string prefix = subnetPrefix(host);
+    if (!prefix.empty())
+    {
+      for (const auto& address : localAddresses)
+        if (subnetPrefix(address) == prefix)
+          return Locality_Subnet;
+    }
+    return Locality_Remote;
+  }
+
+  const std::vector<std::string>& EndpointRanking::localAddressesUnsync()
+  {
+    const auto now = qi::SteadyClock::now();
+    if (now >= _localAddressesExpiry)
+    {
+      _localAddresses.clear();
+      for (const auto& addresses : os::hostIPAddrs())
+        _localAddresses.insert(_localAddresses.end(), addresses.second.begin(), addresses.second.end());
+      _localAddressesExpiry = now + localAddressesLifetime;
+    }
+    return _localAddresses;
+  }
+
+  const EndpointRanking::Endpoint* EndpointRanking::findUnsync(const std::string& machineId,
+                                                               const Url& url) const
+  {
+    const auto machineIt = _machines.find(machineId);
+    if (machineIt == _machines.end())
+      return nullptr;
+    const auto it = machineIt->second.find(url);
+    return it == machineIt->second.end() ? nullptr : &it->second;
+  }
+
+  UrlVector EndpointRanking::rank(const std::string& machineId, UrlVector urls)
+  {
+    // Lower is better. Unknown connection times sort after the known ones.
+    using Key = std::tuple<bool, int, bool, qi::Duration, std::size_t>;
+    std::vector<std::pair<Key, Url>> ranked;
+    ranked.reserve(urls.size());
+    {
+      boost::mutex::scoped_lock lock(_mutex);
+      const auto& localAddresses = localAddressesUnsync();
+      const auto now = qi::SteadyClock::now();
+      for (std::size_t i = 0; i < urls.size(); ++i)
+      {
+        const Endpoint* endpoint = findUnsync(machineId, urls[i]);
+        const bool backingOff = endpoint && endpoint->retryAfter > now;
+        const bool unknownTime = !endpoint || !endpoint->connectionTime;
+        const auto time = unknownTime ? qi::Duration::zero() : *endpoint->connectionTime;
+        ranked.emplace_back(Key(backingOff, locality(urls[i].host(), localAddresses), unknownTime, time, i),
+                            std::move(urls[i]));
+      }
+    }
+    std::sort(ranked.begin(), ranked.end(),
+              [](const std::pair<Key, Url>& a, const std::pair<Key, Url>& b) { return a.first < b.first; });
+    urls.clear();
+    for (auto& pair : ranked)
+      urls.push_back(std::move(pair.second));
+    return urls;
+  }
+
+  qi::Duration EndpointRanking::attemptDelay(const std::string& machineId, const Url& url) const
+  {
+    boost::mutex::scoped_lock lock(_mutex);
+    const Endpoint* endpoint = findUnsync(machineId, url);
+    if (!endpoint || !endpoint->connectionTime)
+      return defaultAttemptDelay;
+    return std::min(defaultAttemptDelay, std::max(minAttemptDelay, 2 * *endpoint->connectionTime));
+  }
+
+  void EndpointRanking::connected(const std::string& machineId, const Url& url, qi::Duration elapsed)
+  {
+    boost::mutex::scoped_lock lock(_mutex);
+    Endpoint& endpoint = _machines[machineId][url];
+    // Smoothed as TCP does for round-trip times.
+    endpoint.connectionTime = endpoint.connectionTime ? (7 * *endpoint.connectionTime + elapsed) / 8 : elapsed;
+    endpoint.failures = 0;
+    endpoint.retryAfter = qi::SteadyClock::time_point();
+  }
+
+  void EndpointRanking::failed(const std::string& machineId, const Url& url)
+  {
+    boost::mutex::scoped_lock lock(_mutex);
+    Endpoint& endpoint = _machines[machineId][url];
+    qi::Duration backoff = minBackoff;
+    for (unsigned int i = 0; i < endpoint.failures && backoff < maxBackoff; ++i)
+      backoff *= 2;
+    ++endpoint.failures;
+    endpoint.retryAfter = qi::SteadyClock::now() + std::min(backoff, maxBackoff);
+  }
+
+  boost::optional<qi::Duration> EndpointRanking::connectionTime(const std::string& machineId,
+                                                                const Url& url) const
+  {
+    boost::mutex::scoped_lock lock(_mutex);
+    const Endpoint* endpoint = findUnsync(machineId, url);
+    if (!endpoint)
+      return {};
+    return endpoint->connectionTime;
+  }
+}
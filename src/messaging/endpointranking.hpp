@@ -0,0 +1,89 @@
+#pragma once
+/*
+**  Copyright (C) 2018 SoftBank Robotics Europe
+**  See COPYING for the license
+*/
+
+#ifndef _SRC_ENDPOINTRANKING_HPP_
+#define _SRC_ENDPOINTRANKING_HPP_
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <boost/optional.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include <qi/clock.hpp>
+#include <qi/url.hpp>
+
+namespace qi
+{
+  /**
+   * @brief Preference between the endpoints of the machines a session
+   * connects to.
+   * @internal
+   *
+   * Endpoints are ranked by:
+   * - whether they failed recently: an endpoint which failed is tried last
+   *   until its backoff, doubled on each consecutive failure, has elapsed;
+   * - locality: loopback and addresses of this machine, then addresses
+   *   sharing a /24 prefix with this machine or link-local ones, then the
+   *   others;
+   * - connection time: the smoothed duration of the previous connections,
+   *   the endpoints which never connected coming last;
+   * - the order given by the service.
+   *
+   * The ranking of each machine is kept for the lifetime of the session, so
+   * that it survives the sockets.
+   */
+  class EndpointRanking
+  {
+  public:
+    enum Locality
+    {
+      Locality_Machine = 0,
+      Locality_Subnet = 1,
+      Locality_Remote = 2,
+    };
+
+    /// Returns `urls` from the most to the least preferred.
+    UrlVector rank(const std::string& machineId, UrlVector urls);
+
+    /// Delay after which the next endpoint is tried if the connection to
+    /// `url` is not established yet.
+    qi::Duration attemptDelay(const std::string& machineId, const Url& url) const;
+
+    void connected(const std::string& machineId, const Url& url, qi::Duration elapsed);
+    void failed(const std::string& machineId, const Url& url);
+
+    /// Smoothed connection time of `url`, if it ever connected.
+    boost::optional<qi::Duration> connectionTime(const std::string& machineId, const Url& url) const;
+
+    /// `localAddresses` are the IP addresses of this machine.
+    static Locality locality(const std::string& host, const std::vector<std::string>& localAddresses);
+
+    static const qi::Duration defaultAttemptDelay;
+    static const qi::Duration minAttemptDelay;
+    static const qi::Duration minBackoff;
+    static const qi::Duration maxBackoff;
+
+  private:
+    struct Endpoint
+    {
+      boost::optional<qi::Duration> connectionTime;
+      unsigned int failures = 0;
+      qi::SteadyClock::time_point retryAfter;
+    };
+
+    const Endpoint* findUnsync(const std::string& machineId, const Url& url) const;
+    const std::vector<std::string>& localAddressesUnsync();
+
+    mutable boost::mutex _mutex;
+    std::map<std::string, std::map<Url, Endpoint>> _machines;
+    std::vector<std::string> _localAddresses;
+    qi::SteadyClock::time_point _localAddressesExpiry;
+  };
+}
+
+#endif  // _SRC_ENDPOINTRANKING_HPP_
@@ -59,6 +59,11 @@ qi::Future<void> Gateway::attachToServiceDirectory(const Url& serviceDirectoryUr
   return _proxy.attachToServiceDirectory(serviceDirectoryUrl);
 }
 
+Future<Gateway::ForwardingMode> Gateway::setForwardingMode(ForwardingMode mode)
+{
+  return _proxy.setForwardingMode(mode);
+}
+
 void Gateway::close()
 {
   _proxy.close();
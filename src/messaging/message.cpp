@@ -55,6 +55,12 @@ namespace qi
       return "Cancel";
     case Type_Canceled:
       return "Canceled";
+    case Type_CallBatch:
+      return "CallBatch";
+    case Type_BatchReply:
+      return "BatchReply";
+    case Type_Chunk:
+      return "Chunk";
     default:
       return "Unknown";
     }
@@ -80,6 +86,8 @@ namespace qi
       return "Properties";
     case BoundObjectFunction_RegisterEventWithSignature:
       return "RegisterEventWithSignature";
+    case BoundObjectFunction_MetaObjectIndex:
+      return "MetaObjectIndex";
     }
 
     if (service != qi::Message::Service_ServiceDirectory)
@@ -282,7 +290,7 @@ namespace qi
       qiLogError() <<"fromBuffer: unknown type " << signature.toString();
       throw std::runtime_error("Could not construct type for " + signature.toString());
     }
-    qi::BufferReader br(_buffer);
+    qi::BufferReader br(buffer());
     AnyReference res(type);
     return AnyValue(
       decodeBinary(&br, res, boost::bind(deserializeObject, _1, socket), socket.get()),
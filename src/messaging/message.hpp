@@ -8,6 +8,7 @@
 #ifndef _SRC_MESSAGE_HPP_
 #define _SRC_MESSAGE_HPP_
 
+#include <vector>
 #include <qi/api.hpp>
 #include <qi/anyvalue.hpp>
 #include <qi/anyobject.hpp>
@@ -19,6 +20,8 @@
 #include <qi/assert.hpp>
 #include <ka/scoped.hpp>
 #include <boost/weak_ptr.hpp>
+#include <boost/make_shared.hpp>
+#include <boost/shared_ptr.hpp>
 
 namespace qi {
 
@@ -113,6 +116,7 @@ namespace qi {
       BoundObjectFunction_SetProperty       = 6,
       BoundObjectFunction_Properties        = 7,
       BoundObjectFunction_RegisterEventWithSignature = 8,
+      BoundObjectFunction_MetaObjectIndex   = 9,
     };
 
     enum ServerFunction
@@ -152,6 +156,13 @@ namespace qi {
       Type_Cancel = 7,
       // Method call was cancelled
       Type_Canceled = 8,
+      // Several method calls, Client->Server (wait for a Type_BatchReply or Type_Error)
+      Type_CallBatch = 9,
+      // Results of the calls of a Type_CallBatch, Server->Client
+      Type_BatchReply = 10,
+      // Part of a larger message, Server<->Client. Its payload is the header of
+      // the larger message followed by the next part of its payload.
+      Type_Chunk = 11,
     };
     // If flag set, payload is of type m instead of expected type
     static const unsigned int TypeFlag_DynamicPayload = 1;
@@ -162,6 +173,12 @@ namespace qi {
      * NOT IMPLEMENTED
      */
     static const unsigned int TypeFlag_ReturnType = 2;
+    /* Priority of the message, only sent to the remote ends supporting the
+     * priorities. See priority().
+     */
+    static const unsigned int TypeFlag_LowPriority = 4;
+    static const unsigned int TypeFlag_HighPriority = 8;
+    static const unsigned int TypeFlags_Priority = TypeFlag_LowPriority | TypeFlag_HighPriority;
 
     QI_API static const char* typeToString(Type t);
     QI_API static const char* actionToString(unsigned int action, unsigned int service);
@@ -227,6 +244,38 @@ namespace qi {
       return _header.flags;
     }
 
+    /// The priority is not part of the header: the socket sets the priority
+    /// flags when it sends the message, and replaces them by the priority when
+    /// it receives it.
+    void setPriority(MessagePriority priority)
+    {
+      _priority = priority;
+    }
+
+    MessagePriority priority() const
+    {
+      return _priority;
+    }
+
+    static qi::uint8_t priorityFlags(MessagePriority priority)
+    {
+      switch (priority)
+      {
+      case MessagePriority_Low:  return TypeFlag_LowPriority;
+      case MessagePriority_High: return TypeFlag_HighPriority;
+      default:                   return 0;
+      }
+    }
+
+    static MessagePriority priorityOfFlags(qi::uint8_t flags)
+    {
+      if (flags & TypeFlag_HighPriority)
+        return MessagePriority_High;
+      if (flags & TypeFlag_LowPriority)
+        return MessagePriority_Low;
+      return MessagePriority_Normal;
+    }
+
     void setService(qi::uint32_t service)
     {
       _header.service = service;
@@ -262,33 +311,89 @@ namespace qi {
 
     void setBuffer(const Buffer &buffer)
     {
+      _sharedBuffer.reset();
       _buffer = buffer;
       _header.size = static_cast<qi::uint32_t>(_buffer.totalSize());
     }
 
     void setBuffer(Buffer&& buffer)
     {
+      _sharedBuffer.reset();
       _buffer = std::move(buffer);
       _header.size = static_cast<qi::uint32_t>(_buffer.totalSize());
     }
 
+    /// Use `buffer` as payload without copying it, so that several messages
+    /// (for instance an event sent to several sockets) share the same
+    /// encoded data. The buffer must not be modified afterwards.
+    void setSharedBuffer(boost::shared_ptr<const Buffer> buffer)
+    {
+      QI_ASSERT(buffer);
+      _buffer.clear();
+      _sharedBuffer = std::move(buffer);
+      _header.size = static_cast<qi::uint32_t>(_sharedBuffer->totalSize());
+    }
+
     const Buffer& buffer() const
     {
-      return _buffer;
+      return _sharedBuffer ? *_sharedBuffer : _buffer;
+    }
+
+    /// Returns the payload, to be given to setSharedBuffer, without copying
+    /// it: a payload not shared yet is moved to a shared buffer first, which
+    /// leaves the value of the message unchanged.
+    boost::shared_ptr<const Buffer> sharedBuffer()
+    {
+      if (!_sharedBuffer)
+      {
+        _sharedBuffer = boost::make_shared<const Buffer>(std::move(_buffer));
+        _buffer.clear();
+      }
+      return _sharedBuffer;
     }
 
     Buffer extractBuffer()
     {
+      if (_sharedBuffer)
+      {
+        Buffer extracted = *_sharedBuffer;
+        _sharedBuffer.reset();
+        return extracted;
+      }
       Buffer extracted = std::move(_buffer);
       _buffer.clear();
       return extracted;
     }
 
+    /// Returns the memory where to receive a payload of `size` bytes, after
+    /// the current payload.
+    void* reservePayload(std::size_t size)
+    {
+      _sharedBuffer.reset();
+      void* ptr = _buffer.reserve(size);
+      _header.size = static_cast<qi::uint32_t>(_buffer.totalSize());
+      return ptr;
+    }
+
+    /// Empties the payload to receive another message in this one, keeping
+    /// the memory of the buffer unless the payload was larger than
+    /// `maxKeptPayload`.
+    void recycle(std::size_t maxKeptPayload)
+    {
+      _sharedBuffer.reset();
+      if (_buffer.size() > maxKeptPayload)
+        _buffer = Buffer();
+      else
+        _buffer.clear();
+      _header.size = 0;
+    }
+
     void setError(const std::string &error)
     {
       QI_ASSERT(type() == Type_Error && "called setError on a non Type_Error message");
 
       // Clear the buffer before setting an error.
+      _sharedBuffer.reset();
       _buffer.clear();
       _header.size = static_cast<qi::uint32_t>(_buffer.totalSize());
 
@@ -331,24 +436,45 @@ namespace qi {
 
     bool operator==(const Message& b) const
     {
-      return _header == b._header && signature == b.signature && _buffer == b._buffer;
+      return _header == b._header && signature == b.signature && buffer() == b.buffer();
     }
 
   private:
     Buffer _buffer;
+    // When set, replaces `_buffer` as payload.
+    boost::shared_ptr<const Buffer> _sharedBuffer;
     std::string signature;
     Header _header;
+    MessagePriority _priority = MessagePriority_Normal;
 
     void encodeBinary(const qi::AutoAnyReference& ref,
                       SerializeObjectCallback onObject,
                       StreamContext* sctx)
     {
+      if (_sharedBuffer)
+      { // Appending to a shared payload requires our own copy.
+        _buffer = *_sharedBuffer;
+        _sharedBuffer.reset();
+      }
       auto updateHeaderSize =
           ka::scoped([&] { _header.size = static_cast<qi::uint32_t>(_buffer.totalSize()); });
       qi::encodeBinary(&_buffer, ref, onObject, sctx);
     }
   };
 
+  /** One call of a Message::Type_CallBatch, or one result of a
+    * Message::Type_BatchReply: the type, action, flags and payload that the
+    * equivalent Type_Call or reply message would have.
+    */
+  struct MessageBatchEntry
+  {
+    qi::uint32_t type;
+    qi::uint32_t action;
+    qi::uint32_t flags;
+    Buffer       payload;
+  };
+  using MessageBatch = std::vector<MessageBatchEntry>;
+
   inline std::ostream& operator<<(std::ostream& os, const qi::MessageAddress &address)
   {
     os << "{" << address.serviceId << "." << address.objectId << "." << address.functionId
@@ -360,5 +486,6 @@ namespace qi {
 }
 
 QI_TYPE_CONCRETE(qi::Message);
+QI_TYPE_STRUCT(qi::MessageBatchEntry, type, action, flags, payload);
 
 #endif  // _SRC_MESSAGE_HPP_
@@ -0,0 +1,183 @@
+/*
+**  Copyright (C) 2018 SoftBank Robotics Europe
+**  See COPYING for the license
+*/
+
+#include "messagechunk.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+
+#include <boost/lexical_cast.hpp>
+
+#include <qi/os.hpp>
+
+namespace qi
+{
+  std::size_t getMessageChunkSizeFromEnv(std::size_t defaultValue)
+  {
+    std::string l = os::getenv("QI_MESSAGE_CHUNK_SIZE");
+    return l.empty() ? defaultValue : boost::lexical_cast<std::size_t>(l);
+  }
+
+  namespace
+  {
+    // Calls `f(data, size)` on the parts of the payload in the order they are
+    // sent on the network, see sock::makeBuffers.
+    template<typename F>
+    void forEachPayloadPart(const Buffer& payload, F f)
+    {
+      std::size_t beginOffset = 0;
+      for (const auto& sub: payload.subBuffers())
+      {
+        const auto endOffset = sub.first + sizeof(Buffer::size_type);
+        f(static_cast<const char*>(payload.data()) + beginOffset, endOffset - beginOffset);
+        beginOffset = endOffset;
+        f(static_cast<const char*>(sub.second.data()), sub.second.size());
+      }
+      f(static_cast<const char*>(payload.data()) + beginOffset, payload.size() - beginOffset);
+    }
+  }
+
+  std::vector<Message> splitIntoChunks(const Message& msg, std::size_t chunkSize)
+  {
+    QI_ASSERT(chunkSize > 0);
+    std::vector<Message> chunks;
+    const Buffer& payload = msg.buffer();
+    if (payload.totalSize() <= chunkSize)
+      return chunks;
+
+    Message::Header header = msg.header();
+    header.size = static_cast<qi::uint32_t>(payload.totalSize());
+    chunks.reserve((header.size + chunkSize - 1) / chunkSize);
+
+    Buffer current;
+    std::size_t room = 0;
+    const auto flush = [&] {
+      Message chunk(Message::Type_Chunk, msg.address());
+      chunk.setPriority(msg.priority());
+      chunk.setBuffer(std::move(current));
+      chunks.push_back(std::move(chunk));
+      current = Buffer();
+    };
+    forEachPayloadPart(payload, [&](const char* data, std::size_t size) {
+      while (size != 0)
+      {
+        if (room == 0)
+        {
+          if (current.size() != 0)
+            flush();
+          current.reserve(sizeof(header) + chunkSize);
+          std::memcpy(current.data(), &header, sizeof(header));
+          room = chunkSize;
+        }
+        const auto part = std::min(size, room);
+        std::memcpy(static_cast<char*>(current.data()) + current.size() - room, data, part);
+        data += part;
+        size -= part;
+        room -= part;
+      }
+    });
+    // The last chunk is smaller than the others.
+    if (room != 0)
+    {
+      Buffer last;
+      last.write(current.data(), current.size() - room);
+      current = std::move(last);
+    }
+    flush();
+    return chunks;
+  }
+
+  MessageChunkAssembler::MessageChunkAssembler(std::size_t maxPayload, std::size_t maxPending)
+    : _maxPayload(maxPayload)
+    , _maxPending(maxPending)
+    , _buffered(0)
+  {
+  }
+
+  boost::optional<Message> MessageChunkAssembler::add(const Message& chunk)
+  {
+    QI_ASSERT(chunk.type() == Message::Type_Chunk);
+    const Buffer& payload = chunk.buffer();
+    Message::Header header;
+    if (payload.size() < sizeof(header))
+      throw std::runtime_error("chunk too small to contain a header");
+    std::memcpy(&header, payload.data(), sizeof(header));
+    if (header.magic != Message::Header::magicCookie)
+      throw std::runtime_error("chunk without the header of its message");
+    if (header.size > _maxPayload)
+    {
+      std::stringstream ss;
+      ss << "chunked message payload of size " << header.size
+         << " above maximum configured payload size " << _maxPayload;
+      throw std::runtime_error(ss.str());
+    }
+
+    const Key key{ header.type, MessageAddress(header.id, header.service, header.object, header.action) };
+    auto it = _partials.find(key);
+    if (it == _partials.end())
+    {
+      if (_partials.size() >= _maxPending)
+      {
+        std::stringstream ss;
+        ss << "more than " << _maxPending << " chunked messages pending";
+        throw std::runtime_error(ss.str());
+      }
+      // The payload grows as its chunks arrive, the size announced by the
+      // header is not trusted.
+      it = _partials.emplace(key, Partial{ header, Buffer() }).first;
+    }
+    Partial& partial = it->second;
+
+    const auto size = payload.size() - sizeof(header);
+    if (partial.payload.size() + size > partial.header.size)
+    {
+      drop(it);
+      throw std::runtime_error("chunks larger than their message");
+    }
+    if (_buffered + size > _maxPayload)
+    {
+      drop(it);
+      std::stringstream ss;
+      ss << "chunked messages pending above maximum configured payload size " << _maxPayload;
+      throw std::runtime_error(ss.str());
+    }
+    partial.payload.write(static_cast<const char*>(payload.data()) + sizeof(header), size);
+    _buffered += size;
+    if (partial.payload.size() < partial.header.size)
+      return {};
+
+    Message msg;
+    _buffered -= partial.payload.size();
+    msg.setBuffer(std::move(partial.payload));
+    msg.header() = partial.header;
+    msg.setPriority(chunk.priority());
+    _partials.erase(it);
+    return msg;
+  }
+
+  void MessageChunkAssembler::drop(std::map<Key, Partial>::iterator it)
+  {
+    _buffered -= it->second.payload.size();
+    _partials.erase(it);
+  }
+
+  void MessageChunkAssembler::clear()
+  {
+    _partials.clear();
+    _buffered = 0;
+  }
+
+  std::size_t MessageChunkAssembler::pending() const
+  {
+    return _partials.size();
+  }
+
+  std::size_t MessageChunkAssembler::buffered() const
+  {
+    return _buffered;
+  }
+}
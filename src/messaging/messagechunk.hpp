@@ -0,0 +1,83 @@
+#pragma once
+/*
+**  Copyright (C) 2018 SoftBank Robotics Europe
+**  See COPYING for the license
+*/
+
+#ifndef _SRC_MESSAGECHUNK_HPP_
+#define _SRC_MESSAGECHUNK_HPP_
+
+#include <cstddef>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include <boost/optional.hpp>
+
+#include "message.hpp"
+
+namespace qi
+{
+  /// Use the environment variable QI_MESSAGE_CHUNK_SIZE, if set.
+  /// Use the passed default size otherwise. 0 disables the chunks.
+  std::size_t getMessageChunkSizeFromEnv(std::size_t defaultValue = 256 * 1024);
+
+  /// Splits the message into Type_Chunk messages carrying at most `chunkSize`
+  /// bytes of its payload, so that messages of higher priority can be sent
+  /// between them. Returns no chunk if the payload is not larger than `chunkSize`.
+  ///
+  /// The chunks have the id, address and priority of the message, and their
+  /// payload starts with its header.
+  ///
+  /// Precondition: chunkSize > 0
+  std::vector<Message> splitIntoChunks(const Message& msg, std::size_t chunkSize);
+
+  /**
+   * @brief Rebuilds the messages sent in Type_Chunk messages.
+   * @internal
+   *
+   * The chunks of a message arrive in order, but may be interleaved with the
+   * chunks of other messages. Not thread-safe, a socket receives its messages
+   * one at a time.
+   *
+   * At most `maxPending` messages may be pending at once, and the payloads
+   * buffered for them may not exceed `maxPayload` bytes altogether.
+   */
+  class MessageChunkAssembler
+  {
+  public:
+    explicit MessageChunkAssembler(std::size_t maxPayload, std::size_t maxPending = 16);
+
+    /// Returns the message if `chunk` is its last chunk.
+    /// Throws a std::runtime_error if the chunk is ill-formed, if the message
+    /// is larger than the maximum payload, or if the limits of the pending
+    /// messages are reached.
+    boost::optional<Message> add(const Message& chunk);
+
+    /// Drops the pending messages.
+    void clear();
+
+    /// Number of messages of which some chunks have been received.
+    std::size_t pending() const;
+
+    /// Bytes of payload buffered for the pending messages.
+    std::size_t buffered() const;
+
+  private:
+    struct Partial
+    {
+      Message::Header header;
+      Buffer payload;
+    };
+    using Key = std::pair<unsigned int, MessageAddress>;
+
+    void drop(std::map<Key, Partial>::iterator it);
+
+    const std::size_t _maxPayload;
+    const std::size_t _maxPending;
+    std::size_t _buffered;
+    std::map<Key, Partial> _partials;
+  };
+}
+
+#endif  // _SRC_MESSAGECHUNK_HPP_
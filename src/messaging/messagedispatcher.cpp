@@ -40,7 +40,7 @@ namespace qi {
 
   void MessageDispatcher::dispatch(const qi::Message& msg) {
     //remove the address from the messageSent map
-    if (msg.type() == qi::Message::Type_Reply)
+    if (msg.type() == qi::Message::Type_Reply || msg.type() == qi::Message::Type_BatchReply)
     {
       boost::mutex::scoped_lock sl(_messageSentMutex);
       MessageSentMap::iterator it;
@@ -141,7 +141,7 @@ namespace qi {
   void MessageDispatcher::sent(const qi::Message& msg) {
     //store Call id, we can use them later to notify the client
     //if the call did not succeed. (network disconnection, message lost)
-    if (msg.type() == qi::Message::Type_Call)
+    if (msg.type() == qi::Message::Type_Call || msg.type() == qi::Message::Type_CallBatch)
     {
       boost::mutex::scoped_lock l(_messageSentMutex);
       MessageSentMap::iterator it = _messageSent.find(msg.id());
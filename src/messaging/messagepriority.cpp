@@ -0,0 +1,44 @@
+/*
+**  Copyright (C) 2018 SoftBank Robotics Europe
+**  See COPYING for the license
+*/
+
+#include <qi/messaging/messagepriority.hpp>
+
+#include <boost/thread/tss.hpp>
+
+#include <qi/atomic.hpp>
+
+namespace qi
+{
+  namespace
+  {
+    boost::thread_specific_ptr<MessagePriority>& threadPriority()
+    {
+      static boost::thread_specific_ptr<MessagePriority>* priority;
+      QI_ONCE(priority = new boost::thread_specific_ptr<MessagePriority>());
+      return *priority;
+    }
+  }
+
+  MessagePriority currentMessagePriority()
+  {
+    const MessagePriority* priority = threadPriority().get();
+    return priority ? *priority : MessagePriority_Normal;
+  }
+
+  ScopedMessagePriority::ScopedMessagePriority(MessagePriority priority)
+    : _previous(currentMessagePriority())
+  {
+    auto& current = threadPriority();
+    if (current.get())
+      *current = priority;
+    else
+      current.reset(new MessagePriority(priority));
+  }
+
+  ScopedMessagePriority::~ScopedMessagePriority()
+  {
+    *threadPriority() = _previous;
+  }
+}
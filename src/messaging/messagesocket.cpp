@@ -20,14 +20,24 @@ namespace qi
     _signalsStrand.join();
   }
 
+  bool MessageSocket::send(qi::Message msg, OnSent onSent)
+  {
+    if (!send(std::move(msg)))
+      return false;
+    if (onSent)
+      onSent();
+    return true;
+  }
+
   bool MessageSocket::isConnected() const
   {
     return status() == qi::MessageSocket::Status::Connected;
   }
 
-  MessageSocketPtr makeMessageSocket(const std::string &protocol, qi::EventLoop *eventLoop)
+  MessageSocketPtr makeMessageSocket(const std::string &protocol, qi::EventLoop *eventLoop,
+                                     const MessageSocketConfig& config)
   {
-    return makeTcpMessageSocket(protocol, eventLoop);
+    return makeTcpMessageSocket(protocol, eventLoop, config);
   }
 }
 
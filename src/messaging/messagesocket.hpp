@@ -6,12 +6,16 @@
 # include <boost/noncopyable.hpp>
 # include <boost/variant.hpp>
 # include <boost/optional.hpp>
+# include <boost/shared_ptr.hpp>
+# include <boost/thread/synchronized_value.hpp>
 # include <qi/future.hpp>
 # include "message.hpp"
 # include <qi/url.hpp>
 # include <qi/eventloop.hpp>
 # include <qi/signal.hpp>
 # include <qi/binarycodec.hpp>
+# include <qi/messaging/tlsoffload.hpp>
+# include <qi/messaging/sockettuning.hpp>
 # include <string>
 # include "messagedispatcher.hpp"
 # include "streamcontext.hpp"
@@ -35,6 +39,16 @@ namespace qi
   }
 
   class Session;
+  class MessageSocket;
+
+  /// Settings of the sockets a session opens and accepts, taken from its
+  /// SessionConfig.
+  struct MessageSocketConfig
+  {
+    TlsOffloadConfig tlsOffload;
+    SocketTuningConfig tuning;
+  };
+  using MessageSocketPtr = boost::shared_ptr<MessageSocket>;
 
   class MessageSocket : private boost::noncopyable, public StreamContext
   {
@@ -74,6 +88,12 @@ namespace qi
 
     virtual bool send(qi::Message msg) = 0;
 
+    /// Same as send(Message), but `onSent` is called once the message has been
+    /// written to the socket, or could not be because of an error.
+    /// `onSent` is not called if this function returns false.
+    using OnSent = boost::function<void ()>;
+    virtual bool send(qi::Message msg, OnSent onSent);
+
     /// Start reading if is not already reading.
     /// Must be called once if the socket is obtained through TransportServer::newConnection()
     virtual bool  ensureReading() = 0;
@@ -95,10 +115,22 @@ namespace qi
       _dispatcher.messagePendingDisconnect(serviceId, objectId, linkId);
     }
 
+    /// Set on a client socket whose session may be resumed if it is lost.
+    /// Once it is, `resumption` is set to the socket on which the session was
+    /// resumed, or to null if it could not be.
+    void setResumption(Future<MessageSocketPtr> resumption) {
+      *_resumption.synchronize() = std::move(resumption);
+    }
+
+    boost::optional<Future<MessageSocketPtr>> resumption() const {
+      return _resumption.get();
+    }
+
   protected:
     qi::EventLoop* _eventLoop;
     Strand _signalsStrand; // Must be declared before the MessageDispatcher and the signals.
     qi::MessageDispatcher _dispatcher;
+    boost::synchronized_value<boost::optional<Future<MessageSocketPtr>>> _resumption;
 
   public:
     // C4251
@@ -112,8 +144,8 @@ namespace qi
     qi::Signal<SocketEventData>  socketEvent;
   };
 
-  using MessageSocketPtr = boost::shared_ptr<MessageSocket>;
-  MessageSocketPtr makeMessageSocket(const std::string &protocol, qi::EventLoop *eventLoop = getNetworkEventLoop());
+  MessageSocketPtr makeMessageSocket(const std::string &protocol, qi::EventLoop *eventLoop = getNetworkEventLoop(),
+                                     const MessageSocketConfig& config = {});
 }
 
 #endif  // _SRC_MESSAGESOCKET_HPP_
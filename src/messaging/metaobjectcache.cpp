@@ -0,0 +1,95 @@
+/*
+**  Copyright (C) 2018 SoftBank Robotics Europe
+**  See COPYING for the license
+*/
+
+#include "metaobjectcache.hpp"
+
+#include <qi/atomic.hpp>
+
+#include "../type/metaobject_p.hpp"
+
+namespace qi
+{
+  namespace
+  {
+    // Caches are only useful for the few services a process talks to.
+    const std::size_t maxEntries = 256;
+  }
+
+  qi::uint64_t metaObjectHash(const MetaObject& metaObject)
+  {
+    // Reuse the digest MetaObjectPrivate keeps of the members, which also
+    // identifies the MetaObjects in the send caches of the sockets.
+    MetaObjectPrivate& p = *metaObject._p;
+    if (p._dirtyCache || !p._contentSHA1)
+      p.refreshCache();
+    qi::uint64_t hash = 0;
+    for (std::size_t i = 0; i < sizeof(hash); ++i)
+      hash = (hash << 8) | (*p._contentSHA1)[i];
+    return hash ? hash : 1;
+  }
+
+  MetaObject compactMetaObject(const MetaObject& metaObject)
+  {
+    MetaObjectBuilder builder;
+    for (const auto& method : metaObject.methodMap())
+    {
+      MetaMethodBuilder mmb(method.second.returnSignature(), method.second.name(),
+                            method.second.parametersSignature());
+      builder.addMethod(mmb, static_cast<int>(method.first));
+    }
+    for (const auto& signal : metaObject.signalMap())
+      builder.addSignal(signal.second.name(), signal.second.parametersSignature(),
+                        static_cast<int>(signal.first));
+    for (const auto& property : metaObject.propertyMap())
+      builder.addProperty(property.second.name(), property.second.signature(),
+                          static_cast<int>(property.first));
+    return builder.metaObject();
+  }
+
+  MetaObjectCache::MetaObjectCache()
+    : _entries(maxEntries)
+    , _lastHashes(maxEntries)
+  {
+  }
+
+  MetaObjectCache& MetaObjectCache::instance()
+  {
+    static MetaObjectCache* cache = nullptr;
+    QI_THREADSAFE_NEW(cache);
+    return *cache;
+  }
+
+  boost::optional<MetaObjectCache::Entry> MetaObjectCache::find(qi::uint64_t hash) const
+  {
+    boost::mutex::scoped_lock lock(_mutex);
+    const Entry* entry = _entries.find(hash);
+    if (!entry)
+      return {};
+    return *entry;
+  }
+
+  void MetaObjectCache::insert(qi::uint64_t hash, const MetaObject& metaObject, bool complete)
+  {
+    boost::mutex::scoped_lock lock(_mutex);
+    Entry* entry = _entries.find(hash);
+    if (!entry)
+      _entries.set(hash, Entry{ metaObject, complete });
+    else if (complete && !entry->complete)
+      *entry = Entry{ metaObject, true };
+  }
+
+  qi::uint64_t MetaObjectCache::lastHash(const std::string& objectKey) const
+  {
+    boost::mutex::scoped_lock lock(_mutex);
+    const qi::uint64_t* hash = _lastHashes.find(objectKey);
+    return hash ? *hash : 0;
+  }
+
+  void MetaObjectCache::setLastHash(const std::string& objectKey, qi::uint64_t hash)
+  {
+    boost::mutex::scoped_lock lock(_mutex);
+    _lastHashes.set(objectKey, hash);
+  }
+}
@@ -0,0 +1,115 @@
+#pragma once
+/*
+**  Copyright (C) 2018 SoftBank Robotics Europe
+**  See COPYING for the license
+*/
+
+#ifndef _SRC_METAOBJECTCACHE_HPP_
+#define _SRC_METAOBJECTCACHE_HPP_
+
+#include <list>
+#include <map>
+#include <string>
+#include <utility>
+
+#include <boost/optional.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include <qi/type/metaobject.hpp>
+
+namespace qi
+{
+  /// Hash of the content of a MetaObject, documentation included, identical
+  /// in every process. 0 is never returned.
+  qi::uint64_t metaObjectHash(const MetaObject& metaObject);
+
+  /// Copy of a MetaObject without the descriptions and parameter names: what
+  /// is needed to call the methods and to use the signals and properties.
+  MetaObject compactMetaObject(const MetaObject& metaObject);
+
+  /**
+   * @brief Process-wide cache of the MetaObjects of remote objects.
+   * @internal
+   *
+   * MetaObjects are stored by the hash their service computed, either in full
+   * or as the compact index. The hash last seen for an object of an endpoint
+   * is also kept, so that a client reconnecting to it can tell the service
+   * which MetaObject it already has.
+   *
+   * Both are bounded: when full, the least recently used element is evicted.
+   */
+  class MetaObjectCache
+  {
+  public:
+    struct Entry
+    {
+      MetaObject metaObject;
+      bool complete;
+    };
+
+    MetaObjectCache();
+
+    static MetaObjectCache& instance();
+
+    boost::optional<Entry> find(qi::uint64_t hash) const;
+
+    /// A complete MetaObject replaces a compact one, not the other way around.
+    void insert(qi::uint64_t hash, const MetaObject& metaObject, bool complete);
+
+    /// @return the hash last seen for `objectKey`, 0 if none.
+    qi::uint64_t lastHash(const std::string& objectKey) const;
+    void setLastHash(const std::string& objectKey, qi::uint64_t hash);
+
+  private:
+    /// Map of at most `capacity` values, evicting the least recently used one.
+    template <typename Key, typename Value>
+    class LruMap
+    {
+    public:
+      explicit LruMap(std::size_t capacity)
+        : _capacity(capacity)
+      {
+      }
+
+      /// Marks the value as used. @return nullptr if there is none.
+      Value* find(const Key& key)
+      {
+        const auto it = _values.find(key);
+        if (it == _values.end())
+          return nullptr;
+        _uses.splice(_uses.begin(), _uses, it->second.second);
+        return &it->second.first;
+      }
+
+      /// Replaces the value of `key` if there is one, and marks it as used.
+      void set(const Key& key, Value value)
+      {
+        if (Value* existing = find(key))
+        {
+          *existing = std::move(value);
+          return;
+        }
+        if (_values.size() >= _capacity)
+        {
+          _values.erase(_uses.back());
+          _uses.pop_back();
+        }
+        _uses.push_front(key);
+        _values.emplace(key, std::make_pair(std::move(value), _uses.begin()));
+      }
+
+    private:
+      using Uses = std::list<Key>; // Most recently used first.
+      std::size_t _capacity;
+      Uses _uses;
+      std::map<Key, std::pair<Value, typename Uses::iterator>> _values;
+    };
+
+    mutable boost::mutex _mutex;
+    // Looking an element up marks it as used.
+    mutable LruMap<qi::uint64_t, Entry> _entries;
+    mutable LruMap<std::string, qi::uint64_t> _lastHashes;
+  };
+}
+
+#endif  // _SRC_METAOBJECTCACHE_HPP_
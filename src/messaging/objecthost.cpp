@@ -104,6 +104,24 @@ void ObjectHost::removeRemoteReferences(MessageSocketPtr socket)
   _remoteReferences.erase(it);
 }
 
+void ObjectHost::resumeRemoteReferences(const MessageSocketPtr& previous, const MessageSocketPtr& socket)
+{
+  ObjectMap objects;
+  {
+    boost::recursive_mutex::scoped_lock lock(_mutex);
+    RemoteReferencesMap::iterator it = _remoteReferences.find(previous.get());
+    if (it != _remoteReferences.end())
+    {
+      auto& references = _remoteReferences[socket.get()];
+      references.insert(references.end(), it->second.begin(), it->second.end());
+      _remoteReferences.erase(it);
+    }
+    objects = _objectMap;
+  }
+  for (const auto& pair : objects)
+    pair.second->onSocketResumed(previous, socket);
+}
+
 namespace
 {
   /// Wraps a shared pointer so that when this class object is copied, the underlying
@@ -35,6 +35,9 @@ namespace qi
     unsigned int addObject(BoundAnyObject obj, StreamContext* remoteReferencer, unsigned int objId = 0);
     Future<void> removeObject(unsigned int id, Future<void> fut = Future<void>{nullptr});
     void removeRemoteReferences(MessageSocketPtr socket);
+    /// Moves the references of `previous` to `socket`, and lets the hosted
+    /// objects do the same with their state.
+    void resumeRemoteReferences(const MessageSocketPtr& previous, const MessageSocketPtr& socket);
     unsigned int service() { return _service;}
     virtual unsigned int nextId() = 0;
     using ObjectMap = std::map<unsigned int, BoundAnyObject>;
@@ -95,51 +95,65 @@ namespace qi {
       return;
     }
     qi::ServiceInfo              si;
-    RegisterServiceMap::iterator it;
+    qi::AnyObject                object;
+    BoundObjectWrapper           wrapBound;
 
     {
       boost::mutex::scoped_lock sl(_registerServiceRequestMutex);
-      it = _registerServiceRequest.find(id);
+      RegisterServiceMap::iterator it = _registerServiceRequest.find(id);
       if (it != _registerServiceRequest.end())
-        si = it->second.second;
+      {
+        si = it->second.serviceInfo;
+        object = it->second.object;
+        wrapBound = it->second.wrapBound;
+      }
     }
     unsigned int idx = fut.value();
     si.setServiceId(idx);
+    try
+    {
+      addService(si, object, wrapBound);
+    }
+    catch (const std::exception& e)
+    {
+      result.setError(e.what());
+      return;
+    }
+
+    // ack the Service directory to tell that we are ready
+    qi::Future<void> fut2 = _sdClient->serviceReady(idx);
+    fut2.connect(boost::bind(&serviceReady, _1, result, idx));
+  }
+
+  void ObjectRegistrar::addService(const qi::ServiceInfo& si, qi::AnyObject obj, BoundObjectWrapper wrapBound)
+  {
+    const unsigned int idx = si.serviceId();
     {
       boost::mutex::scoped_lock sl(_servicesMutex);
       BoundService bs;
       bs.id          = idx;
-      bs.object      = it->second.first;
+      bs.object      = obj;
       bs.serviceInfo = si;
       bs.name        = si.name();
       BoundServiceMap::iterator it;
       it = _services.find(idx);
       if (it != _services.end()) {
         qiLogError() << "A service is already registered with that id:" << idx;
-        result.setError("Service already registered.");
-        return;
+        throw std::runtime_error("Service already registered.");
       }
       _services[idx] = bs;
       //todo register the object on the server (find a better way)
-      Server::addObject(idx, bs.object);
+      Server::addObject(idx, bs.object, std::move(wrapBound));
     }
 
     {
       boost::mutex::scoped_lock sl(_serviceNameToIndexMutex);
       _serviceNameToIndex[si.name()] = idx;
     }
-
-    // ack the Service directory to tell that we are ready
-    qi::Future<void> fut2 = _sdClient->serviceReady(idx);
-    fut2.connect(boost::bind(&serviceReady, _1, result, idx));
   }
 
-  qi::Future<unsigned int> ObjectRegistrar::registerService(const std::string &name, qi::AnyObject obj)
+  qi::ServiceInfo ObjectRegistrar::makeServiceInfo(const std::string& name, const qi::AnyObject& obj)
   {
-    if (Server::endpoints().empty()) {
-      qiLogError() << "Could not register service: " << name << " because the current server has not endpoint";
-      return qi::Future<unsigned int>();
-    }
     qi::ServiceInfo si;
     si.setName(name);
     si.setProcessId(qi::os::getpid());
@@ -147,11 +161,22 @@ namespace qi {
     si.setEndpoints(Server::endpoints());
     si.setSessionId(_id);
     si.setObjectUid(obj.uid());
+    return si;
+  }
+
+  qi::Future<unsigned int> ObjectRegistrar::registerService(const std::string &name, qi::AnyObject obj,
+                                                            BoundObjectWrapper wrapBound)
+  {
+    if (Server::endpoints().empty()) {
+      qiLogError() << "Could not register service: " << name << " because the current server has not endpoint";
+      return qi::Future<unsigned int>();
+    }
+    qi::ServiceInfo si = makeServiceInfo(name, obj);
 
     int id = ++_registerServiceRequestIndex;
     {
       boost::mutex::scoped_lock sl(_registerServiceRequestMutex);
-      _registerServiceRequest[id] = std::make_pair(obj, si);
+      _registerServiceRequest[id] = RegisterServiceRequest{ obj, si, std::move(wrapBound) };
     }
 
     qi::Promise<unsigned int> prom;
@@ -163,6 +188,64 @@ namespace qi {
     return prom.future();
   };
 
+  qi::Future<std::vector<unsigned int>> ObjectRegistrar::registerServices(
+      const std::vector<std::pair<std::string, qi::AnyObject>>& services)
+  {
+    if (Server::endpoints().empty())
+      return qi::makeFutureError<std::vector<unsigned int>>(
+          "Could not register the services because the current server has not endpoint");
+
+    std::vector<qi::ServiceInfo> infos;
+    infos.reserve(services.size());
+    for (const auto& service : services)
+      infos.push_back(makeServiceInfo(service.first, service.second));
+
+    return _sdClient->registerServices(infos).andThen(track(
+        [=](const std::vector<unsigned int>& idxs) {
+          if (idxs.size() != infos.size())
+          {
+            rollbackServices(idxs, 0);
+            throw std::runtime_error("The service directory did not register each service.");
+          }
+          std::size_t bound = 0;
+          try
+          {
+            for (; bound < idxs.size(); ++bound)
+            {
+              qi::ServiceInfo si = infos[bound];
+              si.setServiceId(idxs[bound]);
+              addService(si, services[bound].second, {});
+            }
+          }
+          catch (const std::exception&)
+          {
+            rollbackServices(idxs, bound);
+            throw;
+          }
+          // ack the Service directory to tell that we are ready
+          return _sdClient->servicesReady(idxs).then(track([=](qi::Future<void> ready) {
+            if (!ready.hasValue())
+            {
+              rollbackServices(idxs, idxs.size());
+              throw std::runtime_error(ready.hasError() ? ready.error() : "servicesReady canceled.");
+            }
+            return idxs;
+          }, static_cast<Trackable<Server>*>(this)));
+        },
+        static_cast<Trackable<Server>*>(this))).unwrap();
+  }
+
+  void ObjectRegistrar::rollbackServices(const std::vector<unsigned int>& idxs, std::size_t boundCount)
+  {
+    for (std::size_t i = 0; i < idxs.size(); ++i)
+    {
+      if (i < boundCount)
+        unregisterService(idxs[i]);
+      else
+        _sdClient->unregisterService(idxs[i]);
+    }
+  }
+
   qi::Future<void> ObjectRegistrar::unregisterService(unsigned int idx)
   {
     qi::Future<void> future = _sdClient->unregisterService(idx);
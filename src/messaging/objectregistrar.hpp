@@ -45,7 +45,13 @@ namespace qi {
     void open();
 
     //register/unregister services
-    qi::Future<unsigned int>     registerService(const std::string &name, qi::AnyObject obj);
+    /// @param wrapBound if set, replaces the object bound for the service.
+    qi::Future<unsigned int>     registerService(const std::string &name, qi::AnyObject obj,
+                                                 BoundObjectWrapper wrapBound = {});
+    /// Registers the services in one request to the service directory, which
+    /// adds all or none of them.
+    qi::Future<std::vector<unsigned int>> registerServices(
+        const std::vector<std::pair<std::string, qi::AnyObject>>& services);
     qi::Future<void>             unregisterService(unsigned int idx);
     void                         updateServiceInfo();
 
@@ -61,18 +67,36 @@ namespace qi {
     using Server::listen;
     using Server::setIdentity;
     using Server::endpoints;
+    using Server::setCallSchedulingConfig;
+    using Server::callSchedulingStats;
+    using Server::setSessionResumptionConfig;
+    using Server::setSocketConfig;
 
   private:
     //0 on error
     unsigned int   objectId(const std::string &name);
 
+    qi::ServiceInfo makeServiceInfo(const std::string& name, const qi::AnyObject& obj);
+    // Binds the service registered by the service directory, throws if a
+    // service is already bound with its id.
+    void addService(const qi::ServiceInfo& si, qi::AnyObject obj, BoundObjectWrapper wrapBound);
+    // Unregisters the services registered by registerServices, of which the
+    // first `boundCount` ones were bound.
+    void rollbackServices(const std::vector<unsigned int>& idxs, std::size_t boundCount);
+
   private:
     //Future
     void onFutureFinished(qi::Future<unsigned int> future, int id, qi::Promise<unsigned int> result);
 
   private:
     using BoundServiceMap = std::map<unsigned int, BoundService>;
-    using RegisterServiceMap = std::map<int, std::pair<qi::AnyObject, qi::ServiceInfo>>;
+    struct RegisterServiceRequest
+    {
+      qi::AnyObject object;
+      qi::ServiceInfo serviceInfo;
+      BoundObjectWrapper wrapBound;
+    };
+    using RegisterServiceMap = std::map<int, RegisterServiceRequest>;
     using ServiceNameToIndexMap = std::map<std::string, unsigned int>;
 
   public:
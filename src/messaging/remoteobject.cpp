@@ -10,9 +10,12 @@
 #endif
 
 #include "remoteobject_p.hpp"
+#include "boundobject.hpp"
 #include "message.hpp"
 #include "messagesocket.hpp"
+#include "metaobjectcache.hpp"
 #include <qi/log.hpp>
+#include <qi/messaging/messagepriority.hpp>
 #include <boost/thread/mutex.hpp>
 #include <qi/eventloop.hpp>
 
@@ -28,12 +31,14 @@ namespace qi {
     mob.addMethod("v", "unregisterEvent", "(IIL)", qi::Message::BoundObjectFunction_UnregisterEvent);
     mob.addMethod(typeOf<MetaObject>()->signature(), "metaObject", "(I)", qi::Message::BoundObjectFunction_MetaObject);
     mob.addMethod("L", "registerEventWithSignature", "(IILs)", qi::Message::BoundObjectFunction_RegisterEventWithSignature);
+    mob.addMethod(typeOf<RemoteObject::MetaObjectIndex>()->signature(), "metaObjectIndex", "(IL)", qi::Message::BoundObjectFunction_MetaObjectIndex);
     *mo = mob.metaObject();
 
     QI_ASSERT(mo->methodId("registerEvent::(IIL)") == qi::Message::BoundObjectFunction_RegisterEvent);
     QI_ASSERT(mo->methodId("unregisterEvent::(IIL)") == qi::Message::BoundObjectFunction_UnregisterEvent);
     QI_ASSERT(mo->methodId("metaObject::(I)") == qi::Message::BoundObjectFunction_MetaObject);
     QI_ASSERT(mo->methodId("registerEventWithSignature::(IILs)") == qi::Message::BoundObjectFunction_RegisterEventWithSignature);
+    QI_ASSERT(mo->methodId("metaObjectIndex::(IL)") == qi::Message::BoundObjectFunction_MetaObjectIndex);
 
     return mo;
   }
@@ -112,10 +117,135 @@ namespace qi {
   //should be done in the object thread
   void RemoteObject::onSocketDisconnected(std::string error)
   {
+    boost::optional<Future<MessageSocketPtr>> resumption;
+    if (MessageSocketPtr socket = *_socket)
+      resumption = socket->resumption();
     close("Socket Disconnected", true);
+    if (resumption)
+    {
+      // The remote end kept our object ids and event subscriptions, wait for
+      // the new socket instead of staying closed.
+      _awaitingResumption = true;
+      resumption->connect(track([=](Future<MessageSocketPtr> fut) { onSocketResumed(fut); }, this));
+    }
     throw PointerLockException();
   }
 
+  void RemoteObject::onSocketResumed(Future<MessageSocketPtr> resumption)
+  {
+    if (!_awaitingResumption.exchange(false))
+      return;
+    if (resumption.hasValue() && resumption.value())
+    {
+      qiLogVerbose() << "Service " << _service << " resumed on socket " << resumption.value().get();
+      setTransportSocket(resumption.value());
+    }
+  }
+
+  void RemoteObject::addPooledSocket(qi::MessageSocketPtr socket, bool bulk, std::size_t bulkPayloadThreshold)
+  {
+    {
+      // Same as metaCall, check the transport socket while holding the lock
+      // to avoid a race with close().
+      auto syncSock = _socket.synchronize();
+      auto syncPool = _socketPool.synchronize();
+      if (!*syncSock || !socket->isConnected() || (bulk && syncPool->bulk))
+        return;
+      PooledSocket pooled;
+      pooled.socket = socket;
+      pooled.linkMessageDispatcher = socket->messagePendingConnect(_service,
+        MessageSocket::ALL_OBJECTS,
+        track(boost::bind<void>(&RemoteObject::onMessagePending, this, _1), this));
+      MessageSocket* const rawSocket = socket.get();
+      pooled.linkDisconnected = socket->disconnected.connect(
+          track([=](const std::string& reason) { onPooledSocketDisconnected(rawSocket, reason); }, this));
+      if (bulk)
+        syncPool->bulk = pooled;
+      else
+        syncPool->regular.push_back(pooled);
+      syncPool->bulkPayloadThreshold = bulkPayloadThreshold;
+    }
+    _hasPooledSockets = true;
+    qiLogVerbose() << "Added " << (bulk ? "bulk" : "regular") << " pooled socket " << socket.get()
+                   << " to service " << _service;
+  }
+
+  void RemoteObject::onPooledSocketDisconnected(MessageSocket* socket, const std::string& reason)
+  {
+    boost::optional<PooledSocket> removed;
+    {
+      auto syncPool = _socketPool.synchronize();
+      if (syncPool->bulk && syncPool->bulk->socket.get() == socket)
+      {
+        removed = syncPool->bulk;
+        syncPool->bulk = boost::none;
+      }
+      auto& regular = syncPool->regular;
+      const auto it = std::find_if(regular.begin(), regular.end(), [&](const PooledSocket& pooled) {
+        return pooled.socket.get() == socket;
+      });
+      if (it != regular.end())
+      {
+        removed = *it;
+        regular.erase(it);
+      }
+    }
+    if (!removed)
+      return;
+    qiLogVerbose() << "Pooled socket " << socket << " of service " << _service << " disconnected: " << reason;
+    removed->socket->messagePendingDisconnect(_service, MessageSocket::ALL_OBJECTS, removed->linkMessageDispatcher);
+
+    // The calls in progress on this socket will not get a reply.
+    std::vector<unsigned int> lostCalls;
+    {
+      auto syncCalls = _pooledCalls.synchronize();
+      for (auto it = syncCalls->begin(); it != syncCalls->end();)
+      {
+        if (it->second.get() == socket)
+        {
+          lostCalls.push_back(it->first);
+          it = syncCalls->erase(it);
+        }
+        else
+          ++it;
+      }
+    }
+    for (const auto id : lostCalls)
+    {
+      qi::Promise<AnyReference> promise;
+      {
+        auto syncPromises = _promises.synchronize();
+        auto it = syncPromises->find(id);
+        if (it == syncPromises->end())
+          continue;
+        promise = it->second;
+        syncPromises->erase(it);
+      }
+      promise.setError("Socket Disconnected");
+    }
+  }
+
+  MessageSocketPtr RemoteObject::pooledCallSocket(const MessageSocketPtr& sock, unsigned int method,
+                                                  std::size_t payloadSize)
+  {
+    MessageSocketPtr pooled;
+    {
+      auto syncPool = _socketPool.synchronize();
+      const std::size_t threshold = syncPool->bulkPayloadThreshold;
+      if (syncPool->bulk && threshold != 0
+          && (payloadSize >= threshold || _bulkMethods->count(method) != 0))
+        pooled = syncPool->bulk->socket;
+      else
+      {
+        const std::size_t turn = syncPool->nextRegular++ % (syncPool->regular.size() + 1);
+        if (turn != 0)
+          pooled = syncPool->regular[turn - 1].socket;
+      }
+    }
+    // A pooled socket may be disconnected before we are notified of it.
+    return pooled && pooled->isConnected() ? pooled : sock;
+  }
+
   void RemoteObject::onMetaObject(qi::Future<qi::MetaObject> fut, qi::Promise<void> prom) {
     if (fut.hasError()) {
       qiLogVerbose() << "MetaObject error: " << fut.error();
@@ -124,18 +254,64 @@ namespace qi {
     }
     qiLogVerbose() << "Fetched metaobject";
     setMetaObject(fut.value());
+    _metaObjectHash = metaObjectHash(fut.value());
     prom.setValue(0);
   }
 
+  void RemoteObject::onMetaObjectIndex(qi::Future<MetaObjectIndex> fut, qi::Promise<void> prom,
+                                       const std::string& cacheKey) {
+    if (fut.hasError()) {
+      qiLogVerbose() << "MetaObject index error: " << fut.error();
+      prom.setError(fut.error());
+      return;
+    }
+    const qi::uint64_t hash = fut.value().first;
+    const qi::MetaObject& index = fut.value().second;
+    MetaObjectCache& cache = MetaObjectCache::instance();
+    if (const auto cached = cache.find(hash)) {
+      qiLogVerbose() << "Using cached metaobject " << hash;
+      setMetaObject(cached->metaObject);
+    }
+    else if (index.methodMap().empty()) {
+      // The service thinks we already have it, but it has been evicted.
+      fetchFullMetaObject(prom);
+      return;
+    }
+    else {
+      qiLogVerbose() << "Fetched metaobject index " << hash;
+      setMetaObject(index);
+      cache.insert(hash, index, false);
+    }
+    _metaObjectHash = hash;
+    cache.setLastHash(cacheKey, hash);
+    prom.setValue(0);
+  }
 
+  void RemoteObject::fetchFullMetaObject(qi::Promise<void> prom) {
+    qi::Future<qi::MetaObject> fut =
+      _self.async<qi::MetaObject>("metaObject", 0U);
+    fut.connect(track(boost::bind<void>(&RemoteObject::onMetaObject, this, _1, prom), this));
+  }
 
   //retrieve the metaObject from the network
   qi::Future<void> RemoteObject::fetchMetaObject() {
-    qiLogVerbose() << "Requesting metaobject";
     qi::Promise<void> prom(qi::FutureCallbackType_Sync);
-    qi::Future<qi::MetaObject> fut =
-      _self.async<qi::MetaObject>("metaObject", 0U);
-    fut.connect(track(boost::bind<void>(&RemoteObject::onMetaObject, this, _1, prom), this));
+    MessageSocketPtr sock = *_socket;
+    // Descriptions are only fetched if asked for, with a call to metaObject.
+    if (sock && sock->sharedCapability<bool>(capabilityname::lazyMetaObject, false))
+    {
+      std::ostringstream cacheKey;
+      cacheKey << sock->url().str() << '/' << _service << '/' << _object;
+      const qi::uint64_t knownHash = MetaObjectCache::instance().lastHash(cacheKey.str());
+      qiLogVerbose() << "Requesting metaobject index";
+      qi::Future<MetaObjectIndex> fut =
+        _self.async<MetaObjectIndex>("metaObjectIndex", 0U, knownHash);
+      fut.connect(track(boost::bind<void>(&RemoteObject::onMetaObjectIndex, this, _1, prom,
+                                          cacheKey.str()), this));
+      return prom.future();
+    }
+    qiLogVerbose() << "Requesting metaobject";
+    fetchFullMetaObject(prom);
     return prom.future();
   }
 
@@ -160,6 +336,9 @@ namespace qi {
     }
 
     if (msg.type() == qi::Message::Type_Event) {
+      const RawEventHandler rawEventHandler = *_rawEventHandler;
+      if (rawEventHandler && rawEventHandler(msg))
+        return;
       SignalBase* sb = signal(msg.event());
       if (sb)
       {
@@ -202,13 +381,45 @@ namespace qi {
 
     if (msg.type() != qi::Message::Type_Reply
       && msg.type() != qi::Message::Type_Error
-      && msg.type() != qi::Message::Type_Canceled) {
+      && msg.type() != qi::Message::Type_Canceled
+      && msg.type() != qi::Message::Type_BatchReply) {
       qiLogError() << "Message " << msg.address() << " type not handled: " << msg.type();
 
       passToHost();
       return;
     }
 
+    ForwardHandler forwardHandler;
+    {
+      auto syncForwarded = _forwardedCalls.synchronize();
+      auto it = syncForwarded->find(msg.id());
+      if (it != syncForwarded->end())
+      {
+        forwardHandler = std::move(it->second);
+        syncForwarded->erase(it);
+      }
+    }
+    if (forwardHandler)
+    {
+      forwardHandler(msg);
+      return;
+    }
+
+    if (_hasPooledSockets.load())
+    {
+      _pooledCalls->erase(msg.id());
+      // The calls of the methods which return large replies go on the bulk
+      // lane, so that they do not delay the other calls.
+      if (msg.type() == qi::Message::Type_Reply)
+      {
+        const std::size_t threshold = _socketPool->bulkPayloadThreshold;
+        if (threshold != 0 && msg.buffer().totalSize() >= threshold)
+          _bulkMethods->insert(msg.function());
+        else
+          _bulkMethods->erase(msg.function());
+      }
+    }
+
     qi::Promise<AnyReference> promise;
     {
       auto syncPromises = _promises.synchronize();
@@ -224,10 +435,16 @@ namespace qi {
       }
     }
 
+    Signature returnSignature;
     switch (msg.type()) {
-      case qi::Message::Type_Canceled: {
-        qiLogDebug() << "Message " << msg.address() << " has been cancelled.";
-        promise.setCanceled();
+      case qi::Message::Type_BatchReply: {
+        // The results are dispatched to the promises of the calls by
+        // metaCallBatch.
+        try {
+          promise.setValue(msg.value(typeOf<MessageBatch>()->signature(), sock).release());
+        } catch (std::runtime_error &err) {
+          promise.setError(err.what());
+        }
         return;
       }
       case qi::Message::Type_Reply: {
@@ -240,10 +457,29 @@ namespace qi {
            promise.setError("Result for unknown function");
            return;
         }
+        returnSignature = mm->returnSignature();
+        break;
+      }
+      default:
+        break;
+    }
+    setCallResult(msg, returnSignature, promise, sock);
+  }
+
+  void RemoteObject::setCallResult(const Message& msg, const Signature& returnSignature,
+                                   qi::Promise<AnyReference>& promise, const MessageSocketPtr& sock)
+  {
+    switch (msg.type()) {
+      case qi::Message::Type_Canceled: {
+        qiLogDebug() << "Message " << msg.address() << " has been cancelled.";
+        promise.setCanceled();
+        return;
+      }
+      case qi::Message::Type_Reply: {
         try {
           AnyValue value(msg.value((msg.flags() & Message::TypeFlag_DynamicPayload) ?
                                      "m" :
-                                     mm->returnSignature(),
+                                     returnSignature,
                                    sock));
           promise.setValue(value.release());
         } catch (std::runtime_error &err) {
@@ -267,7 +503,7 @@ namespace qi {
         return;
       }
       default:
-        //not possible
+        promise.setError(std::string("Unexpected reply of type ") + Message::typeToString(msg.type()));
         return;
     }
   }
@@ -275,6 +511,16 @@ namespace qi {
 
   qi::Future<AnyReference> RemoteObject::metaCall(AnyObject, unsigned int method, const qi::GenericFunctionParameters &in, MetaCallType callType, Signature returnSignature)
   {
+    const bool fullMetaObjectCall = method == qi::Message::BoundObjectFunction_MetaObject;
+    // The call asks for the metaObject of the object whose id is its
+    // argument, only the one of this remote object may be known already.
+    if (fullMetaObjectCall && in.size() == 1 && in[0].kind() == TypeKind_Int
+        && in[0].toUInt() == _object)
+    {
+      const auto cached = MetaObjectCache::instance().find(_metaObjectHash.load());
+      if (cached && cached->complete)
+        return qi::Future<AnyReference>(AnyReference::from(cached->metaObject).clone());
+    }
     MetaMethod *mm = metaObject().method(method);
     if (!mm) {
       std::stringstream ss;
@@ -346,9 +592,26 @@ namespace qi {
     msg.setService(_service);
     msg.setObject(_object);
     msg.setFunction(method);
+    msg.setPriority(currentMessagePriority());
 
-    //error will come back as a error message
     const auto msgId = msg.id();
+    // The calls which cannot carry objects, which are bound to a socket, may
+    // be sent on another socket of the pool of the endpoint.
+    bool pooled = false;
+    if (_hasPooledSockets.load() && method >= Manageable::startId
+        && !(msg.flags() & Message::TypeFlag_DynamicPayload)
+        && !mayContainObjects(funcSig) && !mayContainObjects(mm->returnSignature()))
+    {
+      MessageSocketPtr pooledSock = pooledCallSocket(sock, method, msg.buffer().totalSize());
+      if (pooledSock != sock)
+      {
+        (*_pooledCalls.synchronize())[msgId] = pooledSock;
+        sock = std::move(pooledSock);
+        pooled = true;
+      }
+    }
+
+    //error will come back as a error message
     if (!sock->isConnected() || !sock->send(std::move(msg))) {
       qi::MetaMethod*   meth = metaObject().method(method);
       std::stringstream ss;
@@ -368,16 +631,158 @@ namespace qi {
       out.setError(ss.str());
       qiLogDebug() << "Removing promise id:" << msgId;
       _promises->erase(msgId);
+      if (pooled)
+        _pooledCalls->erase(msgId);
     }
     else
       out.setOnCancel(qi::bind(&RemoteObject::onFutureCancelled, this, msgId));
+
+    if (fullMetaObjectCall)
+    {
+      return out.future().andThen(qi::FutureCallbackType_Sync, [](const AnyReference& result) {
+        try
+        {
+          const auto mo = result.to<qi::MetaObject>();
+          MetaObjectCache::instance().insert(metaObjectHash(mo), mo, true);
+        }
+        catch (const std::exception& e)
+        {
+          qiLogVerbose() << "Cannot cache the received metaobject: " << e.what();
+        }
+        return result;
+      });
+    }
     return out.future();
   }
 
+  std::vector<qi::Future<AnyReference>> RemoteObject::metaCallBatch(AnyObject context, const MetaCallBatch& calls)
+  {
+    MessageSocketPtr sock = *_socket;
+    if (calls.empty() || !sock || !sock->sharedCapability<bool>(capabilityname::callBatch, false))
+      return DynamicObject::metaCallBatch(context, calls);
+
+    std::vector<qi::Future<AnyReference>> results(calls.size());
+    std::vector<qi::Promise<AnyReference>> promises;
+    std::vector<Signature> returnSignatures;
+    MessageBatch batch;
+    for (std::size_t i = 0; i < calls.size(); ++i)
+    {
+      const unsigned int method = calls[i].first;
+      MetaMethod* mm = metaObject().method(method);
+      if (!mm)
+      {
+        std::stringstream ss;
+        ss << "Method " << method << " not found on service " << _service;
+        results[i] = makeFutureError<AnyReference>(ss.str());
+        continue;
+      }
+      // Each call is encoded as the payload of its own Type_Call would be.
+      qi::Message call;
+      try {
+        try {
+          call.setValues(calls[i].second, mm->parametersSignature(), weakPtr(), sock.get());
+        }
+        catch (const std::exception& e)
+        {
+          qiLogVerbose() << "setValues exception: " << e.what();
+          if (!sock->remoteCapability("MessageFlags", false))
+            throw;
+          // Delegate conversion to the remote end.
+          call.addFlags(Message::TypeFlag_DynamicPayload);
+          call.setValues(calls[i].second, "m", weakPtr(), sock.get());
+        }
+      }
+      catch (const std::exception& e)
+      {
+        results[i] = makeFutureError<AnyReference>(e.what());
+        continue;
+      }
+      batch.push_back(MessageBatchEntry{Message::Type_Call, method, call.flags(), call.extractBuffer()});
+      qi::Promise<AnyReference> promise;
+      results[i] = promise.future();
+      promises.push_back(promise);
+      returnSignatures.push_back(mm->returnSignature());
+    }
+    if (batch.empty())
+      return results;
+
+    qi::Promise<AnyReference> replies(qi::FutureCallbackType_Sync);
+    replies.future().connect([promises, returnSignatures, sock](const Future<AnyReference>& f) mutable {
+      if (f.hasError())
+      {
+        for (auto& promise : promises)
+          promise.setError(f.error());
+        return;
+      }
+      MessageBatch results;
+      try
+      {
+        AnyValue value(f.value(), false, true);
+        results = value.to<MessageBatch>();
+        if (results.size() != promises.size())
+          throw std::runtime_error("Invalid batch reply: unexpected number of results");
+      }
+      catch (const std::exception& e)
+      {
+        for (auto& promise : promises)
+          promise.setError(e.what());
+        return;
+      }
+      for (std::size_t i = 0; i < results.size(); ++i)
+      {
+        qi::Message reply;
+        reply.setType(static_cast<Message::Type>(results[i].type));
+        reply.setFlags(static_cast<qi::uint8_t>(results[i].flags));
+        reply.setFunction(results[i].action);
+        reply.setBuffer(std::move(results[i].payload));
+        setCallResult(reply, returnSignatures[i], promises[i], sock);
+      }
+    });
+
+    qi::Message msg;
+    {
+      auto syncSock = _socket.synchronize();
+      // Same as metaCall, check the socket while holding the lock.
+      if (!*syncSock || !(*syncSock)->isConnected())
+      {
+        replies.setError("Socket is not connected");
+        return results;
+      }
+      (*_promises.synchronize())[msg.id()] = replies;
+    }
+    msg.setType(qi::Message::Type_CallBatch);
+    msg.setService(_service);
+    msg.setObject(_object);
+    msg.setPriority(currentMessagePriority());
+    msg.setValue(AnyReference::from(batch), typeOf<MessageBatch>()->signature());
+
+    const auto msgId = msg.id();
+    if (!sock->isConnected() || !sock->send(std::move(msg)))
+    {
+      std::stringstream ss;
+      ss << "Network error while sending a batch of " << batch.size() << " calls.";
+      if (!sock->isConnected())
+        ss << " Socket is not connected.";
+      qiLogVerbose() << ss.str();
+      if (_promises->erase(msgId))
+        replies.setError(ss.str());
+    }
+    return results;
+  }
+
   void RemoteObject::onFutureCancelled(unsigned int originalMessageId)
   {
     qiLogDebug() << "Cancel request for message " << originalMessageId;
-    MessageSocketPtr sock = *_socket;
+    // The cancel must be sent on the socket of the call.
+    MessageSocketPtr sock;
+    {
+      auto syncCalls = _pooledCalls.synchronize();
+      auto it = syncCalls->find(originalMessageId);
+      if (it != syncCalls->end())
+        sock = it->second;
+    }
+    if (!sock)
+      sock = *_socket;
     Message cancelMessage;
 
     if (!sock)
@@ -398,6 +803,34 @@ namespace qi {
     sock->send(std::move(cancelMessage));
   }
 
+  bool RemoteObject::forwardMessage(qi::Message msg, ForwardHandler onReply)
+  {
+    MessageSocketPtr sock;
+    msg.setService(_service);
+    {
+      // Same as metaCall, check the socket while holding the lock to avoid a
+      // race with close().
+      auto syncSock = _socket.synchronize();
+      sock = *syncSock;
+      if (!sock || !sock->isConnected())
+        return false;
+      if (onReply)
+        (*_forwardedCalls.synchronize())[msg.id()] = std::move(onReply);
+    }
+    const unsigned int id = msg.id();
+    if (!sock->send(std::move(msg)))
+    {
+      _forwardedCalls->erase(id);
+      return false;
+    }
+    return true;
+  }
+
+  void RemoteObject::setRawEventHandler(RawEventHandler handler)
+  {
+    *_rawEventHandler.synchronize() = std::move(handler);
+  }
+
   void RemoteObject::metaPost(AnyObject, unsigned int event, const qi::GenericFunctionParameters &in)
   {
     // Bounce the emit request to server
@@ -436,6 +869,7 @@ namespace qi {
     msg.setService(_service);
     msg.setObject(_object);
     msg.setFunction(event);
+    msg.setPriority(currentMessagePriority());
     if (!sock || !sock->send(std::move(msg))) {
       qiLogVerbose() << "error while emitting event";
       return;
@@ -564,6 +998,8 @@ namespace qi {
   void RemoteObject::close(const std::string& reason, bool fromSignal)
   {
     qiLogDebug() << "Closing remote object";
+    if (!fromSignal)
+      _awaitingResumption = false;
     MessageSocketPtr socket;
     {
        auto syncSock = _socket.synchronize();
@@ -577,6 +1013,19 @@ namespace qi {
         if (!fromSignal)
           socket->disconnected.disconnectAsync(_linkDisconnected);
     }
+    SocketPool pool;
+    {
+      auto syncPool = _socketPool.synchronize();
+      std::swap(pool, *syncPool);
+    }
+    if (pool.bulk)
+      pool.regular.push_back(*pool.bulk);
+    for (auto& pooled: pool.regular)
+    {
+      pooled.socket->messagePendingDisconnect(_service, MessageSocket::ALL_OBJECTS, pooled.linkMessageDispatcher);
+      pooled.socket->disconnected.disconnectAsync(pooled.linkDisconnected);
+    }
+    _pooledCalls->clear();
     std::map<int, qi::Promise<AnyReference> > promises;
     {
       auto syncPromises = _promises.synchronize();
@@ -589,6 +1038,17 @@ namespace qi {
       qiLogVerbose() << "Reporting error for request " << pair.first << "(" << reason << ")";
       pair.second.setError(reason);
     }
+    std::map<unsigned int, ForwardHandler> forwardedCalls;
+    {
+      auto syncForwarded = _forwardedCalls.synchronize();
+      forwardedCalls.swap(*syncForwarded);
+    }
+    for (auto& pair: forwardedCalls)
+    {
+      Message error(Message::Type_Error, MessageAddress(pair.first, _service, _object, 0));
+      error.setError(reason);
+      pair.second(error);
+    }
 
     //@warning: remove connection are not removed
     //          not very important ATM, because RemoteObject
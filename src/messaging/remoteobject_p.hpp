@@ -17,7 +17,11 @@
 
 #include <boost/thread/mutex.hpp>
 #include <boost/thread/synchronized_value.hpp>
+#include <atomic>
+#include <set>
 #include <string>
+#include <utility>
+#include <vector>
 
 namespace qi {
 
@@ -36,6 +40,9 @@ namespace qi {
 
   class RemoteObject : public qi::DynamicObject, public ObjectHost, public Trackable<RemoteObject> {
   public:
+    /// Content hash and compact MetaObject, see ServiceBoundObject::metaObjectIndex.
+    using MetaObjectIndex = std::pair<qi::uint64_t, qi::MetaObject>;
+
     RemoteObject();
     RemoteObject(unsigned int service, qi::MessageSocketPtr socket = qi::MessageSocketPtr(),
       boost::optional<ObjectUid> uid = boost::none);
@@ -49,23 +56,64 @@ namespace qi {
     qi::Future<void> fetchMetaObject();
 
     void setTransportSocket(qi::MessageSocketPtr socket);
+    qi::MessageSocketPtr transportSocket() { return *_socket; }
+
+    /**
+     * Adds a socket to the endpoint of the transport socket, on which the
+     * calls which cannot carry objects may be sent, see SocketPoolConfig.
+     * If `bulk`, it is only used for the calls whose arguments or last reply
+     * are at least `bulkPayloadThreshold` bytes.
+     */
+    void addPooledSocket(qi::MessageSocketPtr socket, bool bulk, std::size_t bulkPayloadThreshold);
     // Set fromSignal if close is invoked from disconnect signal callback
     void close(const std::string& reason, bool fromSignal = false);
     unsigned int service() const { return _service; }
     unsigned int object() const { return _object; }
 
+    /// Receives a message for a forwarded call, or a forwarded event.
+    using ForwardHandler = boost::function<void (const qi::Message&)>;
+    /// Returns true if it has handled the event message.
+    using RawEventHandler = boost::function<bool (const qi::Message&)>;
+
+    /**
+     * Sends a message built elsewhere without decoding its payload, only its
+     * service is set to the one of this object. The reply to a call is given
+     * to `onReply`, or a Type_Error message if the object is closed first.
+     * @return false if the socket is not connected.
+     */
+    bool forwardMessage(qi::Message msg, ForwardHandler onReply);
+
+    /// The events are given to `handler` before being decoded, so that it can
+    /// forward them as they are.
+    void setRawEventHandler(RawEventHandler handler);
+
   protected:
     //TransportSocket.messagePending
     void onMessagePending(const qi::Message &msg);
     //TransportSocket.disconnected
     void onSocketDisconnected(std::string error);
+    // Reattaches the object to the socket on which the session of the lost
+    // one was resumed, if any.
+    void onSocketResumed(Future<MessageSocketPtr> resumption);
 
     virtual void metaPost(AnyObject context, unsigned int event, const GenericFunctionParameters& args);
     virtual qi::Future<AnyReference> metaCall(AnyObject context, unsigned int method, const GenericFunctionParameters& args, qi::MetaCallType callType, Signature returnSignature);
+    /// Sends the calls in a single Type_CallBatch message if the remote end
+    /// supports it, the calls of a batch cannot be canceled.
+    virtual std::vector<qi::Future<AnyReference>> metaCallBatch(AnyObject context, const MetaCallBatch& calls);
     void onFutureCancelled(unsigned int originalMessageId);
+    void onPooledSocketDisconnected(MessageSocket* socket, const std::string& reason);
+    // Returns the socket on which to send a call which may use the pool.
+    MessageSocketPtr pooledCallSocket(const MessageSocketPtr& sock, unsigned int method, std::size_t payloadSize);
+    // Sets the promise of a call from its Type_Reply, Type_Error or Type_Canceled message.
+    static void setCallResult(const Message& msg, const Signature& returnSignature,
+                              qi::Promise<AnyReference>& promise, const MessageSocketPtr& sock);
 
     //metaObject received
     void onMetaObject(qi::Future<qi::MetaObject> fut, qi::Promise<void> prom);
+    void onMetaObjectIndex(qi::Future<MetaObjectIndex> fut, qi::Promise<void> prom,
+                           const std::string& cacheKey);
+    void fetchFullMetaObject(qi::Promise<void> prom);
 
     virtual qi::Future<SignalLink> metaConnect(unsigned int event, const SignalSubscriber& sub);
     virtual qi::Future<void> metaDisconnect(SignalLink linkId);
@@ -80,11 +128,39 @@ namespace qi {
     unsigned int                                    _service;
     unsigned int                                    _object;
     boost::synchronized_value<std::map<int, qi::Promise<AnyReference>>> _promises;
+    // message id -> handler of the reply to a forwarded call
+    boost::synchronized_value<std::map<unsigned int, ForwardHandler>> _forwardedCalls;
+    boost::synchronized_value<RawEventHandler>      _rawEventHandler;
     qi::SignalLink                                  _linkMessageDispatcher;
     qi::SignalLink                                  _linkDisconnected;
     qi::AnyObject                                   _self;
     boost::recursive_mutex                          _localToRemoteSignalLinkMutex;
     LocalToRemoteSignalLinkMap                      _localToRemoteSignalLink;
+    // Key of the metaObject in the MetaObjectCache, 0 until it is fetched.
+    std::atomic<qi::uint64_t>                       _metaObjectHash{0};
+
+    struct PooledSocket
+    {
+      MessageSocketPtr socket;
+      qi::SignalLink   linkMessageDispatcher;
+      qi::SignalLink   linkDisconnected;
+    };
+    struct SocketPool
+    {
+      // Used in turn with the transport socket.
+      std::vector<PooledSocket>      regular;
+      boost::optional<PooledSocket>  bulk;
+      std::size_t                    bulkPayloadThreshold = 0;
+      unsigned int                   nextRegular = 0;
+    };
+    std::atomic<bool>                               _hasPooledSockets{false};
+    // Closed because the socket was lost, until its session is resumed.
+    std::atomic<bool>                               _awaitingResumption{false};
+    boost::synchronized_value<SocketPool>           _socketPool;
+    // id of a call sent on a pooled socket -> that socket
+    boost::synchronized_value<std::map<unsigned int, MessageSocketPtr>> _pooledCalls;
+    // Methods whose last reply was large enough for the bulk lane.
+    boost::synchronized_value<std::set<unsigned int>> _bulkMethods;
 
   private:
     static qi::Atomic<unsigned int> _nextId;
@@ -3,6 +3,7 @@
 **  See COPYING for the license
 */
 #include <qi/anyobject.hpp>
+#include <qi/async.hpp>
 #include "transportserver.hpp"
 #include <qi/messaging/serviceinfo.hpp>
 #include <qi/type/objecttypebuilder.hpp>
@@ -34,11 +35,13 @@ namespace qi {
     close();
   }
 
-  bool Server::addObject(unsigned int id, qi::AnyObject obj)
+  bool Server::addObject(unsigned int id, qi::AnyObject obj, const BoundObjectWrapper& wrapBound)
   {
     if (!obj)
       return false;
-    BoundAnyObject bop = makeServiceBoundAnyObject(id, obj, _defaultCallType);
+    BoundAnyObject bop = makeServiceBoundAnyObject(id, obj, _defaultCallType, _callScheduling);
+    if (wrapBound)
+      bop = wrapBound(id, bop);
     return addObject(id, bop);
   }
 
@@ -82,6 +85,40 @@ namespace qi {
     _authProviderFactory = factory;
   }
 
+  void Server::setCallSchedulingConfig(const CallSchedulingConfig& config)
+  {
+    _callScheduling = config;
+  }
+
+  void Server::setSessionResumptionConfig(const SessionResumptionConfig& config)
+  {
+    _sessionResumption = config;
+  }
+
+  void Server::setSocketConfig(const MessageSocketConfig& config)
+  {
+    _server.setSocketConfig(config);
+  }
+
+  CallSchedulingStats Server::callSchedulingStats(unsigned int idx)
+  {
+    BoundAnyObject object;
+    {
+      boost::mutex::scoped_lock sl(_boundObjectsMutex);
+      BoundAnyObjectMap::iterator it = _boundObjects.find(idx);
+      if (it != _boundObjects.end())
+        object = it->second;
+    }
+    auto bound = boost::dynamic_pointer_cast<ServiceBoundObject>(object);
+    if (!bound)
+    {
+      std::stringstream ss;
+      ss << "No service with id " << idx;
+      throw std::runtime_error(ss.str());
+    }
+    return bound->callSchedulingStats();
+  }
+
   namespace server_private
   {
     static void sendCapabilities(MessageSocketPtr sock)
@@ -167,6 +204,8 @@ namespace qi {
 
     if (isAuthMsg)
     {
+      if (resumeSession(msg, socket, first, signalLink, reply))
+        return;
       if (_enforceAuth)
       {
         handleAuthMsgAuthEnabled(msg, socket, auth, first, signalLink, reply);
@@ -208,6 +247,7 @@ namespace qi {
         qiLogVerbose() << "Client " << socket->remoteEndpoint().value().str() << " successfully authenticated.";
         socket->messageReady.disconnectAsync(*signalLink); // yet guarantees immediate disconnection
         connectMessageReady(socket);
+        offerResumption(socket, authResult);
         // no break, we know that authentication is done, send the response to the remote end
         QI_FALLTHROUGH;
       case AuthProvider::State_Cont:
@@ -249,6 +289,7 @@ namespace qi {
     connectMessageReady(socket);
     CapabilityMap authResult;
     authResult[AuthProvider::State_Key] = AnyValue::from<unsigned int>(AuthProvider::State_Done);
+    offerResumption(socket, authResult);
     if (*first)
     {
       authResult.insert(socket->localCapabilities().begin(), socket->localCapabilities().end());
@@ -261,6 +302,64 @@ namespace qi {
     socket->send(std::move(reply));
   }
 
+  /* The client sends the token it got on its previous socket with its first authentication message. If its session
+   * is still suspended, the state of the previous socket is moved to this one, and the client does not have to
+   * authenticate again.
+   */
+  bool Server::resumeSession(const qi::Message& msg, MessageSocketPtr socket, boost::shared_ptr<bool> first,
+      boost::shared_ptr<qi::SignalLink> signalLink, qi::Message& reply)
+  {
+    if (!*first)
+      return false;
+    const std::string token = socket->remoteCapability(sessionresumption::tokenKey, std::string());
+    if (token.empty())
+      return false;
+    const MessageSocketPtr previous = _resumption.resume(token);
+    if (!previous)
+    {
+      qiLogVerbose() << "Unknown or expired resumption token, authenticating the client again.";
+      return false;
+    }
+
+    {
+      boost::mutex::scoped_lock sl(_boundObjectsMutex);
+      for (const auto& pair : _boundObjects)
+      {
+        try
+        {
+          pair.second->onSocketResumed(previous, socket);
+        }
+        catch (const std::runtime_error& e)
+        {
+          qiLogError() << e.what();
+        }
+      }
+    }
+    qiLogVerbose() << "Client " << socket->remoteEndpoint().value().str() << " resumed its session.";
+    socket->messageReady.disconnectAsync(*signalLink); // yet guarantees immediate disconnection
+    connectMessageReady(socket);
+
+    CapabilityMap authResult;
+    authResult[AuthProvider::State_Key] = AnyValue::from<unsigned int>(AuthProvider::State_Done);
+    authResult[sessionresumption::resumedKey] = AnyValue::from(true);
+    offerResumption(socket, authResult);
+    authResult.insert(socket->localCapabilities().begin(), socket->localCapabilities().end());
+    *first = false;
+    reply.setValue(authResult, typeOf<CapabilityMap>()->signature());
+    reply.setType(Message::Type_Reply);
+    reply.setFunction(msg.function());
+    socket->send(std::move(reply));
+    return true;
+  }
+
+  void Server::offerResumption(const MessageSocketPtr& socket, CapabilityMap& authResult)
+  {
+    if (!_sessionResumption.enabled() || !socket->remoteCapability(capabilityname::sessionResumption, false))
+      return;
+    if (const auto token = _resumption.issue(socket))
+      authResult[sessionresumption::tokenKey] = AnyValue::from(*token);
+  }
+
   /* We handle the case when the message we receive is not an authentication message, yet the server enforces authentication.
    * This is an error
    */
@@ -362,6 +461,7 @@ namespace qi {
       for (auto& pair : subscribersCopy)
         disconnectSignals(pair.first, pair.second);
     }
+    _resumption.clear();
     _server.close();
   }
 
@@ -386,21 +486,18 @@ namespace qi {
         return;
       }
 
-      BoundAnyObjectMap::iterator it;
+      // The state of a client which may resume its session is kept until it
+      // does, or until the grace period has elapsed.
+      if (const auto token = _resumption.suspend(socket))
       {
-        boost::mutex::scoped_lock sl(_boundObjectsMutex);
-        for (it = _boundObjects.begin(); it != _boundObjects.end(); ++it) {
-          BoundAnyObject o = it->second;
-          try
-          {
-            o->onSocketDisconnected(socket, error);
-          }
-          catch (const std::runtime_error& e)
-          {
-            qiLogError() << e.what();
-          }
-        }
+        qiLogVerbose() << "Keeping the state of a disconnected client for "
+                       << _sessionResumption.gracePeriod.count() << "ms.";
+        _resumption.setExpiry(*token, asyncDelay(track([=] {
+          onResumptionExpired(*token, error);
+        }, this), _sessionResumption.gracePeriod));
       }
+      else
+        releaseSocketState(socket, error);
 
       {
         // Lock the mutex, erase the socket, and disconnect it outside the lock.
@@ -420,6 +517,34 @@ namespace qi {
     }
   }
 
+  void Server::releaseSocketState(const MessageSocketPtr& socket, const std::string& error)
+  {
+    boost::mutex::scoped_lock sl(_boundObjectsMutex);
+    for (BoundAnyObjectMap::iterator it = _boundObjects.begin(); it != _boundObjects.end(); ++it) {
+      BoundAnyObject o = it->second;
+      try
+      {
+        o->onSocketDisconnected(socket, error);
+      }
+      catch (const std::runtime_error& e)
+      {
+        qiLogError() << e.what();
+      }
+    }
+  }
+
+  void Server::onResumptionExpired(const std::string& token, const std::string& error)
+  {
+    boost::mutex::scoped_lock l(_stateMutex);
+    if (_dying)
+      return;
+    if (const MessageSocketPtr socket = _resumption.expire(token))
+    {
+      qiLogVerbose() << "A disconnected client did not resume its session in time.";
+      releaseSocketState(socket, error);
+    }
+  }
+
   qi::UrlVector Server::endpoints() const {
     return _server.endpoints();
   }
@@ -11,6 +11,7 @@
 #include <boost/noncopyable.hpp>
 #include "boundobject.hpp"
 #include "authprovider_p.hpp"
+#include "socketresumption.hpp"
 
 namespace qi {
 
@@ -22,6 +23,10 @@ namespace qi {
    * Thread-safety warning: do not call listen and addSocketObject at the same time.
    *
    */
+  /// Replaces the object bound for a service, for instance by one which
+  /// forwards some messages elsewhere before dispatching the others to `bound`.
+  using BoundObjectWrapper = boost::function<BoundAnyObject (unsigned int serviceId, BoundAnyObject bound)>;
+
   class Server: public qi::Trackable<Server>, private boost::noncopyable {
   public:
     Server(bool enforceAuth = false);
@@ -35,7 +40,7 @@ namespace qi {
     bool setIdentity(const std::string& key, const std::string& crt);
 
     //Create a BoundObject
-    bool addObject(unsigned int idx, qi::AnyObject obj);
+    bool addObject(unsigned int idx, qi::AnyObject obj, const BoundObjectWrapper& wrapBound = {});
     bool addObject(unsigned int idx, qi::BoundAnyObject obj);
     bool removeObject(unsigned int idx);
 
@@ -44,6 +49,17 @@ namespace qi {
     void onTransportServerNewConnection(MessageSocketPtr socket, bool startReading);
     void setAuthProviderFactory(AuthProviderFactoryPtr factory);
 
+    /// Applies to the objects added afterwards.
+    void setCallSchedulingConfig(const CallSchedulingConfig& config);
+    /// Throws if there is no object `idx`.
+    CallSchedulingStats callSchedulingStats(unsigned int idx);
+
+    /// Applies to the clients authenticated afterwards.
+    void setSessionResumptionConfig(const SessionResumptionConfig& config);
+
+    /// Applies to the endpoints listened to afterwards.
+    void setSocketConfig(const MessageSocketConfig& config);
+
   private:
     void setSocketObjectEndpoints();
 
@@ -66,6 +82,15 @@ namespace qi {
     void handleAuthMsgAuthDisabled(const qi::Message& msg, MessageSocketPtr socket, AuthProviderPtr authProvider,
                                    boost::shared_ptr<bool> first, boost::shared_ptr<SignalLink> signalLink,
                                    qi::Message& reply);
+    // Returns false if the message does not resume a suspended session, it
+    // is then handled as a new authentication.
+    bool resumeSession(const qi::Message& msg, MessageSocketPtr socket, boost::shared_ptr<bool> first,
+                       boost::shared_ptr<SignalLink> signalLink, qi::Message& reply);
+    // Gives a resumption token to the client if both ends enabled it.
+    void offerResumption(const MessageSocketPtr& socket, CapabilityMap& authResult);
+    // Releases the state of the bound objects for this client.
+    void releaseSocketState(const MessageSocketPtr& socket, const std::string& error);
+    void onResumptionExpired(const std::string& token, const std::string& error);
 
   private:
     //bool: true if it's a socketobject
@@ -82,6 +107,8 @@ namespace qi {
     TransportServer                     _server;
     bool                                _dying;
     qi::MetaCallType                    _defaultCallType;
+    CallSchedulingConfig                _callScheduling;
+    SessionResumptionConfig             _sessionResumption;
 
   private:
     struct SocketSubscriber
@@ -92,6 +119,7 @@ namespace qi {
     std::map<MessageSocketPtr, SocketSubscriber> _subscribers;
 
     boost::recursive_mutex              _socketsMutex;
+    SocketResumption                    _resumption;
 
     void connectMessageReady(const MessageSocketPtr& socket);
     void disconnectSignals(const MessageSocketPtr& socket, const SocketSubscriber& subscriber);
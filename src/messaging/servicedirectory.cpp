@@ -11,6 +11,7 @@
 
 #include <vector>
 #include <map>
+#include <set>
 
 #include <boost/make_shared.hpp>
 
@@ -65,6 +66,8 @@ namespace qi
       id = ob->advertiseMethod("machineId", &ServiceDirectory::machineId);
       QI_ASSERT(id == qi::Message::ServiceDirectoryAction_MachineId);
       ob->advertiseMethod("_socketOfService", &ServiceDirectory::_socketOfService);
+      ob->advertiseMethod("registerServices", &ServiceDirectory::registerServices);
+      ob->advertiseMethod("servicesReady", &ServiceDirectory::servicesReady);
       // used locally only, we do not export its id
       // Silence compile warning unused id
       (void)id;
@@ -73,7 +76,8 @@ namespace qi
   }
 
   ServiceDirectory::ServiceDirectory()
-    : servicesCount(0)
+    : _snapshot(std::make_shared<ServiceDirectorySnapshot>())
+    , servicesCount(0)
   {
   }
 
@@ -83,6 +87,20 @@ namespace qi
       qiLogWarning() << "Destroying while connected services remain";
   }
 
+  void ServiceDirectory::publishSnapshotUnsync()
+  {
+    auto snapshot = std::make_shared<ServiceDirectorySnapshot>();
+    snapshot->connectedServices = connectedServices;
+    snapshot->nameToIdx.insert(nameToIdx.begin(), nameToIdx.end());
+    snapshot->idxToSocket.insert(idxToSocket.begin(), idxToSocket.end());
+    std::atomic_store(&_snapshot, ServiceDirectorySnapshotPtr(std::move(snapshot)));
+  }
+
+  ServiceDirectorySnapshotPtr ServiceDirectory::snapshot() const
+  {
+    return std::atomic_load(&_snapshot);
+  }
+
   void ServiceDirectory::onSocketDisconnected(MessageSocketPtr socket, std::string error)
   {
     boost::recursive_mutex::scoped_lock lock(mutex);
@@ -99,55 +117,52 @@ namespace qi
     std::map<MessageSocketPtr, std::vector<unsigned int> >::iterator it;
     it = socketToIdx.find(socket);
     if (it == socketToIdx.end()) {
+      publishSnapshotUnsync();
       return;
     }
     // Copy the vector, iterators will be invalidated.
     std::vector<unsigned int> ids = it->second;
-    // Always start at the beginning since we erase elements on unregisterService
-    // and mess up the iterator
+    std::vector<std::pair<unsigned int, std::string> > removed;
     for (std::vector<unsigned int>::iterator it2 = ids.begin();
          it2 != ids.end();
          ++it2)
     {
       qiLogInfo() << "Service #" << *it2 << " disconnected";
       try {
-        unregisterService(*it2);
+        removed.push_back(std::make_pair(*it2, unregisterServiceUnsync(*it2)));
       } catch (std::runtime_error &) {
         qiLogWarning() << "Cannot unregister service #" << *it2;
       }
     }
-    socketToIdx.erase(it);
+    socketToIdx.erase(socket);
+    // All the services of the socket disappear at once.
+    publishSnapshotUnsync();
+    for (const auto& service : removed)
+      serviceRemoved(service.first, service.second);
   }
 
   std::vector<ServiceInfo> ServiceDirectory::services()
   {
-    boost::recursive_mutex::scoped_lock lock(mutex);
+    const ServiceDirectorySnapshotPtr snapshot = this->snapshot();
     std::vector<ServiceInfo> result;
-    std::map<unsigned int, ServiceInfo>::const_iterator it;
-
-    for (it = connectedServices.begin(); it != connectedServices.end(); ++it)
-      result.push_back(it->second);
-
+    result.reserve(snapshot->connectedServices.size());
+    for (const auto& service : snapshot->connectedServices)
+      result.push_back(service.second);
     return result;
   }
 
   ServiceInfo ServiceDirectory::service(const std::string &name)
   {
-    boost::recursive_mutex::scoped_lock lock(mutex);
-    std::map<unsigned int, ServiceInfo>::const_iterator servicesIt;
-    std::map<std::string, unsigned int>::const_iterator it;
-
-    it = nameToIdx.find(name);
-    if (it == nameToIdx.end()) {
+    const ServiceDirectorySnapshotPtr snapshot = this->snapshot();
+    const auto it = snapshot->nameToIdx.find(name);
+    if (it == snapshot->nameToIdx.end()) {
       std::stringstream ss;
       ss << "Cannot find service '" << name << "' in index";
       throw std::runtime_error(ss.str());
     }
 
-    unsigned int idx = it->second;
-
-    servicesIt = connectedServices.find(idx);
-    if (servicesIt == connectedServices.end()) {
+    const auto servicesIt = snapshot->connectedServices.find(it->second);
+    if (servicesIt == snapshot->connectedServices.end()) {
       std::stringstream ss;
       ss << "Cannot find ServiceInfo for service '" << name << "'";
       throw std::runtime_error(ss.str());
@@ -156,6 +171,11 @@ namespace qi
   }
 
   unsigned int ServiceDirectory::registerService(const ServiceInfo &svcinfo)
+  {
+    return registerServices(std::vector<ServiceInfo>{ svcinfo }).front();
+  }
+
+  std::vector<unsigned int> ServiceDirectory::registerServices(const std::vector<ServiceInfo> &svcinfos)
   {
     boost::shared_ptr<ServiceBoundObject> sbo = serviceBoundObject.lock();
     if (!sbo)
@@ -163,19 +183,32 @@ namespace qi
 
     MessageSocketPtr socket = sbo->currentSocket();
     boost::recursive_mutex::scoped_lock lock(mutex);
-    std::map<std::string, unsigned int>::iterator it;
-    it = nameToIdx.find(svcinfo.name());
-    if (it != nameToIdx.end())
+    std::set<std::string> names;
+    for (const auto& svcinfo : svcinfos)
     {
-      std::stringstream ss;
-      ss << "Service \"" <<
-        svcinfo.name() <<
-        "\" (#" << it->second << ") is already registered. " <<
-        "Rejecting conflicting registration attempt.";
-      qiLogWarning()  << ss.str();
-      throw std::runtime_error(ss.str());
+      std::map<std::string, unsigned int>::iterator it = nameToIdx.find(svcinfo.name());
+      if (it != nameToIdx.end() || !names.insert(svcinfo.name()).second)
+      {
+        std::stringstream ss;
+        ss << "Service \"" << svcinfo.name() << "\" ";
+        if (it != nameToIdx.end())
+          ss << "(#" << it->second << ") ";
+        ss << "is already registered. Rejecting conflicting registration attempt.";
+        qiLogWarning()  << ss.str();
+        throw std::runtime_error(ss.str());
+      }
     }
 
+    std::vector<unsigned int> idxs;
+    idxs.reserve(svcinfos.size());
+    for (const auto& svcinfo : svcinfos)
+      idxs.push_back(registerServiceUnsync(svcinfo, socket));
+    publishSnapshotUnsync();
+    return idxs;
+  }
+
+  unsigned int ServiceDirectory::registerServiceUnsync(const ServiceInfo &svcinfo, const MessageSocketPtr& socket)
+  {
     unsigned int idx = ++servicesCount;
     nameToIdx[svcinfo.name()] = idx;
     // Do not add serviceDirectory on the map (socket() == null)
@@ -208,6 +241,13 @@ namespace qi
   void ServiceDirectory::unregisterService(const unsigned int &idx)
   {
     boost::recursive_mutex::scoped_lock lock(mutex);
+    const std::string serviceName = unregisterServiceUnsync(idx);
+    publishSnapshotUnsync();
+    serviceRemoved(idx, serviceName);
+  }
+
+  std::string ServiceDirectory::unregisterServiceUnsync(unsigned int idx)
+  {
     bool pending = false;
     // search the id before accessing it
     // otherwise operator[] create a empty entry
@@ -274,8 +314,7 @@ namespace qi
         }
       }
     }
-
-    serviceRemoved(idx, serviceName);
+    return serviceName;
   }
 
   void ServiceDirectory::updateServiceInfo(const ServiceInfo &svcinfo)
@@ -294,11 +333,12 @@ namespace qi
     }
 
     itService = connectedServices.find(svcinfo.serviceId());
-    if (itService != connectedServices.end())
-    {
-      connectedServices[svcinfo.serviceId()] = svcinfo;
+    const bool connected = itService != connectedServices.end();
+    if (connected)
+      itService->second = svcinfo;
+    publishSnapshotUnsync();
+    if (connected)
       return;
-    }
 
     // maybe the service registration was pending...
     itService = pendingServices.find(svcinfo.serviceId());
@@ -314,26 +354,59 @@ namespace qi
     throw std::runtime_error(ss.str());
   }
 
+  bool ServiceDirectory::setServiceEndpoints(unsigned int idx, const UrlVector& endpoints)
+  {
+    boost::recursive_mutex::scoped_lock lock(mutex);
+    std::map<unsigned int, ServiceInfo>::iterator itService = connectedServices.find(idx);
+    if (itService == connectedServices.end())
+      return false;
+    itService->second.setEndpoints(endpoints);
+    publishSnapshotUnsync();
+    return true;
+  }
+
   void ServiceDirectory::serviceReady(const unsigned int &idx)
+  {
+    servicesReady(std::vector<unsigned int>{ idx });
+  }
+
+  void ServiceDirectory::servicesReady(const std::vector<unsigned int> &idxs)
   {
     boost::recursive_mutex::scoped_lock lock(mutex);
-    // search the id before accessing it
-    // otherwise operator[] create a empty entry
-    std::map<unsigned int, ServiceInfo>::iterator itService;
-    itService = pendingServices.find(idx);
-    if (itService == pendingServices.end())
+    std::set<unsigned int> readyIdxs;
+    for (auto idx : idxs)
     {
-      std::stringstream ss;
-      ss << "Can't find pending service #" << idx;
-      qiLogError() << ss.str();
-      throw std::runtime_error(ss.str());
+      if (!readyIdxs.insert(idx).second)
+      {
+        std::stringstream ss;
+        ss << "Service #" << idx << " is ready more than once.";
+        qiLogError() << ss.str();
+        throw std::runtime_error(ss.str());
+      }
+      if (pendingServices.find(idx) == pendingServices.end())
+      {
+        std::stringstream ss;
+        ss << "Can't find pending service #" << idx;
+        qiLogError() << ss.str();
+        throw std::runtime_error(ss.str());
+      }
     }
 
-    std::string serviceName = itService->second.name();
-    connectedServices[idx] = itService->second;
-    pendingServices.erase(itService);
+    std::vector<std::string> names;
+    names.reserve(idxs.size());
+    for (auto idx : idxs)
+    {
+      // search the id before accessing it
+      // otherwise operator[] create a empty entry
+      std::map<unsigned int, ServiceInfo>::iterator itService = pendingServices.find(idx);
+      names.push_back(itService->second.name());
+      connectedServices[idx] = itService->second;
+      pendingServices.erase(itService);
+    }
+    publishSnapshotUnsync();
 
-    serviceAdded(idx, serviceName);
+    for (std::size_t i = 0; i < idxs.size(); ++i)
+      serviceAdded(idxs[i], names[i]);
   }
 
 
@@ -404,12 +477,8 @@ namespace qi
       if (!error.empty())
         throw std::runtime_error(error);
 
-      auto it = _sdObject->connectedServices.find(qi::Message::Service_ServiceDirectory);
-      if (it != _sdObject->connectedServices.end())
-      {
-        it->second.setEndpoints(_server->endpoints());
+      if (_sdObject->setServiceEndpoints(qi::Message::Service_ServiceDirectory, _server->endpoints()))
         return;
-      }
 
       ServiceInfo si;
       si.setName(Session::serviceDirectoryServiceName());
@@ -437,9 +506,9 @@ namespace qi
 
   qi::MessageSocketPtr ServiceDirectory::_socketOfService(unsigned int id)
   {
-    boost::recursive_mutex::scoped_lock lock(mutex);
-    std::map<unsigned int, MessageSocketPtr>::iterator it = idxToSocket.find(id);
-    if (it == idxToSocket.end())
+    const ServiceDirectorySnapshotPtr snapshot = this->snapshot();
+    const auto it = snapshot->idxToSocket.find(id);
+    if (it == snapshot->idxToSocket.end())
       return MessageSocketPtr();
     else
       return it->second;
@@ -11,12 +11,25 @@
 # include <qi/future.hpp>
 # include "messagesocket.hpp"
 # include <boost/thread/recursive_mutex.hpp>
+# include <memory>
+# include <unordered_map>
 # include "boundobject.hpp"
 # include "server.hpp"
 # include "objectregistrar.hpp"
 
 namespace qi
 {
+  /// Immutable view of the registry of a ServiceDirectory, replaced as a
+  /// whole on every change so that the lookups never take its mutex.
+  struct ServiceDirectorySnapshot
+  {
+    std::map<unsigned int, ServiceInfo>              connectedServices;
+    // Includes the pending services.
+    std::unordered_map<std::string, unsigned int>    nameToIdx;
+    std::unordered_map<unsigned int, MessageSocketPtr> idxToSocket;
+  };
+  using ServiceDirectorySnapshotPtr = std::shared_ptr<const ServiceDirectorySnapshot>;
+
   class ServiceDirectory {
   public:
     ServiceDirectory();
@@ -31,17 +44,37 @@ namespace qi
     std::vector<ServiceInfo> services();
     ServiceInfo              service(const std::string &name);
     unsigned int             registerService(const ServiceInfo &svcinfo);
+    /// Same as registerService for each service, all or none of them are
+    /// registered.
+    std::vector<unsigned int> registerServices(const std::vector<ServiceInfo> &svcinfos);
     void                     unregisterService(const unsigned int &idx);
     void                     serviceReady(const unsigned int &idx);
+    /// Same as serviceReady for each service.
+    void                     servicesReady(const std::vector<unsigned int> &idxs);
     void                     updateServiceInfo(const ServiceInfo &svcinfo);
     std::string              machineId();
     qi::MessageSocketPtr   _socketOfService(unsigned int id);
     void                     _setServiceBoundObject(boost::shared_ptr<ServiceBoundObject> sbo);
+    /// Returns false if there is no connected service `idx`.
+    bool                     setServiceEndpoints(unsigned int idx, const UrlVector& endpoints);
+
+    ServiceDirectorySnapshotPtr snapshot() const;
 
     qi::Signal<unsigned int, std::string>  serviceAdded;
     qi::Signal<unsigned int, std::string>  serviceRemoved;
 
+  private:
+    unsigned int registerServiceUnsync(const ServiceInfo &svcinfo, const MessageSocketPtr& socket);
+    // Returns the name of the service, the caller emits serviceRemoved once
+    // the snapshot is published.
+    std::string  unregisterServiceUnsync(unsigned int idx);
+    // Must be called after each change, with the mutex locked.
+    void         publishSnapshotUnsync();
+
+    ServiceDirectorySnapshotPtr                               _snapshot;
+
   public:
+    // The maps are only used by the writers, under the mutex.
     std::map<unsigned int, ServiceInfo>                       pendingServices;
     std::map<unsigned int, ServiceInfo>                       connectedServices;
     std::map<std::string, unsigned int>                       nameToIdx;
@@ -75,6 +75,7 @@ namespace qi {
     if (ready)
     {
       promise.setValue(0);
+      synchronizeServiceCache();
       connected();
     }
   }
@@ -152,6 +153,7 @@ namespace qi {
       _object = makeDynamicAnyObject(_remoteObject.get(), false);
     }
 
+    _serviceCache.reset();
     return fut;
   }
 
@@ -344,7 +346,7 @@ namespace qi {
 
       if (_stateData.sdSocket)
         _stateData.sdSocket->disconnect().async();
-      _stateData.sdSocket = qi::makeMessageSocket(serviceDirectoryURL.protocol());
+      _stateData.sdSocket = qi::makeMessageSocket(serviceDirectoryURL.protocol(), getNetworkEventLoop(), _socketConfig);
 
       if (!_stateData.sdSocket)
         return qi::makeFutureError<void>(std::string("unrecognized protocol '") + serviceDirectoryURL.protocol() + "' in url '" + serviceDirectoryURL.str() + "'");
@@ -418,13 +420,81 @@ namespace qi {
     _authFactory = authFactory;
   }
 
+  void ServiceDirectoryClient::setServiceCacheConfig(const ServiceCacheConfig& config)
+  {
+    _serviceCacheEnabled = config.enabled;
+  }
+
+  void ServiceDirectoryClient::setSocketConfig(const MessageSocketConfig& config)
+  {
+    boost::mutex::scoped_lock lock(_mutex);
+    _socketConfig = config;
+  }
+
+  ServiceCacheStats ServiceDirectoryClient::serviceCacheStats() const
+  {
+    return _serviceCache.stats();
+  }
+
+  bool ServiceDirectoryClient::serviceCacheEnabled()
+  {
+    // A local service directory is answered without a round trip.
+    return _serviceCacheEnabled && !isLocal();
+  }
+
+  void ServiceDirectoryClient::synchronizeServiceCache()
+  {
+    if (!serviceCacheEnabled())
+      return;
+    const auto generation = _serviceCache.beginFetch();
+    _object.async<std::vector<ServiceInfo>>("services").connect(track(
+        [=](Future<std::vector<ServiceInfo>> services) {
+          if (services.hasError())
+          {
+            qiLogVerbose() << "Cannot fill the service cache: " << services.error();
+            _serviceCache.endFetch(generation, nullptr);
+            return;
+          }
+          _serviceCache.synchronize(generation, services.value());
+        },
+        this));
+  }
+
+  void ServiceDirectoryClient::fetchServiceInfo(const std::string& name)
+  {
+    const auto generation = _serviceCache.beginFetch();
+    _object.async<ServiceInfo>("service", name).connect(track(
+        [=](Future<ServiceInfo> info) {
+          _serviceCache.endFetch(generation, info.hasValue() ? &info.value() : nullptr);
+        },
+        this));
+  }
+
+  boost::optional<bool> ServiceDirectoryClient::hasService(const std::string& name)
+  {
+    if (!serviceCacheEnabled())
+      return {};
+    return _serviceCache.contains(name);
+  }
+
+  void ServiceDirectoryClient::invalidateService(const std::string& name)
+  {
+    _serviceCache.invalidate(name);
+  }
+
   void ServiceDirectoryClient::onServiceRemoved(unsigned int idx, const std::string &name) {
     qiLogVerbose() << "ServiceDirectoryClient: Service Removed #" << idx << ": " << name << std::endl;
+    if (serviceCacheEnabled())
+      _serviceCache.remove(idx, name);
     serviceRemoved(idx, name);
   }
 
   void ServiceDirectoryClient::onServiceAdded(unsigned int idx, const std::string &name) {
     qiLogVerbose() << "ServiceDirectoryClient: Service Added #" << idx << ": " << name << std::endl;
+    // Recorded before the signal is emitted, so that whoever checks the
+    // cache after connecting to the signal cannot miss the service.
+    if (serviceCacheEnabled() && _serviceCache.add(idx, name))
+      fetchServiceInfo(name);
     serviceAdded(idx, name);
   }
 
@@ -457,13 +527,60 @@ namespace qi {
   }
 
   qi::Future<ServiceInfo>              ServiceDirectoryClient::service(const std::string &name) {
-    return _object.async< ServiceInfo >("service", name);
+    if (!serviceCacheEnabled())
+      return _object.async< ServiceInfo >("service", name);
+    if (const auto info = _serviceCache.find(name))
+      return qi::Future<ServiceInfo>(*info);
+
+    const auto generation = _serviceCache.beginFetch();
+    return _object.async< ServiceInfo >("service", name).then(track(
+        [=](Future<ServiceInfo> info) {
+          _serviceCache.endFetch(generation, info.hasValue() ? &info.value() : nullptr);
+          return info.value();
+        },
+        this));
   }
 
   qi::Future<unsigned int>             ServiceDirectoryClient::registerService(const ServiceInfo &svcinfo) {
     return _object.async< unsigned int >("registerService", svcinfo);
   }
 
+  bool ServiceDirectoryClient::hasMethod(const std::string& name) const
+  {
+    return _object && !_object.metaObject().findMethod(name).empty();
+  }
+
+  qi::Future<std::vector<unsigned int>> ServiceDirectoryClient::registerServices(const std::vector<ServiceInfo> &svcinfos) {
+    if (hasMethod("registerServices"))
+      return _object.async< std::vector<unsigned int> >("registerServices", svcinfos);
+
+    // The older service directories register the services one at a time.
+    std::vector<qi::Future<unsigned int>> futures;
+    futures.reserve(svcinfos.size());
+    for (const auto& svcinfo : svcinfos)
+      futures.push_back(registerService(svcinfo));
+    return qi::waitForAll(futures).async().andThen(track(
+        [=](const std::vector<qi::Future<unsigned int>>& results) {
+          std::vector<unsigned int> idxs;
+          std::string error;
+          for (const auto& result : results)
+          {
+            if (result.hasValue())
+              idxs.push_back(result.value());
+            else if (error.empty())
+              error = result.hasError() ? result.error() : "Registration canceled.";
+          }
+          if (!error.empty())
+          {
+            for (auto idx : idxs)
+              unregisterService(idx);
+            throw std::runtime_error(error);
+          }
+          return idxs;
+        },
+        this));
+  }
+
   qi::Future<void>                     ServiceDirectoryClient::unregisterService(const unsigned int &idx) {
     return _object.async<void>("unregisterService", idx);
   }
@@ -472,6 +589,21 @@ namespace qi {
     return _object.async<void>("serviceReady", idx);
   }
 
+  qi::Future<void>                     ServiceDirectoryClient::servicesReady(const std::vector<unsigned int> &idxs) {
+    if (hasMethod("servicesReady"))
+      return _object.async<void>("servicesReady", idxs);
+
+    std::vector<qi::Future<void>> futures;
+    futures.reserve(idxs.size());
+    for (auto idx : idxs)
+      futures.push_back(serviceReady(idx));
+    return qi::waitForAll(futures).async().andThen([](const std::vector<qi::Future<void>>& results) {
+      for (const auto& result : results)
+        if (!result.hasValue())
+          throw std::runtime_error(result.hasError() ? result.error() : "serviceReady canceled.");
+    });
+  }
+
   qi::Future<void>                     ServiceDirectoryClient::updateServiceInfo(const ServiceInfo &svcinfo) {
     return _object.async<void>("updateServiceInfo", svcinfo);
   }
@@ -7,8 +7,10 @@
 #ifndef _SRC_SERVICEDIRECTORYCLIENT_HPP_
 #define _SRC_SERVICEDIRECTORYCLIENT_HPP_
 
+#include <atomic>
 #include <vector>
 #include <string>
+#include <boost/optional.hpp>
 #include <qi/signal.hpp>
 #include <qi/trackable.hpp>
 #include <qi/messaging/serviceinfo.hpp>
@@ -16,6 +18,7 @@
 #include "remoteobject_p.hpp"
 #include "clientauthenticator_p.hpp"
 #include "messagesocket.hpp"
+#include "serviceinfocache.hpp"
 
 namespace qi {
 
@@ -35,19 +38,35 @@ namespace qi {
 
     qi::AnyObject        object() { return _object; }
     void                 setClientAuthenticatorFactory(ClientAuthenticatorFactoryPtr);
+    void                 setServiceCacheConfig(const ServiceCacheConfig& config);
+    /// Applies to the connections made afterwards.
+    void                 setSocketConfig(const MessageSocketConfig& config);
+    ServiceCacheStats    serviceCacheStats() const;
 
   public:
     //Bound Interface
     qi::Future< std::vector<ServiceInfo> > services();
     qi::Future< ServiceInfo >              service(const std::string &name);
     qi::Future< unsigned int >             registerService(const ServiceInfo &svcinfo);
+    /// Registers all or none of the services, see ServiceDirectory::registerServices.
+    /// Registers them one at a time if the service directory cannot register
+    /// several services at once, and unregisters them if one fails.
+    qi::Future< std::vector<unsigned int> > registerServices(const std::vector<ServiceInfo> &svcinfos);
     qi::Future< void >                     unregisterService(const unsigned int &idx);
     qi::Future< void >                     serviceReady(const unsigned int &idx);
+    qi::Future< void >                     servicesReady(const std::vector<unsigned int> &idxs);
     qi::Future< void >                     updateServiceInfo(const ServiceInfo &svcinfo);
     qi::Future< std::string >              machineId();
     /// if isLocal() only, return socket holding given service id
     qi::Future<qi::MessageSocketPtr>     _socketOfService(unsigned int serviceId);
 
+    /// Whether the service is registered, if the service cache is enabled
+    /// and synchronized. Otherwise the service directory must be asked.
+    boost::optional<bool> hasService(const std::string& name);
+    /// Drops the cached info of the service, e.g. because its endpoints
+    /// could not be reached.
+    void invalidateService(const std::string& name);
+
     qi::Signal<>                                  connected;
     qi::Signal<std::string>                       disconnected;
     qi::Signal<unsigned int, std::string>         serviceAdded;
@@ -88,6 +107,13 @@ namespace qi {
 
     Future<void> closeImpl(const std::string& reason, bool sendSignalDisconnected);
 
+    bool serviceCacheEnabled();
+    void synchronizeServiceCache();
+    void fetchServiceInfo(const std::string& name);
+    // Whether the service directory has a method of that name, which the
+    // older service directories may not have.
+    bool hasMethod(const std::string& name) const;
+
   private:
     struct StateData
     {
@@ -109,6 +135,9 @@ namespace qi {
     AnyObject _object;
     ClientAuthenticatorFactoryPtr _authFactory;
     bool _enforceAuth;
+    std::atomic<bool> _serviceCacheEnabled{false};
+    MessageSocketConfig _socketConfig; // protected by _mutex
+    ServiceInfoCache _serviceCache;
     mutable boost::mutex _mutex;
   };
 }
@@ -5,6 +5,8 @@
 
 #include "clientauthenticator_p.hpp"
 #include "server.hpp"
+#include "serviceforwarder.hpp"
+#include "session_p.hpp"
 #include <ka/errorhandling.hpp>
 #include <ka/functional.hpp>
 #include <ka/scoped.hpp>
@@ -97,7 +99,8 @@ MirroringResult mirrorService(const std::string& name,
                               Session& srcSess,
                               Session& destSess,
                               const std::string& srcDesc,
-                              const std::string& destDesc)
+                              const std::string& destDesc,
+                              ServiceDirectoryProxy::ForwardingMode mode)
 {
   AnyObject service;
   try
@@ -116,7 +119,12 @@ MirroringResult mirrorService(const std::string& name,
   try
   {
     qiLogVerbose() << "Registering service '" << name << "' on " << destDesc << ".";
-    destId = destSess.registerService(name, service).value();
+    BoundObjectWrapper wrapBound;
+    if (mode == ServiceDirectoryProxy::ForwardingMode::Raw)
+      wrapBound = [service](unsigned int id, BoundAnyObject bound) {
+        return ServiceForwarder::wrap(id, service, std::move(bound));
+      };
+    destId = SessionPrivate::registerService(destSess, name, service, std::move(wrapBound)).value();
     qiLogVerbose() << "Registered service '" << name << "' (#" << *destId << ") on " << destDesc
                    << ".";
   }
@@ -171,6 +179,7 @@ public:
   Future<void> setAuthProviderFactory(AuthProviderFactoryPtr provider);
   Future<void> attachToServiceDirectory(const Url& sdUrl);
   Future<ServiceFilter> setServiceFilter(ServiceFilter filter);
+  Future<ForwardingMode> setForwardingMode(ForwardingMode mode);
 
 private:
   // Precondition synchronized():
@@ -295,6 +304,7 @@ private:
   AuthProviderFactoryPtr _authProviderFactory;
   bool _isEnforcedAuth;
   ServiceFilter _serviceFilter;
+  ForwardingMode _forwardingMode = ForwardingMode::Mirroring;
 
   mutable Strand _strand;
 };
@@ -324,6 +334,12 @@ Future<ServiceDirectoryProxy::ServiceFilter> ServiceDirectoryProxy::setServiceFi
   return _p->setServiceFilter(std::move(filter));
 }
 
+Future<ServiceDirectoryProxy::ForwardingMode> ServiceDirectoryProxy::setForwardingMode(
+    ForwardingMode mode)
+{
+  return _p->setForwardingMode(mode);
+}
+
 UrlVector ServiceDirectoryProxy::endpoints() const
 {
   return _p->endpoints().value();
@@ -593,6 +609,16 @@ Future<ServiceDirectoryProxy::ServiceFilter> ServiceDirectoryProxy::Impl::setSer
   });
 }
 
+Future<ServiceDirectoryProxy::ForwardingMode> ServiceDirectoryProxy::Impl::setForwardingMode(
+    ForwardingMode mode)
+{
+  return _strand.async([=] {
+    const auto previous = _forwardingMode;
+    _forwardingMode = mode;
+    return previous;
+  });
+}
+
 Future<void> ServiceDirectoryProxy::Impl::mirrorAllServices()
 {
   return _strand.async([=] {
@@ -628,7 +654,7 @@ MirroringResult ServiceDirectoryProxy::Impl::mirrorServiceFromSDUnsync(unsigned
 
   qiLogVerbose() << "Mirroring service '" << name << "' from the service directory to the proxy.";
   const auto result =
-      mirrorService(name, *_sdClient, *_server, "service directory", "proxy");
+      mirrorService(name, *_sdClient, *_server, "service directory", "proxy", _forwardingMode);
   if (result.mirroredId)
     _servicesInfo[name] = { *result.mirroredId, remoteId,
                             MirroredServiceInfo::Source::ServiceDirectory };
@@ -715,7 +741,7 @@ MirroringResult ServiceDirectoryProxy::Impl::mirrorServiceToSDUnsync(unsigned in
 
   qiLogVerbose() << "Mirroring service '" << name << "' from the proxy to the service directory.";
   const auto result =
-      mirrorService(name, *_server, *_sdClient, "proxy", "service directory");
+      mirrorService(name, *_server, *_sdClient, "proxy", "service directory", _forwardingMode);
   if (result.mirroredId)
     _servicesInfo[name] = { localId, *result.mirroredId, MirroredServiceInfo::Source::Proxy };
   return result;
@@ -921,6 +947,18 @@ std::ostream& operator<<(std::ostream& out, ServiceDirectoryProxy::ListenStatus
   return out;
 }
 
+std::ostream& operator<<(std::ostream& out, ServiceDirectoryProxy::ForwardingMode mode)
+{
+  using Mode = ServiceDirectoryProxy::ForwardingMode;
+  switch (mode)
+  {
+    case Mode::Mirroring: out << "Mirroring";                  break;
+    case Mode::Raw:       out << "Raw";                        break;
+    default:              printUnexpectedEnumValue(out, mode); break;
+  };
+  return out;
+}
+
 std::ostream& operator<<(std::ostream& out, ServiceDirectoryProxy::ConnectionStatus status)
 {
   using Status = ServiceDirectoryProxy::ConnectionStatus;
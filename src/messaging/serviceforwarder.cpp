@@ -0,0 +1,400 @@
+/*
+**  Copyright (C) 2018 SoftBank Robotics Europe
+**  See COPYING for the license
+*/
+
+#include "serviceforwarder.hpp"
+
+#include <atomic>
+#include <limits>
+
+#include <boost/make_shared.hpp>
+
+#include <qi/log.hpp>
+#include <qi/type/dynamicobject.hpp>
+
+qiLogCategory("qimessaging.serviceforwarder");
+
+namespace qi
+{
+  namespace
+  {
+    // The links of the events registered by the forwarders take the upper
+    // part of the range, to avoid colliding with the ones of the remote
+    // objects sharing their sockets.
+    std::atomic<SignalLink> nextRemoteLink{ std::numeric_limits<SignalLink>::max() / 2 };
+
+    const Signature registerEventSignature("(IIL)");
+    const Signature registerEventWithSignatureSignature("(IILs)");
+    const Signature unregisterEventSignature("(IIL)");
+
+    // The payload of a received message belongs to the receiving, which
+    // reuses its memory for the next message: it is copied once, without
+    // being decoded, then shared by the messages forwarded.
+    boost::shared_ptr<const Buffer> sharedPayload(const Message& from)
+    {
+      return boost::make_shared<const Buffer>(from.buffer());
+    }
+
+    Message rewritten(const Message& from, const MessageAddress& address)
+    {
+      Message msg(static_cast<Message::Type>(from.type()), address);
+      msg.setFlags(from.flags());
+      msg.setPriority(from.priority());
+      msg.setSharedBuffer(sharedPayload(from));
+      return msg;
+    }
+  }
+
+  BoundAnyObject ServiceForwarder::wrap(unsigned int serviceId, AnyObject object,
+                                        BoundAnyObject fallback)
+  {
+    GenericObject* go = object.asGenericObject();
+    if (!go || go->type != getDynamicTypeInterface())
+      return fallback;
+    RemoteObject* remote = dynamic_cast<RemoteObject*>(static_cast<DynamicObject*>(go->value));
+    if (!remote)
+      return fallback;
+
+    auto forwarder = boost::make_shared<ServiceForwarder>(serviceId, std::move(object), remote,
+                                                          std::move(fallback));
+    boost::weak_ptr<ServiceForwarder> weakForwarder = forwarder;
+    remote->setRawEventHandler([weakForwarder](const Message& msg) {
+      auto self = weakForwarder.lock();
+      return self && self->onRemoteEvent(msg);
+    });
+    return forwarder;
+  }
+
+  ServiceForwarder::ServiceForwarder(unsigned int serviceId, AnyObject object,
+                                     RemoteObject* remote, BoundAnyObject fallback)
+    : _serviceId(serviceId)
+    , _object(std::move(object))
+    , _remote(remote)
+    , _fallback(std::move(fallback))
+  {
+  }
+
+  ServiceForwarder::~ServiceForwarder()
+  {
+    _remote->setRawEventHandler(RemoteObject::RawEventHandler());
+    std::map<unsigned int, EventRoute> events;
+    {
+      boost::mutex::scoped_lock lock(_mutex);
+      events.swap(_events);
+    }
+    for (const auto& event: events)
+      unregisterRemoteEvent(event.first, event.second.remoteLink);
+  }
+
+  void ServiceForwarder::reply(const MessageSocketPtr& socket, const Message& request, Message reply)
+  {
+    reply.setAddress(request.address());
+    if (!socket->send(std::move(reply)))
+      qiLogVerbose() << "Cannot send the reply to " << request.address();
+  }
+
+  bool ServiceForwarder::isForwardable(const Message& msg) const
+  {
+    if (msg.flags() & Message::TypeFlag_DynamicPayload)
+      return false;
+    const MetaObject& metaObject = _object.metaObject();
+    if (const MetaMethod* method = metaObject.method(msg.function()))
+      return !mayContainObjects(method->parametersSignature())
+          && !mayContainObjects(method->returnSignature());
+    // A post may also trigger a signal.
+    const MetaSignal* signal = msg.type() == Message::Type_Post ? metaObject.signal(msg.function()) : nullptr;
+    return signal && !mayContainObjects(signal->parametersSignature());
+  }
+
+  void ServiceForwarder::onMessage(const qi::Message& msg, MessageSocketPtr socket)
+  {
+    bool forwarded = false;
+    if (msg.object() == Message::GenericObject_Main)
+    {
+      switch (msg.type())
+      {
+      case Message::Type_Call:
+      case Message::Type_Post:
+        switch (msg.function())
+        {
+        case Message::BoundObjectFunction_RegisterEvent:
+        case Message::BoundObjectFunction_RegisterEventWithSignature:
+          forwarded = msg.type() == Message::Type_Call && registerEvent(msg, socket);
+          break;
+        case Message::BoundObjectFunction_UnregisterEvent:
+          forwarded = msg.type() == Message::Type_Call && unregisterEvent(msg, socket);
+          break;
+        default:
+          forwarded = msg.function() >= Manageable::startId && isForwardable(msg)
+              && forwardCall(msg, socket);
+          break;
+        }
+        break;
+      case Message::Type_Cancel:
+        forwarded = forwardCancel(msg, socket);
+        break;
+      default:
+        break;
+      }
+    }
+    if (!forwarded)
+      _fallback->onMessage(msg, socket);
+  }
+
+  bool ServiceForwarder::forwardCall(const Message& msg, const MessageSocketPtr& socket)
+  {
+    // The forwarded message gets a new id, unique on the socket to the service.
+    Message forwarded = rewritten(msg, MessageAddress(Message::Header::newMessageId(),
+                                                      _remote->service(), msg.object(),
+                                                      msg.function()));
+    if (msg.type() == Message::Type_Post)
+      return _remote->forwardMessage(std::move(forwarded), RemoteObject::ForwardHandler());
+
+    const CallKey key(socket, msg.id());
+    const unsigned int forwardedId = forwarded.id();
+    {
+      boost::mutex::scoped_lock lock(_mutex);
+      _calls[key] = forwardedId;
+    }
+    boost::weak_ptr<ServiceForwarder> weakSelf = shared_from_this();
+    const MessageAddress replyAddress(msg.id(), _serviceId, msg.object(), msg.function());
+    const bool sent = _remote->forwardMessage(std::move(forwarded),
+                                              [=](const Message& reply) {
+      if (auto self = weakSelf.lock())
+      {
+        boost::mutex::scoped_lock lock(self->_mutex);
+        self->_calls.erase(key);
+      }
+      if (!socket->send(rewritten(reply, replyAddress)))
+        qiLogVerbose() << "Cannot forward the reply of " << replyAddress;
+    });
+    if (!sent)
+    {
+      boost::mutex::scoped_lock lock(_mutex);
+      _calls.erase(key);
+    }
+    return sent;
+  }
+
+  bool ServiceForwarder::forwardCancel(const Message& msg, const MessageSocketPtr& socket)
+  {
+    unsigned int forwardedId = 0;
+    try
+    {
+      const unsigned int canceledId = msg.value("I", socket).to<unsigned int>();
+      boost::mutex::scoped_lock lock(_mutex);
+      auto it = _calls.find(CallKey(socket, canceledId));
+      if (it == _calls.end())
+        return false;
+      forwardedId = it->second;
+    }
+    catch (const std::exception& e)
+    {
+      qiLogVerbose() << "Invalid cancel request " << msg.address() << ": " << e.what();
+      return false;
+    }
+    // Only the id of the canceled call is rewritten in the payload.
+    Message cancel(Message::Type_Cancel, MessageAddress(Message::Header::newMessageId(),
+                                                        _remote->service(), msg.object(),
+                                                        msg.function()));
+    cancel.setValue(AnyReference::from(forwardedId), "I");
+    _remote->forwardMessage(std::move(cancel), RemoteObject::ForwardHandler());
+    return true;
+  }
+
+  bool ServiceForwarder::registerEvent(const Message& msg, const MessageSocketPtr& socket)
+  {
+    const bool withSignature = msg.function() == Message::BoundObjectFunction_RegisterEventWithSignature;
+    unsigned int event = 0;
+    SignalLink link = SignalBase::invalidSignalLink;
+    std::string forcedSignature;
+    try
+    {
+      AnyValue args = msg.value(withSignature ? registerEventWithSignatureSignature
+                                              : registerEventSignature, socket);
+      event = args[1].to<unsigned int>();
+      link = args[2].to<SignalLink>();
+      if (withSignature)
+        forcedSignature = args[3].to<std::string>();
+    }
+    catch (const std::exception& e)
+    {
+      qiLogVerbose() << "Invalid event registration " << msg.address() << ": " << e.what();
+      return false;
+    }
+
+    // The properties also have a signal with their id.
+    const MetaSignal* signal = _object.metaObject().signal(event);
+    const Signature signature = signal ? signal->parametersSignature() : Signature();
+    // The conversions to a forced signature and the objects need the payload
+    // to be decoded.
+    if (!signature.isValid() || mayContainObjects(signature)
+        || (!forcedSignature.empty() && forcedSignature != signature.toString()))
+      return false;
+
+    Future<SignalLink> registered;
+    {
+      boost::mutex::scoped_lock lock(_mutex);
+      auto it = _events.find(event);
+      if (it == _events.end())
+      {
+        EventRoute route;
+        route.remoteLink = nextRemoteLink++;
+        route.registered = _object.async<SignalLink>("registerEvent", _remote->service(), event,
+                                                     route.remoteLink);
+        it = _events.emplace(event, std::move(route)).first;
+      }
+      it->second.subscribers.insert(Subscriber(socket, link));
+      registered = it->second.registered;
+    }
+
+    boost::weak_ptr<ServiceForwarder> weakSelf = shared_from_this();
+    registered.then([=](Future<SignalLink> result) {
+      Message answer(Message::Type_Reply, msg.address());
+      if (result.hasError())
+      {
+        if (auto self = weakSelf.lock())
+        {
+          boost::mutex::scoped_lock lock(self->_mutex);
+          auto it = self->_events.find(event);
+          if (it != self->_events.end() && it->second.registered == result)
+            self->_events.erase(it);
+        }
+        answer.setType(Message::Type_Error);
+        answer.setError(result.error());
+      }
+      else
+        answer.setValue(AnyReference::from(link), "L");
+      reply(socket, msg, std::move(answer));
+    });
+    return true;
+  }
+
+  bool ServiceForwarder::unregisterEvent(const Message& msg, const MessageSocketPtr& socket)
+  {
+    unsigned int event = 0;
+    SignalLink link = SignalBase::invalidSignalLink;
+    try
+    {
+      AnyValue args = msg.value(unregisterEventSignature, socket);
+      event = args[1].to<unsigned int>();
+      link = args[2].to<SignalLink>();
+    }
+    catch (const std::exception& e)
+    {
+      qiLogVerbose() << "Invalid event unregistration " << msg.address() << ": " << e.what();
+      return false;
+    }
+
+    boost::optional<SignalLink> unusedLink;
+    {
+      boost::mutex::scoped_lock lock(_mutex);
+      auto it = _events.find(event);
+      if (it == _events.end() || !it->second.subscribers.count(Subscriber(socket, link)))
+        return false;
+      unusedLink = removeSubscriberUnsync(event, Subscriber(socket, link));
+    }
+    if (unusedLink)
+      unregisterRemoteEvent(event, *unusedLink);
+    reply(socket, msg, Message(Message::Type_Reply, msg.address()));
+    return true;
+  }
+
+  boost::optional<SignalLink> ServiceForwarder::removeSubscriberUnsync(unsigned int event,
+                                                                      const Subscriber& subscriber)
+  {
+    auto it = _events.find(event);
+    if (it == _events.end())
+      return {};
+    it->second.subscribers.erase(subscriber);
+    if (!it->second.subscribers.empty())
+      return {};
+    const SignalLink remoteLink = it->second.remoteLink;
+    _events.erase(it);
+    return remoteLink;
+  }
+
+  void ServiceForwarder::unregisterRemoteEvent(unsigned int event, SignalLink remoteLink)
+  {
+    _object.async<void>("unregisterEvent", _remote->service(), event, remoteLink)
+        .then([=](Future<void> f) {
+          if (f.hasError())
+            qiLogVerbose() << "Cannot unregister event " << event << ": " << f.error();
+        });
+  }
+
+  bool ServiceForwarder::onRemoteEvent(const Message& msg)
+  {
+    std::vector<Subscriber> subscribers;
+    {
+      boost::mutex::scoped_lock lock(_mutex);
+      auto it = _events.find(msg.event());
+      if (msg.object() != Message::GenericObject_Main || it == _events.end())
+        return false;
+      subscribers.assign(it->second.subscribers.begin(), it->second.subscribers.end());
+    }
+    // One message per subscription, as the service itself would send, all
+    // sharing a single copy of the payload received.
+    const auto payload = sharedPayload(msg);
+    for (const auto& subscriber: subscribers)
+    {
+      Message event(Message::Type_Event,
+                    MessageAddress(Message::Header::newMessageId(), _serviceId, msg.object(),
+                                   msg.event()));
+      event.setFlags(msg.flags());
+      event.setPriority(msg.priority());
+      event.setSharedBuffer(payload);
+      subscriber.first->send(std::move(event));
+    }
+    return true;
+  }
+
+  void ServiceForwarder::onSocketDisconnected(qi::MessageSocketPtr socket, std::string error)
+  {
+    std::vector<std::pair<unsigned int, SignalLink>> unusedLinks;
+    {
+      boost::mutex::scoped_lock lock(_mutex);
+      for (auto it = _calls.begin(); it != _calls.end();)
+      {
+        if (it->first.first == socket)
+          it = _calls.erase(it);
+        else
+          ++it;
+      }
+      std::vector<std::pair<unsigned int, Subscriber>> removed;
+      for (const auto& event: _events)
+        for (const auto& subscriber: event.second.subscribers)
+          if (subscriber.first == socket)
+            removed.emplace_back(event.first, subscriber);
+      for (const auto& r: removed)
+        if (auto link = removeSubscriberUnsync(r.first, r.second))
+          unusedLinks.emplace_back(r.first, *link);
+    }
+    for (const auto& link: unusedLinks)
+      unregisterRemoteEvent(link.first, link.second);
+    _fallback->onSocketDisconnected(socket, std::move(error));
+  }
+
+  void ServiceForwarder::onSocketResumed(qi::MessageSocketPtr previous, qi::MessageSocketPtr socket)
+  {
+    {
+      boost::mutex::scoped_lock lock(_mutex);
+      for (auto it = _calls.begin(); it != _calls.end();)
+      {
+        if (it->first.first == previous)
+          it = _calls.erase(it);
+        else
+          ++it;
+      }
+      for (auto& event: _events)
+      {
+        std::set<Subscriber> subscribers;
+        for (const auto& subscriber: event.second.subscribers)
+          subscribers.insert(subscriber.first == previous ? Subscriber(socket, subscriber.second) : subscriber);
+        event.second.subscribers.swap(subscribers);
+      }
+    }
+    _fallback->onSocketResumed(std::move(previous), std::move(socket));
+  }
+}
@@ -0,0 +1,89 @@
+#pragma once
+/*
+**  Copyright (C) 2018 SoftBank Robotics Europe
+**  See COPYING for the license
+*/
+
+#ifndef _SRC_SERVICEFORWARDER_HPP_
+#define _SRC_SERVICEFORWARDER_HPP_
+
+#include <map>
+#include <set>
+#include <string>
+#include <utility>
+
+#include <boost/enable_shared_from_this.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include "boundobject.hpp"
+#include "remoteobject_p.hpp"
+
+namespace qi
+{
+  /**
+   * @brief Bound object of a service mirrored from another session, which
+   * forwards the messages of the clients to the remote service without
+   * decoding their payload.
+   * @internal
+   *
+   * Only the headers are rewritten: the service, and the id of the calls so
+   * that they are unique on the socket to the remote service. The messages
+   * which may carry object references, which target sub-objects, or which
+   * call the special functions other than the event registrations are given
+   * to the bound object of the mirrored object, which decodes them.
+   *
+   * An event is registered once on the remote service for all the clients,
+   * and each event received is sent to them with the same payload.
+   */
+  class ServiceForwarder
+    : public BoundObject
+    , public boost::enable_shared_from_this<ServiceForwarder>
+  {
+  public:
+    /// Returns `fallback` if `object` is not a remote object.
+    static BoundAnyObject wrap(unsigned int serviceId, AnyObject object, BoundAnyObject fallback);
+
+    ServiceForwarder(unsigned int serviceId, AnyObject object, RemoteObject* remote,
+                     BoundAnyObject fallback);
+    ~ServiceForwarder();
+
+    void onMessage(const qi::Message& msg, MessageSocketPtr socket) override;
+    void onSocketDisconnected(qi::MessageSocketPtr socket, std::string error) override;
+    void onSocketResumed(qi::MessageSocketPtr previous, qi::MessageSocketPtr socket) override;
+
+  private:
+    using Subscriber = std::pair<MessageSocketPtr, SignalLink>;
+    struct EventRoute
+    {
+      std::set<Subscriber> subscribers;
+      SignalLink remoteLink;
+      Future<SignalLink> registered;
+    };
+    // (client socket, id of the call on that socket) -> id of the forwarded call
+    using CallKey = std::pair<MessageSocketPtr, unsigned int>;
+
+    bool isForwardable(const Message& msg) const;
+    bool forwardCall(const Message& msg, const MessageSocketPtr& socket);
+    bool forwardCancel(const Message& msg, const MessageSocketPtr& socket);
+    bool registerEvent(const Message& msg, const MessageSocketPtr& socket);
+    bool unregisterEvent(const Message& msg, const MessageSocketPtr& socket);
+    bool onRemoteEvent(const Message& msg);
+    // Returns the link of the event to unregister on the remote service, if
+    // it has no subscriber left.
+    boost::optional<SignalLink> removeSubscriberUnsync(unsigned int event, const Subscriber& subscriber);
+    void unregisterRemoteEvent(unsigned int event, SignalLink remoteLink);
+
+    static void reply(const MessageSocketPtr& socket, const Message& request, Message reply);
+
+    const unsigned int _serviceId;
+    const AnyObject _object;
+    RemoteObject* const _remote;
+    const BoundAnyObject _fallback;
+
+    boost::mutex _mutex;
+    std::map<CallKey, unsigned int> _calls;
+    std::map<unsigned int, EventRoute> _events;
+  };
+}
+
+#endif  // _SRC_SERVICEFORWARDER_HPP_
@@ -0,0 +1,139 @@
+/*
+**  Copyright (C) 2018 SoftBank Robotics Europe
+**  See COPYING for the license
+*/
+
+#include "serviceinfocache.hpp"
+
+namespace qi
+{
+  void ServiceInfoCache::reset()
+  {
+    boost::mutex::scoped_lock lock(_mutex);
+    _services.clear();
+    _removed.clear();
+    ++_generation;
+    _fetches = 0;
+    _stats.synchronized = false;
+  }
+
+  unsigned int ServiceInfoCache::beginFetch()
+  {
+    boost::mutex::scoped_lock lock(_mutex);
+    ++_fetches;
+    return _generation;
+  }
+
+  void ServiceInfoCache::endFetch(unsigned int generation, const ServiceInfo* info)
+  {
+    boost::mutex::scoped_lock lock(_mutex);
+    if (generation != _generation)
+      return;
+    if (info)
+    {
+      ++_stats.fetches;
+      storeUnsync(*info);
+    }
+    endFetchUnsync();
+  }
+
+  void ServiceInfoCache::synchronize(unsigned int generation, const std::vector<ServiceInfo>& services)
+  {
+    boost::mutex::scoped_lock lock(_mutex);
+    if (generation != _generation)
+      return;
+    for (const auto& info : services)
+      storeUnsync(info);
+    _stats.synchronized = true;
+    ++_stats.synchronizations;
+    endFetchUnsync();
+  }
+
+  bool ServiceInfoCache::add(unsigned int serviceId, const std::string& name)
+  {
+    boost::mutex::scoped_lock lock(_mutex);
+    const auto it = _services.find(name);
+    if (it != _services.end() && it->second.serviceId >= serviceId)
+      return false;
+    _services[name] = Entry{ serviceId, {} };
+    return true;
+  }
+
+  void ServiceInfoCache::remove(unsigned int serviceId, const std::string& name)
+  {
+    boost::mutex::scoped_lock lock(_mutex);
+    if (_fetches != 0)
+      _removed.insert(serviceId);
+    const auto it = _services.find(name);
+    if (it != _services.end() && it->second.serviceId <= serviceId)
+      _services.erase(it);
+  }
+
+  void ServiceInfoCache::invalidate(const std::string& name)
+  {
+    boost::mutex::scoped_lock lock(_mutex);
+    const auto it = _services.find(name);
+    if (it == _services.end() || !it->second.info)
+      return;
+    it->second.info = boost::none;
+    ++_stats.invalidations;
+  }
+
+  boost::optional<ServiceInfo> ServiceInfoCache::find(const std::string& name)
+  {
+    boost::mutex::scoped_lock lock(_mutex);
+    if (!_stats.synchronized)
+      return {};
+    const auto it = _services.find(name);
+    if (it == _services.end() || !it->second.info)
+    {
+      ++_stats.misses;
+      return {};
+    }
+    ++_stats.hits;
+    return it->second.info;
+  }
+
+  boost::optional<bool> ServiceInfoCache::contains(const std::string& name) const
+  {
+    boost::mutex::scoped_lock lock(_mutex);
+    if (!_stats.synchronized)
+      return {};
+    return _services.find(name) != _services.end();
+  }
+
+  ServiceCacheStats ServiceInfoCache::stats() const
+  {
+    boost::mutex::scoped_lock lock(_mutex);
+    ServiceCacheStats stats = _stats;
+    stats.services = _services.size();
+    for (const auto& entry : _services)
+      if (!entry.second.info)
+        ++stats.pending;
+    return stats;
+  }
+
+  void ServiceInfoCache::storeUnsync(const ServiceInfo& info)
+  {
+    if (_removed.count(info.serviceId()))
+    {
+      ++_stats.discarded;
+      return;
+    }
+    const auto it = _services.find(info.name());
+    if (it == _services.end())
+      _services[info.name()] = Entry{ info.serviceId(), info };
+    else if (it->second.serviceId < info.serviceId())
+      it->second = Entry{ info.serviceId(), info };
+    else if (it->second.serviceId == info.serviceId())
+      it->second.info = info;
+    else
+      ++_stats.discarded;
+  }
+
+  void ServiceInfoCache::endFetchUnsync()
+  {
+    if (_fetches != 0 && --_fetches == 0)
+      _removed.clear();
+  }
+}
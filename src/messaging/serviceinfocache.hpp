@@ -0,0 +1,88 @@
+#pragma once
+/*
+**  Copyright (C) 2018 SoftBank Robotics Europe
+**  See COPYING for the license
+*/
+
+#ifndef _SRC_SERVICEINFOCACHE_HPP_
+#define _SRC_SERVICEINFOCACHE_HPP_
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <boost/optional.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include <qi/messaging/servicecache.hpp>
+#include <qi/messaging/serviceinfo.hpp>
+
+namespace qi
+{
+  /**
+   * @brief Copy of the service infos of a service directory, kept up to date
+   * with its events.
+   * @internal
+   *
+   * The infos are fetched asynchronously, so an info may arrive after the
+   * event removing its service. The ids of the services removed while fetches
+   * are in progress are remembered to drop such infos. Service ids are never
+   * reused by a service directory.
+   *
+   * The fetches are identified by the generation of the cache at their
+   * beginning, and those begun before a reset are ignored.
+   */
+  class ServiceInfoCache
+  {
+  public:
+    /// Forgets all the services, and the fetches in progress.
+    void reset();
+
+    /// Returns the generation to give back when the fetch is over.
+    unsigned int beginFetch();
+
+    /// Stores `info` if set, and its service was not removed meanwhile.
+    void endFetch(unsigned int generation, const ServiceInfo* info);
+
+    /// Stores the infos of all the services, and marks the cache as
+    /// synchronized.
+    void synchronize(unsigned int generation, const std::vector<ServiceInfo>& services);
+
+    /// Records a service whose info is yet to be fetched. Returns false if it
+    /// is already known.
+    bool add(unsigned int serviceId, const std::string& name);
+    void remove(unsigned int serviceId, const std::string& name);
+
+    /// Drops the info of the service, so that it is fetched again.
+    void invalidate(const std::string& name);
+
+    /// Returns the info of the service if the cache has it.
+    boost::optional<ServiceInfo> find(const std::string& name);
+
+    /// Returns whether the service is registered, if the cache is synchronized.
+    boost::optional<bool> contains(const std::string& name) const;
+
+    ServiceCacheStats stats() const;
+
+  private:
+    struct Entry
+    {
+      unsigned int serviceId;
+      boost::optional<ServiceInfo> info;
+    };
+
+    void storeUnsync(const ServiceInfo& info);
+    void endFetchUnsync();
+
+    mutable boost::mutex _mutex;
+    std::map<std::string, Entry> _services;
+    // Services removed while fetches are in progress.
+    std::set<unsigned int> _removed;
+    unsigned int _generation = 0;
+    unsigned int _fetches = 0;
+    ServiceCacheStats _stats;
+  };
+}
+
+#endif  // _SRC_SERVICEINFOCACHE_HPP_
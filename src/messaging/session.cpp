@@ -52,6 +52,17 @@ namespace qi {
     _sdClient.serviceRemoved.connect(session->serviceUnregistered);
     setAuthProviderFactory(AuthProviderFactoryPtr(new NullAuthProviderFactory));
     setClientAuthenticatorFactory(ClientAuthenticatorFactoryPtr(new NullClientAuthenticatorFactory));
+    _serverObject.setCallSchedulingConfig(_config.callScheduling);
+    _serviceHandler.setSocketPoolConfig(_config.socketPool);
+    _serverObject.setSessionResumptionConfig(_config.sessionResumption);
+    _serviceHandler.setSessionResumptionConfig(_config.sessionResumption);
+    _sdClient.setServiceCacheConfig(_config.serviceCache);
+    MessageSocketConfig socketConfig;
+    socketConfig.tlsOffload = _config.tlsOffload;
+    socketConfig.tuning = _config.socketTuning;
+    _serverObject.setSocketConfig(socketConfig);
+    _serviceHandler.setSocketConfig(socketConfig);
+    _sdClient.setSocketConfig(socketConfig);
   }
 
   SessionPrivate::~SessionPrivate()
@@ -410,6 +421,12 @@ namespace qi {
   }
 
   qi::FutureSync<unsigned int> Session::registerService(const std::string &name, qi::AnyObject obj)
+  {
+    return SessionPrivate::registerService(*this, name, obj, BoundObjectWrapper());
+  }
+
+  qi::Future<unsigned int> SessionPrivate::registerService(Session& session, const std::string& name,
+                                                           qi::AnyObject obj, BoundObjectWrapper wrapBound)
   {
     if (!obj)
       return makeFutureError<unsigned int>("registerService: Object is empty");
@@ -417,14 +434,33 @@ namespace qi {
     // Compatibility: Exposing a service means the session must be a server (it must be listening
     // for connections). A better solution would probably be to raise an error, but since a lot of
     // code relies on the following behavior, we're keeping it that way.
+    if (session.endpoints().empty())
+      session.listen();
+
+    if (!session.isConnected()) {
+      return qi::makeFutureError< unsigned int >("Session not connected.");
+    }
+
+    return session._p->_serverObject.registerService(name, obj, std::move(wrapBound));
+  }
+
+  qi::FutureSync<std::vector<unsigned int>> Session::registerServices(
+      const std::vector<std::pair<std::string, qi::AnyObject>>& services)
+  {
+    for (const auto& service : services)
+      if (!service.second)
+        return makeFutureError<std::vector<unsigned int>>(
+            "registerServices: Object of service \"" + service.first + "\" is empty");
+
+    // Compatibility: same as registerService.
     if (endpoints().empty())
       listen();
 
     if (!isConnected()) {
-      return qi::makeFutureError< unsigned int >("Session not connected.");
+      return qi::makeFutureError<std::vector<unsigned int>>("Session not connected.");
     }
 
-    return _p->_serverObject.registerService(name, obj);
+    return _p->_serverObject.registerServices(services);
   }
 
   qi::FutureSync<void> Session::unregisterService(unsigned int idx)
@@ -436,6 +472,16 @@ namespace qi {
     return _p->_serverObject.unregisterService(idx);
   }
 
+  CallSchedulingStats Session::callSchedulingStats(unsigned int serviceId) const
+  {
+    return _p->_serverObject.callSchedulingStats(serviceId);
+  }
+
+  ServiceCacheStats Session::serviceCacheStats() const
+  {
+    return _p->_sdClient.serviceCacheStats();
+  }
+
   std::vector<qi::Url> Session::endpoints() const
   {
     return _p->_serverObject.endpoints();
@@ -526,6 +572,16 @@ namespace qi {
     auto futureService = futureLink.andThen(track(
           [privSession, servicename](qi::SignalLink) mutable
           {
+            // The service cache knows the services without asking the
+            // service directory. If it does not know this one yet, the
+            // signal will tell.
+            if (const auto known = privSession->_sdClient.hasService(servicename))
+            {
+              if (*known)
+                return qi::Future<ServiceInfo>(ServiceInfo());
+              return qi::makeFutureError<ServiceInfo>("Service not registered yet");
+            }
+
             // Do not use the `Session_Service::service` method that returns an object for the
             // service, instead use the service directory client `service` method that returns the
             // service info. The reason behind this choice is that to construct a full object, we
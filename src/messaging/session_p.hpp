@@ -37,6 +37,11 @@ namespace qi {
     void setAuthProviderFactory(AuthProviderFactoryPtr factory);
     void setClientAuthenticatorFactory(ClientAuthenticatorFactoryPtr factory);
 
+    /// Session::registerService, with the object bound for the service
+    /// replaced by `wrapBound` if it is set.
+    static qi::Future<unsigned int> registerService(Session& session, const std::string& name,
+                                                    qi::AnyObject obj, BoundObjectWrapper wrapBound);
+
   public:
     void listenStandaloneCont(qi::Promise<void> p, qi::Future<void> f);
     // internal, add sd socket to socket cache
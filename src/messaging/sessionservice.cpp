@@ -10,10 +10,12 @@
 #endif
 
 #include <ka/scoped.hpp>
+#include <qi/async.hpp>
 #include "sessionservice.hpp"
 #include "servicedirectoryclient.hpp"
 #include "objectregistrar.hpp"
 #include "remoteobject_p.hpp"
+#include "socketresumption.hpp"
 
 qiLogCategory("qimessaging.sessionservice");
 
@@ -57,7 +59,27 @@ namespace qi {
     _authFactory = factory;
   }
 
+  void Session_Service::setSocketPoolConfig(const SocketPoolConfig& config)
+  {
+    _socketPool = config;
+    _socketCache->setSocketPool(config.socketsPerEndpoint, track([=](MessageSocketPtr socket) {
+      return authenticateSocket(socket, CapabilityMap()).andThen([](const CapabilityMap&) {});
+    }, this));
+  }
+
+  void Session_Service::setSessionResumptionConfig(const SessionResumptionConfig& config)
+  {
+    _sessionResumption = config;
+  }
+
+  void Session_Service::setSocketConfig(const MessageSocketConfig& config)
+  {
+    _socketConfig = config;
+    _socketCache->setSocketConfig(config);
+  }
+
   void Session_Service::close() {
+    ++_closeCount;
     //cleanup all RemoteObject
     //they are not valid anymore after this function
     boost::recursive_mutex::scoped_lock sl(_remoteObjectsMutex);
@@ -124,6 +146,74 @@ namespace qi {
       msg.setValue(sock->localCapabilities(), typeOf<CapabilityMap>()->signature());
       sock->send(std::move(msg));
     }
+
+    // Outcome of an authentication message received by the client.
+    struct AuthenticationStep
+    {
+      enum class Status { Pending, Done, Failed };
+
+      Status status;
+      // When done, the data of the last authentication reply.
+      CapabilityMap data;
+      // When failed, the reason.
+      std::string error;
+    };
+
+    // Handles `data`, received on `sock` while it is authenticated, and sends
+    // the next authentication message if the authentication goes on.
+    static AuthenticationStep authenticationStep(const MessageSocket::SocketEventData& data,
+                                                 const MessageSocketPtr& sock,
+                                                 const ClientAuthenticatorPtr& auth, bool enforceAuth)
+    {
+      using Status = AuthenticationStep::Status;
+      static const std::string cmsig = typeOf<CapabilityMap>()->signature().toString();
+      if (data.which() == MessageSocket::Event_Error)
+        return { Status::Failed, {}, boost::get<std::string>(data) };
+
+      // The messages come from the remote end and may not decode.
+      try
+      {
+        const Message& msg = boost::get<const Message&>(data);
+        const unsigned int function = msg.function();
+        const bool failure = msg.type() == Message::Type_Error
+            || msg.service() != Message::Service_Server
+            || function != Message::ServerFunction_Authenticate;
+        if (failure)
+        {
+          if (enforceAuth)
+          {
+            std::stringstream error;
+            if (msg.type() == Message::Type_Error)
+              error << "Error while authenticating: " << msg.value("s", sock).to<std::string>();
+            else
+              error << "Expected a message for function #" << Message::ServerFunction_Authenticate << " (authentication), received a message for function " << function;
+            return { Status::Failed, {}, error.str() };
+          }
+          sendCapabilities(sock);
+          return { Status::Done, {}, {} };
+        }
+
+        CapabilityMap authData = msg.value(cmsig, sock).to<CapabilityMap>();
+        CapabilityMap::iterator authStateIt = authData.find(AuthProvider::State_Key);
+        if (authStateIt == authData.end() || authStateIt->second.to<unsigned int>() < AuthProvider::State_Error
+            || authStateIt->second.to<unsigned int>() > AuthProvider::State_Done)
+          return { Status::Failed, {}, "Invalid authentication state token." };
+        if (authStateIt->second.to<unsigned int>() == AuthProvider::State_Done)
+          return { Status::Done, std::move(authData), {} };
+
+        Message authMsg;
+        authMsg.setService(Message::Service_Server);
+        authMsg.setType(Message::Type_Call);
+        authMsg.setValue(auth->processAuth(authData), cmsig);
+        authMsg.setFunction(Message::ServerFunction_Authenticate);
+        sock->send(std::move(authMsg));
+        return { Status::Pending, {}, {} };
+      }
+      catch (const std::exception& e)
+      {
+        return { Status::Failed, {}, std::string("Error while authenticating: ") + e.what() };
+      }
+    }
   } // session_service_private
 
   // Bind the 'set in error' of the promise and request removal.
@@ -167,7 +257,7 @@ namespace qi {
 
   void Session_Service::onAuthentication(const MessageSocket::SocketEventData& data, long requestId, MessageSocketPtr socket, ClientAuthenticatorPtr auth, SignalSubscriberPtr old)
   {
-    static const std::string cmsig = typeOf<CapabilityMap>()->signature().toString();
+    using Status = session_service_private::AuthenticationStep::Status;
     boost::recursive_mutex::scoped_lock sl(_requestsMutex);
     ServiceRequest *sr = serviceRequest(requestId);
     if (!sr)
@@ -181,94 +271,181 @@ namespace qi {
     bool mustSetPromise = true;
     auto _ = ka::scoped(SetPromiseInError{*this, promise, mustSetPromise, requestId});
 
-    if (data.which() == MessageSocket::Event_Error)
+    const auto step = session_service_private::authenticationStep(data, socket, auth, _enforceAuth);
+    if (step.status == Status::Pending)
     {
-      if (old)
-        socket->socketEvent.disconnect(*old);
-      setErrorAndRemoveRequest(sr->promise, boost::get<std::string>(data), requestId);
+      mustSetPromise = false;
+      return;
+    }
+    if (old)
+      socket->socketEvent.disconnectAsync(*old);
+    if (step.status == Status::Failed)
+    {
+      qiLogVerbose() << step.error;
+      setErrorAndRemoveRequest(sr->promise, step.error, requestId);
       return;
     }
 
-    const Message& msg = boost::get<const Message&>(data);
-    int function = msg.function();
-    bool failure = msg.type() == Message::Type_Error
-        || msg.service() != Message::Service_Server
-        || function != Message::ServerFunction_Authenticate;
+    QI_ASSERT_NULL(sr->remoteObject);
+    // Before the remote object is attached to the socket, so that it knows
+    // it may be resumed.
+    const auto tokenIt = step.data.find(sessionresumption::tokenKey);
+    if (tokenIt != step.data.end())
+      watchResumption(socket, sr->serviceInfo.machineId(), tokenIt->second.toString());
+
+    sr->remoteObject = boost::make_shared<RemoteObject>(sr->serviceInfo.serviceId(), socket, sr->serviceInfo.objectUid());
+
+    //ask the remoteObject to fetch the metaObject
+    qi::Future<void> metaObjFut = sr->remoteObject->fetchMetaObject();
+    qiLogVerbose() << "Fetching metaobject for requestId = " << requestId;
+    metaObjFut.connect(track(
+      boost::bind(
+        &Session_Service::onRemoteObjectComplete, this, _1, requestId),
+      this));
+    mustSetPromise = false;
+  }
 
-    if (failure)
+  Future<CapabilityMap> Session_Service::authenticateSocket(MessageSocketPtr socket, const CapabilityMap& extraData)
+  {
+    static const std::string cmsig = typeOf<CapabilityMap>()->signature().toString();
+    Promise<CapabilityMap> promise;
+    ClientAuthenticatorPtr authenticator = _authFactory->newAuthenticator();
+    const bool enforceAuth = _enforceAuth;
+    const boost::weak_ptr<MessageSocket> weakSocket = socket;
+    const auto link = boost::make_shared<SignalLink>(SignalBase::invalidSignalLink);
+
+    // Same steps as onAuthentication, without a service request.
+    *link = socket->socketEvent.connect([=](const MessageSocket::SocketEventData& data) mutable {
+      using Status = session_service_private::AuthenticationStep::Status;
+      const MessageSocketPtr sock = weakSocket.lock();
+      if (!sock || promise.future().isFinished())
+        return;
+      const auto step = session_service_private::authenticationStep(data, sock, authenticator, enforceAuth);
+      if (step.status == Status::Pending)
+        return;
+      sock->socketEvent.disconnectAsync(*link);
+      if (step.status == Status::Failed)
+        promise.setError(step.error);
+      else
+        promise.setValue(step.data);
+    });
+
+    CapabilityMap socketCaps;
+    MessageSocketPtr sdSocket = _sdClient->socket();
+    if (sdSocket)
     {
-      if (old)
-        socket->socketEvent.disconnect(*old);
-      if (_enforceAuth)
+      socketCaps = sdSocket->localCapabilities();
+      socket->advertiseCapabilities(socketCaps);
+    }
+    for (const auto& data: authenticator->initialAuthData())
+      socketCaps[AuthProvider::UserAuthPrefix + data.first] = data.second;
+    for (const auto& data: extraData)
+      socketCaps[data.first] = data.second;
+
+    Message msgCapabilities;
+    msgCapabilities.setFunction(Message::ServerFunction_Authenticate);
+    msgCapabilities.setService(Message::Service_Server);
+    msgCapabilities.setType(Message::Type_Call);
+    msgCapabilities.setValue(socketCaps, cmsig);
+    socket->send(std::move(msgCapabilities));
+    return promise.future();
+  }
+
+  void Session_Service::watchResumption(const MessageSocketPtr& socket, const std::string& machineId,
+                                        const std::string& token)
+  {
+    Promise<MessageSocketPtr> promise;
+    socket->setResumption(promise.future());
+    const Url url = socket->url();
+    const unsigned int closeCount = _closeCount.load();
+    // If the session service is destroyed first, the promise is broken and
+    // the remote objects stay closed.
+    socket->disconnected.connect(track([=](const std::string& reason) mutable {
+      if (closeCount != _closeCount.load())
       {
-        std::stringstream error;
-        if (msg.type() == Message::Type_Error)
-          error << "Error while authenticating: " << msg.value("s", socket).to<std::string>();
-        else
-          error << "Expected a message for function #" << Message::ServerFunction_Authenticate << " (authentication), received a message for function " << function;
-        setErrorAndRemoveRequest(sr->promise, error.str(), requestId);
+        promise.setValue(MessageSocketPtr());
+        return;
       }
-      else
+      qiLogVerbose() << "Socket to " << url.str() << " lost (" << reason << "), resuming its session.";
+      resumeSocket(promise, url, machineId, token, SteadyClock::now() + _sessionResumption.gracePeriod,
+                   qi::MilliSeconds(50), closeCount);
+    }, this));
+  }
+
+  void Session_Service::resumeSocket(Promise<MessageSocketPtr> promise, const Url& url, const std::string& machineId,
+                                     const std::string& token, SteadyClock::time_point deadline,
+                                     qi::Duration retryDelay, unsigned int closeCount)
+  {
+    const MessageSocketPtr socket = makeMessageSocket(url.protocol(), getNetworkEventLoop(), _socketConfig);
+    CapabilityMap resumeData;
+    resumeData[sessionresumption::tokenKey] = AnyValue::from(token);
+    resumeData[capabilityname::sessionResumption] = AnyValue::from(true);
+    Future<void> connecting = socket->connect(url);
+    Future<CapabilityMap> resuming = connecting.andThen(track([=](void*) {
+      return authenticateSocket(socket, resumeData);
+    }, this)).unwrap();
+
+    resuming.connect(track([=](Future<CapabilityMap> result) mutable {
+      if (result.hasValue())
       {
-        session_service_private::sendCapabilities(socket);
-        qi::Future<void> metaObjFut;
-        QI_ASSERT_NULL(sr->remoteObject);
-        sr->remoteObject.reset(new qi::RemoteObject(sr->serviceInfo.serviceId(), socket, sr->serviceInfo.objectUid()));
-
-        // TODO 40203: check if it's possible that the following future is never set.
-        metaObjFut = sr->remoteObject->fetchMetaObject();
-
-        qiLogVerbose() << "Fetching metaobject (1) for requestId = " << requestId;
-        metaObjFut.connect(track(
-          boost::bind(
-            &Session_Service::onRemoteObjectComplete, this, _1, requestId),
-          this));
-        mustSetPromise = false;
+        const CapabilityMap& data = result.value();
+        const auto resumedIt = data.find(sessionresumption::resumedKey);
+        if (resumedIt != data.end() && resumedIt->second.to<bool>())
+        {
+          qiLogVerbose() << "Session on " << url.str() << " resumed.";
+          const auto tokenIt = data.find(sessionresumption::tokenKey);
+          if (tokenIt != data.end())
+            watchResumption(socket, machineId, tokenIt->second.toString());
+          _socketCache->insert(machineId, url, socket);
+          promise.setValue(socket);
+          return;
+        }
+        // The remote end is back but it released our state.
+        qiLogVerbose() << "Session on " << url.str() << " expired.";
+        socket->disconnect().async();
+        promise.setValue(MessageSocketPtr());
+        return;
       }
-      return;
-    }
-
-    CapabilityMap authData = msg.value(typeOf<CapabilityMap>()->signature(), socket).to<CapabilityMap>();
 
-    CapabilityMap::iterator authStateIt = authData.find(AuthProvider::State_Key);
+      socket->disconnect().async();
+      if (closeCount != _closeCount.load() || SteadyClock::now() + retryDelay >= deadline)
+      {
+        qiLogVerbose() << "Could not resume the session on " << url.str() << ": "
+                       << (result.hasError() ? result.error() : std::string("canceled"));
+        promise.setValue(MessageSocketPtr());
+        return;
+      }
+      const qi::Duration nextDelay = std::min<qi::Duration>(retryDelay * 2, qi::Seconds(1));
+      asyncDelay(track([=] {
+        resumeSocket(promise, url, machineId, token, deadline, nextDelay, closeCount);
+      }, this), retryDelay);
+    }, this));
+  }
 
-    if (authStateIt == authData.end() || authStateIt->second.to<unsigned int>() < AuthProvider::State_Error
-        || authStateIt->second.to<unsigned int>() > AuthProvider::State_Done)
-    {
-      if (old)
-        socket->socketEvent.disconnect(*old);
-      const std::string error = "Invalid authentication state token.";
-      setErrorAndRemoveRequest(sr->promise, error, requestId);
-      qiLogInfo() << error;
+  void Session_Service::addPooledSockets(RemoteObjectPtr remoteObject)
+  {
+    const MessageSocketPtr socket = remoteObject->transportSocket();
+    if (!socket)
       return;
-    }
-    if (authData[AuthProvider::State_Key].to<unsigned int>() == AuthProvider::State_Done)
+    const auto pooledSockets = _socketCache->pooledSockets(socket);
+    const std::size_t threshold = _socketPool.bulkPayloadThreshold;
+    const boost::weak_ptr<RemoteObject> weakRemoteObject = remoteObject;
+    const unsigned int serviceId = remoteObject->service();
+    for (std::size_t i = 0; i < pooledSockets.size(); ++i)
     {
-      qi::Future<void> metaObjFut;
-      if (old)
-        socket->socketEvent.disconnectAsync(*old);
-      QI_ASSERT_NULL(sr->remoteObject);
-
-      sr->remoteObject = boost::make_shared<RemoteObject>(sr->serviceInfo.serviceId(), socket, sr->serviceInfo.objectUid());
-
-      //ask the remoteObject to fetch the metaObject
-      metaObjFut = sr->remoteObject->fetchMetaObject();
-      qiLogVerbose() << "Fetching metaobject (2) for requestId = " << requestId;
-      metaObjFut.connect(track(
-        boost::bind(
-          &Session_Service::onRemoteObjectComplete, this, _1, requestId),
-        this));
-      mustSetPromise = false;
-      return;
+      // The last socket of the pool is the bulk lane.
+      const bool bulk = threshold != 0 && i + 1 == pooledSockets.size();
+      Future<MessageSocketPtr> pooledSocket = pooledSockets[i];
+      pooledSocket.connect([=](Future<MessageSocketPtr> fut) {
+        if (fut.hasError())
+        {
+          qiLogVerbose() << "Pooled socket unavailable for service #" << serviceId << ": " << fut.error();
+          return;
+        }
+        if (RemoteObjectPtr remote = weakRemoteObject.lock())
+          remote->addPooledSocket(fut.value(), bulk, threshold);
+      });
     }
-
-    CapabilityMap nextData = auth->processAuth(authData);
-    Message authMsg;
-    authMsg.setService(Message::Service_Server);
-    authMsg.setType(Message::Type_Call);
-    authMsg.setValue(nextData, cmsig);
-    authMsg.setFunction(Message::ServerFunction_Authenticate);
-    socket->send(std::move(authMsg));
   }
 
   void Session_Service::onTransportSocketResult(qi::Future<MessageSocketPtr> value, long requestId)
@@ -291,6 +468,8 @@ namespace qi {
 
       if (value.hasError())
       {
+        // The endpoints may have changed since the service info was cached.
+        _sdClient->invalidateService(sr->serviceInfo.name());
         setErrorAndRemoveRequest(sr->promise, value.error(), requestId);
         return;
       }
@@ -351,6 +530,8 @@ namespace qi {
       socket->advertiseCapabilities(socketCaps);
     }
     socketCaps.insert(authCaps.begin(), authCaps.end());
+    if (_sessionResumption.enabled())
+      socketCaps[capabilityname::sessionResumption] = AnyValue::from(true);
     msgCapabilities.setValue(socketCaps, typeOf<CapabilityMap>()->signature());
     socket->send(std::move(msgCapabilities));
   }
@@ -391,6 +572,8 @@ namespace qi {
 
         // If this throws, the promise will be set because of the `scoped` object.
         addService(sr->serviceInfo.name(), o);
+        if (sr->fromSocketCache && _socketPool.enabled())
+          addPooledSockets(sr->remoteObject);
         sr->promise.setValue(o);
       }
     }
@@ -529,6 +712,7 @@ namespace qi {
           setErrorAndRemoveRequest(*promise, ss.str(), *requestId);
           return;
         }
+        sr->fromSocketCache = true;
 
         if (protocol != "")
         {
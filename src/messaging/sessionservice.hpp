@@ -9,10 +9,12 @@
 
 #include <qi/future.hpp>
 #include <qi/trackable.hpp>
+#include <atomic>
 #include <string>
 #include <boost/thread/mutex.hpp>
 #include <qi/session.hpp>
 #include <qi/atomic.hpp>
+#include <qi/messaging/socketpool.hpp>
 #include "remoteobject_p.hpp"
 #include "transportsocketcache.hpp"
 #include "messagesocket.hpp"
@@ -42,6 +44,8 @@ namespace qi {
     qi::Promise<qi::AnyObject>    promise;
     ServiceInfo                   serviceInfo;
     RemoteObjectPtr               remoteObject;
+    // True if the socket of the remote object comes from the socket cache.
+    bool                          fromSocketCache = false;
   };
 
   class Session_Service: public qi::Trackable<Session_Service>
@@ -59,6 +63,10 @@ namespace qi {
     void removeService(const std::string &service);
 
     void setClientAuthenticatorFactory(ClientAuthenticatorFactoryPtr factory);
+    void setSocketPoolConfig(const SocketPoolConfig& config);
+    void setSessionResumptionConfig(const SessionResumptionConfig& config);
+    /// Applies to the sockets opened afterwards.
+    void setSocketConfig(const MessageSocketConfig& config);
 
   private:
     //FutureInterface
@@ -68,6 +76,19 @@ namespace qi {
     //ServiceDirectoryClient
     void onAuthentication(const MessageSocket::SocketEventData& data, long requestId, MessageSocketPtr socket, ClientAuthenticatorPtr auth, SignalSubscriberPtr old);
 
+    // Authenticates a socket which is not used by a service request yet,
+    // and returns the data of the last authentication reply.
+    Future<CapabilityMap> authenticateSocket(MessageSocketPtr socket, const CapabilityMap& extraData);
+    void addPooledSockets(RemoteObjectPtr remoteObject);
+
+    // Resumes the session of `socket` with `token` if the socket is lost.
+    void watchResumption(const MessageSocketPtr& socket, const std::string& machineId, const std::string& token);
+    // Reconnects to `url` until the session is resumed or `deadline` has
+    // passed, and sets `promise` to the new socket, or to null on failure.
+    void resumeSocket(Promise<MessageSocketPtr> promise, const Url& url, const std::string& machineId,
+                      const std::string& token, SteadyClock::time_point deadline, qi::Duration retryDelay,
+                      unsigned int closeCount);
+
     ServiceRequest *serviceRequest(long requestId);
     void            removeRequest(long requestId);
 
@@ -103,6 +124,11 @@ namespace qi {
     ObjectRegistrar        *_server;    //not owned by us
     ClientAuthenticatorFactoryPtr      _authFactory;
     bool _enforceAuth;
+    SocketPoolConfig _socketPool;
+    SessionResumptionConfig _sessionResumption;
+    MessageSocketConfig _socketConfig;
+    // Incremented by close(), so that the sessions are not resumed afterwards.
+    std::atomic<unsigned int> _closeCount{0};
     friend inline void sessionServiceWaitBarrier(Session_Service* ptr);
 
     void setErrorAndRemoveRequest(
@@ -279,6 +279,8 @@ namespace qi { namespace sock {
 ///   && SslContext<N>: NetSslContext
 ///   && SslSocket<N>: NetSslSocket
 ///   && SocketOptionNoDelay<N>: NetOption
+///   && SocketOptionSendBufferSize<N>: NetOption
+///   && SocketOptionReceiveBufferSize<N>: NetOption
 ///   && AcceptOptionReuseAddress<N>: NetOption
 ///   && ErrorCode<N>: NetErrorCode
 ///   && IoService<N>: NetIoService
@@ -290,9 +292,14 @@ namespace qi { namespace sock {
 ///           const void* const_data,
 ///           std::size_t maxSizeInBytes,
 ///           SslSocket<N> sslSocketLValue,
+///           SslContext<N> sslContextLValue,
 ///           NetTransferHandler transferHandler, the following is valid:
 ///        IoService<N>& io = N::defaultIoService();
 ///        Regular v = N::sslVerifyNone();
+///     && N::enableTlsOffload(sslContextLValue)
+///     && bool b = N::offloadTlsSend(sslSocketLValue)
+///     && bool b = N::setSocketBusyPoll(handle, unsigned(i))
+///     && N::setSocketCork(handle, b)
 ///     && N::setSocketNativeOptionsWindows(handle, i) if compiled on Windows
 ///     && N::setSocketNativeOptionsLinux(handle, i) if compiled on Linux
 ///     && N::setSocketNativeOptionsMacOs(handle) if compiled on MacOs
@@ -219,6 +219,11 @@ namespace qi
       {
         return _impl->send(std::forward<Msg>(msg), ssl, onSent);
       }
+      /// See `SendMessageEnqueue`.
+      void setCorkBatches(bool cork)
+      {
+        _impl->_sendMsg.setCorkBatches(cork);
+      }
       Future<SyncConnectedResultPtr<N, S>> complete() const
       {
         return _impl->_completePromise->future();
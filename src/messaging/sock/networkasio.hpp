@@ -22,6 +22,8 @@ namespace qi { namespace sock {
     using ssl_context_type = boost::asio::ssl::context;
     using ssl_socket_type = boost::asio::ssl::stream<boost::asio::ip::tcp::socket>;
     using socket_option_no_delay_type = boost::asio::ip::tcp::no_delay;
+    using socket_option_send_buffer_size_type = boost::asio::socket_base::send_buffer_size;
+    using socket_option_receive_buffer_size_type = boost::asio::socket_base::receive_buffer_size;
     using accept_option_reuse_address_type = boost::asio::ip::tcp::acceptor::reuse_address;
     using error_code_type = boost::system::error_code;
     using io_service_type = boost::asio::io_service;
@@ -42,6 +44,33 @@ namespace qi { namespace sock {
     /// Warning: On some platform (e.g. MacOs), timeout might be ignored.
     static void setSocketNativeOptions(boost::asio::ip::tcp::socket::native_handle_type h, int timeoutInSeconds);
 
+    /// Busy polls the device queue for `us` microseconds on reads (SO_BUSY_POLL).
+    /// Returns false if the platform does not allow it.
+    static bool setSocketBusyPoll(boost::asio::ip::tcp::socket::native_handle_type h, unsigned int us);
+
+    /// Holds the partial segments of the data sent until uncorked (TCP_CORK).
+    /// Does nothing if the platform does not allow it.
+    static void setSocketCork(boost::asio::ip::tcp::socket::native_handle_type h, bool corked);
+
+    /// Restricts the context to the TLS versions whose encryption can be
+    /// offloaded, see `offloadTlsSend`.
+    static void enableTlsOffload(ssl_context_type& context);
+
+    /// Hands the encryption of the data sent on `s`, whose handshake is done,
+    /// to the kernel. The data must then be written in clear to the next
+    /// layer of `s`, while the data received is still read from `s`.
+    /// Returns false, leaving `s` as is, if the platform or the negotiated
+    /// cipher do not allow it.
+    ///
+    /// NetSslSocket S
+    template<typename S>
+    static bool offloadTlsSend(S& s)
+    {
+      return offloadTlsSend(s.native_handle(), s.lowest_layer().native_handle());
+    }
+    static bool offloadTlsSend(ssl_socket_type::native_handle_type ssl,
+                               boost::asio::ip::tcp::socket::native_handle_type h);
+
     /// NetSslSocket S, MutableBufferSequence B, ReadHandler H
     template<typename S, typename B, typename H>
     static void async_read(S& s, const B& b, H h)
@@ -6,6 +6,7 @@
 #include <ka/typetraits.hpp>
 #include <ka/macroregular.hpp>
 #include <qi/log.hpp>
+#include <qi/messaging/sockettuning.hpp>
 #include "concept.hpp"
 #include "traits.hpp"
 #include "socketptr.hpp"
@@ -102,6 +103,43 @@ namespace qi { namespace sock {
     }
     N::setSocketNativeOptions(handle, static_cast<int>(ajustedTimeout));
   }
+
+  /// Set the options of `tuning` on a connected socket. The options failing to
+  /// be set are logged and skipped.
+  ///
+  /// Corking is not a socket option but is done by the sender of the
+  /// messages, see `SendMessageEnqueue`.
+  ///
+  /// Network N,
+  /// With NetSslSocket S:
+  ///   S is compatible with N,
+  ///   Mutable<S> S
+  template<typename N, typename S>
+  void setSocketTuning(S socket, const SocketTuning& tuning)
+  {
+    auto& lowest = (*socket).lowest_layer();
+    try
+    {
+      lowest.set_option(sock::SocketOptionNoDelay<N>{tuning.noDelay});
+    }
+    catch (const std::exception& e)
+    {
+      qiLogWarning(logCategory()) << "Can't set no_delay option: " << e.what();
+    }
+    try
+    {
+      if (tuning.sendBufferSize > 0)
+        lowest.set_option(sock::SocketOptionSendBufferSize<N>{tuning.sendBufferSize});
+      if (tuning.receiveBufferSize > 0)
+        lowest.set_option(sock::SocketOptionReceiveBufferSize<N>{tuning.receiveBufferSize});
+    }
+    catch (const std::exception& e)
+    {
+      qiLogWarning(logCategory()) << "Can't set buffer size option: " << e.what();
+    }
+    if (tuning.busyPollMicroseconds > 0)
+      N::setSocketBusyPoll(lowest.native_handle(), tuning.busyPollMicroseconds);
+  }
 }} // namespace qi::sock
 
 #endif // _QI_SOCK_OPTION_HPP
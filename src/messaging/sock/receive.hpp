@@ -283,10 +283,7 @@ namespace qi { namespace sock {
         receiveErrorAndMaybeReceiveNext(messageSize<ErrorCode<N>>());
         return;
       }
-      auto messageBuffer = msg.extractBuffer();
-      void* ptr = messageBuffer.reserve(payload);
-      auto buffer = N::buffer(ptr, payload);
-      msg.setBuffer(std::move(messageBuffer));
+      auto buffer = N::buffer(msg.reservePayload(payload), payload);
       auto readData = lifetimeTransfo([=](ErrorCode<N> error, std::size_t /*len*/) {
         onReadData<N>(error, socket, ptrMsg, ssl, maxPayload, onReceive, lifetimeTransfo, syncTransfo);
       });
@@ -346,6 +343,14 @@ namespace qi { namespace sock {
   /// The only role of this type is to store a message.
   /// The message receiving is handled by `receiveMessage`.
   ///
+  /// The message is recycled to receive the next one in place: its buffer
+  /// keeps its memory, so that once a payload of a given size has been
+  /// received, receiving as large messages does not allocate. Payloads of at
+  /// most 768 bytes are stored inline in the buffer. The memory of
+  /// payloads larger than `maxKeptPayload` is released. This only covers the
+  /// receiving: the handler, which dispatches the message to the signals of
+  /// the socket, may still allocate.
+  ///
   /// Warning: The instance must remain alive until the handler is called.
   /// You can provide a procedure transformation (`lifetimeTransfo`) that will
   /// wrap the handler and handle the expired instance case.
@@ -373,6 +378,8 @@ namespace qi { namespace sock {
   {
     Message _msg;
   public:
+    static const std::size_t maxKeptPayload = 1024 * 1024;
+
   // QuasiRegular:
     ReceiveMessageContinuous() = default;
     // TODO: uncomment when messages are comparable, or when latest GCC is fixed.
@@ -399,9 +406,7 @@ namespace qi { namespace sock {
           if (onReceive(erc, m))
           {
             // Must continue.
-            auto dataBuffer = _msg.extractBuffer();
-            dataBuffer.clear();
-            _msg.setBuffer(std::move(dataBuffer));
+            _msg.recycle(maxKeptPayload);
             return {&_msg}; // We reuse the message memory to receive the next message.
           }
           return {};
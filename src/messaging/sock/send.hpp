@@ -223,7 +223,9 @@ namespace qi { namespace sock {
   /// The role of this type is to provide a queue for messages.
   /// You can therefore ask to send a message before the current one has
   /// actually been sent. The message will simply be enqueued and sent ASAP.
-  /// The messages will be sent in a FIFO manner.
+  /// The messages are sent by decreasing priority, and in a FIFO manner among
+  /// the messages of the same priority. A message of higher priority never
+  /// interrupts the one being sent.
   /// Sending messages is thread-safe.
   ///
   /// The actual sending is done by `sendMessage`.
@@ -235,6 +237,10 @@ namespace qi { namespace sock {
   /// the queue is not cleared. Next time you send a message, it will
   /// be enqueued and the queue processing will continue from where it had stopped.
   ///
+  /// If corking batches is enabled, the socket is corked while messages are
+  /// queued behind the one being sent, and uncorked once the queue is empty,
+  /// so that a burst of small messages is sent in full segments.
+  ///
   /// Warning: The instance must remain alive until messages are sent.
   /// You can provide a procedure transformation (`lifetimeTransfo`) that will
   /// wrap any internal callback and handle the expired instance case.
@@ -250,12 +256,21 @@ namespace qi { namespace sock {
     using ReadableMessage = std::list<Message>::const_iterator;
     SendMessageEnqueue()
       : _sending{false}
+      , _corkBatches{false}
+      , _corked{false}
     {
     }
     explicit SendMessageEnqueue(const S& socket)
       : _socket(socket)
       , _sending{false}
+      , _corkBatches{false}
+      , _corked{false}
+    {
+    }
+    void setCorkBatches(bool cork)
     {
+      std::lock_guard<std::mutex> lock{_sendMutex};
+      _corkBatches = cork;
     }
   // Procedure:
     /// Message Msg,
@@ -268,21 +283,55 @@ namespace qi { namespace sock {
     void operator()(Msg&&, SslEnabled, Proc onSent = Proc{true},
       const F0& lifetimeTransfo = F0{}, const F1& syncTransfo = F1{});
   private:
+    using I = std::list<Message>::iterator;
+    /// Returns where to insert a message of the given priority: after the
+    /// messages of the same or higher priority, and after the message being
+    /// sent.
+    I insertPositionUnsync(MessagePriority priority);
+    void setCorkedUnsync(bool corked);
+
     S _socket;
     /// A list is used because we need the iterators not to be invalidated by
     /// insertions at begin or end, which is not the case with deque.
     /// See [23.3.3.4 deque modifiers].
     std::list<Message> _sendQueue;
     bool _sending;
+    bool _corkBatches;
+    bool _corked;
     std::mutex _sendMutex;
   };
 
+  template<typename N, typename S>
+  void SendMessageEnqueue<N, S>::setCorkedUnsync(bool corked)
+  {
+    if (_corked == corked)
+      return;
+    N::setSocketCork((*_socket).lowest_layer().native_handle(), corked);
+    _corked = corked;
+  }
+
+  template<typename N, typename S>
+  auto SendMessageEnqueue<N, S>::insertPositionUnsync(MessagePriority priority) -> I
+  {
+    // Most messages have the same priority, they are appended.
+    if (_sendQueue.empty() || _sendQueue.back().priority() >= priority)
+      return _sendQueue.end();
+    auto it = _sendQueue.begin();
+    if (_sending)
+      ++it;
+    while (it != _sendQueue.end() && it->priority() >= priority)
+      ++it;
+    return it;
+  }
+
   // Lemma SendMessageEnqueue.0:
   //  If a message is already being sent, the message is queued without
   //  invalidating the one being sent.
   // Proof:
   //  All messages are put in the send queue, including the one being sent.
   //  The send queue is a list so adding an element doesn't invalidate the other ones.
+  //  The message being sent stays at the front of the queue, as
+  //  insertPositionUnsync never returns a position before it.
   template<typename N, typename S>
   template<typename Msg, typename Proc, typename F0, typename F1>
   void SendMessageEnqueue<N, S>::operator()(Msg&& msg, SslEnabled ssl, Proc onSent,
@@ -294,7 +343,8 @@ namespace qi { namespace sock {
     bool mustStartSendLoop = false;
     {
       std::lock_guard<std::mutex> lock{_sendMutex};
-      _sendQueue.emplace_back(std::forward<Msg>(msg));
+      const auto position = insertPositionUnsync(msg.priority());
+      _sendQueue.emplace(position, std::forward<Msg>(msg));
       itMsg = _sendQueue.begin();
       // We've just added a message to the queue, so if we are not currently sending,
       // we must (re)start the send loop.
@@ -347,9 +397,13 @@ namespace qi { namespace sock {
                 if (!_sending)
                   qiLogWarning(logCategory()) << "SendMessageEnqueue: sending flag should be raised.";
                 _sending = false;
+                // Flushes what the batch left in the last partial segment.
+                setCorkedUnsync(false);
                 return;
               }
               itNext = _sendQueue.begin();
+              if (_corkBatches)
+                setCorkedUnsync(true);
             });
             mustContinue = onSent(erc, itSent);
           }
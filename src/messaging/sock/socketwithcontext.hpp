@@ -28,6 +28,7 @@ namespace qi { namespace sock {
     using handshake_type = HandshakeSide<socket_t>;
     using lowest_layer_type = Lowest<socket_t>;
     using next_layer_type = typename socket_t::next_layer_type;
+    using native_handle_type = typename socket_t::native_handle_type;
 
     SocketWithContext(io_service_t& io, const SslContextPtr<N>& ctx)
       : context(ctx)
@@ -61,6 +62,11 @@ namespace qi { namespace sock {
       return socket.next_layer();
     }
 
+    native_handle_type native_handle()
+    {
+      return socket.native_handle();
+    }
+
   // Custom:
     template<typename T, typename U>
     void async_read_some(const T& buffers, const U& handler)
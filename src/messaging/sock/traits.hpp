@@ -24,6 +24,12 @@ namespace qi { namespace sock {
   template<typename N>
   using SocketOptionNoDelay = typename N::socket_option_no_delay_type;
 
+  template<typename N>
+  using SocketOptionSendBufferSize = typename N::socket_option_send_buffer_size_type;
+
+  template<typename N>
+  using SocketOptionReceiveBufferSize = typename N::socket_option_receive_buffer_size_type;
+
   template<typename N>
   using AcceptOptionReuseAddress = typename N::accept_option_reuse_address_type;
 
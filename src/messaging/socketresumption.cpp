@@ -0,0 +1,131 @@
+/*
+**  Copyright (C) 2018 SoftBank Robotics Europe
+**  See COPYING for the license
+*/
+
+#include <openssl/crypto.h>
+#include <openssl/rand.h>
+
+#include <qi/log.hpp>
+
+#include "socketresumption.hpp"
+
+qiLogCategory("qimessaging.socketresumption");
+
+namespace qi
+{
+  namespace sessionresumption
+  {
+    char const * const tokenKey   = "ResumptionToken";
+    char const * const resumedKey = "ResumptionDone";
+  }
+
+  namespace
+  {
+    const std::size_t tokenBytes = 32;
+  }
+
+  boost::optional<std::string> SocketResumption::issue(const MessageSocketPtr& socket)
+  {
+    unsigned char bytes[tokenBytes];
+    if (RAND_bytes(bytes, sizeof(bytes)) != 1)
+    {
+      qiLogWarning() << "Cannot generate a resumption token, the session will not be resumable.";
+      return {};
+    }
+    static const char hexDigits[] = "0123456789abcdef";
+    std::string token;
+    token.reserve(2 * sizeof(bytes));
+    for (const auto byte: bytes)
+    {
+      token.push_back(hexDigits[byte >> 4]);
+      token.push_back(hexDigits[byte & 0xF]);
+    }
+    OPENSSL_cleanse(bytes, sizeof(bytes));
+    boost::mutex::scoped_lock lock(_mutex);
+    _tokens[socket.get()] = token;
+    return token;
+  }
+
+  std::map<std::string, SocketResumption::Suspended>::iterator
+  SocketResumption::findSuspended(const std::string& token)
+  {
+    auto found = _suspended.end();
+    if (token.size() != 2 * tokenBytes)
+      return found;
+    for (auto it = _suspended.begin(); it != _suspended.end(); ++it)
+    {
+      if (it->first.size() == token.size()
+          && CRYPTO_memcmp(it->first.data(), token.data(), token.size()) == 0)
+        found = it;
+    }
+    return found;
+  }
+
+  boost::optional<std::string> SocketResumption::suspend(const MessageSocketPtr& socket)
+  {
+    boost::mutex::scoped_lock lock(_mutex);
+    const auto it = _tokens.find(socket.get());
+    if (it == _tokens.end())
+      return {};
+    const std::string token = it->second;
+    _tokens.erase(it);
+    _suspended[token] = Suspended{ socket, Future<void>() };
+    return token;
+  }
+
+  void SocketResumption::setExpiry(const std::string& token, Future<void> expiry)
+  {
+    {
+      boost::mutex::scoped_lock lock(_mutex);
+      const auto it = findSuspended(token);
+      if (it != _suspended.end())
+      {
+        it->second.expiry = std::move(expiry);
+        return;
+      }
+    }
+    // Already resumed.
+    expiry.cancel();
+  }
+
+  MessageSocketPtr SocketResumption::expire(const std::string& token)
+  {
+    boost::mutex::scoped_lock lock(_mutex);
+    const auto it = findSuspended(token);
+    if (it == _suspended.end())
+      return {};
+    const MessageSocketPtr socket = it->second.socket;
+    _suspended.erase(it);
+    return socket;
+  }
+
+  MessageSocketPtr SocketResumption::resume(const std::string& token)
+  {
+    Suspended suspended;
+    {
+      boost::mutex::scoped_lock lock(_mutex);
+      const auto it = findSuspended(token);
+      if (it == _suspended.end())
+        return {};
+      suspended = std::move(it->second);
+      _suspended.erase(it);
+    }
+    if (suspended.expiry.isValid())
+      suspended.expiry.cancel();
+    return suspended.socket;
+  }
+
+  void SocketResumption::clear()
+  {
+    std::map<std::string, Suspended> suspended;
+    {
+      boost::mutex::scoped_lock lock(_mutex);
+      _tokens.clear();
+      std::swap(suspended, _suspended);
+    }
+    for (auto& pair: suspended)
+      if (pair.second.expiry.isValid())
+        pair.second.expiry.cancel();
+  }
+}
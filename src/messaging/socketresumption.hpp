@@ -0,0 +1,84 @@
+#pragma once
+/*
+**  Copyright (C) 2018 SoftBank Robotics Europe
+**  See COPYING for the license
+*/
+
+#ifndef _SRC_SOCKETRESUMPTION_HPP_
+#define _SRC_SOCKETRESUMPTION_HPP_
+
+#include <map>
+#include <string>
+
+#include <boost/optional.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include <qi/future.hpp>
+
+#include "messagesocket.hpp"
+
+namespace qi
+{
+  namespace sessionresumption
+  {
+    // Authentication data: the token given by a server to a client on
+    // success, and the one sent back by a client to resume its session.
+    extern char const * const tokenKey;
+    // Authentication reply: true if the session of the token was resumed.
+    extern char const * const resumedKey;
+  }
+
+  /**
+   * @brief Resumption tokens of the clients of a server, and the sockets of
+   * those which were disconnected and may still resume their session.
+   * @internal
+   *
+   * A suspended socket is only kept to identify the state of the bound
+   * objects, which is moved to the new socket of the client on resumption,
+   * or released by the server once the grace period has elapsed.
+   */
+  class SocketResumption
+  {
+  public:
+    /// Returns a new token for `socket`, which replaces its previous one.
+    /// The token lets a socket skip the authentication: it is made of 256
+    /// random bits from a cryptographically secure generator. Returns none
+    /// if the generator failed.
+    boost::optional<std::string> issue(const MessageSocketPtr& socket);
+
+    /// Suspends `socket`, and returns its token if it has one. Otherwise
+    /// the socket cannot be resumed.
+    boost::optional<std::string> suspend(const MessageSocketPtr& socket);
+
+    /// Canceled if the socket of `token` is resumed.
+    void setExpiry(const std::string& token, Future<void> expiry);
+
+    /// Forgets the socket of `token`, and returns it unless it was resumed
+    /// meanwhile.
+    MessageSocketPtr expire(const std::string& token);
+
+    /// Forgets the socket of `token`, and returns it if it was suspended.
+    MessageSocketPtr resume(const std::string& token);
+
+    /// Forgets all the tokens.
+    void clear();
+
+  private:
+    struct Suspended
+    {
+      MessageSocketPtr socket;
+      Future<void> expiry;
+    };
+
+    // Compares `token` to every token suspended in constant time, so that
+    // the time taken does not tell how much of a token was guessed.
+    std::map<std::string, Suspended>::iterator findSuspended(const std::string& token);
+
+    boost::mutex _mutex;
+    // Tokens of the connected sockets.
+    std::map<MessageSocket*, std::string> _tokens;
+    std::map<std::string, Suspended> _suspended;
+  };
+}
+
+#endif  // _SRC_SOCKETRESUMPTION_HPP_
@@ -16,6 +16,10 @@ namespace qi
     char const * const messageFlags          = "MessageFlags";
     char const * const remoteCancelableCalls = "RemoteCancelableCalls";
     char const * const objectPtrUid          = "ObjectPtrUID";
+    char const * const lazyMetaObject        = "LazyMetaObject";
+    char const * const callBatch             = "CallBatch";
+    char const * const messagePriorities     = "MessagePriorities";
+    char const * const sessionResumption     = "SessionResumption";
   }
 
 
@@ -114,6 +118,9 @@ static void initCapabilities()
   , { capabilityname::metaObjectCache      , AnyValue::from(false) }
   , { capabilityname::remoteCancelableCalls, AnyValue::from(true)  }
   , { capabilityname::objectPtrUid         , AnyValue::from(true)  }
+  , { capabilityname::lazyMetaObject       , AnyValue::from(false) }
+  , { capabilityname::callBatch            , AnyValue::from(true)  }
+  , { capabilityname::messagePriorities    , AnyValue::from(true)  }
   };
 
   _defaultCapabilities = new CapabilityMap(defaultCaps);
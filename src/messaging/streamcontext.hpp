@@ -37,6 +37,22 @@ using CapabilityMap = std::map<std::string, AnyValue>;
 
     // Capability: Objects allow unique identification using Ptruid/ObjectUid.
     QI_API extern char const * const objectPtrUid;
+
+    // Capability: remote end answers metaObjectIndex calls, so that the
+    // method index of a service can be fetched without its descriptions.
+    // Off by default: the MetaObjects of the remote objects then lack their
+    // descriptions until a metaObject call, which matters to the processes
+    // listing or relaying them.
+    QI_API extern char const * const lazyMetaObject;
+    // Capability: remote end handles Type_CallBatch messages.
+    QI_API extern char const * const callBatch;
+    // Capability: remote end handles the priority flags and the Type_Chunk
+    // messages.
+    QI_API extern char const * const messagePriorities;
+    // Capability: sent by a client in its authentication data to ask for a
+    // token with which it may resume its session if its socket is lost.
+    // Not advertised by default.
+    QI_API extern char const * const sessionResumption;
   }
 
 /** Store contextual data associated to one point-to-point point transport.
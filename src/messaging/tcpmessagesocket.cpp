@@ -1,7 +1,14 @@
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <memory>
 #include <string>
 #include <boost/asio/ip/tcp.hpp>
+#include <boost/core/ignore_unused.hpp>
 #include <boost/lexical_cast.hpp>
 #include <boost/optional.hpp>
+#include <openssl/evp.h>
+#include <openssl/ssl.h>
 #include <qi/os.hpp>
 #include <qi/log.hpp>
 #include "sock/networkasio.hpp"
@@ -14,6 +21,16 @@
 # include <linux/in.h> // for  IPPROTO_TCP
 #endif
 
+// Kernel TLS needs the headers of Linux 4.13, and the TLS 1.2 key derivation
+// of OpenSSL 1.1.1.
+#if BOOST_OS_LINUX && !BOOST_OS_ANDROID && OPENSSL_VERSION_NUMBER >= 0x10101000L && defined(__has_include)
+# if __has_include(<linux/tls.h>)
+#  include <linux/tls.h>
+#  include <openssl/kdf.h>
+#  define QI_KERNEL_TLS 1
+# endif
+#endif
+
 qiLogCategory(qi::sock::logCategory());
 
 #if BOOST_OS_WINDOWS
@@ -108,6 +125,79 @@ static void setSocketNativeOptionsMacOs(
 }
 #endif
 
+#if QI_KERNEL_TLS
+namespace
+{
+  // Missing from the headers of the older C libraries.
+  const int qiTcpUlp = 31;
+  const int qiSolTls = 282;
+
+  /// Derives the key block of a TLS 1.2 connection (RFC 5246, section 6.3).
+  bool deriveTls12KeyBlock(SSL* ssl, const EVP_MD* md, unsigned char* keyBlock, std::size_t size)
+  {
+    unsigned char clientRandom[SSL3_RANDOM_SIZE];
+    unsigned char serverRandom[SSL3_RANDOM_SIZE];
+    if (SSL_get_client_random(ssl, clientRandom, sizeof(clientRandom)) != sizeof(clientRandom)
+        || SSL_get_server_random(ssl, serverRandom, sizeof(serverRandom)) != sizeof(serverRandom))
+      return false;
+    unsigned char masterKey[SSL_MAX_MASTER_KEY_LENGTH];
+    const std::size_t masterKeySize =
+        SSL_SESSION_get_master_key(SSL_get_session(ssl), masterKey, sizeof(masterKey));
+    static const char label[] = "key expansion";
+    std::unique_ptr<EVP_PKEY_CTX, void (*)(EVP_PKEY_CTX*)> ctx(
+        EVP_PKEY_CTX_new_id(EVP_PKEY_TLS1_PRF, nullptr), &EVP_PKEY_CTX_free);
+    std::size_t derived = size;
+    const bool ok = ctx && masterKeySize != 0
+        && EVP_PKEY_derive_init(ctx.get()) > 0
+        && EVP_PKEY_CTX_set_tls1_prf_md(ctx.get(), md) > 0
+        && EVP_PKEY_CTX_set1_tls1_prf_secret(ctx.get(), masterKey, static_cast<int>(masterKeySize)) > 0
+        && EVP_PKEY_CTX_add1_tls1_prf_seed(ctx.get(), reinterpret_cast<const unsigned char*>(label), static_cast<int>(sizeof(label) - 1)) > 0
+        && EVP_PKEY_CTX_add1_tls1_prf_seed(ctx.get(), serverRandom, static_cast<int>(sizeof(serverRandom))) > 0
+        && EVP_PKEY_CTX_add1_tls1_prf_seed(ctx.get(), clientRandom, static_cast<int>(sizeof(clientRandom))) > 0
+        && EVP_PKEY_derive(ctx.get(), keyBlock, &derived) > 0
+        && derived == size;
+    OPENSSL_cleanse(masterKey, sizeof(masterKey));
+    return ok;
+  }
+
+  /// CryptoInfo is one of the tls12_crypto_info_aes_gcm_* of linux/tls.h.
+  template<typename CryptoInfo>
+  bool setKernelTlsSendAesGcm(SSL* ssl, int socket, unsigned short cipherType, const EVP_MD* md)
+  {
+    CryptoInfo info;
+    std::memset(&info, 0, sizeof(info));
+    const std::size_t keySize = sizeof(info.key);
+    const std::size_t saltSize = sizeof(info.salt);
+    // The AEAD ciphers have no MAC key: the block is made of the client and
+    // server write keys, then of their implicit nonces.
+    unsigned char keyBlock[2 * (sizeof(info.key) + sizeof(info.salt))];
+    if (!deriveTls12KeyBlock(ssl, md, keyBlock, sizeof(keyBlock)))
+    {
+      qiLogVerbose() << "Kernel TLS: failed to derive the keys of the connection.";
+      return false;
+    }
+    const bool server = SSL_is_server(ssl) == 1;
+    info.info.version = TLS_1_2_VERSION;
+    info.info.cipher_type = cipherType;
+    std::memcpy(info.key, keyBlock + (server ? keySize : 0), keySize);
+    std::memcpy(info.salt, keyBlock + 2 * keySize + (server ? saltSize : 0), saltSize);
+    // Since the keys were changed, each side sent a single record: its
+    // Finished message. This only holds because the offload happens right
+    // after the handshake, before any application record is written through
+    // OpenSSL. The explicit nonces are the sequence numbers of the records,
+    // as advised by RFC 5288.
+    info.rec_seq[sizeof(info.rec_seq) - 1] = 1;
+    std::memcpy(info.iv, info.rec_seq, sizeof(info.iv));
+    OPENSSL_cleanse(keyBlock, sizeof(keyBlock));
+    const bool ok = setsockopt(socket, qiSolTls, TLS_TX, &info, sizeof(info)) == 0;
+    if (!ok)
+      qiLogVerbose() << "Kernel TLS: failed to set the send keys: " << strerror(errno);
+    OPENSSL_cleanse(&info, sizeof(info));
+    return ok;
+  }
+}
+#endif
+
 namespace qi {
 
   /// Use the environment variable QI_TCP_PING_TIMEOUT, if set.
@@ -157,4 +247,83 @@ namespace qi { namespace sock {
   #endif
   }
 
+  bool NetworkAsio::setSocketBusyPoll(
+    boost::asio::ip::tcp::socket::native_handle_type socketNativeHandle, unsigned int us)
+  {
+  #if BOOST_OS_LINUX || BOOST_OS_ANDROID
+    // Missing from the headers of the older C libraries.
+    static const int qiSoBusyPoll = 46;
+    const int optval = static_cast<int>(std::min(us, static_cast<unsigned int>(std::numeric_limits<int>::max())));
+    if (setsockopt(socketNativeHandle, SOL_SOCKET, qiSoBusyPoll, &optval, sizeof(optval)) < 0)
+    {
+      qiLogWarning() << "Failed to set SO_BUSY_POLL: " << strerror(errno);
+      return false;
+    }
+    return true;
+  #else
+    boost::ignore_unused(socketNativeHandle, us);
+    return false;
+  #endif
+  }
+
+  void NetworkAsio::setSocketCork(
+    boost::asio::ip::tcp::socket::native_handle_type socketNativeHandle, bool corked)
+  {
+  #if BOOST_OS_LINUX || BOOST_OS_ANDROID
+    const int optval = corked ? 1 : 0;
+    if (setsockopt(socketNativeHandle, IPPROTO_TCP, TCP_CORK, &optval, sizeof(optval)) < 0)
+      qiLogVerbose() << "Failed to set TCP_CORK: " << strerror(errno);
+  #else
+    boost::ignore_unused(socketNativeHandle, corked);
+  #endif
+  }
+
+  void NetworkAsio::enableTlsOffload(ssl_context_type& context)
+  {
+  #if QI_KERNEL_TLS
+  # if defined(SSL_OP_NO_TLSv1_3)
+    context.set_options(ssl_context_type::no_tlsv1_3);
+  # endif
+    // Once the kernel encrypts the records sent, OpenSSL must not send any:
+    // they would not have the sequence numbers of the kernel.
+    SSL_CTX_set_options(context.native_handle(), SSL_OP_NO_RENEGOTIATION);
+  #else
+    boost::ignore_unused(context);
+  #endif
+  }
+
+  bool NetworkAsio::offloadTlsSend(ssl_socket_type::native_handle_type ssl,
+                                   boost::asio::ip::tcp::socket::native_handle_type h)
+  {
+  #if QI_KERNEL_TLS
+    const SSL_CIPHER* cipher = SSL_get_current_cipher(ssl);
+    const int cipherNid = cipher ? SSL_CIPHER_get_cipher_nid(cipher) : NID_undef;
+    const EVP_MD* md = cipher ? SSL_CIPHER_get_handshake_digest(cipher) : nullptr;
+    if (SSL_version(ssl) != TLS1_2_VERSION || !md
+        || (cipherNid != NID_aes_128_gcm && cipherNid != NID_aes_256_gcm))
+    {
+      qiLogVerbose() << "Kernel TLS: unsupported protocol or cipher: " << SSL_get_version(ssl)
+                     << " " << (cipher ? SSL_CIPHER_get_name(cipher) : "none");
+      return false;
+    }
+    if (!(SSL_get_options(ssl) & SSL_OP_NO_RENEGOTIATION))
+    {
+      qiLogVerbose() << "Kernel TLS: the renegotiations of the connection are not disabled.";
+      return false;
+    }
+    // Without keys, the TLS layer of the kernel lets the data through as is.
+    if (setsockopt(h, SOL_TCP, qiTcpUlp, "tls", sizeof("tls")) != 0)
+    {
+      qiLogVerbose() << "Kernel TLS is not available: " << strerror(errno);
+      return false;
+    }
+    return cipherNid == NID_aes_128_gcm
+        ? setKernelTlsSendAesGcm<tls12_crypto_info_aes_gcm_128>(ssl, h, TLS_CIPHER_AES_GCM_128, md)
+        : setKernelTlsSendAesGcm<tls12_crypto_info_aes_gcm_256>(ssl, h, TLS_CIPHER_AES_GCM_256, md);
+  #else
+    boost::ignore_unused(ssl, h);
+    return false;
+  #endif
+  }
+
 }} // namespace qi::sock
@@ -12,10 +12,13 @@
 #include <boost/optional.hpp>
 #include <boost/predef.h>
 #include <boost/thread/synchronized_value.hpp>
+#include <map>
+#include <vector>
 #include <ka/typetraits.hpp>
 #include <ka/macroregular.hpp>
 #include <qi/url.hpp>
 #include "message.hpp"
+#include "messagechunk.hpp"
 #include "messagedispatcher.hpp"
 #include "messagesocket.hpp"
 #include "sock/disconnectedstate.hpp"
@@ -61,6 +64,8 @@ namespace qi {
     const int defaultTimeoutInSeconds = 30;
   } // namespace sock
 
+  std::uint32_t getMaxPayloadFromEnv(std::uint32_t defaultValue = std::numeric_limits<std::uint32_t>::max());
+
   /// A socket to send and receive messages.
   ///
   /// # General kinematics
@@ -198,7 +203,7 @@ namespace qi {
     /// On server side, if SSL is enabled the connection only consist of the handshake.
     /// On client side (null socket), the connection is done by calling `connect(Url)`.
     explicit TcpMessageSocket(sock::IoService<N>& io = N::defaultIoService(),
-      sock::SslEnabled ssl = {false}, SocketPtr = {});
+      sock::SslEnabled ssl = {false}, SocketPtr = {}, const MessageSocketConfig& config = {});
 
     virtual ~TcpMessageSocket();
 
@@ -214,6 +219,7 @@ namespace qi {
     /// Returns `true` if we could ask to send the message.
     /// One failure case (return `false`) is when the socket is not connected.
     bool send(Message msg) override;
+    bool send(Message msg, OnSent onSent) override;
 
     Status status() const override
     {
@@ -238,6 +244,14 @@ namespace qi {
       return {};
     }
     bool ensureReading() override;
+
+    /// True if the encryption of the messages sent is done by the kernel,
+    /// see TlsOffloadConfig.
+    bool tlsSendOffloaded() const
+    {
+      boost::recursive_mutex::scoped_lock lock(_stateMutex);
+      return *_ssl && !*_sendSsl;
+    }
   private:
     /// Handler called when we transition outside the connected state.
     /// It is the responsibility of the caller to ensure the socket pointer is
@@ -265,7 +279,11 @@ namespace qi {
     };
 
     const sock::SslEnabled _ssl;
+    const MessageSocketConfig _config;
     mutable boost::recursive_mutex _stateMutex;
+    // Whether the messages are sent through the TLS layer of `S`, which is not
+    // the case once the kernel encrypts them.
+    sock::SslEnabled _sendSsl;
     sock::IoService<N>& _ioService;
 
     void enterDisconnectedState(const SocketPtr& socket = {},
@@ -284,7 +302,16 @@ namespace qi {
     bool mustTreatAsServerAuthentication(const Message& msg) const;
     bool handleCapabilityMessage(const Message& msg);
     bool handleNormalMessage(Message& msg);
+    bool handleChunk(const Message& chunk);
     bool handleMessage(Message& msg);
+    // Handles a message whose priority is set.
+    bool handleWholeMessage(Message& msg);
+    std::vector<Message> prepareToSend(Message& msg);
+
+    // Only used by the receiving of the messages, which are received one at a time.
+    MessageChunkAssembler _chunkAssembler;
+    // Priority of the calls received, given to their replies.
+    boost::synchronized_value<std::map<unsigned int, MessagePriority>> _callPriorities;
 
     ConnectedState& asConnected(State& s)
     {
@@ -312,6 +339,7 @@ namespace qi {
       return static_cast<Status>(_state.which());
     }
     FutureSync<void> doDisconnect();
+    void offloadTlsSendUnsync(const SocketPtr& socket);
   };
 
   template<typename N, typename S>
@@ -319,15 +347,21 @@ namespace qi {
 
   template<typename N, typename S>
   TcpMessageSocket<N, S>::TcpMessageSocket(sock::IoService<N>& io, sock::SslEnabled ssl,
-        SocketPtr socket)
+        SocketPtr socket, const MessageSocketConfig& config)
     : MessageSocket()
     , _ssl(ssl)
+    , _config(config)
+    , _sendSsl(ssl)
     , _ioService(io)
     , _state{DisconnectedState{}}
+    , _chunkAssembler(getMaxPayloadFromEnv())
   {
     if (socket)
     {
       sock::setSocketOptions<N>(socket, getTcpPingTimeout(Seconds{sock::defaultTimeoutInSeconds}));
+      // The server gives the options of the URL the socket was accepted on as
+      // the defaults.
+      sock::setSocketTuning<N>(socket, _config.tuning.defaults);
       _state = ConnectingState{io, ssl, socket, Handshake::server};
     }
   }
@@ -343,8 +377,6 @@ namespace qi {
     }
   }
 
-  std::uint32_t getMaxPayloadFromEnv(std::uint32_t defaultValue = std::numeric_limits<std::uint32_t>::max());
-
   /// Start receiving messages. Also allows to send messages.
   ///
   /// The returned value indicates if the operation succeeded.
@@ -377,8 +409,10 @@ namespace qi {
         return false;
       }
       auto self = shared_from_this();
+      offloadTlsSendUnsync(res.socket);
       _state = ConnectedState(res.socket, _ssl, maxPayload, sock::HandleMessage<N, S>{self});
       auto& connected = asConnected(_state);
+      connected.setCorkBatches(_config.tuning.defaults.corkBatches);
       connected.complete().then(connected.ioServiceStranded(
         OnConnectedComplete{self, Future<void>{nullptr}}
       ));
@@ -409,8 +443,10 @@ namespace qi {
     _state =
         ConnectingState{ _ioService, url, _ssl,
                          [&] {
-                           return sock::makeSocketWithContextPtr<N>(
-                                 _ioService, sock::makeSslContextPtr<N>(Method::sslv23));
+                           auto context = sock::makeSslContextPtr<N>(Method::sslv23);
+                           if (*_ssl && _config.tlsOffload.enabled)
+                             N::enableTlsOffload(*context);
+                           return sock::makeSocketWithContextPtr<N>(_ioService, context);
                          },
                          !disableIpV6, Side::client,
                          getTcpPingTimeout(Seconds{ sock::defaultTimeoutInSeconds }) };
@@ -440,8 +476,12 @@ namespace qi {
         // Connecting was successful, so we enter the connected state (to be able
         // send and receive messages).
         static const auto maxPayload = getMaxPayloadFromEnv();
+        const auto& tuning = _config.tuning.forUrl(url);
+        sock::setSocketTuning<N>(res.socket, tuning);
+        offloadTlsSendUnsync(res.socket);
         _state = ConnectedState(res.socket, _ssl, maxPayload, sock::HandleMessage<N, S>{self});
         auto& connected = asConnected(_state);
+        connected.setCorkBatches(tuning.corkBatches);
         connected.complete().then(connected.ioServiceStranded(
           OnConnectedComplete{self, connectedPromise.future()}
         ));
@@ -460,6 +500,27 @@ namespace qi {
     return connectedPromise.future();
   }
 
+  /// Once the handshake is done, hands the encryption of the messages sent to
+  /// the kernel if it is enabled and possible.
+  ///
+  /// _state must be synchronized before calling this method.
+  template<typename N, typename S>
+  void TcpMessageSocket<N, S>::offloadTlsSendUnsync(const SocketPtr& socket)
+  {
+    _sendSsl = _ssl;
+    if (!*_ssl || !_config.tlsOffload.enabled)
+      return;
+    if (N::offloadTlsSend(*socket))
+    {
+      _sendSsl = sock::SslEnabled{false};
+      QI_LOG_DEBUG_SOCKET(this) << "Messages sent are encrypted by the kernel.";
+    }
+    else
+    {
+      QI_LOG_DEBUG_SOCKET(this) << "Messages sent are encrypted in user space.";
+    }
+  }
+
   /// You must wait for this method to complete before
   /// destructing the socket.
   template<typename N, typename S>
@@ -497,6 +558,10 @@ namespace qi {
         wasConnected = (getStatus() == Status::Connected);
         QI_LOG_DEBUG_SOCKET(socket.get()) << "Entering Disconnecting state";
         _state = disconnect;
+        // The receiving is over: the partial messages will never be completed
+        // and the calls received will never be replied to on this connection.
+        _chunkAssembler.clear();
+        _callPriorities->clear();
       }
       disconnect();
       auto self = shared_from_this();
@@ -562,9 +627,50 @@ namespace qi {
     return true;
   }
 
+  template<typename N, typename S>
+  bool TcpMessageSocket<N, S>::handleChunk(const Message& chunk)
+  {
+    // Chunks are only sent to the peers that support the priorities, which
+    // is known once the capabilities are exchanged during the authentication.
+    if (!sharedCapability<bool>(capabilityname::messagePriorities, false))
+    {
+      QI_LOG_ERROR_SOCKET(this) << "Chunk message received but the message priorities were not negotiated.";
+      return false;
+    }
+    boost::optional<Message> msg;
+    try
+    {
+      msg = _chunkAssembler.add(chunk);
+    }
+    catch (const std::runtime_error& e)
+    {
+      QI_LOG_ERROR_SOCKET(this) << "Ill-formed chunk message: " << e.what();
+      return false;
+    }
+    // The reassembled message has the priority of its chunks, its header has
+    // no priority flags.
+    return !msg || handleWholeMessage(*msg);
+  }
+
   template<typename N, typename S>
   bool TcpMessageSocket<N, S>::handleMessage(Message& msg)
   {
+    // The received message may be reused for the next one, so its priority is
+    // always reset.
+    msg.setPriority(Message::priorityOfFlags(msg.flags()));
+    msg.setFlags(msg.flags() & ~Message::TypeFlags_Priority);
+    if (msg.type() == Message::Type_Chunk)
+      return handleChunk(msg);
+    return handleWholeMessage(msg);
+  }
+
+  template<typename N, typename S>
+  bool TcpMessageSocket<N, S>::handleWholeMessage(Message& msg)
+  {
+    if (msg.priority() != MessagePriority_Normal
+        && (msg.type() == Message::Type_Call || msg.type() == Message::Type_CallBatch))
+      (*_callPriorities.synchronize())[msg.id()] = msg.priority();
+
     bool success = false;
     if (mustTreatAsServerAuthentication(msg) || msg.type() == Message::Type_Capability)
     {
@@ -584,6 +690,45 @@ namespace qi {
     return success;
   }
 
+  /// Gives to a reply the priority of its call. If the remote end supports the
+  /// priorities, sets the priority flags and returns the chunks to send
+  /// instead of the message if it is too large.
+  template<typename N, typename S>
+  std::vector<Message> TcpMessageSocket<N, S>::prepareToSend(Message& msg)
+  {
+    switch (msg.type())
+    {
+    case Message::Type_Reply:
+    case Message::Type_Error:
+    case Message::Type_Canceled:
+    case Message::Type_BatchReply:
+    {
+      auto priorities = _callPriorities.synchronize();
+      auto it = priorities->find(msg.id());
+      if (it != priorities->end())
+      {
+        msg.setPriority(it->second);
+        priorities->erase(it);
+      }
+      break;
+    }
+    default:
+      break;
+    }
+
+    std::vector<Message> chunks;
+    if (!sharedCapability<bool>(capabilityname::messagePriorities, false))
+      return chunks;
+    static const auto chunkSize = getMessageChunkSizeFromEnv();
+    if (chunkSize != 0)
+      chunks = splitIntoChunks(msg, chunkSize);
+    if (chunks.empty())
+      msg.addFlags(Message::priorityFlags(msg.priority()));
+    for (auto& chunk: chunks)
+      chunk.addFlags(Message::priorityFlags(chunk.priority()));
+    return chunks;
+  }
+
   template<typename N, typename S>
   bool TcpMessageSocket<N, S>::send(Message msg)
   {
@@ -595,7 +740,39 @@ namespace qi {
     }
     // NOTE: Should we specify an `onSent` callback and stop sending if an error
     // occurred?
-    asConnected(_state).send(std::move(msg), _ssl);
+    auto chunks = prepareToSend(msg);
+    if (chunks.empty())
+      asConnected(_state).send(std::move(msg), _sendSsl);
+    for (auto& chunk: chunks)
+      asConnected(_state).send(std::move(chunk), _sendSsl);
+    return true;
+  }
+
+  template<typename N, typename S>
+  bool TcpMessageSocket<N, S>::send(Message msg, OnSent onSent)
+  {
+    boost::recursive_mutex::scoped_lock lock(_stateMutex);
+    if (getStatus() != Status::Connected)
+    {
+      QI_LOG_DEBUG_SOCKET(this) << "Socket must be connected to send().";
+      return false;
+    }
+    using ReadableMessage = typename sock::SendMessageEnqueue<N, SocketPtr>::ReadableMessage;
+    auto chunks = prepareToSend(msg);
+    // The message is sent once its last chunk is.
+    if (!chunks.empty())
+    {
+      msg = std::move(chunks.back());
+      chunks.pop_back();
+    }
+    for (auto& chunk: chunks)
+      asConnected(_state).send(std::move(chunk), _sendSsl);
+    asConnected(_state).send(std::move(msg), _sendSsl,
+      [=](const sock::ErrorCode<N>&, const ReadableMessage&) {
+        if (onSent)
+          onSent();
+        return true;
+      });
     return true;
   }
 
@@ -604,16 +781,17 @@ namespace qi {
   ///   S is compatible with N
   template <typename N = sock::NetworkAsio, typename S = sock::SocketWithContext<N>>
   TcpMessageSocketPtr<N, S> makeTcpMessageSocket(const std::string& protocol,
-                                                 EventLoop* eventLoop = getNetworkEventLoop())
+                                                 EventLoop* eventLoop = getNetworkEventLoop(),
+                                                 const MessageSocketConfig& config = {})
   {
     using Socket = TcpMessageSocket<N, S>;
     if (protocol == "tcp")
     {
-      return boost::make_shared<Socket>(*asIoServicePtr(eventLoop), false);
+      return boost::make_shared<Socket>(*asIoServicePtr(eventLoop), false, typename Socket::SocketPtr{}, config);
     }
     if (protocol == "tcps")
     {
-      return boost::make_shared<Socket>(*asIoServicePtr(eventLoop), true);
+      return boost::make_shared<Socket>(*asIoServicePtr(eventLoop), true, typename Socket::SocketPtr{}, config);
     }
     qiLogError(qi::sock::logCategory()) << "Unrecognized protocol to create the TransportSocket: "
                                         << protocol;
@@ -9,6 +9,7 @@
 # pragma warning(disable: 4355)
 #endif
 
+#include <algorithm>
 #include <string>
 #include <cstring>
 #include <cstdlib>
@@ -43,22 +44,56 @@ namespace qi
 
   qi::Future<void> TransportServer::listen(const qi::Url &url, qi::EventLoop* ctx)
   {
-    TransportServerImplPtr impl;
-    if (url.protocol() == "tcp" || url.protocol() == "tcps")
-    {
-      impl = TransportServerAsioPrivate::make(this, ctx);
-    }
-    else
+    if (url.protocol() != "tcp" && url.protocol() != "tcps")
     {
       const char* s = "Unrecognized protocol to create the TransportServer.";
       qiLogError() << s;
       return qi::makeFutureError<void>(s);
     }
-    {
+
+    // The sockets accepted on `url` get its options.
+    MessageSocketConfig config = _socketConfig;
+    config.tuning.defaults = _socketConfig.tuning.forUrl(url);
+    config.tuning.urls.clear();
+    const unsigned int acceptors = std::max(config.tuning.defaults.acceptors, 1u);
+
+    auto makeImpl = [&](bool registerEndpoints) {
+      auto impl = TransportServerAsioPrivate::make(this, ctx);
+      impl->_socketConfig = config;
+      impl->_reusePort = acceptors > 1;
+      impl->_registerEndpoints = registerEndpoints;
       boost::mutex::scoped_lock l(_implMutex);
       _impl.push_back(impl);
+      return impl;
+    };
+
+    auto impl = makeImpl(true);
+    auto listening = impl->listen(url);
+    if (acceptors == 1 || listening.hasError())
+      return listening;
+
+    // The additional acceptors listen to the endpoint of the first one, whose
+    // port is known even if `url` let the system choose it.
+    for (unsigned int i = 1; i < acceptors; ++i)
+    {
+      std::string error;
+      try
+      {
+        auto listeningMore = makeImpl(false)->listen(impl->_listenUrl);
+        if (listeningMore.hasError())
+          error = listeningMore.error();
+      }
+      catch (const std::exception& e)
+      {
+        error = e.what();
+      }
+      if (!error.empty())
+      {
+        qiLogWarning() << "Cannot add an acceptor to " << impl->_listenUrl.str() << ": " << error;
+        break;
+      }
     }
-    return impl->listen(url);
+    return listening;
   }
 
   bool TransportServer::setIdentity(const std::string& key, const std::string& crt)
@@ -82,6 +117,11 @@ namespace qi
     return true;
   }
 
+  void TransportServer::setSocketConfig(const MessageSocketConfig& config)
+  {
+    _socketConfig = config;
+  }
+
   std::vector<qi::Url> TransportServer::endpoints() const
   {
     std::vector<qi::Url> r;
@@ -15,6 +15,7 @@
 # include <vector>
 # include <boost/asio/ip/tcp.hpp>
 # include <boost/asio/ssl/stream.hpp>
+# include "messagesocket.hpp"
 
 
 namespace qi {
@@ -66,6 +67,8 @@ namespace qi {
     qi::Future<void> listen(const qi::Url &url,
                             qi::EventLoop* ctx = qi::getNetworkEventLoop());
     bool setIdentity(const std::string& key, const std::string& crt);
+    /// Applies to the endpoints listened to afterwards.
+    void setSocketConfig(const MessageSocketConfig& config);
     void close();
 
     std::vector<qi::Url> endpoints() const;
@@ -81,6 +84,7 @@ namespace qi {
     qi::Signal<void>               endpointsChanged;
     std::string                           _identityKey;
     std::string                           _identityCertificate;
+    MessageSocketConfig                   _socketConfig;
     std::vector<TransportServerImplPtr>   _impl;
     mutable boost::mutex                 _implMutex;
   };
@@ -80,7 +80,7 @@ namespace qi
     }
     else
     {
-        auto socket = boost::make_shared<qi::TcpMessageSocket<>>(*asIoServicePtr(context), _ssl, s);
+        auto socket = boost::make_shared<qi::TcpMessageSocket<>>(*asIoServicePtr(context), _ssl, s, _socketConfig);
         qiLogDebug() << "New socket accepted: " << socket.get();
 
         self->newConnection(std::pair<MessageSocketPtr, Url>{
@@ -230,6 +230,22 @@ namespace qi
     fcntl(_acceptor->native(), F_SETFD, FD_CLOEXEC);
 #endif
     _acceptor->set_option(option);
+    if (_reusePort)
+    {
+#ifdef SO_REUSEPORT
+      _acceptor->set_option(boost::asio::detail::socket_option::boolean<SOL_SOCKET, SO_REUSEPORT>(true));
+#else
+      qiLogWarning() << "SO_REUSEPORT is not available, " << _listenUrl.str()
+                     << " cannot be listened to by several acceptors.";
+#endif
+    }
+    // Accepted sockets inherit the buffer sizes of the acceptor, which must be
+    // set before listening so that the window scale is negotiated accordingly.
+    const auto& tuning = _socketConfig.tuning.defaults;
+    if (tuning.sendBufferSize > 0)
+      _acceptor->set_option(socket_base::send_buffer_size(tuning.sendBufferSize));
+    if (tuning.receiveBufferSize > 0)
+      _acceptor->set_option(socket_base::receive_buffer_size(tuning.receiveBufferSize));
     try
     {
       _acceptor->bind(ep);
@@ -257,14 +273,17 @@ namespace qi
     }
 
     /* Set endpoints */
-    if (_listenUrl.host() != "0.0.0.0")
-    {
-      boost::mutex::scoped_lock l(_endpointsMutex);
-      _endpoints.push_back(_listenUrl.str());
-    }
-    else
+    if (_registerEndpoints)
     {
-      updateEndpoints();
+      if (_listenUrl.host() != "0.0.0.0")
+      {
+        boost::mutex::scoped_lock l(_endpointsMutex);
+        _endpoints.push_back(_listenUrl.str());
+      }
+      else
+      {
+        updateEndpoints();
+      }
     }
 
     {
@@ -291,6 +310,8 @@ namespace qi
         | boost::asio::ssl::context::no_sslv2);
       _sslContext->use_certificate_chain_file(self->_identityCertificate.c_str());
       _sslContext->use_private_key_file(self->_identityKey.c_str(), boost::asio::ssl::context::pem);
+      if (_socketConfig.tlsOffload.enabled)
+        sock::NetworkAsio::enableTlsOffload(*_sslContext);
     }
 
     _s = sock::makeSocketWithContextPtr<sock::NetworkAsio>(_acceptor->get_io_service(), _sslContext);
@@ -331,6 +352,8 @@ namespace qi
                                                              sock::SslContext<sock::NetworkAsio>::sslv23))
     , _s()
     , _ssl(false)
+    , _reusePort(false)
+    , _registerEndpoints(true)
     , _port(0)
   {
   }
@@ -47,6 +47,14 @@ namespace qi
     sock::SslContextPtr<sock::NetworkAsio> _sslContext;
     sock::SocketWithContextPtr<sock::NetworkAsio> _s;
     bool _ssl;
+    // Set by the TransportServer before listening. The tuning defaults are the
+    // options of the URL listened to.
+    MessageSocketConfig _socketConfig;
+    // Whether the acceptor shares its endpoint with other ones (SO_REUSEPORT).
+    bool _reusePort;
+    // False for the additional acceptors of an endpoint, which is advertised
+    // by the first one.
+    bool _registerEndpoints;
     unsigned short _port;
     boost::synchronized_value<qi::Future<void>> _asyncEndpoints;
     Url _listenUrl;
@@ -20,6 +20,7 @@ namespace qi
 {
 TransportSocketCache::TransportSocketCache()
   : _dying(false)
+  , _socketsPerEndpoint(1)
 {
 }
 
@@ -62,11 +63,21 @@ void TransportSocketCache::close()
   {
     ConnectionMap map;
     std::list<MessageSocketPtr> pending;
+    std::map<MessageSocket*, SocketPool> pools;
     {
       boost::mutex::scoped_lock lock(_socketMutex);
       _dying = true;
       std::swap(map, _connections);
       std::swap(pending, _allPendingConnections);
+      std::swap(pools, _pools);
+    }
+    for (auto& pairOwnerPool: pools)
+    {
+      auto& pool = pairOwnerPool.second;
+      if (auto owner = pool.owner.lock())
+        owner->disconnected.disconnectAsync(pool.ownerDisconnectionTracking);
+      for (auto& pooled: pool.sockets)
+        pooled.socket->disconnect();
     }
     for (auto& pairMachineIdConnection: map)
     {
@@ -163,30 +174,64 @@ Future<MessageSocketPtr> TransportSocketCache::socket(const ServiceInfo& servInf
         }
       }
     }
+    const auto unusable = [&](const Url& url) {
+      // Do not try to connect to an invalid url, nor on localhost when it is a remote!
+      return !url.isValid() || (!local && isLocalHost(url.host()));
+    };
+    connectionCandidates.erase(
+        std::remove_if(connectionCandidates.begin(), connectionCandidates.end(), unusable),
+        connectionCandidates.end());
+    if (connectionCandidates.empty())
+      return makeFutureError<MessageSocketPtr>("No usable endpoint for service #"
+                                               + os::to_string(servInfo.serviceId()) + ".");
+
     // Otherwise, we keep track of all those URLs and assign them the same promise in our map.
     // They will all track the same connection.
-    couple->attemptCount = qi::numericConvert<int>(connectionCandidates.size());
+    const UrlVector ranked = _ranking.rank(machineId, std::move(connectionCandidates));
+    couple->attemptCount = qi::numericConvert<int>(ranked.size());
     std::map<Url, ConnectionAttemptPtr>& urlMap = _connections[machineId];
-    for (const auto& url: connectionCandidates)
+    for (const auto& url: ranked)
     {
-      if (!url.isValid())
-        continue; // Do not try to connect to an invalid url!
-
-      if (!local && isLocalHost(url.host()))
-        continue; // Do not try to connect on localhost when it is a remote!
-
       urlMap[url] = couple;
-      MessageSocketPtr socket = makeMessageSocket(url.protocol());
-      _allPendingConnections.push_back(socket);
-      Future<void> sockFuture = socket->connect(url);
+      couple->untriedUrls.push_back(url);
       qiLogDebug() << "Inserted [" << machineId << "][" << url.str() << "]";
-      sockFuture.then(std::bind(&TransportSocketCache::onSocketParallelConnectionAttempt, this,
-                                std::placeholders::_1, socket, url, servInfo));
     }
+    startNextAttemptUnsync(couple, servInfo);
   }
   return couple->promise.future();
 }
 
+void TransportSocketCache::startNextAttemptUnsync(ConnectionAttemptPtr attempt, const ServiceInfo& info)
+{
+  if (attempt->state != State_Pending || attempt->untriedUrls.empty())
+    return;
+  // The attempt may be started before the end of the delay, which must not
+  // start another one.
+  ++attempt->nextAttemptDelayIndex;
+  if (attempt->nextAttemptDelay.isValid())
+    attempt->nextAttemptDelay.cancel();
+  const Url url = attempt->untriedUrls.front();
+  attempt->untriedUrls.pop_front();
+
+  MessageSocketPtr socket = makeMessageSocket(url.protocol(), getNetworkEventLoop(), _socketConfig);
+  _allPendingConnections.push_back(socket);
+  const auto start = SteadyClock::now();
+  Future<void> sockFuture = socket->connect(url);
+  qiLogDebug() << "Trying [" << info.machineId() << "][" << url.str() << "]";
+  sockFuture.then(std::bind(&TransportSocketCache::onSocketParallelConnectionAttempt, this,
+                            std::placeholders::_1, socket, url, info, start));
+
+  if (attempt->untriedUrls.empty())
+    return;
+  // Race the next endpoint if this one is slow to answer.
+  const auto delayIndex = attempt->nextAttemptDelayIndex;
+  attempt->nextAttemptDelay = asyncDelay(track([=] {
+    boost::mutex::scoped_lock lock(_socketMutex);
+    if (!_dying && attempt->nextAttemptDelayIndex == delayIndex)
+      startNextAttemptUnsync(attempt, info);
+  }, this), _ranking.attemptDelay(info.machineId(), url));
+}
+
 FutureSync<void> TransportSocketCache::disconnect(MessageSocketPtr socket)
 {
   Promise<void> promiseSocketRemoved;
@@ -215,6 +260,92 @@ FutureSync<void> TransportSocketCache::disconnect(MessageSocketPtr socket)
   });
 }
 
+void TransportSocketCache::setSocketPool(unsigned int socketsPerEndpoint, AuthenticateSocket authenticate)
+{
+  boost::mutex::scoped_lock lock(_socketMutex);
+  _socketsPerEndpoint = std::max(1u, socketsPerEndpoint);
+  _authenticatePooledSocket = std::move(authenticate);
+}
+
+void TransportSocketCache::setSocketConfig(const MessageSocketConfig& config)
+{
+  boost::mutex::scoped_lock lock(_socketMutex);
+  _socketConfig = config;
+}
+
+TransportSocketCache::PooledSocket TransportSocketCache::openPooledSocket(const Url& url)
+{
+  PooledSocket pooled;
+  const MessageSocketPtr socket = makeMessageSocket(url.protocol(), getNetworkEventLoop(), _socketConfig);
+  const AuthenticateSocket authenticate = _authenticatePooledSocket;
+  pooled.socket = socket;
+  Future<void> connecting = socket->connect(url);
+  pooled.ready = connecting.andThen([=](void*) {
+    return authenticate ? authenticate(socket) : Future<void>(nullptr);
+  }).unwrap().andThen([=](void*) {
+    return socket;
+  });
+  qiLogDebug() << "Opening pooled socket " << socket.get() << " to " << url.str();
+  return pooled;
+}
+
+std::vector<Future<MessageSocketPtr>> TransportSocketCache::pooledSockets(const MessageSocketPtr& socket)
+{
+  std::vector<Future<MessageSocketPtr>> result;
+  boost::mutex::scoped_lock lock(_socketMutex);
+  if (_dying || _socketsPerEndpoint <= 1 || !socket || !socket->isConnected())
+    return result;
+
+  MessageSocket* const owner = socket.get();
+  auto poolIt = _pools.find(owner);
+  if (poolIt == _pools.end())
+  {
+    SocketPool pool;
+    pool.owner = socket;
+    pool.ownerDisconnectionTracking = socket->disconnected.connect(
+        track([=](const std::string&) { onPoolOwnerDisconnected(owner); }, this));
+    // The socket may have been disconnected before we started tracking it.
+    if (!socket->isConnected())
+    {
+      socket->disconnected.disconnectAsync(pool.ownerDisconnectionTracking);
+      return result;
+    }
+    poolIt = _pools.emplace(owner, std::move(pool)).first;
+  }
+
+  auto& sockets = poolIt->second.sockets;
+  sockets.resize(_socketsPerEndpoint - 1);
+  for (auto& pooled: sockets)
+  {
+    const bool usable = pooled.socket
+        && (!pooled.ready.isFinished() || (!pooled.ready.hasError() && pooled.socket->isConnected()));
+    if (!usable)
+    {
+      if (pooled.socket)
+        pooled.socket->disconnect().async();
+      pooled = openPooledSocket(socket->url());
+    }
+    result.push_back(pooled.ready);
+  }
+  return result;
+}
+
+void TransportSocketCache::onPoolOwnerDisconnected(MessageSocket* owner)
+{
+  SocketPool pool;
+  {
+    boost::mutex::scoped_lock lock(_socketMutex);
+    auto it = _pools.find(owner);
+    if (it == _pools.end())
+      return;
+    pool = std::move(it->second);
+    _pools.erase(it);
+  }
+  qiLogDebug() << "Closing the " << pool.sockets.size() << " pooled sockets of " << owner;
+  for (auto& pooled: pool.sockets)
+    pooled.socket->disconnect().async();
+}
+
 void TransportSocketCache::insert(const std::string& machineId, const Url& url, MessageSocketPtr socket)
 {
   // If a connection is pending for this machine / url, terminate the pendage and set the
@@ -276,8 +407,15 @@ void TransportSocketCache::insert(const std::string& machineId, const Url& url,
 void TransportSocketCache::onSocketParallelConnectionAttempt(Future<void> fut,
                                                              MessageSocketPtr socket,
                                                              Url url,
-                                                             const ServiceInfo& info)
+                                                             const ServiceInfo& info,
+                                                             SteadyClock::time_point start)
 {
+  // Even the connections which lose the race tell how fast their endpoint is.
+  if (fut.hasError())
+    _ranking.failed(info.machineId(), url);
+  else if (!fut.isCanceled())
+    _ranking.connected(info.machineId(), url, SteadyClock::now() - start);
+
   boost::mutex::scoped_lock lock(_socketMutex);
 
   if (_dying)
@@ -330,6 +468,11 @@ void TransportSocketCache::onSocketParallelConnectionAttempt(Future<void> fut,
       attempt->state = State_Error;
       checkClear(attempt, info.machineId());
     }
+    else
+    {
+      // No need to wait for the delay of the next endpoint.
+      startNextAttemptUnsync(attempt, info);
+    }
     return;
   }
   qi::SignalLink disconnectionTracking = socket->disconnected.connect(
@@ -338,6 +481,10 @@ void TransportSocketCache::onSocketParallelConnectionAttempt(Future<void> fut,
   attempt->endpoint = socket;
   attempt->promise.setValue(socket);
   attempt->disconnectionTracking = disconnectionTracking;
+  attempt->attemptCount -= qi::numericConvert<int>(attempt->untriedUrls.size());
+  attempt->untriedUrls.clear();
+  if (attempt->nextAttemptDelay.isValid())
+    attempt->nextAttemptDelay.cancel();
   qiLogDebug() << "Connected to service #" << info.serviceId() << " through url " << url.str() << " and socket "
                << socket.get();
 }
@@ -7,8 +7,12 @@
 #ifndef _SRC_TRANSPORTSOCKETCACHE2_HPP_
 #define _SRC_TRANSPORTSOCKETCACHE2_HPP_
 
+#include <deque>
 #include <string>
 #include <queue>
+#include <vector>
+
+#include <boost/function.hpp>
 
 #include <boost/thread/mutex.hpp>
 #include <boost/thread/synchronized_value.hpp>
@@ -18,6 +22,7 @@
 
 #include <qi/trackable.hpp>
 
+#include "endpointranking.hpp"
 #include "messagesocket.hpp"
 
 namespace qi
@@ -33,6 +38,14 @@ namespace qi
   * -> if the connection is pending wait for the result
   * -> if the socket do not exist, create it, and try to connect it
   * -> if the socket is disconnected try to reconnect it
+  *
+  * The endpoints of a service are tried from the most to the least preferred
+  * one, see EndpointRanking. The next one is tried when the previous one
+  * fails, or has not connected after a delay which depends on its previous
+  * connection times. The first one to connect is used.
+  *
+  * `pooledSockets` returns the other sockets of the pool of an endpoint, see
+  * SocketPoolConfig.
   */
 
   class TransportSocketCache : public Trackable<TransportSocketCache>
@@ -56,6 +69,18 @@ namespace qi
     /// The returned future is set when the socket has been disconnected and
     /// effectively removed from the cache.
     FutureSync<void> disconnect(MessageSocketPtr socket);
+
+    /// Authenticates a socket of a pool before it is used.
+    using AuthenticateSocket = boost::function<Future<void> (MessageSocketPtr)>;
+    void setSocketPool(unsigned int socketsPerEndpoint, AuthenticateSocket authenticate);
+
+    /// Applies to the sockets opened afterwards.
+    void setSocketConfig(const MessageSocketConfig& config);
+
+    /// Get the sockets to the endpoint of `socket` other than itself, opening
+    /// or reopening them if needed. The futures are set once the sockets are
+    /// connected and authenticated. Returns nothing if the pool is disabled.
+    std::vector<Future<MessageSocketPtr>> pooledSockets(const MessageSocketPtr& socket);
   private:
     enum State
     {
@@ -66,8 +91,10 @@ namespace qi
 
     using UrlVectorPtr = boost::shared_ptr<UrlVector>;
     void onSocketConnectionAttempt(Future<void> fut, Promise<MessageSocketPtr> prom, MessageSocketPtr socket, const ServiceInfo& info, uint32_t currentUrlIdx, UrlVectorPtr urls);
-    void onSocketParallelConnectionAttempt(Future<void> fut, MessageSocketPtr socket, Url url, const ServiceInfo& info);
+    void onSocketParallelConnectionAttempt(Future<void> fut, MessageSocketPtr socket, Url url, const ServiceInfo& info,
+                                           SteadyClock::time_point start);
     void onSocketDisconnected(Url url, const ServiceInfo& info);
+    void onPoolOwnerDisconnected(MessageSocket* owner);
 
 
     boost::mutex _socketMutex;
@@ -78,9 +105,17 @@ namespace qi
       int attemptCount;
       State state;
       SignalLink disconnectionTracking;
+      // Endpoints not tried yet, and the delay before trying the next one.
+      // Only the delay numbered `nextAttemptDelayIndex` may start an attempt:
+      // a canceled delay may already be running.
+      std::deque<Url> untriedUrls;
+      Future<void> nextAttemptDelay;
+      unsigned int nextAttemptDelayIndex = 0;
     };
     using ConnectionAttemptPtr = boost::shared_ptr<ConnectionAttempt>;
 
+    void startNextAttemptUnsync(ConnectionAttemptPtr attempt, const ServiceInfo& info);
+
     void checkClear(ConnectionAttemptPtr, const std::string& machineId);
 
     /// The promise is set when the `disconnected` signal of `socket` has been received.
@@ -96,6 +131,27 @@ namespace qi
     std::list<MessageSocketPtr> _allPendingConnections;
     boost::synchronized_value<std::vector<DisconnectInfo>> _disconnectInfos;
     bool _dying;
+
+    struct PooledSocket
+    {
+      MessageSocketPtr socket;
+      Future<MessageSocketPtr> ready;
+    };
+    struct SocketPool
+    {
+      boost::weak_ptr<MessageSocket> owner;
+      std::vector<PooledSocket> sockets;
+      SignalLink ownerDisconnectionTracking;
+    };
+    PooledSocket openPooledSocket(const Url& url);
+    // Keyed by the socket of the cache to the endpoint, which is tracked to
+    // close its pool when it is disconnected.
+    std::map<MessageSocket*, SocketPool> _pools;
+    unsigned int _socketsPerEndpoint;
+    AuthenticateSocket _authenticatePooledSocket;
+    MessageSocketConfig _socketConfig;
+    // Kept when the cache is closed, to be used on the next connection.
+    EndpointRanking _ranking;
   };
 }
 
@@ -4,12 +4,22 @@
  * found in the COPYING file.
  */
 
+#include <algorithm>
+#include <cstring>
 #include <boost/lexical_cast.hpp>
 #include <boost/thread.hpp>
+#include <qi/eventloop.hpp>
 #include <qi/log.hpp>
+#include <qi/os.hpp>
+#include <qi/perf/measure.hpp>
 #include <qi/periodictask.hpp>
 #include <qi/trackable.hpp>
 
+#ifndef _WIN32
+# include <pthread.h>
+# include <sched.h>
+#endif
+
 
 qiLogCategory("qi.PeriodicTask");
 
@@ -42,6 +52,34 @@ enum class TaskState
 
 namespace qi
 {
+  namespace
+  {
+    // Jitter samples kept between two stats displays. When there are more
+    // calls than that, the oldest samples are overwritten.
+    const std::size_t maxJitterSamples = 1 << 16;
+
+    void setupDedicatedThread(const std::string& name,
+                              const std::vector<int>& cpus,
+                              int realtimePriority)
+    {
+      if (!cpus.empty() && !os::setCurrentThreadCPUAffinity(cpus))
+        qiLogWarning() << name << ": cannot set the CPU affinity of the dedicated thread";
+
+      if (realtimePriority <= 0)
+        return;
+#ifndef _WIN32
+      sched_param param;
+      std::memset(&param, 0, sizeof(param));
+      param.sched_priority = realtimePriority;
+      const int err = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+      if (err)
+        qiLogWarning() << name << ": cannot set SCHED_FIFO priority " << realtimePriority
+                       << " on the dedicated thread: " << std::strerror(err);
+#else
+      qiLogWarning() << name << ": realtime priority is not supported on this platform";
+#endif
+    }
+  }
 
   struct PeriodicTaskPrivate: Trackable<PeriodicTaskPrivate>
   {
@@ -57,6 +95,12 @@ namespace qi
     qi::Future<void>        _task;
     std::string             _name;
     bool                    _compensateCallTime;
+    bool                    _absoluteDeadlines;
+    qi::SteadyClockTimePoint _deadline;
+    std::vector<float>      _jitterSamples; // microseconds
+    std::size_t             _jitterCount;
+    unsigned int            _missedDeadlines;
+    std::unique_ptr<EventLoop> _dedicatedLoop;
     int                     _tid;
     using Mutex = boost::recursive_mutex;
     using ScopedLock = Mutex::scoped_lock;
@@ -78,6 +122,9 @@ namespace qi
     ~PeriodicTaskPrivate();
 
     void _reschedule(qi::Duration delay = qi::Duration(0));
+    void _rescheduleAt(qi::SteadyClockTimePoint deadline);
+    void _pushJitter(qi::Duration jitter);
+    qi::SteadyClockTimePoint _nextAbsoluteDeadline(qi::SteadyClockTimePoint now);
     void _wrap();
     void _onTaskFinished(const qi::Future<void>& fut);
 
@@ -93,6 +140,9 @@ namespace qi
     _p->_period = qi::Duration(-1);
     _p->_tid = invalidThreadId;
     _p->_compensateCallTime =false;
+    _p->_absoluteDeadlines = false;
+    _p->_jitterCount = 0;
+    _p->_missedDeadlines = 0;
     _p->_statsDisplayTime = qi::SteadyClock::now();
     _p->_name = "PeriodicTask_" + boost::lexical_cast<std::string>(this);
     _p->_state = TaskState::Stopped;
@@ -156,6 +206,8 @@ namespace qi
       qiLogDebug() << static_cast<int>(_p->_state) << " task was not stopped";
       return; // Already running or being started.
     }
+    // So that _pushJitter never allocates while the task runs.
+    _p->_jitterSamples.reserve(maxJitterSamples);
     _p->_taskSynchro.reset(new PeriodicTaskPrivate::TaskSynchronizer);
     _p->_reschedule(immediate ? qi::Duration(0) : _p->_period);
   }
@@ -257,12 +309,21 @@ namespace qi
 
   void PeriodicTaskPrivate::_reschedule(qi::Duration delay)
   {
+    _rescheduleAt(qi::SteadyClock::now() + delay);
+  }
+
+  void PeriodicTaskPrivate::_rescheduleAt(qi::SteadyClockTimePoint deadline)
+  {
+    const auto delay = std::max(qi::Duration(0), deadline - qi::SteadyClock::now());
     qiLogDebug() << "rescheduling in " << qi::to_string(delay);
 
     QI_ASSERT_TRUE(_taskSynchro);
+    _deadline = deadline;
     auto task = qi::track([&]{ _wrap(); }, _taskSynchro.get());
     if (_scheduleCallback)
       _task = _scheduleCallback(std::move(task), delay);
+    else if (_dedicatedLoop)
+      _task = _dedicatedLoop->asyncDelay(std::move(task), delay);
     else
       _task = getEventLoop()->asyncDelay(std::move(task), delay);
     _state = TaskState::Scheduled;
@@ -278,6 +339,28 @@ namespace qi
           &PeriodicTaskPrivate::_onTaskFinished, this, _1), this), qi::FutureCallbackType_Sync);
   }
 
+  void PeriodicTaskPrivate::_pushJitter(qi::Duration jitter)
+  {
+    const float us = float(boost::chrono::duration_cast<qi::NanoSeconds>(jitter).count()) / 1e3f;
+    if (_jitterSamples.size() < maxJitterSamples)
+      _jitterSamples.push_back(us);
+    else
+      _jitterSamples[_jitterCount % maxJitterSamples] = us;
+    ++_jitterCount;
+  }
+
+  qi::SteadyClockTimePoint PeriodicTaskPrivate::_nextAbsoluteDeadline(qi::SteadyClockTimePoint now)
+  {
+    auto next = _deadline + _period;
+    if (next < now && _period > qi::Duration(0))
+    {
+      const auto missed = (now - next) / _period + 1;
+      next += missed * _period;
+      _missedDeadlines += static_cast<unsigned int>(missed);
+    }
+    return next;
+  }
+
   void PeriodicTaskPrivate::_wrap()
   {
     qiLogDebug() << "callback start";
@@ -296,13 +379,16 @@ namespace qi
       }
       QI_ASSERT(_state == TaskState::Scheduled || _state == TaskState::Triggering);
       _state = TaskState::Running;
+      _pushJitter(qi::SteadyClock::now() - _deadline);
       _cond.notify_all();
     }
     bool shouldAbort = false;
     qi::SteadyClockTimePoint now;
     qi::Duration delta;
     qi::int64_t usr, sys;
-    bool compensate = _compensateCallTime; // we don't want that bool to change in the middle
+    // we don't want these bools to change in the middle
+    bool compensate = _compensateCallTime;
+    bool absoluteDeadlines = _absoluteDeadlines;
     try
     {
       qi::SteadyClockTimePoint start = qi::SteadyClock::now();
@@ -357,15 +443,29 @@ namespace qi
         _statsDisplayTime = now;
         unsigned int count = _callStats.count();
         std::string catName = "stats." + _name;
-        qiLogVerbose(catName.c_str())
-          << (_callStats.user().cumulatedValue() * 100.0 / secTime)
-          << "%  "
-          << count
-          << "  " << _callStats.wall().asString(count)
-          << "  " << _callStats.user().asString(count)
-          << "  " << _callStats.system().asString(count)
-          ;
+        // Sorting the jitter samples is only worth it if they are logged.
+        if (qi::log::isVisible(catName, qi::LogLevel_Verbose))
+        {
+          std::vector<float> jitter(_jitterSamples);
+          std::sort(jitter.begin(), jitter.end());
+          qiLogVerbose(catName.c_str())
+            << (_callStats.user().cumulatedValue() * 100.0 / secTime)
+            << "%  "
+            << count
+            << "  " << _callStats.wall().asString(count)
+            << "  " << _callStats.user().asString(count)
+            << "  " << _callStats.system().asString(count)
+            << "  jitter(us) " << measure::percentile(jitter, 0.5)
+            << ' ' << measure::percentile(jitter, 0.9)
+            << ' ' << measure::percentile(jitter, 0.99)
+            << ' ' << (jitter.empty() ? 0.f : jitter.back())
+            << "  missed " << _missedDeadlines
+            ;
+        }
         _callStats.reset();
+        _jitterSamples.clear();
+        _jitterCount = 0;
+        _missedDeadlines = 0;
       }
 
       qiLogDebug() << "continuing";
@@ -377,8 +477,33 @@ namespace qi
         _cond.notify_all();
         return;
       }
-      _reschedule(std::max(qi::Duration(0), _period - (compensate ? delta : qi::Duration(0))));
+      if (absoluteDeadlines)
+        _rescheduleAt(_nextAbsoluteDeadline(now));
+      else
+        _reschedule(std::max(qi::Duration(0), _period - (compensate ? delta : qi::Duration(0))));
+    }
+  }
+
+  void PeriodicTask::useAbsoluteDeadlines(bool enable)
+  {
+    PeriodicTaskPrivate::ScopedLock l(_p->_mutex);
+    _p->_absoluteDeadlines = enable;
+  }
+
+  void PeriodicTask::setDedicatedThread(const std::vector<int>& cpus, int realtimePriority)
+  {
+    std::unique_ptr<EventLoop> loop;
+    {
+      PeriodicTaskPrivate::ScopedLock l(_p->_mutex);
+      if (_p->_state != TaskState::Stopped)
+        throw std::runtime_error("Cannot set the dedicated thread of a running periodic task");
+      // A single worker and no monitoring thread, so that it never spawns more.
+      loop.reset(new EventLoop(_p->_name, 1, 1, 1, false));
+      const auto name = _p->_name;
+      loop->async([=] { setupDedicatedThread(name, cpus, realtimePriority); }).wait();
+      std::swap(loop, _p->_dedicatedLoop);
     }
+    // the previous loop, if any, is joined outside of the lock
   }
 
   void PeriodicTask::compensateCallbackTime(bool enable)
@@ -0,0 +1,387 @@
+/*
+**  Copyright (C) 2018 SoftBank Robotics Europe
+**  See COPYING for the license
+*/
+
+#include <qi/log/rotatingfileloghandler.hpp>
+
+#include <boost/filesystem.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <deque>
+#include <string>
+#include <vector>
+
+#ifdef WITH_ZLIB
+# include <zlib.h>
+#endif
+
+#include "log_p.hpp"
+#include <qi/os.hpp>
+
+qiLogCategory("qi.log.rotatingfileloghandler");
+
+namespace bfs = boost::filesystem;
+
+namespace qi
+{
+namespace log
+{
+  namespace
+  {
+#ifdef WITH_ZLIB
+    bool gzipFile(const std::string& source, const std::string& destination)
+    {
+      FILE* in = qi::os::fopen(source.c_str(), "rb");
+      if (!in)
+        return false;
+      gzFile out = gzopen(destination.c_str(), "wb");
+      if (!out)
+      {
+        fclose(in);
+        return false;
+      }
+      std::vector<char> buffer(64 * 1024);
+      bool ok = true;
+      std::size_t size;
+      while (ok && (size = fread(buffer.data(), 1, buffer.size(), in)) > 0)
+        ok = gzwrite(out, buffer.data(), static_cast<unsigned int>(size)) == static_cast<int>(size);
+      fclose(in);
+      return gzclose(out) == Z_OK && ok;
+    }
+#endif
+
+    // Returns N if `fileName` is `baseName`.N or `baseName`.N.gz, 0 otherwise.
+    unsigned int segmentNumber(const std::string& baseName, const std::string& fileName)
+    {
+      const std::string prefix = baseName + ".";
+      if (fileName.compare(0, prefix.size(), prefix) != 0)
+        return 0;
+      std::string number = fileName.substr(prefix.size());
+      if (number.size() > 3 && number.compare(number.size() - 3, 3, ".gz") == 0)
+        number.resize(number.size() - 3);
+      if (number.empty() || number.find_first_not_of("0123456789") != std::string::npos)
+        return 0;
+      try
+      {
+        return boost::lexical_cast<unsigned int>(number);
+      }
+      catch (const boost::bad_lexical_cast&)
+      {
+        return 0;
+      }
+    }
+  }
+
+  struct PrivateRotatingFileLogHandler
+  {
+    RotatingFileLogHandlerConfig _config;
+    bfs::path _path;
+
+    // Owned by the writer thread once it is started.
+    FILE* _file = nullptr;
+    std::size_t _fileSize = 0;
+    qi::SteadyClock::time_point _fileOpened;
+    unsigned int _nextSegment = 1;
+
+    // Guards the buffers and the writer state.
+    boost::mutex _mutex;
+    boost::condition_variable _writerCondition;
+    boost::condition_variable _producerCondition;
+    std::string _current;
+    std::deque<std::string> _pending;
+    std::vector<std::string> _free;
+    qi::uint64_t _flushRequest = 0;
+    qi::uint64_t _flushed = 0;
+    bool _stop = false;
+    boost::thread _writer;
+
+    // Guards the rotated segments and the compression queue.
+    boost::mutex _segmentMutex;
+    boost::condition_variable _compressCondition;
+    std::deque<unsigned int> _segments; // oldest first
+    std::deque<unsigned int> _toCompress;
+    bool _stopCompressor = false;
+    boost::thread _compressor;
+
+    std::string segmentPath(unsigned int segment) const
+    {
+      return _path.string() + "." + boost::lexical_cast<std::string>(segment);
+    }
+
+    void findSegments();
+    void newCurrentBuffer();
+    void writerLoop();
+    void write(const std::string& buffer);
+    void rotate();
+    void compressorLoop();
+  };
+
+  void PrivateRotatingFileLogHandler::findSegments()
+  {
+    const std::string baseName = _path.filename().string();
+    std::vector<unsigned int> segments;
+    boost::system::error_code ec;
+    for (bfs::directory_iterator it(_path.parent_path(), ec), end; !ec && it != end; it.increment(ec))
+    {
+      const unsigned int segment = segmentNumber(baseName, it->path().filename().string());
+      if (segment)
+        segments.push_back(segment);
+    }
+    std::sort(segments.begin(), segments.end());
+    segments.erase(std::unique(segments.begin(), segments.end()), segments.end());
+    _segments.assign(segments.begin(), segments.end());
+    if (!segments.empty())
+      _nextSegment = segments.back() + 1;
+    if (_config.compressRotatedFiles)
+    {
+      for (unsigned int segment : segments)
+        if (bfs::exists(segmentPath(segment), ec))
+          _toCompress.push_back(segment);
+    }
+  }
+
+  void PrivateRotatingFileLogHandler::newCurrentBuffer()
+  {
+    if (_free.empty())
+    {
+      _current = std::string();
+      _current.reserve(_config.bufferSize);
+    }
+    else
+    {
+      _current.swap(_free.back());
+      _free.pop_back();
+    }
+  }
+
+  void PrivateRotatingFileLogHandler::writerLoop()
+  {
+    qi::os::setCurrentThreadName("qi.log.file");
+    std::deque<std::string> batch;
+    boost::unique_lock<boost::mutex> lock(_mutex);
+    while (true)
+    {
+      if (!_stop && _pending.empty() && _flushRequest == _flushed)
+        _writerCondition.wait_for(lock, _config.flushInterval);
+
+      const bool stop = _stop;
+      const qi::uint64_t flushRequest = _flushRequest;
+      batch.swap(_pending);
+      if (!_current.empty())
+      {
+        batch.push_back(std::move(_current));
+        newCurrentBuffer();
+      }
+      _producerCondition.notify_all();
+
+      // Producers keep filling new buffers while the batch is written.
+      lock.unlock();
+      for (const auto& buffer : batch)
+        write(buffer);
+      if (_file && !batch.empty())
+        fflush(_file);
+      if (_config.maxFileAge > qi::Duration::zero() && _fileSize > 0
+          && qi::SteadyClock::now() - _fileOpened >= _config.maxFileAge)
+        rotate();
+      lock.lock();
+
+      for (auto& buffer : batch)
+      {
+        buffer.clear();
+        if (_free.size() < _config.maxPendingBuffers)
+          _free.push_back(std::move(buffer));
+      }
+      batch.clear();
+      _flushed = flushRequest;
+      _producerCondition.notify_all();
+      if (stop)
+        return;
+    }
+  }
+
+  void PrivateRotatingFileLogHandler::write(const std::string& buffer)
+  {
+    if (!_file)
+      return;
+    _fileSize += fwrite(buffer.data(), 1, buffer.size(), _file);
+    if (_config.maxFileSize && _fileSize >= _config.maxFileSize)
+      rotate();
+  }
+
+  // Errors are not logged: the writer thread may not wait on the logging
+  // system, which may itself be waiting for the writer.
+  void PrivateRotatingFileLogHandler::rotate()
+  {
+    if (_file)
+      fclose(_file);
+    const unsigned int segment = _nextSegment++;
+    boost::system::error_code ec;
+    bfs::rename(_path, segmentPath(segment), ec);
+    _file = qi::os::fopen(_path.string().c_str(), "w");
+    _fileSize = 0;
+    _fileOpened = qi::SteadyClock::now();
+    if (ec)
+      return;
+
+    boost::mutex::scoped_lock lock(_segmentMutex);
+    _segments.push_back(segment);
+    while (_segments.size() > _config.maxRotatedFiles)
+    {
+      const std::string oldest = segmentPath(_segments.front());
+      _segments.pop_front();
+      bfs::remove(oldest, ec);
+      bfs::remove(oldest + ".gz", ec);
+    }
+    if (_config.compressRotatedFiles)
+    {
+      _toCompress.push_back(segment);
+      _compressCondition.notify_one();
+    }
+  }
+
+  void PrivateRotatingFileLogHandler::compressorLoop()
+  {
+#ifdef WITH_ZLIB
+    qi::os::setCurrentThreadName("qi.log.gzip");
+    boost::unique_lock<boost::mutex> lock(_segmentMutex);
+    while (true)
+    {
+      while (_toCompress.empty() && !_stopCompressor)
+        _compressCondition.wait(lock);
+      if (_toCompress.empty())
+        return;
+      const unsigned int segment = _toCompress.front();
+      _toCompress.pop_front();
+      const std::string source = segmentPath(segment);
+      const std::string temporary = source + ".gz.tmp";
+
+      lock.unlock();
+      const bool compressed = gzipFile(source, temporary);
+      lock.lock();
+
+      // The segment may have been removed by a rotation in the meantime.
+      boost::system::error_code ec;
+      const bool kept = std::find(_segments.begin(), _segments.end(), segment) != _segments.end();
+      if (compressed && kept)
+      {
+        bfs::rename(temporary, source + ".gz", ec);
+        if (!ec)
+          bfs::remove(source, ec);
+      }
+      else
+        bfs::remove(temporary, ec);
+    }
+#endif
+  }
+
+  RotatingFileLogHandler::RotatingFileLogHandler(const std::string& filePath,
+                                                 RotatingFileLogHandlerConfig config)
+    : _p(new PrivateRotatingFileLogHandler)
+  {
+#ifndef WITH_ZLIB
+    if (config.compressRotatedFiles)
+    {
+      qiLogWarning() << "libqi was built without zlib, rotated log files will not be compressed";
+      config.compressRotatedFiles = false;
+    }
+#endif
+    config.bufferSize = std::max<std::size_t>(config.bufferSize, 1);
+    config.maxPendingBuffers = std::max<std::size_t>(config.maxPendingBuffers, 1);
+    config.flushInterval = std::max<qi::Duration>(config.flushInterval, qi::MilliSeconds(1));
+    _p->_config = config;
+    _p->_path = bfs::path(filePath).make_preferred();
+
+    try
+    {
+      if (!bfs::exists(_p->_path.parent_path()))
+        bfs::create_directories(_p->_path.parent_path());
+    }
+    catch (const bfs::filesystem_error& e)
+    {
+      qiLogWarning() << e.what();
+    }
+
+    FILE* file = qi::os::fopen(_p->_path.string().c_str(), "a");
+    if (!file)
+    {
+      qiLogWarning() << "Cannot open " << filePath;
+      return;
+    }
+    _p->_file = file;
+    boost::system::error_code ec;
+    const auto size = bfs::file_size(_p->_path, ec);
+    _p->_fileSize = ec ? 0 : static_cast<std::size_t>(size);
+    _p->_fileOpened = qi::SteadyClock::now();
+    _p->findSegments();
+    _p->newCurrentBuffer();
+
+    _p->_writer = boost::thread(&PrivateRotatingFileLogHandler::writerLoop, _p.get());
+    if (_p->_config.compressRotatedFiles)
+      _p->_compressor = boost::thread(&PrivateRotatingFileLogHandler::compressorLoop, _p.get());
+  }
+
+  RotatingFileLogHandler::~RotatingFileLogHandler()
+  {
+    {
+      boost::mutex::scoped_lock lock(_p->_mutex);
+      _p->_stop = true;
+      _p->_writerCondition.notify_one();
+    }
+    if (_p->_writer.joinable())
+      _p->_writer.join();
+    {
+      boost::mutex::scoped_lock lock(_p->_segmentMutex);
+      _p->_stopCompressor = true;
+      _p->_compressCondition.notify_one();
+    }
+    if (_p->_compressor.joinable())
+      _p->_compressor.join();
+    if (_p->_file)
+      fclose(_p->_file);
+  }
+
+  void RotatingFileLogHandler::log(const qi::LogLevel verb,
+                                   const qi::Clock::time_point date,
+                                   const qi::SystemClock::time_point systemDate,
+                                   const char* category,
+                                   const char* msg,
+                                   const char* file,
+                                   const char* fct,
+                                   const int line)
+  {
+    if (verb > qi::log::logLevel() || !_p->_writer.joinable())
+      return;
+
+    const std::string logline =
+        qi::detail::logline(qi::log::context(), date, systemDate, category, msg, file, fct, line, verb);
+
+    boost::unique_lock<boost::mutex> lock(_p->_mutex);
+    _p->_current += logline;
+    if (_p->_current.size() >= _p->_config.bufferSize || verb <= _p->_config.flushLevel)
+    {
+      while (_p->_pending.size() >= _p->_config.maxPendingBuffers && !_p->_stop)
+        _p->_producerCondition.wait(lock);
+      _p->_pending.push_back(std::move(_p->_current));
+      _p->newCurrentBuffer();
+      _p->_writerCondition.notify_one();
+    }
+  }
+
+  void RotatingFileLogHandler::flush()
+  {
+    if (!_p->_writer.joinable())
+      return;
+    boost::unique_lock<boost::mutex> lock(_p->_mutex);
+    const qi::uint64_t request = ++_p->_flushRequest;
+    _p->_writerCondition.notify_one();
+    while (_p->_flushed < request && !_p->_stop)
+      _p->_producerCondition.wait(lock);
+  }
+}
+}
@@ -0,0 +1,477 @@
+/*
+**  Copyright (C) 2018 SoftBank Robotics Europe
+**  See COPYING for the license
+*/
+
+#include <qi/log/sharedmemoryloghandler.hpp>
+
+#include <boost/interprocess/mapped_region.hpp>
+#include <boost/interprocess/shared_memory_object.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include <qi/os.hpp>
+
+qiLogCategory("qi.log.sharedmemoryloghandler");
+
+namespace bip = boost::interprocess;
+
+/* The segment holds a header followed by a ring of records. Positions in the
+ * ring only grow, the offset of a position is position % capacity.
+ *
+ * Producers of any process reserve room for a record by moving writePos
+ * forward, write it, then publish it by storing its tag: the record size
+ * and the sequence number of its position, so that the reader cannot
+ * mistake stale data for a record. A record never wraps around the end of
+ * the ring, a padding record fills the room left instead.
+ *
+ * Right after reserving a record, a producer writes its pid in it and stores
+ * a reserved tag: the record size with reservedFlag.
+ *
+ * The reader copies the records in order, then moves readPos forward, which
+ * gives the room back to the producers. If the record at readPos is still
+ * reserved after stallTimeout, the reader skips it once its producer is no
+ * longer running. If there is still no tag at readPos after stallTimeout, its
+ * producer died before storing one, and the reader skips everything reserved
+ * so far. The sizes read from the segment are checked before use: on a
+ * corrupted record, the reader skips everything reserved so far as well.
+ *
+ * record:  tag:u64 level:u8 pad[3] pid:i32 date:i64 systemDate:i64 line:i32
+ *          sizes:u32[5] (category, file, function, format, message)
+ *          bytes (the strings, the format is absent if its size is noFormat)
+ */
+
+namespace qi
+{
+namespace log
+{
+  char const * const defaultSharedMemoryLogName = "qi-log";
+
+  namespace
+  {
+    static_assert(ATOMIC_LLONG_LOCK_FREE == 2,
+                  "shared memory logging requires lock-free 64-bit atomics");
+
+    const char magic[] = { 'Q', 'I', 'L', 'O', 'G', 'S', 'H', 'M' };
+    const qi::uint32_t version = 1;
+    const qi::uint64_t paddingFlag = 1u << 31;
+    const qi::uint64_t reservedFlag = 1u << 30;
+    const qi::uint64_t sizeMask = reservedFlag - 1;
+    const qi::uint32_t noFormat = 0xFFFFFFFF;
+    const std::size_t minSize = 4096;
+    const qi::Duration stallTimeout = qi::Seconds(1);
+    const qi::Duration attachInterval = qi::MilliSeconds(200);
+
+    struct SegmentHeader
+    {
+      char magic[8];
+      qi::uint32_t version;
+      std::atomic<qi::uint32_t> ready;
+      qi::uint64_t capacity;
+      alignas(64) std::atomic<qi::uint64_t> writePos;
+      alignas(64) std::atomic<qi::uint64_t> readPos;
+      std::atomic<qi::uint64_t> dropped;
+    };
+
+    const std::size_t dataOffset = (sizeof(SegmentHeader) + 63) / 64 * 64;
+
+    struct RecordFixed
+    {
+      qi::uint8_t level;
+      qi::uint8_t pad[3];
+      qi::int32_t pid;
+      qi::int64_t date;
+      qi::int64_t systemDate;
+      qi::int32_t line;
+      qi::uint32_t sizes[5];
+    };
+
+    const std::size_t recordHeaderSize = sizeof(qi::uint64_t) + sizeof(RecordFixed);
+
+    std::size_t align8(std::size_t size)
+    {
+      return (size + 7) & ~std::size_t(7);
+    }
+
+    qi::uint64_t sequence(qi::uint64_t position)
+    {
+      return static_cast<qi::uint32_t>((position >> 3) + 1);
+    }
+
+    qi::uint64_t makeTag(qi::uint64_t position, qi::uint64_t size, qi::uint64_t flags)
+    {
+      return (sequence(position) << 32) | flags | size;
+    }
+
+    std::atomic<qi::uint64_t>& tagAt(char* data, qi::uint64_t offset)
+    {
+      return *reinterpret_cast<std::atomic<qi::uint64_t>*>(data + offset);
+    }
+
+    // Whether a record of `size` bytes at `position` lies within the ring and
+    // within what the producers reserved.
+    bool isValidSize(qi::uint64_t position, qi::uint64_t size, qi::uint64_t written,
+                     qi::uint64_t capacity)
+    {
+      return size != 0
+          && size % 8 == 0
+          && size <= capacity - position % capacity
+          && size <= written - position;
+    }
+
+    void skipTo(SegmentHeader& header, qi::uint64_t position, qi::uint64_t written,
+                const char* reason)
+    {
+      qiLogWarning() << reason << " record at " << position << ", skipping "
+                     << written - position << " bytes";
+      header.dropped.fetch_add(1, std::memory_order_relaxed);
+      header.readPos.store(written, std::memory_order_release);
+    }
+
+    bool isValid(const SegmentHeader& header, std::size_t regionSize)
+    {
+      return std::memcmp(header.magic, magic, sizeof(magic)) == 0
+          && header.version == version
+          && header.ready.load(std::memory_order_acquire) == 1
+          && header.capacity >= minSize
+          && header.capacity / 4 <= sizeMask
+          && dataOffset + header.capacity <= regionSize;
+    }
+  }
+
+  struct PrivateSharedMemoryLogHandler
+  {
+    std::string _name;
+    int _pid;
+
+    boost::mutex _attachMutex;
+    bip::mapped_region _region;
+    std::atomic<SegmentHeader*> _header{nullptr};
+    qi::SteadyClock::time_point _lastAttempt;
+    std::atomic<qi::uint64_t> _dropped{0};
+
+    SegmentHeader* attach();
+  };
+
+  SegmentHeader* PrivateSharedMemoryLogHandler::attach()
+  {
+    SegmentHeader* header = _header.load(std::memory_order_acquire);
+    if (header)
+      return header;
+
+    boost::mutex::scoped_lock lock(_attachMutex, boost::try_to_lock);
+    if (!lock.owns_lock())
+      return nullptr;
+    const auto now = qi::SteadyClock::now();
+    if (_lastAttempt != qi::SteadyClock::time_point() && now - _lastAttempt < attachInterval)
+      return nullptr;
+    _lastAttempt = now;
+    try
+    {
+      bip::shared_memory_object shm(bip::open_only, _name.c_str(), bip::read_write);
+      bip::mapped_region region(shm, bip::read_write);
+      if (region.get_size() < dataOffset
+          || !isValid(*static_cast<SegmentHeader*>(region.get_address()), region.get_size()))
+        return nullptr;
+      _region.swap(region);
+    }
+    catch (const bip::interprocess_exception&)
+    {
+      // No collector yet.
+      return nullptr;
+    }
+    header = static_cast<SegmentHeader*>(_region.get_address());
+    _header.store(header, std::memory_order_release);
+    return header;
+  }
+
+  SharedMemoryLogHandler::SharedMemoryLogHandler(const std::string& name)
+    : _p(new PrivateSharedMemoryLogHandler)
+  {
+    _p->_name = name;
+    _p->_pid = qi::os::getpid();
+    if (!_p->attach())
+      qiLogVerbose() << "No log collector on " << name << " yet, messages are dropped until there is one";
+  }
+
+  SharedMemoryLogHandler::~SharedMemoryLogHandler()
+  {
+  }
+
+  void SharedMemoryLogHandler::log(const DeferredLogRecord& record)
+  {
+    SegmentHeader* header = _p->attach();
+    if (!header)
+    {
+      _p->_dropped.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+
+    const char* category = record.category ? record.category : "";
+    const char* file = record.file ? record.file : "";
+    const char* function = record.function ? record.function : "";
+    RecordFixed fixed = {};
+    fixed.level = static_cast<qi::uint8_t>(record.level);
+    fixed.pid = _p->_pid;
+    fixed.date = record.date.time_since_epoch().count();
+    fixed.systemDate = record.systemDate.time_since_epoch().count();
+    fixed.line = record.line;
+    fixed.sizes[0] = static_cast<qi::uint32_t>(std::strlen(category));
+    fixed.sizes[1] = static_cast<qi::uint32_t>(std::strlen(file));
+    fixed.sizes[2] = static_cast<qi::uint32_t>(std::strlen(function));
+    fixed.sizes[3] = record.format ? static_cast<qi::uint32_t>(std::strlen(record.format)) : noFormat;
+    fixed.sizes[4] = static_cast<qi::uint32_t>(record.format ? record.messageSize
+                                                             : std::strlen(record.message));
+    const std::size_t need = align8(recordHeaderSize + fixed.sizes[0] + fixed.sizes[1] + fixed.sizes[2]
+                                    + (record.format ? fixed.sizes[3] : 0) + fixed.sizes[4]);
+
+    const qi::uint64_t capacity = header->capacity;
+    char* data = reinterpret_cast<char*>(header) + dataOffset;
+    qi::uint64_t head = header->writePos.load(std::memory_order_relaxed);
+    qi::uint64_t padding;
+    while (true)
+    {
+      const qi::uint64_t toEnd = capacity - head % capacity;
+      padding = toEnd < need ? toEnd : 0;
+      if (need > capacity / 4
+          || head + padding + need - header->readPos.load(std::memory_order_acquire) > capacity)
+      {
+        header->dropped.fetch_add(1, std::memory_order_relaxed);
+        _p->_dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+      }
+      if (header->writePos.compare_exchange_weak(head, head + padding + need,
+                                                 std::memory_order_relaxed))
+        break;
+    }
+
+    if (padding)
+      tagAt(data, head % capacity).store(makeTag(head, padding, paddingFlag), std::memory_order_release);
+    const qi::uint64_t position = head + padding;
+    char* out = data + position % capacity + sizeof(qi::uint64_t);
+    std::memcpy(out + offsetof(RecordFixed, pid), &fixed.pid, sizeof(fixed.pid));
+    tagAt(data, position % capacity).store(makeTag(position, need, reservedFlag), std::memory_order_release);
+    std::memcpy(out, &fixed, sizeof(fixed));
+    out += sizeof(fixed);
+    const char* strings[] = { category, file, function, record.format, record.message };
+    for (int i = 0; i < 5; ++i)
+    {
+      if (i == 3 && !record.format)
+        continue;
+      std::memcpy(out, strings[i], fixed.sizes[i]);
+      out += fixed.sizes[i];
+    }
+    tagAt(data, position % capacity).store(makeTag(position, need, 0), std::memory_order_release);
+  }
+
+  bool SharedMemoryLogHandler::isAttached() const
+  {
+    return _p->_header.load(std::memory_order_acquire) != nullptr;
+  }
+
+  qi::uint64_t SharedMemoryLogHandler::droppedMessageCount() const
+  {
+    return _p->_dropped.load(std::memory_order_relaxed);
+  }
+
+  struct PrivateSharedMemoryLogReader
+  {
+    bip::mapped_region _region;
+    SegmentHeader* _header;
+    char* _data;
+    std::string _strings[5];
+    // Position at which the reader is waiting for a record to be published.
+    qi::uint64_t _stalledPosition = ~qi::uint64_t(0);
+    qi::SteadyClock::time_point _stalledSince;
+
+    // Whether the reader has been waiting at `position` for more than
+    // stallTimeout, in which case the wait starts over.
+    bool hasStalled(qi::uint64_t position);
+  };
+
+  bool PrivateSharedMemoryLogReader::hasStalled(qi::uint64_t position)
+  {
+    const auto now = qi::SteadyClock::now();
+    if (_stalledPosition != position)
+    {
+      _stalledPosition = position;
+      _stalledSince = now;
+      return false;
+    }
+    if (now - _stalledSince <= stallTimeout)
+      return false;
+    _stalledSince = now;
+    return true;
+  }
+
+  SharedMemoryLogReader::SharedMemoryLogReader(const std::string& name, std::size_t size)
+    : _p(new PrivateSharedMemoryLogReader)
+  {
+    std::size_t capacity = minSize;
+    while (capacity < size)
+      capacity *= 2;
+    if (capacity / 4 > sizeMask)
+      throw std::runtime_error("Cannot create the shared memory segment " + name + ": the ring is too large");
+
+    try
+    {
+      // Only the processes of the user running the collector may log to it.
+      bip::permissions permissions;
+      permissions.set_permissions(0600);
+      bip::shared_memory_object shm(bip::open_or_create, name.c_str(), bip::read_write, permissions);
+      bip::offset_t existingSize = 0;
+      shm.get_size(existingSize);
+      bool reuse = false;
+      if (existingSize >= static_cast<bip::offset_t>(dataOffset))
+      {
+        bip::mapped_region region(shm, bip::read_write);
+        reuse = isValid(*static_cast<SegmentHeader*>(region.get_address()), region.get_size());
+        if (reuse)
+          _p->_region.swap(region);
+      }
+      if (!reuse)
+      {
+        shm.truncate(static_cast<bip::offset_t>(dataOffset + capacity));
+        bip::mapped_region region(shm, bip::read_write);
+        std::memset(region.get_address(), 0, region.get_size());
+        SegmentHeader* header = new (region.get_address()) SegmentHeader;
+        std::memcpy(header->magic, magic, sizeof(magic));
+        header->version = version;
+        header->capacity = capacity;
+        header->writePos.store(0, std::memory_order_relaxed);
+        header->readPos.store(0, std::memory_order_relaxed);
+        header->dropped.store(0, std::memory_order_relaxed);
+        header->ready.store(1, std::memory_order_release);
+        _p->_region.swap(region);
+      }
+    }
+    catch (const bip::interprocess_exception& e)
+    {
+      throw std::runtime_error("Cannot create the shared memory segment " + name + ": " + e.what());
+    }
+    _p->_header = static_cast<SegmentHeader*>(_p->_region.get_address());
+    _p->_data = static_cast<char*>(_p->_region.get_address()) + dataOffset;
+  }
+
+  SharedMemoryLogReader::~SharedMemoryLogReader()
+  {
+  }
+
+  bool SharedMemoryLogReader::next(DeferredLogRecord& record, int& pid, qi::Duration timeout)
+  {
+    SegmentHeader& header = *_p->_header;
+    const qi::uint64_t capacity = header.capacity;
+    const auto deadline = qi::SteadyClock::now() + timeout;
+    while (true)
+    {
+      const qi::uint64_t position = header.readPos.load(std::memory_order_relaxed);
+      const qi::uint64_t written = header.writePos.load(std::memory_order_acquire);
+      if (position != written)
+      {
+        const qi::uint64_t tag = tagAt(_p->_data, position % capacity).load(std::memory_order_acquire);
+        const qi::uint64_t size = tag & sizeMask;
+        const char* in = _p->_data + position % capacity + sizeof(qi::uint64_t);
+        if ((tag >> 32) == sequence(position))
+        {
+          if (!isValidSize(position, size, written, capacity))
+          {
+            skipTo(header, position, written, "Corrupted");
+            continue;
+          }
+
+          if (tag & paddingFlag)
+          {
+            _p->_stalledPosition = ~qi::uint64_t(0);
+            header.readPos.store(position + size, std::memory_order_release);
+            continue;
+          }
+
+          if (tag & reservedFlag)
+          {
+            // Reserved but not published yet.
+            if (_p->hasStalled(position))
+            {
+              qi::int32_t producer;
+              std::memcpy(&producer, in + offsetof(RecordFixed, pid), sizeof(producer));
+              if (!qi::os::isProcessRunning(producer))
+              {
+                header.dropped.fetch_add(1, std::memory_order_relaxed);
+                header.readPos.store(position + size, std::memory_order_release);
+                _p->_stalledPosition = ~qi::uint64_t(0);
+                continue;
+              }
+              // Slow but alive, check again after another stallTimeout.
+            }
+          }
+          else
+          {
+            _p->_stalledPosition = ~qi::uint64_t(0);
+            RecordFixed fixed;
+            std::memcpy(&fixed, in, sizeof(fixed));
+            in += sizeof(fixed);
+            qi::uint64_t stringsSize = 0;
+            for (int i = 0; i < 5; ++i)
+              stringsSize += fixed.sizes[i] == noFormat ? 0 : fixed.sizes[i];
+            if (size < recordHeaderSize || stringsSize > size - recordHeaderSize)
+            {
+              skipTo(header, position, written, "Corrupted");
+              continue;
+            }
+
+            for (int i = 0; i < 5; ++i)
+            {
+              const qi::uint32_t length = fixed.sizes[i] == noFormat ? 0 : fixed.sizes[i];
+              _p->_strings[i].assign(in, length);
+              in += length;
+            }
+            header.readPos.store(position + size, std::memory_order_release);
+
+            pid = fixed.pid;
+            record.level = static_cast<qi::LogLevel>(fixed.level);
+            record.date = qi::Clock::time_point(qi::Clock::duration(fixed.date));
+            record.systemDate = qi::SystemClock::time_point(qi::SystemClock::duration(fixed.systemDate));
+            record.category = _p->_strings[0].c_str();
+            record.file = _p->_strings[1].c_str();
+            record.function = _p->_strings[2].c_str();
+            record.line = fixed.line;
+            record.format = fixed.sizes[3] == noFormat ? nullptr : _p->_strings[3].c_str();
+            record.message = _p->_strings[4].c_str();
+            record.messageSize = _p->_strings[4].size();
+            return true;
+          }
+        }
+        else if (_p->hasStalled(position))
+        {
+          // The record is being reserved and its tag is about to be stored,
+          // unless its producer died right after moving writePos. Its size is
+          // unknown then.
+          skipTo(header, position, written, "Unpublished");
+          _p->_stalledPosition = ~qi::uint64_t(0);
+          continue;
+        }
+      }
+
+      if (qi::SteadyClock::now() >= deadline)
+        return false;
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  }
+
+  qi::uint64_t SharedMemoryLogReader::droppedMessageCount() const
+  {
+    return _p->_header->dropped.load(std::memory_order_relaxed);
+  }
+
+  void SharedMemoryLogReader::remove(const std::string& name)
+  {
+    bip::shared_memory_object::remove(name.c_str());
+  }
+}
+}
@@ -49,6 +49,33 @@ std::ptrdiff_t ObjectTypeInterface::inherits(TypeInterface* other)
   return INHERITS_FAILED;
 }
 
+std::vector<qi::Future<AnyReference>> ObjectTypeInterface::metaCallBatch(
+    void* instance, AnyObject context, const MetaCallBatch& calls)
+{
+  if (auto batchType = dynamic_cast<ObjectTypeBatchCallInterface*>(this))
+    return batchType->metaCallBatch(instance, context, calls);
+  return metaCallOneByOne(instance, context, calls);
+}
+
+std::vector<qi::Future<AnyReference>> ObjectTypeInterface::metaCallOneByOne(
+    void* instance, AnyObject context, const MetaCallBatch& calls)
+{
+  std::vector<qi::Future<AnyReference>> results;
+  results.reserve(calls.size());
+  for (const auto& call : calls)
+  {
+    try
+    {
+      results.push_back(metaCall(instance, context, call.first, call.second, MetaCallType_Queued));
+    }
+    catch (const std::exception& e)
+    {
+      results.push_back(qi::makeFutureError<AnyReference>(e.what()));
+    }
+  }
+  return results;
+}
+
 namespace detail
 {
   ProxyGeneratorMap& proxyGeneratorMap()
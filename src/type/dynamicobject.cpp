@@ -105,7 +105,8 @@ namespace qi
     return  nullptr;
   }
 
-  class DynamicObjectTypeInterface: public ObjectTypeInterface, public DefaultTypeImplMethods<DynamicObject>
+  class DynamicObjectTypeInterface: public ObjectTypeInterface, public ObjectTypeBatchCallInterface,
+                                    public DefaultTypeImplMethods<DynamicObject>
   {
   public:
     DynamicObjectTypeInterface() {}
@@ -113,6 +114,7 @@ namespace qi
     const MetaObject& metaObject(void* instance) override;
     qi::Future<AnyReference> metaCall(void* instance, AnyObject context, unsigned int method, const GenericFunctionParameters& params, MetaCallType callType, Signature returnSignature) override;
     void metaPost(void* instance, AnyObject context, unsigned int signal, const GenericFunctionParameters& params) override;
+    std::vector<qi::Future<AnyReference>> metaCallBatch(void* instance, AnyObject context, const MetaCallBatch& calls) override;
     qi::Future<SignalLink> connect(void* instance, AnyObject context, unsigned int event, const SignalSubscriber& subscriber) override;
     /// Disconnect an event link. Returns if disconnection was successful.
     qi::Future<void> disconnect(void* instance, AnyObject context, SignalLink linkId) override;
@@ -351,6 +353,11 @@ namespace qi
     return;
   }
 
+  std::vector<qi::Future<AnyReference>> DynamicObject::metaCallBatch(AnyObject context, const MetaCallBatch& calls)
+  {
+    return getDynamicTypeInterface()->metaCallOneByOne(this, context, calls);
+  }
+
   qi::Future<SignalLink> DynamicObject::metaConnect(unsigned int event, const SignalSubscriber& subscriber)
   {
     SignalBase * s = _p->createSignal(event);
@@ -418,6 +425,11 @@ namespace qi
     reinterpret_cast<DynamicObject*>(instance)->metaPost(context, signal, params);
   }
 
+  std::vector<qi::Future<AnyReference>> DynamicObjectTypeInterface::metaCallBatch(void* instance, AnyObject context, const MetaCallBatch& calls)
+  {
+    return reinterpret_cast<DynamicObject*>(instance)->metaCallBatch(context, calls);
+  }
+
   qi::Future<SignalLink> DynamicObjectTypeInterface::connect(void* instance, AnyObject context, unsigned int event, const SignalSubscriber& subscriber)
   {
     return reinterpret_cast<DynamicObject*>(instance)->metaConnect(event, subscriber);
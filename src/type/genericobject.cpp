@@ -76,6 +76,61 @@ qi::Future<AnyReference> GenericObject::metaCall(
   return metaCall(methodId, args, callType, returnSignature);
 }
 
+std::vector<Future<AnyReference>> GenericObject::metaCallBatchNoUnwrap(const MetaCallBatch& calls)
+{
+  QI_ASSERT(type && value && "invalid generic object");
+  if (!type || !value)
+    return std::vector<Future<AnyReference>>(
+        calls.size(), qi::makeFutureError<AnyReference>("invalid generic object"));
+  return type->metaCallBatch(value, shared_from_this(), calls);
+}
+
+std::vector<qi::Future<AnyReference>> GenericObject::metaCallBatch(const MetaCallBatch& calls)
+{
+  auto results = metaCallBatchNoUnwrap(calls);
+  for (auto& result : results)
+  {
+    Promise<AnyReference> unwrappedResult;
+    qi::adaptFutureUnwrap(result, unwrappedResult);
+    result = unwrappedResult.future();
+  }
+  return results;
+}
+
+std::vector<qi::Future<AnyValue>> GenericObject::callBatch(const std::vector<BatchCall>& calls)
+{
+  std::vector<qi::Future<AnyValue>> results(calls.size());
+  // Calls to unknown methods fail right away, the others are made together.
+  MetaCallBatch batch;
+  std::vector<std::size_t> batchIndexes;
+  batch.reserve(calls.size());
+  batchIndexes.reserve(calls.size());
+  for (std::size_t i = 0; i < calls.size(); ++i)
+  {
+    GenericFunctionParameters args;
+    args.reserve(calls[i].arguments.size());
+    for (const auto& argument : calls[i].arguments)
+      args.push_back(argument.asReference());
+    const int methodId = findMethod(calls[i].method, args);
+    if (methodId < 0)
+    {
+      results[i] = makeFutureError<AnyValue>(makeFindMethodErrorMessage(calls[i].method, args, methodId));
+      continue;
+    }
+    batch.emplace_back(methodId, std::move(args));
+    batchIndexes.push_back(i);
+  }
+
+  auto futures = metaCallBatchNoUnwrap(batch);
+  for (std::size_t i = 0; i < futures.size(); ++i)
+  {
+    qi::Promise<AnyValue> result;
+    qi::adaptFutureUnwrap(futures[i], result);
+    results[batchIndexes[i]] = result.future();
+  }
+  return results;
+}
+
 int GenericObject::findMethod(const std::string& nameWithOptionalSignature, const GenericFunctionParameters& args)
 {
   return metaObject().findMethod(nameWithOptionalSignature, args);
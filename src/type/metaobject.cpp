@@ -220,51 +220,92 @@ qi::Atomic<int> MetaObjectPrivate::uid{1};
       // DO *NOT* hold the lock while resolving signatures dynamically. This
       // may block (and in case of python need the GIL)
       Signature sResolved = args.signature(dyn==1);
+      std::string fullSig = nameWithOptionalSignature + "::" + sResolved.toString();
+      int result;
       {
-        boost::recursive_mutex::scoped_lock sl(_methodsMutex);
-        std::string resolvedSig = sResolved.toString();
-        std::string fullSig = nameWithOptionalSignature + "::" + resolvedSig;
-        qiLogDebug() << "Finding method for resolved signature " << fullSig;
-        // First try an exact match, which is much faster if we're lucky.
-        int idRev = methodId(nameWithOptionalSignature);
-        if (idRev != -1)
-          return idRev;
-
-        using MethodsPtr = std::vector<std::pair<const MetaMethod*, float>>;
-        MethodsPtr mml;
-
-        // embed findCompatibleMethod
-        for (MetaMethod* mm = firstOverload; mm; mm=mm->_p->next)
-        { // still suboptimal, we are rescanning all overloads regardless of arg count
-          float score = sResolved.isConvertibleTo(mm->parametersSignature());
-          if (score)
-            mml.push_back(std::make_pair(mm, score));
-        }
-
-        if (mml.empty())
-          continue;
-        if (mml.size() == 1)
-          return mml.front().first->uid();
-
-        // get best match
-        MethodsPtr::iterator it = std::max_element(mml.begin(), mml.end(), less_pair_second());
-        int count = 0;
-        for (unsigned i=0; i<mml.size(); ++i)
+        boost::shared_lock<boost::shared_mutex> cl(_overloadCacheMutex);
+        const auto it = _overloadCache.find(fullSig);
+        if (it != _overloadCache.end())
         {
-          if (mml[i].second == it->second)
-            ++count;
+          ++_overloadCacheHits;
+          result = it->second;
         }
-        QI_ASSERT(count);
-        if (count > 1) {
-          qiLogVerbose() << generateErrorString(nameWithOptionalSignature, fullSig, const_cast<MetaObjectPrivate*>(this)->findCompatibleMethod(nameWithOptionalSignature), -3, false);
-          retval = -3;
-        } else
-          return it->first->uid();
+        else
+          result = overloadCacheMiss;
       }
+      if (result == overloadCacheMiss)
+      {
+        ++_overloadCacheMisses;
+        boost::recursive_mutex::scoped_lock sl(_methodsMutex);
+        result = resolveOverload(nameWithOptionalSignature, fullSig, sResolved, firstOverload);
+        // Inserted under the methods lock, so that refreshCache cannot clear
+        // the cache between the resolution and the insertion.
+        boost::unique_lock<boost::shared_mutex> cl(_overloadCacheMutex);
+        if (_overloadCache.size() >= maxOverloadCacheSize)
+          _overloadCache.clear();
+        _overloadCache.emplace(std::move(fullSig), result);
+      }
+      if (result >= 0)
+        return result;
+      if (result == -3)
+        retval = -3;
     }
     return retval;
   }
 
+  /*
+   * Scores the overloads against the resolved signature of the arguments.
+   * return the method id, -2 if none matches or -3 if several match equally.
+   */
+  int MetaObjectPrivate::resolveOverload(const std::string& name,
+                                         const std::string& fullSig,
+                                         const Signature& sResolved,
+                                         MetaMethod* firstOverload) const
+  {
+    qiLogDebug() << "Finding method for resolved signature " << fullSig;
+    // First try an exact match, which is much faster if we're lucky.
+    int idRev = methodId(name);
+    if (idRev != -1)
+      return idRev;
+
+    using MethodsPtr = std::vector<std::pair<const MetaMethod*, float>>;
+    MethodsPtr mml;
+
+    // embed findCompatibleMethod
+    for (MetaMethod* mm = firstOverload; mm; mm=mm->_p->next)
+    { // still suboptimal, we are rescanning all overloads regardless of arg count
+      float score = sResolved.isConvertibleTo(mm->parametersSignature());
+      if (score)
+        mml.push_back(std::make_pair(mm, score));
+    }
+
+    if (mml.empty())
+      return -2;
+    if (mml.size() == 1)
+      return mml.front().first->uid();
+
+    // get best match
+    MethodsPtr::iterator it = std::max_element(mml.begin(), mml.end(), less_pair_second());
+    int count = 0;
+    for (unsigned i=0; i<mml.size(); ++i)
+    {
+      if (mml[i].second == it->second)
+        ++count;
+    }
+    QI_ASSERT(count);
+    if (count > 1) {
+      qiLogVerbose() << generateErrorString(name, fullSig, const_cast<MetaObjectPrivate*>(this)->findCompatibleMethod(name), -3, false);
+      return -3;
+    }
+    return it->first->uid();
+  }
+
+  MetaObject::OverloadCacheStats MetaObject::overloadCacheStats() const
+  {
+    boost::shared_lock<boost::shared_mutex> cl(_p->_overloadCacheMutex);
+    return { _p->_overloadCacheHits.load(), _p->_overloadCacheMisses.load(), _p->_overloadCache.size() };
+  }
+
   std::vector<MetaObject::CompatibleMethod> MetaObjectPrivate::findCompatibleMethod(const std::string &nameOrSignature)
   {
     boost::recursive_mutex::scoped_lock sl(_methodsMutex);
@@ -501,6 +542,12 @@ qi::Atomic<int> MetaObjectPrivate::uid{1};
         _objectNameToIdx[methodNameSignature] = MetaObjectIdType(metaMethod.uid(), MetaObjectType_Method);
         idx = std::max(idx, metaMethod.uid());
         buff << methodNameSignature << metaMethod.uid();
+        // The documentation is part of the content: MetaObjects are told
+        // apart by their digest when cached.
+        buff << metaMethod.returnSignature().toString() << metaMethod.description()
+             << metaMethod.returnDescription();
+        for (const auto& parameter : metaMethod.parameters())
+          buff << parameter.name() << parameter.description();
 
         OverloadMap::iterator overloadIt = _methodNameToOverload.find(metaMethod.name());
         if (overloadIt == _methodNameToOverload.end())
@@ -533,6 +580,10 @@ qi::Atomic<int> MetaObjectPrivate::uid{1};
     // update content hash
     _contentSHA1 = ka::sha1(buff.str());
     _dirtyCache = false;
+
+    // overloads may have changed
+    boost::unique_lock<boost::shared_mutex> cl(_overloadCacheMutex);
+    _overloadCache.clear();
   }
 
   void MetaObjectPrivate::setDescription(const std::string &desc) {
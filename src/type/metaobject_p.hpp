@@ -8,8 +8,11 @@
 #pragma once
 
 #include <array>
+#include <atomic>
+#include <unordered_map>
 #include <boost/optional.hpp>
 #include <boost/thread/recursive_mutex.hpp>
+#include <boost/thread/shared_mutex.hpp>
 #include <ka/macroregular.hpp>
 #include <ka/range.hpp>
 #include <qi/atomic.hpp>
@@ -161,6 +164,9 @@ namespace qi {
   private:
     friend class MetaObject;
 
+    int resolveOverload(const std::string& name, const std::string& fullSig,
+                        const Signature& sResolved, MetaMethod* firstOverload) const;
+
   public:
     /*
      * When a member is added, serialization and deserialization
@@ -194,6 +200,16 @@ namespace qi {
 
     boost::optional<ka::sha1_digest_t>  _contentSHA1;
 
+    // Overloads chosen by findMethod, by name and resolved signature of the
+    // arguments ("name::(sig)"). Negative values are resolution failures.
+    // Cleared by refreshCache.
+    enum { overloadCacheMiss = -100, maxOverloadCacheSize = 4096 };
+    using OverloadCache = std::unordered_map<std::string, int>;
+    mutable OverloadCache               _overloadCache;
+    mutable boost::shared_mutex         _overloadCacheMutex;
+    mutable std::atomic<qi::uint64_t>   _overloadCacheHits{0};
+    mutable std::atomic<qi::uint64_t>   _overloadCacheMisses{0};
+
     // Global uid for event subscribers.
     static qi::Atomic<int> uid;
 
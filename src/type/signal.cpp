@@ -49,6 +49,7 @@ namespace qi {
       subscriber = it->second;
       // Remove from map (but SignalSubscriber object still good)
       subscriberMap.erase(it);
+      publishSubscribersUnsync();
       if (subscriberMap.empty() && onSubscribers)
         onSubscribersToCall = onSubscribers;
       // Ensure no call on subscriber occurs once this function returns
@@ -90,6 +91,20 @@ namespace qi {
     });
   }
 
+  void SignalBasePrivate::publishSubscribersUnsync()
+  {
+    auto snapshot = std::make_shared<SignalSubscriberSnapshot>();
+    snapshot->reserve(subscriberMap.size());
+    for (const auto& linkAndSubscriber: subscriberMap)
+      snapshot->push_back(linkAndSubscriber.second);
+    std::atomic_store(&subscribersSnapshot, std::move(snapshot));
+  }
+
+  SignalSubscriberSnapshotPtr SignalBasePrivate::subscribers() const
+  {
+    return std::atomic_load(&subscribersSnapshot);
+  }
+
   SignalSubscriberPrivate::SignalSubscriberPrivate() = default;
   SignalSubscriberPrivate::~SignalSubscriberPrivate() = default;
 
@@ -133,10 +148,48 @@ QI_WARNING_POP()
   void SignalBase::setCallType(MetaCallType callType)
   {
     QI_ASSERT(_p);
-    boost::recursive_mutex::scoped_lock lock(_p->mutex);
     _p->defaultCallType = callType;
   }
 
+  namespace {
+    void inheritDeliveryPolicy(SignalSubscriberPrivate& subscriber, const DeliveryPolicy& policy)
+    {
+      if (!subscriber.hasOwnDeliveryPolicy)
+        subscriber.maxPendingDeliveries = policy.maxPending();
+    }
+  } // namespace
+
+  void SignalBase::setDeliveryPolicy(DeliveryPolicy policy)
+  {
+    QI_ASSERT(_p);
+    boost::recursive_mutex::scoped_lock lock(_p->mutex);
+    _p->deliveryPolicy = policy;
+    for (auto& linkAndSubscriber: _p->subscriberMap)
+      inheritDeliveryPolicy(*linkAndSubscriber.second._p, policy);
+  }
+
+  DeliveryPolicy SignalBase::deliveryPolicy() const
+  {
+    QI_ASSERT(_p);
+    boost::recursive_mutex::scoped_lock lock(_p->mutex);
+    return _p->deliveryPolicy;
+  }
+
+  void SignalBase::setMessagePriority(MessagePriority priority)
+  {
+    QI_ASSERT(_p);
+    boost::recursive_mutex::scoped_lock lock(_p->mutex);
+    _p->messagePriority = priority;
+    for (auto& linkAndSubscriber: _p->subscriberMap)
+      linkAndSubscriber.second._p->messagePriority = priority;
+  }
+
+  MessagePriority SignalBase::messagePriority() const
+  {
+    QI_ASSERT(_p);
+    return _p->messagePriority;
+  }
+
   void SignalBase::operator()(
       qi::AutoAnyReference p1,
       qi::AutoAnyReference p2,
@@ -163,7 +216,7 @@ QI_WARNING_POP()
                      << signature.toString() << " " << _p->signature.toString();
         return MetaCallType_Auto;
       }
-      return _p->defaultCallType;
+      return _p->defaultCallType.load();
     }();
 
     trigger(params, mct);
@@ -198,14 +251,32 @@ QI_WARNING_POP()
   }
 
   namespace {
+    std::shared_ptr<GenericFunctionParameters> sharedParameters(
+        const GenericFunctionParameters& params)
+    {
+      return {
+        new auto(params.copy()),
+        [](GenericFunctionParameters* object) {
+          object->destroy(); // see GenericFunctionParameters::copy() for details
+          delete object;
+        }
+      };
+    }
+
+    const std::shared_ptr<GenericFunctionParameters>& sharedParameters(
+        const std::shared_ptr<GenericFunctionParameters>& params)
+    {
+      return params;
+    }
+
     template<typename Params>
-    void callSubscribersImpl(const SignalBase& x, SignalSubscriberMap& subscribers,
+    void callSubscribersImpl(const SignalBase& x, SignalSubscriberSnapshot& subscribers,
                              const Params& params, MetaCallType callType)
     {
-      for (auto& i: subscribers)
+      // The snapshot holds the subscriptions alive.
+      for (auto& s: subscribers)
       {
         qiLogDebug() << &x << " Invoking signal subscriber";
-        SignalSubscriber s = i.second; // holds the subscription alive
         s.call(params, callType);
       }
     }
@@ -216,15 +287,15 @@ QI_WARNING_POP()
     MetaCallType mct = callType;
     QI_ASSERT(_p);
 
-    SignalSubscriberMap copy;
-    {
-      boost::recursive_mutex::scoped_lock lock(_p->mutex);
-      if (mct == qi::MetaCallType_Auto)
-        mct = _p->defaultCallType;
+    if (mct == qi::MetaCallType_Auto)
+      mct = _p->defaultCallType;
 
-      copy = _p->subscriberMap;
-    }
-    qiLogDebug() << this << " Invoking signal subscribers: " << copy.size();
+    // The snapshot is only replaced on connection and disconnection, so that
+    // triggering neither locks the signal nor copies its subscribers.
+    const SignalSubscriberSnapshotPtr subscribers = _p->subscribers();
+    qiLogDebug() << this << " Invoking signal subscribers: " << subscribers->size();
+    if (subscribers->empty())
+      return;
 
     // If any subscriber is going to use an execution context, it's going to
     // need a copy of the arguments, so that it can post a task to the execution
@@ -232,26 +303,19 @@ QI_WARNING_POP()
     // because it would be inefficient. We therefore detect here if a copy is
     // needed, and if so make this copy once for all.
 
-    using V = SignalSubscriberMap::value_type;
-    const bool mustCopyParams = std::any_of(copy.begin(), copy.end(), [mct](const V& v) {
-      const SignalSubscriber& s = v.second;
+    const bool mustCopyParams = std::any_of(subscribers->begin(), subscribers->end(),
+                                            [mct](const SignalSubscriber& s) {
       return static_cast<bool>(s.executionContextFor(mct)); // Has a context.
     });
 
     if (mustCopyParams)
     {
-      std::shared_ptr<GenericFunctionParameters> paramsCopy{
-        new auto(params.copy()),
-        [](GenericFunctionParameters* object) {
-          object->destroy(); // see GenericFunctionParameters::copy() for details
-          delete object;
-        }
-      };
-      callSubscribersImpl(*this, copy, std::move(paramsCopy), mct);
+      auto paramsCopy = sharedParameters(params);
+      callSubscribersImpl(*this, *subscribers, std::move(paramsCopy), mct);
     }
     else
     {
-      callSubscribersImpl(*this, copy, params, mct);
+      callSubscribersImpl(*this, *subscribers, params, mct);
     }
     qiLogDebug() << this << " done invoking signal subscribers";
   }
@@ -329,6 +393,11 @@ QI_WARNING_POP()
         {
           throw std::runtime_error("Event loop was destroyed");
         }
+        if (_p->maxPendingDeliveries != 0)
+        {
+          postBounded(sharedParameters(args), executionContext);
+          return;
+        }
         auto subscriberCopy = *this;
         executionContext->post([subscriberCopy, args] () mutable {
           subscriberCopy.callImpl(ka::src(args));
@@ -360,6 +429,48 @@ QI_WARNING_POP()
     }
   }
 
+  void SignalSubscriber::postBounded(std::shared_ptr<GenericFunctionParameters> args,
+                                     ExecutionContext* executionContext)
+  {
+    {
+      boost::mutex::scoped_lock lock(_p->pendingMutex);
+      auto& pending = _p->pendingDeliveries;
+      const std::size_t maxPending = _p->maxPendingDeliveries;
+      while (!pending.empty() && pending.size() >= maxPending)
+      {
+        pending.pop_front();
+        ++_p->droppedDeliveries;
+      }
+      pending.push_back(std::move(args));
+      if (_p->draining)
+        return;
+      _p->draining = true;
+    }
+    auto subscriberCopy = *this;
+    executionContext->post([subscriberCopy] () mutable {
+      subscriberCopy.drainPendingDeliveries();
+    });
+  }
+
+  void SignalSubscriber::drainPendingDeliveries()
+  {
+    while (true)
+    {
+      std::shared_ptr<GenericFunctionParameters> args;
+      {
+        boost::mutex::scoped_lock lock(_p->pendingMutex);
+        if (_p->pendingDeliveries.empty())
+        {
+          _p->draining = false;
+          return;
+        }
+        args = std::move(_p->pendingDeliveries.front());
+        _p->pendingDeliveries.pop_front();
+      }
+      callImpl(*args);
+    }
+  }
+
   void SignalSubscriber::call(const GenericFunctionParameters& args, MetaCallType callType)
   {
     callWithValueOrPtr(args, callType);
@@ -377,6 +488,29 @@ QI_WARNING_POP()
     return *this;
   }
 
+  SignalSubscriber SignalSubscriber::setDeliveryPolicy(DeliveryPolicy policy)
+  {
+    _p->hasOwnDeliveryPolicy = true;
+    _p->maxPendingDeliveries = policy.maxPending();
+    return *this;
+  }
+
+  DeliveryPolicy SignalSubscriber::deliveryPolicy() const
+  {
+    const std::size_t maxPending = _p->maxPendingDeliveries;
+    return maxPending == 0 ? DeliveryPolicy::all() : DeliveryPolicy::bounded(maxPending);
+  }
+
+  qi::uint64_t SignalSubscriber::droppedDeliveries() const
+  {
+    return _p->droppedDeliveries;
+  }
+
+  MessagePriority SignalSubscriber::messagePriority() const
+  {
+    return _p->messagePriority;
+  }
+
   SignalLink SignalSubscriber::link() const
   {
     return _p->linkId;
@@ -461,6 +595,9 @@ QI_WARNING_POP()
     subscriberInMap = src;
     subscriberInMap._p->linkId = res;
     subscriberInMap._p->source = this->_p;
+    inheritDeliveryPolicy(*subscriberInMap._p, _p->deliveryPolicy);
+    subscriberInMap._p->messagePriority = _p->messagePriority.load();
+    _p->publishSubscribersUnsync();
     Future<void> callingOnSubscribers{nullptr};
     if (first && _p->onSubscribers)
     {
@@ -502,6 +639,7 @@ QI_WARNING_POP()
 
     _p->subscriberMap.erase(it->second);
     _p->trackMap.erase(it);
+    _p->publishSubscribersUnsync();
   }
 
   ExecutionContext* SignalBase::executionContext() const
@@ -587,19 +725,14 @@ QI_WARNING_POP()
 
   std::vector<SignalSubscriber> SignalBase::subscribers()
   {
-    std::vector<SignalSubscriber> res;
     QI_ASSERT(_p);
-    boost::recursive_mutex::scoped_lock sl(_p->mutex);
-    for (const auto& i: _p->subscriberMap)
-      res.push_back(i.second);
-    return res;
+    return *_p->subscribers();
   }
 
   bool SignalBase::hasSubscribers()
   {
     QI_ASSERT(_p);
-    boost::recursive_mutex::scoped_lock sl(_p->mutex);
-    return !_p->subscriberMap.empty();
+    return !_p->subscribers()->empty();
   }
 
   SignalSubscriber SignalBase::connect(AnyObject obj, const std::string& slot)
@@ -7,6 +7,9 @@
 #ifndef _SRC_SIGNAL_P_HPP_
 #define _SRC_SIGNAL_P_HPP_
 
+#include <atomic>
+#include <memory>
+#include <vector>
 #include <qi/signal.hpp>
 #include <boost/thread/thread.hpp>
 #include <boost/thread/recursive_mutex.hpp>
@@ -16,12 +19,19 @@ namespace qi {
   using SignalSubscriberMap = std::map<SignalLink, SignalSubscriber>;
   using TrackMap = std::map<int, SignalLink>;
 
+  /// Immutable view of the subscribers of a signal, shared by all the triggers
+  /// running concurrently. The vector is never modified once published.
+  using SignalSubscriberSnapshot = std::vector<SignalSubscriber>;
+  using SignalSubscriberSnapshotPtr = std::shared_ptr<SignalSubscriberSnapshot>;
+
   class SignalBasePrivate
   {
   public:
     SignalBasePrivate()
       : execContext(nullptr)
+      , subscribersSnapshot(std::make_shared<SignalSubscriberSnapshot>())
       , defaultCallType(MetaCallType_Auto)
+      , deliveryPolicy(DeliveryPolicy::all())
     {}
 
     ~SignalBasePrivate();
@@ -32,14 +42,26 @@ namespace qi {
     friend class SignalBase;
     Future<bool> disconnectAllStep(bool overallSuccess);
 
+    /// Rebuilds the snapshot read by triggers from `subscriberMap`.
+    /// Must be called with `mutex` locked, after each change of the map.
+    void publishSubscribersUnsync();
+
+    /// Returns the current snapshot without taking `mutex`.
+    SignalSubscriberSnapshotPtr subscribers() const;
+
     SignalBase::OnSubscribers      onSubscribers;
     ExecutionContext*              execContext;
     SignalSubscriberMap            subscriberMap;
+    // Copy-on-write view of `subscriberMap`, swapped on connect/disconnect.
+    // Only accessed through std::atomic_load/std::atomic_store.
+    SignalSubscriberSnapshotPtr    subscribersSnapshot;
     TrackMap                       trackMap;
     qi::Atomic<int>                trackId;
     qi::Signature                  signature;
     boost::recursive_mutex         mutex;
-    MetaCallType                   defaultCallType;
+    std::atomic<MetaCallType>      defaultCallType;
+    DeliveryPolicy                 deliveryPolicy;
+    std::atomic<MessagePriority>   messagePriority{MessagePriority_Normal};
     SignalBase::Trigger            triggerOverride;
   };
 
@@ -34,4 +34,5 @@ namespace mock
       N::SocketFunctions<qi::sock::SocketWithContext<N>>::_async_write_socket =
           defaultAsyncWriteSocket<qi::sock::SocketWithContext<N>>;
   N::_anyAsyncWriterNextLayer N::_async_write_next_layer = defaultAsyncWriteNextLayer;
+  N::_anyCorkSetter N::_setSocketCork = defaultSetSocketCork;
 } // namespace mock
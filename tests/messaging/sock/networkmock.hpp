@@ -29,6 +29,14 @@ namespace mock
     {
       bool value;
     };
+    struct socket_option_send_buffer_size_type
+    {
+      int value;
+    };
+    struct socket_option_receive_buffer_size_type
+    {
+      int value;
+    };
     struct accept_option_reuse_address_type
     {
       bool value;
@@ -139,6 +147,8 @@ namespace mock
         static const int max_connections = 42;
         using endpoint_type = _endpoint;
         void set_option(socket_option_no_delay_type) {}
+        void set_option(socket_option_send_buffer_size_type) {}
+        void set_option(socket_option_receive_buffer_size_type) {}
 
         using _anyAsyncConnecter = std::function<void (_resolver_entry, _anyHandler)>;
         static _anyAsyncConnecter async_connect;
@@ -183,6 +193,9 @@ namespace mock
 
       struct next_layer_type {} _next_layer;
       next_layer_type& next_layer() {return _next_layer;}
+
+      using native_handle_type = void*;
+      native_handle_type native_handle() {return {};}
     };
     struct acceptor_type
     {
@@ -251,6 +264,17 @@ namespace mock
 
     using H = ssl_socket_type::lowest_layer_type::_native_handle;
     static void setSocketNativeOptions(H, int) {}
+    static bool setSocketBusyPoll(H, unsigned int) {return false;}
+    using _anyCorkSetter = std::function<void (H, bool)>;
+    static _anyCorkSetter _setSocketCork;
+    static void setSocketCork(H h, bool corked)
+    {
+      _setSocketCork(h, corked);
+    }
+
+    static void enableTlsOffload(ssl_context_type&) {}
+    template<typename S>
+    static bool offloadTlsSend(S&) {return false;}
 
     struct _mutable_buffer_sequence
     {
@@ -457,6 +481,10 @@ namespace mock
     }}.detach();
   }
 
+  inline void defaultSetSocketCork(N::H, bool)
+  {
+  }
+
   inline void defaultAsyncWriteNextLayer(N::ssl_socket_type::next_layer_type&, const std::vector<N::_const_buffer_sequence>&, N::_anyTransferHandler h)
   {
     std::thread{[=] {
@@ -0,0 +1,173 @@
+/*
+**  Copyright (C) 2018 SoftBank Robotics Europe
+**  See COPYING for the license
+*/
+
+#include <cstdlib>
+#include <new>
+#include <thread>
+#include <vector>
+#include <boost/asio.hpp>
+#include <gtest/gtest.h>
+#include "src/messaging/message.hpp"
+#include <src/messaging/sock/networkasio.hpp>
+#include <src/messaging/sock/sslcontextptr.hpp>
+#include <src/messaging/sock/receive.hpp>
+
+// Counts the allocations made by the threads which enable it. This replaces
+// the global allocation functions of the whole test program, which is why
+// these tests have a program of their own.
+namespace
+{
+  thread_local bool countingAllocations = false;
+  thread_local std::size_t allocationCount = 0;
+
+  void countAllocation()
+  {
+    if (countingAllocations)
+      ++allocationCount;
+  }
+}
+
+#ifdef __GLIBC__
+// Buffer grows its memory with malloc and realloc, which are counted too.
+// Operator new calls malloc, so it is counted by malloc.
+extern "C" void* __libc_malloc(std::size_t size);
+extern "C" void* __libc_realloc(void* p, std::size_t size);
+
+extern "C" void* malloc(std::size_t size)
+{
+  countAllocation();
+  return __libc_malloc(size);
+}
+
+extern "C" void* realloc(void* p, std::size_t size)
+{
+  countAllocation();
+  return __libc_realloc(p, size);
+}
+#endif
+
+void* operator new(std::size_t size)
+{
+#ifndef __GLIBC__
+  countAllocation();
+#endif
+  if (void* p = std::malloc(size ? size : 1))
+    return p;
+  throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept
+{
+  std::free(p);
+}
+
+namespace
+{
+  struct SteadyReceive
+  {
+    std::size_t allocationCount;
+    bool samePayloadMemory;
+  };
+
+  // Receives `warmUp` messages with a payload of `payloadSize` bytes, then
+  // `measured` others while counting the allocations of the receiving
+  // thread. Only the receiving of the messages is measured: the messages are
+  // not dispatched to a signal.
+  SteadyReceive receiveSteadily(std::size_t payloadSize, std::size_t warmUp, std::size_t measured,
+                                std::size_t batch)
+  {
+    using namespace qi;
+    using namespace qi::sock;
+    using N = NetworkAsio;
+    namespace ip = boost::asio::ip;
+
+    // All the handlers run on this thread, the only one counting allocations.
+    N::io_service_type io;
+    SslContext<N> context{ Method<SslContext<N>>::sslv23 };
+    ip::tcp::acceptor acceptor(io, ip::tcp::endpoint(ip::address_v4::loopback(), 0));
+    auto receiver = makeSslSocketPtr<N>(io, context);
+    ip::tcp::socket sender(io);
+    sender.connect(acceptor.local_endpoint());
+    acceptor.accept(receiver->next_layer());
+
+    // One message as sent on the wire.
+    Message msg{Message::Type_Call, MessageAddress{1, 2, 3, 4}};
+    std::vector<char> payload(payloadSize, 'p');
+    Buffer buffer;
+    buffer.write(payload.data(), payload.size());
+    msg.setBuffer(buffer);
+    const char* header = reinterpret_cast<const char*>(&msg.header());
+    std::vector<char> wire(header, header + sizeof(Message::Header));
+    wire.insert(wire.end(), payload.begin(), payload.end());
+
+    std::size_t received = 0;
+    const void* payloadMemory = nullptr;
+    SteadyReceive result{0u, true};
+    ReceiveMessageContinuous<N> receive;
+    receive(receiver, SslEnabled{false}, 2 * payloadSize, [&](ErrorCode<N> e, const Message* m) {
+      if (e)
+        return false;
+      ++received;
+      if (received == warmUp)
+        payloadMemory = m->buffer().data();
+      else if (received > warmUp && m->buffer().data() != payloadMemory)
+        result.samePayloadMemory = false;
+      return received < warmUp + measured;
+    });
+
+    // The messages are written by another thread, so that large batches do
+    // not block this one.
+    auto sendAndReceive = [&](std::size_t count) {
+      std::vector<char> bytes;
+      for (std::size_t i = 0; i < count; ++i)
+        bytes.insert(bytes.end(), wire.begin(), wire.end());
+      std::thread writer([&] { boost::asio::write(sender, boost::asio::buffer(bytes)); });
+      const std::size_t target = received + count;
+      countingAllocations = true;
+      while (received < target && io.run_one() != 0)
+        ;
+      countingAllocations = false;
+      writer.join();
+    };
+
+    sendAndReceive(warmUp);
+    EXPECT_EQ(warmUp, received);
+    allocationCount = 0;
+    for (std::size_t i = 0; i < measured / batch; ++i)
+      sendAndReceive(batch);
+    EXPECT_EQ(warmUp + measured, received);
+    result.allocationCount = allocationCount;
+
+    sender.close();
+    receiver->next_layer().close();
+    return result;
+  }
+}
+
+TEST(NetReceiveMessage, ReceivesWithoutAllocatingOnceWarmedUp)
+{
+  // The payload is stored inline in the buffer.
+  const auto result = receiveSteadily(100, 10, 1000, 50);
+  EXPECT_EQ(0u, result.allocationCount);
+  EXPECT_TRUE(result.samePayloadMemory);
+}
+
+TEST(NetReceiveMessage, ReceivesLargePayloadsWithoutAllocatingOnceWarmedUp)
+{
+  // The payload is stored in the memory of the buffer on the heap, which is
+  // kept from a message to the next.
+  const auto result = receiveSteadily(64 * 1024, 10, 200, 10);
+  EXPECT_EQ(0u, result.allocationCount);
+  EXPECT_TRUE(result.samePayloadMemory);
+}
+
+TEST(NetReceiveMessage, ReleasesTheMemoryOfPayloadsLargerThanTheKeptMaximum)
+{
+  const std::size_t measured = 10;
+  const auto result = receiveSteadily(
+      qi::sock::ReceiveMessageContinuous<qi::sock::NetworkAsio>::maxKeptPayload + 1, 2, measured, 1);
+  // The memory is allocated again for each message.
+  EXPECT_LE(measured, result.allocationCount);
+}
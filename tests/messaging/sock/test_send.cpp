@@ -275,6 +275,101 @@ TYPED_TEST(NetSendMessageEnqueue, MultipleSendsFromMultipleThreads)
   std::this_thread::sleep_for(defaultPostPauseInMs);
 }
 
+TEST(NetSendMessageEnqueue, HigherPriorityMessagesAreSentFirst)
+{
+  using namespace qi;
+  using namespace qi::sock;
+  using N = mock::Network;
+  // The writes complete when the test says so.
+  std::vector<N::_anyTransferHandler> pendingWrites;
+  auto scopedWrite = ka::scoped_set_and_restore(
+    N::_async_write_next_layer,
+    [&](SslSocket<N>::next_layer_type&, const std::vector<N::_const_buffer_sequence>&,
+        N::_anyTransferHandler writeCont) {
+      pendingWrites.push_back(writeCont);
+    }
+  );
+  SslContext<N> context;
+  auto socket = makeSslSocketPtr<N>(N::defaultIoService(), context);
+  using I = std::list<Message>::const_iterator;
+  std::vector<unsigned int> sentIds;
+  SendMessageEnqueue<N, SslSocketPtr<N>> send{socket};
+  auto onSent = [&](ErrorCode<N>, I itMsg) {
+    sentIds.push_back(itMsg->id());
+    return true;
+  };
+  auto message = [](unsigned int id, MessagePriority priority) {
+    Message msg(Message::Type_Call, MessageAddress{id, 1, 1, 100});
+    msg.setPriority(priority);
+    return msg;
+  };
+
+  // The first message is being sent, it is not preempted.
+  send(message(1, MessagePriority_Low), SslEnabled{false}, onSent);
+  send(message(2, MessagePriority_Low), SslEnabled{false}, onSent);
+  send(message(3, MessagePriority_Normal), SslEnabled{false}, onSent);
+  send(message(4, MessagePriority_High), SslEnabled{false}, onSent);
+  send(message(5, MessagePriority_Normal), SslEnabled{false}, onSent);
+  send(message(6, MessagePriority_High), SslEnabled{false}, onSent);
+  ASSERT_EQ(1u, pendingWrites.size());
+
+  while (!pendingWrites.empty())
+  {
+    auto writeCont = pendingWrites.front();
+    pendingWrites.erase(pendingWrites.begin());
+    writeCont(success<ErrorCode<N>>(), 0u);
+  }
+  const std::vector<unsigned int> expected{1, 4, 6, 3, 5, 2};
+  ASSERT_EQ(expected, sentIds);
+}
+
+TEST(NetSendMessageEnqueue, CorksWhileMessagesAreQueued)
+{
+  using namespace qi;
+  using namespace qi::sock;
+  using N = mock::Network;
+  // The writes complete when the test says so.
+  std::vector<N::_anyTransferHandler> pendingWrites;
+  auto scopedWrite = ka::scoped_set_and_restore(
+    N::_async_write_next_layer,
+    [&](SslSocket<N>::next_layer_type&, const std::vector<N::_const_buffer_sequence>&,
+        N::_anyTransferHandler writeCont) {
+      pendingWrites.push_back(writeCont);
+    }
+  );
+  std::vector<bool> corks;
+  auto scopedCork = ka::scoped_set_and_restore(
+    N::_setSocketCork,
+    [&](N::H, bool corked) {
+      corks.push_back(corked);
+    }
+  );
+  SslContext<N> context;
+  auto socket = makeSslSocketPtr<N>(N::defaultIoService(), context);
+  SendMessageEnqueue<N, SslSocketPtr<N>> send{socket};
+  send.setCorkBatches(true);
+  auto completeWrites = [&] {
+    while (!pendingWrites.empty())
+    {
+      auto writeCont = pendingWrites.front();
+      pendingWrites.erase(pendingWrites.begin());
+      writeCont(success<ErrorCode<N>>(), 0u);
+    }
+  };
+
+  // A message sent alone is not corked.
+  send(Message{}, SslEnabled{false});
+  completeWrites();
+  ASSERT_TRUE(corks.empty());
+
+  // A burst is corked from the second message on, and uncorked once sent.
+  for (int i = 0; i < 4; ++i)
+    send(Message{}, SslEnabled{false});
+  completeWrites();
+  const std::vector<bool> expected{true, false};
+  ASSERT_EQ(expected, corks);
+}
+
 // Multiple threads send messages with the same send object.
 // The socket is not connected so the send fails but it's not important here.
 // See test_tcpmessagesocket for a similar test on the real socket.
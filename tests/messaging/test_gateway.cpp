@@ -5,6 +5,8 @@
  ** Copyright (C) 2010, 2012 Aldebaran Robotics
  */
 
+#include <atomic>
+#include <memory>
 #include <string>
 #include <random>
 
@@ -21,6 +23,9 @@
 #include <qi/log.hpp>
 #include <qi/testutils/testutils.hpp>
 
+#include "src/messaging/message.hpp"
+#include "src/messaging/remoteobject_p.hpp"
+
 qiLogCategory("TestGateway");
 
 namespace qi
@@ -548,6 +553,122 @@ namespace
     // ASSERT_EQ(concreteService, serviceObject);
   }
 
+  class TestGatewayRawForwarding : public TestGateway
+  {
+  public:
+    void SetUp()
+    {
+      ASSERT_EQ(qi::Gateway::ForwardingMode::Mirroring,
+                gw_.setForwardingMode(qi::Gateway::ForwardingMode::Raw).value());
+      TestGateway::SetUp();
+    }
+  };
+
+  TEST_F(TestGatewayRawForwarding, MethodCallOnSDService)
+  {
+    SessionPtr client = connectClientToGw();
+    SessionPtr serviceHost = connectClientToSd();
+
+    serviceHost->registerService("my_service", makeBaseService()).value();
+    ASSERT_TRUE(test::finishesWithValue(client->waitForService("my_service")));
+    qi::AnyObject service = client->service("my_service").value();
+
+    for (int i = 0; i < 10; ++i)
+    {
+      const int value = randomValue();
+      ASSERT_EQ(value, service.call<int>("echoValue", value));
+    }
+  }
+
+  TEST_F(TestGatewayRawForwarding, SignalOnSDServiceReachesAllSubscribers)
+  {
+    SessionPtr client = connectClientToGw();
+    SessionPtr client2 = connectClientToGw();
+    SessionPtr serviceHost = connectClientToSd();
+
+    qi::AnyObject hosted = makeBaseService();
+    serviceHost->registerService("my_service", hosted).value();
+    ASSERT_TRUE(test::finishesWithValue(client->waitForService("my_service")));
+    ASSERT_TRUE(test::finishesWithValue(client2->waitForService("my_service")));
+    qi::AnyObject service = client->service("my_service").value();
+    qi::AnyObject service2 = client2->service("my_service").value();
+
+    const int value = randomValue();
+    qi::Promise<void> firstReceived;
+    qi::Promise<void> secondReceived;
+    qi::Promise<int> sync2;
+    auto received = std::make_shared<std::atomic<int>>(0);
+    service.connect("echoSignal", boost::function<void (int)>([=](int v) mutable {
+      if (v != value)
+        return;
+      const int count = ++*received;
+      if (count == 1)
+        firstReceived.setValue(nullptr);
+      else if (count == 2)
+        secondReceived.setValue(nullptr);
+    })).value();
+    const qi::SignalLink link2 =
+        service2.connect("echoSignal", boost::function<void (int)>(callsync_(sync2, value))).value();
+
+    hosted.post("echoSignal", value);
+    ASSERT_TRUE(test::finishesWithValue(firstReceived.future()));
+    ASSERT_TRUE(test::finishesWithValue(sync2.future()));
+
+    // The remaining subscriber still receives the signal.
+    service2.disconnect(link2).value();
+    hosted.post("echoSignal", value);
+    ASSERT_TRUE(test::finishesWithValue(secondReceived.future()));
+  }
+
+  TEST_F(TestGatewayRawForwarding, EventsKeepThePriorityOfTheService)
+  {
+    // Raw forwarding keeps the priority of the event sent by the service.
+    qi::Signal<int> urgent;
+    urgent.setMessagePriority(qi::MessagePriority_High);
+    SessionPtr client = connectClientToGw();
+    SessionPtr serviceHost = connectClientToSd();
+
+    qi::DynamicObjectBuilder ob;
+    ob.advertiseSignal("urgent", &urgent);
+    serviceHost->registerService("my_service", ob.object()).value();
+    ASSERT_TRUE(test::finishesWithValue(client->waitForService("my_service")));
+    qi::AnyObject service = client->service("my_service").value();
+
+    const qi::MessageSocketPtr socket =
+        static_cast<qi::RemoteObject*>(service.asGenericObject()->value)->transportSocket();
+    ASSERT_TRUE(socket);
+    qi::Promise<qi::MessagePriority> priority;
+    auto firstEvent = std::make_shared<std::atomic<bool>>(true);
+    const qi::SignalLink socketLink = socket->messageReady.connect([=](const qi::Message& msg) mutable {
+      if (msg.type() == qi::Message::Type_Event && firstEvent->exchange(false))
+        priority.setValue(msg.priority());
+    }).setCallType(qi::MetaCallType_Direct);
+
+    const int value = randomValue();
+    qi::Promise<int> received;
+    service.connect("urgent", boost::function<void (int)>(callsync_(received, value))).value();
+    urgent(value);
+    ASSERT_TRUE(test::finishesWithValue(received.future()));
+    ASSERT_TRUE(test::finishesWithValue(priority.future()));
+    EXPECT_EQ(qi::MessagePriority_High, priority.future().value());
+    socket->messageReady.disconnect(socketLink);
+  }
+
+  TEST_F(TestGatewayRawForwarding, ObjectsAreStillMirrored)
+  {
+    SessionPtr client = connectClientToGw();
+    SessionPtr serviceHost = connectClientToSd();
+
+    serviceHost->registerService("my_service", makeBaseService()).value();
+    ASSERT_TRUE(test::finishesWithValue(client->waitForService("my_service")));
+    qi::AnyObject service = client->service("my_service").value();
+
+    qi::AnyObject object = service.call<qi::AnyObject>("getObject");
+    ASSERT_TRUE(object.isValid());
+    const int value = randomValue();
+    ASSERT_EQ(value, object.call<int>("echoValue", value));
+  }
+
   TEST(TestGatewayLateSD, AttachesToSDWhenAvailable)
   {
     qi::Gateway gw;
@@ -0,0 +1,77 @@
+/*
+**  Copyright (C) 2018 SoftBank Robotics Europe
+**  See COPYING for the license
+*/
+
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include <qi/anyobject.hpp>
+#include <qi/os.hpp>
+#include <qi/session.hpp>
+#include <qi/type/dynamicobjectbuilder.hpp>
+
+static std::string reply(const std::string& msg)
+{
+  return msg;
+}
+
+TEST(LazyMetaObject, RemoteMethodDescriptionsAreFetchedOnDemand)
+{
+  auto server = qi::makeSession();
+  auto client = qi::makeSession();
+  server->listenStandalone(qi::Url("tcp://127.0.0.1:0"));
+  qi::DynamicObjectBuilder ob;
+  ob.advertiseMethod("reply", &reply, std::string("Replies the message."));
+  server->registerService("service", ob.object());
+  client->connect(server->endpoints()[0]);
+
+  qi::AnyObject service = client->service("service").value();
+  const int id = service.metaObject().methodId("reply::(s)");
+  ASSERT_NE(-1, id);
+  EXPECT_EQ("", service.metaObject().method(id)->description());
+  EXPECT_EQ("coin", service.call<std::string>("reply", "coin"));
+
+  const auto full = service.call<qi::MetaObject>("metaObject", 0U);
+  ASSERT_NE(nullptr, full.method(id));
+  EXPECT_EQ("Replies the message.", full.method(id)->description());
+}
+
+TEST(LazyMetaObject, ReconnectingClientsReuseTheCachedMetaObject)
+{
+  auto server = qi::makeSession();
+  server->listenStandalone(qi::Url("tcp://127.0.0.1:0"));
+  qi::DynamicObjectBuilder ob;
+  ob.advertiseMethod("reply", &reply, std::string("Replies the message, again."));
+  server->registerService("service", ob.object());
+
+  int id = -1;
+  {
+    auto client = qi::makeSession();
+    client->connect(server->endpoints()[0]);
+    qi::AnyObject service = client->service("service").value();
+    id = service.metaObject().methodId("reply::(s)");
+    ASSERT_NE(-1, id);
+    service.call<qi::MetaObject>("metaObject", 0U);
+    client->close();
+  }
+
+  // The service only sends the hash of its metaObject, the descriptions come
+  // from the cache filled by the previous client.
+  auto client = qi::makeSession();
+  client->connect(server->endpoints()[0]);
+  qi::AnyObject service = client->service("service").value();
+  ASSERT_NE(nullptr, service.metaObject().method(id));
+  EXPECT_EQ("Replies the message, again.", service.metaObject().method(id)->description());
+  EXPECT_EQ("coin", service.call<std::string>("reply", "coin"));
+}
+
+int main(int argc, char** argv)
+{
+  // The capability is off by default, and the default capabilities are read
+  // once, by the first session.
+  qi::os::setenv("QI_TRANSPORT_CAPABILITIES", "+LazyMetaObject");
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
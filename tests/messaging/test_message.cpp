@@ -1,8 +1,10 @@
 #include <string>
 #include <algorithm>
+#include <boost/make_shared.hpp>
 #include <gtest/gtest.h>
 #include <qi/application.hpp>
 #include "src/messaging/message.hpp"
+#include "src/messaging/messagechunk.hpp"
 
 namespace qi
 {
@@ -60,3 +62,189 @@ TEST(TestMessage, CopiesAreDistinct)
   ASSERT_NE(buf.totalSize(), bb.totalSize());
 
 }
+
+TEST(TestMessage, SharedBufferIsNotCopied)
+{
+  using namespace qi;
+  int i = 5;
+  auto buf = boost::make_shared<Buffer>();
+  buf->write(&i, sizeof(int));
+
+  Message m0(Message::Type_Event, MessageAddress{1, 2, 3, 4});
+  Message m1(Message::Type_Event, MessageAddress{2, 2, 3, 4});
+  m0.setSharedBuffer(buf);
+  m1.setSharedBuffer(buf);
+  ASSERT_EQ(sizeof(int), m0.header().size);
+  ASSERT_EQ(buf->data(), m0.buffer().data());
+  ASSERT_EQ(buf->data(), m1.buffer().data());
+
+  // Appending to the payload does not alter the shared buffer.
+  m1.setValue(AnyReference::from(i), "i");
+  ASSERT_EQ(2 * sizeof(int), m1.buffer().size());
+  ASSERT_EQ(sizeof(int), buf->size());
+  ASSERT_EQ(sizeof(int), m0.buffer().size());
+}
+
+namespace
+{
+  std::string letters(std::size_t size)
+  {
+    std::string s(size, 'a');
+    for (std::size_t i = 0; i < size; ++i)
+      s[i] = static_cast<char>('a' + i % 26);
+    return s;
+  }
+
+  using StringAndBuffer = std::pair<std::string, qi::Buffer>;
+
+  // A call whose payload has a sub-buffer.
+  qi::Message largeCall(unsigned int id, std::size_t stringSize, std::size_t bufferSize)
+  {
+    using namespace qi;
+    Buffer buffer;
+    const auto data = letters(bufferSize);
+    buffer.write(data.data(), data.size());
+    Message msg(Message::Type_Call, MessageAddress{id, 2, 3, 105});
+    msg.setValue(AnyReference::from(StringAndBuffer{letters(stringSize), buffer}), "(sr)");
+    return msg;
+  }
+} // namespace
+
+TEST(TestMessageChunk, SmallMessageIsNotSplit)
+{
+  using namespace qi;
+  const auto msg = largeCall(1, 10, 10);
+  EXPECT_TRUE(splitIntoChunks(msg, msg.buffer().totalSize()).empty());
+}
+
+TEST(TestMessageChunk, LargeMessageIsRebuiltFromItsChunks)
+{
+  using namespace qi;
+  auto msg = largeCall(509, 3000, 1000);
+  msg.addFlags(Message::TypeFlag_DynamicPayload);
+  msg.setPriority(MessagePriority_High);
+  const std::size_t chunkSize = 512;
+
+  const auto chunks = splitIntoChunks(msg, chunkSize);
+  ASSERT_EQ((msg.buffer().totalSize() + chunkSize - 1) / chunkSize, chunks.size());
+  for (const auto& chunk: chunks)
+  {
+    EXPECT_EQ(Message::Type_Chunk, chunk.type());
+    EXPECT_EQ(msg.id(), chunk.id());
+    EXPECT_EQ(MessagePriority_High, chunk.priority());
+    EXPECT_LE(chunk.buffer().totalSize(), sizeof(Message::Header) + chunkSize);
+  }
+
+  MessageChunkAssembler assembler(msg.buffer().totalSize());
+  boost::optional<Message> rebuilt;
+  for (const auto& chunk: chunks)
+  {
+    ASSERT_FALSE(rebuilt);
+    rebuilt = assembler.add(chunk);
+  }
+  ASSERT_TRUE(rebuilt);
+  EXPECT_EQ(0u, assembler.pending());
+  EXPECT_EQ(msg.header(), rebuilt->header());
+  EXPECT_EQ(MessagePriority_High, rebuilt->priority());
+
+  const auto original = msg.value("(sr)", MessageSocketPtr()).to<StringAndBuffer>();
+  const auto value = rebuilt->value("(sr)", MessageSocketPtr()).to<StringAndBuffer>();
+  EXPECT_EQ(original.first, value.first);
+  EXPECT_EQ(original.second, value.second);
+}
+
+TEST(TestMessageChunk, ChunksOfSeveralMessagesMayBeInterleaved)
+{
+  using namespace qi;
+  const auto first = largeCall(1, 2000, 0);
+  const auto second = largeCall(2, 100, 2000);
+  auto firstChunks = splitIntoChunks(first, 300);
+  auto secondChunks = splitIntoChunks(second, 300);
+  ASSERT_FALSE(firstChunks.empty());
+  ASSERT_FALSE(secondChunks.empty());
+
+  MessageChunkAssembler assembler(1024 * 1024);
+  std::vector<Message> rebuilt;
+  std::size_t i = 0;
+  while (i < firstChunks.size() || i < secondChunks.size())
+  {
+    if (i < secondChunks.size())
+      if (auto msg = assembler.add(secondChunks[i]))
+        rebuilt.push_back(*msg);
+    if (i < firstChunks.size())
+      if (auto msg = assembler.add(firstChunks[i]))
+        rebuilt.push_back(*msg);
+    ++i;
+  }
+  ASSERT_EQ(2u, rebuilt.size());
+  EXPECT_EQ(0u, assembler.pending());
+  for (const auto& msg: rebuilt)
+  {
+    const auto& original = msg.id() == 1 ? first : second;
+    EXPECT_EQ(original.header(), msg.header());
+    EXPECT_EQ(original.value("(sr)", MessageSocketPtr()).to<StringAndBuffer>().second,
+              msg.value("(sr)", MessageSocketPtr()).to<StringAndBuffer>().second);
+  }
+}
+
+TEST(TestMessageChunk, MessageAboveMaximumPayloadIsRejected)
+{
+  using namespace qi;
+  const auto msg = largeCall(1, 2000, 0);
+  const auto chunks = splitIntoChunks(msg, 500);
+  ASSERT_FALSE(chunks.empty());
+  MessageChunkAssembler assembler(1000);
+  EXPECT_THROW(assembler.add(chunks.front()), std::runtime_error);
+}
+
+TEST(TestMessageChunk, ChunkWithoutHeaderIsRejected)
+{
+  using namespace qi;
+  Message chunk(Message::Type_Chunk, MessageAddress{1, 2, 3, 4});
+  chunk.setValue(AnyReference::from(42), "i");
+  MessageChunkAssembler assembler(1000);
+  EXPECT_THROW(assembler.add(chunk), std::runtime_error);
+}
+
+TEST(TestMessageChunk, PayloadGrowsAsChunksArrive)
+{
+  using namespace qi;
+  const auto msg = largeCall(1, 2000, 0);
+  const auto chunks = splitIntoChunks(msg, 500);
+  ASSERT_LT(1u, chunks.size());
+  MessageChunkAssembler assembler(1024 * 1024);
+  ASSERT_FALSE(assembler.add(chunks.front()));
+  EXPECT_EQ(500u, assembler.buffered());
+}
+
+TEST(TestMessageChunk, TooManyPendingMessagesAreRejected)
+{
+  using namespace qi;
+  MessageChunkAssembler assembler(1024 * 1024, 2);
+  for (unsigned int id = 1; id <= 2; ++id)
+    ASSERT_FALSE(assembler.add(splitIntoChunks(largeCall(id, 2000, 0), 500).front()));
+  EXPECT_THROW(assembler.add(splitIntoChunks(largeCall(3, 2000, 0), 500).front()),
+               std::runtime_error);
+  EXPECT_EQ(2u, assembler.pending());
+
+  assembler.clear();
+  EXPECT_EQ(0u, assembler.pending());
+  EXPECT_EQ(0u, assembler.buffered());
+}
+
+TEST(TestMessageChunk, PendingMessagesAboveMaximumPayloadAreRejected)
+{
+  using namespace qi;
+  const auto first = splitIntoChunks(largeCall(1, 2000, 0), 500);
+  const auto second = splitIntoChunks(largeCall(2, 2000, 0), 500);
+  ASSERT_LT(2u, first.size());
+  MessageChunkAssembler assembler(2100);
+  ASSERT_FALSE(assembler.add(first[0]));
+  ASSERT_FALSE(assembler.add(first[1]));
+  ASSERT_FALSE(assembler.add(second[0]));
+  ASSERT_FALSE(assembler.add(second[1]));
+  // The third chunk of the first message would buffer more than 2100 bytes.
+  EXPECT_THROW(assembler.add(first[2]), std::runtime_error);
+  EXPECT_EQ(1u, assembler.pending());
+  EXPECT_EQ(1000u, assembler.buffered());
+}
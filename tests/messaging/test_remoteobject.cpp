@@ -1,9 +1,11 @@
 #include <chrono>
 #include <future>
 #include <mutex>
+#include <string>
 #include <gtest/gtest.h>
 #include <qi/jsoncodec.hpp>
 #include <qi/log.hpp>
+#include "../../src/messaging/metaobjectcache.hpp"
 #include "../../src/messaging/remoteobject_p.hpp"
 #include "../../src/messaging/server.hpp"
 
@@ -131,3 +133,32 @@ TEST_F(RemoteObject, CallingAVoidMethodSendsACallMessage)
   EXPECT_EQ(methodId, message.address().functionId);
 }
 
+
+TEST(MetaObjectCache, EvictsTheLeastRecentlyUsedEntry)
+{
+  qi::MetaObjectCache cache;
+  const qi::MetaObject mo;
+  cache.insert(1u, mo, true);
+  cache.setLastHash("first", 1u);
+  for (qi::uint64_t hash = 2u; hash < 256u; ++hash)
+  {
+    cache.insert(hash, mo, true);
+    cache.setLastHash(std::to_string(hash), hash);
+  }
+
+  // Using the oldest elements makes the second ones the least recently used.
+  ASSERT_TRUE(cache.find(1u));
+  ASSERT_EQ(1u, cache.lastHash("first"));
+  cache.insert(256u, mo, true);
+  cache.setLastHash("256", 256u);
+  cache.insert(257u, mo, true);
+  cache.setLastHash("257", 257u);
+
+  EXPECT_TRUE(cache.find(1u));
+  EXPECT_FALSE(cache.find(2u));
+  EXPECT_TRUE(cache.find(3u));
+  EXPECT_TRUE(cache.find(257u));
+  EXPECT_EQ(1u, cache.lastHash("first"));
+  EXPECT_EQ(0u, cache.lastHash("2"));
+  EXPECT_EQ(257u, cache.lastHash("257"));
+}
@@ -3,9 +3,15 @@
 ** Copyright (C) 2012 Aldebaran Robotics
 */
 
+#include <atomic>
+#include <future>
+#include <string>
+#include <vector>
+
 #include <gtest/gtest.h>
 #include <qi/application.hpp>
 #include <qi/log.hpp>
+#include <qi/os.hpp>
 #include <qi/session.hpp>
 #include <qi/testutils/testutils.hpp>
 #include <qi/type/dynamicobjectbuilder.hpp>
@@ -276,3 +282,111 @@ TEST(ServiceDirectory, IsNotConnectedAfterClose)
   session->close();
   ASSERT_FALSE(session->isConnected());
 }
+
+namespace
+{
+  qi::ServiceInfo serviceInfo(const std::string& name, const qi::UrlVector& endpoints)
+  {
+    qi::ServiceInfo info;
+    info.setName(name);
+    info.setMachineId(qi::os::getMachineId());
+    info.setProcessId(qi::os::getpid());
+    info.setSessionId("batch");
+    info.setEndpoints(endpoints);
+    return info;
+  }
+}
+
+TEST(ServiceDirectory, RegistersAndReadiesServicesInBatches)
+{
+  auto sd = qi::makeSession();
+  sd->listenStandalone("tcp://127.0.0.1:0");
+  auto client = qi::makeSession();
+  client->connect(sd->url());
+  qi::AnyObject directory = client->service(qi::Session::serviceDirectoryServiceName()).value();
+
+  const std::vector<qi::ServiceInfo> infos{ serviceInfo("A", sd->endpoints()), serviceInfo("B", sd->endpoints()) };
+  const auto ids = directory.call<std::vector<unsigned int>>("registerServices", infos);
+  ASSERT_EQ(2u, ids.size());
+  // Pending services are not visible yet.
+  EXPECT_ANY_THROW(directory.call<qi::ServiceInfo>("service", "A"));
+
+  // A repeated id rejects the whole batch.
+  EXPECT_ANY_THROW(directory.call<void>("servicesReady", std::vector<unsigned int>{ ids[0], ids[0] }));
+  EXPECT_ANY_THROW(directory.call<qi::ServiceInfo>("service", "A"));
+
+  directory.call<void>("servicesReady", ids);
+  EXPECT_EQ(ids[0], directory.call<qi::ServiceInfo>("service", "A").serviceId());
+  EXPECT_EQ(ids[1], directory.call<qi::ServiceInfo>("service", "B").serviceId());
+
+  // A conflicting name rejects the whole batch.
+  const std::vector<qi::ServiceInfo> conflicting{ serviceInfo("C", sd->endpoints()),
+                                                  serviceInfo("A", sd->endpoints()) };
+  EXPECT_ANY_THROW(directory.call<std::vector<unsigned int>>("registerServices", conflicting));
+  EXPECT_ANY_THROW(directory.call<std::vector<unsigned int>>("registerServices",
+                                                           std::vector<qi::ServiceInfo>{
+                                                             serviceInfo("D", sd->endpoints()),
+                                                             serviceInfo("D", sd->endpoints()) }));
+  for (const auto& info : sd->services().value())
+  {
+    EXPECT_NE("C", info.name());
+    EXPECT_NE("D", info.name());
+  }
+}
+
+TEST(ServiceDirectory, SessionRegistersServicesTogether)
+{
+  auto sd = qi::makeSession();
+  sd->listenStandalone("tcp://127.0.0.1:0");
+  auto provider = qi::makeSession();
+  provider->connect(sd->url());
+  provider->listen("tcp://127.0.0.1:0");
+
+  const auto ids = provider->registerServices({ { "A", boost::make_shared<Serv>() },
+                                                { "B", boost::make_shared<Serv>() } }).value();
+  ASSERT_EQ(2u, ids.size());
+  auto client = qi::makeSession();
+  client->connect(sd->url());
+  qi::AnyObject directory = client->service(qi::Session::serviceDirectoryServiceName()).value();
+  EXPECT_EQ(ids[0], directory.call<qi::ServiceInfo>("service", "A").serviceId());
+  EXPECT_EQ(ids[1], directory.call<qi::ServiceInfo>("service", "B").serviceId());
+  EXPECT_EQ(Serv::response, client->service("B").value().call<int>("f"));
+
+  // A conflicting name rejects the whole batch.
+  EXPECT_ANY_THROW(provider->registerServices({ { "C", boost::make_shared<Serv>() },
+                                                { "A", boost::make_shared<Serv>() } }).value());
+  EXPECT_ANY_THROW(directory.call<qi::ServiceInfo>("service", "C"));
+}
+
+TEST(ServiceDirectory, LookupsRunConcurrentlyWithRegistrations)
+{
+  auto sd = qi::makeSession();
+  sd->listenStandalone("tcp://127.0.0.1:0");
+  sd->registerService("Serv", boost::make_shared<Serv>());
+  auto client = qi::makeSession();
+  client->connect(sd->url());
+  qi::AnyObject directory = client->service(qi::Session::serviceDirectoryServiceName()).value();
+
+  std::atomic<bool> stop{false};
+  auto registrations = std::async(std::launch::async, [&] {
+    for (int i = 0; !stop; ++i)
+    {
+      const auto name = "Transient" + std::to_string(i);
+      const auto ids = directory.call<std::vector<unsigned int>>(
+          "registerServices", std::vector<qi::ServiceInfo>{ serviceInfo(name, sd->endpoints()) });
+      directory.call<void>("servicesReady", ids);
+      directory.call<void>("unregisterService", ids.front());
+    }
+  });
+
+  std::vector<qi::Future<qi::ServiceInfo>> lookups;
+  for (int i = 0; i < 500; ++i)
+    lookups.push_back(directory.async<qi::ServiceInfo>("service", "Serv"));
+  for (auto& lookup : lookups)
+  {
+    ASSERT_EQ(qi::FutureState_FinishedWithValue, lookup.wait(qi::Seconds(10)));
+    EXPECT_EQ("Serv", lookup.value().name());
+  }
+  stop = true;
+  registrations.get();
+}
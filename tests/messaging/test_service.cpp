@@ -5,7 +5,9 @@
  ** Copyright (C) 2010, 2012 Aldebaran Robotics
  */
 
+#include <atomic>
 #include <future>
+#include <memory>
 #include <vector>
 #include <string>
 
@@ -20,6 +22,7 @@
 #include <qi/application.hpp>
 #include <testsession/testsessionpair.hpp>
 #include <boost/optional/optional_io.hpp>
+#include "src/messaging/remoteobject_p.hpp"
 
 qiLogCategory("test");
 
@@ -402,6 +405,451 @@ TEST(QiService, NetworkObjectsAreClosedWithTheSession)
   // is gone so our object has been deleted.
 }
 
+TEST(QiService, RemoteMethodDescriptionsAreFetchedByDefault)
+{
+  auto server = qi::makeSession();
+  auto client = qi::makeSession();
+  server->listenStandalone(qi::Url("tcp://127.0.0.1:0"));
+  qi::DynamicObjectBuilder ob;
+  ob.advertiseMethod("reply", &reply, std::string("Replies the message."));
+  server->registerService("service", ob.object());
+  client->connect(server->endpoints()[0]);
+
+  qi::AnyObject service = client->service("service").value();
+  const int id = service.metaObject().methodId("reply::(s)");
+  ASSERT_NE(-1, id);
+  EXPECT_EQ("Replies the message.", service.metaObject().method(id)->description());
+}
+
+static qi::RemoteObject* remoteObject(const qi::AnyObject& object)
+{
+  return static_cast<qi::RemoteObject*>(object.asGenericObject()->value);
+}
+
+static int checkedIndex(int i)
+{
+  if (i < 0)
+    throw std::runtime_error("negative index");
+  return i * 2;
+}
+
+TEST(QiService, CallBatchReturnsOneResultPerCall)
+{
+  auto server = qi::makeSession();
+  auto client = qi::makeSession();
+  server->listenStandalone(qi::Url("tcp://127.0.0.1:0"));
+  qi::DynamicObjectBuilder ob;
+  ob.advertiseMethod("reply", &reply);
+  ob.advertiseMethod("checkedIndex", &checkedIndex);
+  const unsigned int serviceId = server->registerService("service", ob.object()).value();
+  client->connect(server->endpoints()[0]);
+  qi::AnyObject service = client->service("service").value();
+
+  // The calls go in one Type_CallBatch message, answered by one
+  // Type_BatchReply message.
+  const qi::MessageSocketPtr socket = remoteObject(service)->transportSocket();
+  ASSERT_TRUE(socket);
+  std::atomic<int> batchReplies{0};
+  std::atomic<int> replies{0};
+  const qi::SignalLink link = socket->messageReady.connect([&](const qi::Message& msg) {
+    if (msg.service() != serviceId)
+      return;
+    if (msg.type() == qi::Message::Type_BatchReply)
+      ++batchReplies;
+    else
+      ++replies;
+  }).setCallType(qi::MetaCallType_Direct);
+
+  std::vector<qi::BatchCall> calls;
+  for (int i = 0; i < 50; ++i)
+    calls.emplace_back("checkedIndex", i);
+  calls.emplace_back("reply", std::string("coin"));
+  calls.emplace_back("checkedIndex", -1);
+  calls.emplace_back("unknownMethod", 42);
+
+  const auto results = service.callBatch(calls);
+  ASSERT_EQ(calls.size(), results.size());
+  for (int i = 0; i < 50; ++i)
+  {
+    ASSERT_EQ(qi::FutureState_FinishedWithValue, results[i].wait(usualTimeout * 10));
+    EXPECT_EQ(i * 2, results[i].value().to<int>());
+  }
+  EXPECT_EQ("coin", results[50].value().to<std::string>());
+  ASSERT_TRUE(results[51].hasError());
+  EXPECT_NE(std::string::npos, results[51].error().find("negative index"));
+  EXPECT_TRUE(results[52].hasError());
+
+  PERSIST_EXPECT(, batchReplies.load() == 1, std::chrono::milliseconds{2000});
+  EXPECT_EQ(0, replies.load());
+  socket->messageReady.disconnect(link);
+}
+
+TEST(QiService, CallBatchOnALocalObject)
+{
+  qi::DynamicObjectBuilder ob;
+  ob.advertiseMethod("checkedIndex", &checkedIndex);
+  qi::AnyObject object = ob.object();
+
+  const auto results = object.callBatch({ qi::BatchCall("checkedIndex", 21),
+                                          qi::BatchCall("checkedIndex", -21) });
+  ASSERT_EQ(2u, results.size());
+  EXPECT_EQ(42, results[0].value().to<int>());
+  EXPECT_TRUE(results[1].hasError());
+}
+
+static qi::SessionConfig limitedCallsConfig()
+{
+  qi::SessionConfig config;
+  config.callScheduling.maxInFlightCallsPerClient = 1;
+  config.callScheduling.maxQueuedCallsPerClient = 1;
+  return config;
+}
+
+TEST(QiService, CallsBeyondTheLimitsOfAClientWaitThenAreRejected)
+{
+  auto server = qi::makeSession(limitedCallsConfig());
+  auto client = qi::makeSession();
+  server->listenStandalone(qi::Url("tcp://127.0.0.1:0"));
+  qi::Promise<int> result;
+  qi::Promise<void> started;
+  qi::DynamicObjectBuilder ob;
+  auto calls = std::make_shared<std::atomic<int>>(0);
+  ob.advertiseMethod("block", [=]() mutable {
+    if (++*calls == 1)
+      started.setValue(nullptr);
+    return result.future();
+  });
+  const unsigned int id = server->registerService("service", ob.object()).value();
+  client->connect(server->endpoints()[0]);
+  qi::AnyObject service = client->service("service").value();
+
+  auto first = service.async<int>("block");
+  ASSERT_EQ(qi::FutureState_FinishedWithValue, started.future().wait(usualTimeout * 10));
+  auto second = service.async<int>("block");
+  auto third = service.async<int>("block");
+  ASSERT_EQ(qi::FutureState_FinishedWithError, third.wait(usualTimeout * 10));
+  EXPECT_EQ(0u, third.error().find(qi::serviceOverloadedError));
+  EXPECT_EQ(qi::FutureState_Running, second.wait(usualTimeout));
+
+  result.setValue(42);
+  ASSERT_EQ(qi::FutureState_FinishedWithValue, first.wait(usualTimeout * 10));
+  ASSERT_EQ(qi::FutureState_FinishedWithValue, second.wait(usualTimeout * 10));
+  EXPECT_EQ(42, second.value());
+
+  const qi::CallSchedulingStats stats = server->callSchedulingStats(id);
+  EXPECT_EQ(2u, stats.started);
+  EXPECT_EQ(1u, stats.delayed);
+  EXPECT_EQ(1u, stats.rejected);
+  EXPECT_EQ(0u, stats.waiting);
+  EXPECT_LE(usualTimeout, stats.maxQueueDelay);
+}
+
+TEST(QiService, WaitingCallsCanBeCanceled)
+{
+  auto server = qi::makeSession(limitedCallsConfig());
+  auto client = qi::makeSession();
+  server->listenStandalone(qi::Url("tcp://127.0.0.1:0"));
+  qi::Promise<int> result;
+  qi::Promise<void> started;
+  qi::DynamicObjectBuilder ob;
+  auto calls = std::make_shared<std::atomic<int>>(0);
+  ob.advertiseMethod("block", [=]() mutable {
+    if (++*calls == 1)
+      started.setValue(nullptr);
+    return result.future();
+  });
+  const unsigned int id = server->registerService("service", ob.object()).value();
+  client->connect(server->endpoints()[0]);
+  qi::AnyObject service = client->service("service").value();
+
+  auto first = service.async<int>("block");
+  ASSERT_EQ(qi::FutureState_FinishedWithValue, started.future().wait(usualTimeout * 10));
+  auto second = service.async<int>("block");
+  PERSIST_ASSERT(, server->callSchedulingStats(id).waiting == 1u, std::chrono::milliseconds{2000});
+
+  second.cancel();
+  ASSERT_EQ(qi::FutureState_Canceled, second.wait(usualTimeout * 10));
+  EXPECT_EQ(0u, server->callSchedulingStats(id).waiting);
+
+  result.setValue(42);
+  ASSERT_EQ(qi::FutureState_FinishedWithValue, first.wait(usualTimeout * 10));
+  EXPECT_EQ(1u, server->callSchedulingStats(id).started);
+  EXPECT_EQ(1, calls->load());
+}
+
+TEST(QiService, CallLimitsOfAClientDoNotDelayTheOthers)
+{
+  auto server = qi::makeSession(limitedCallsConfig());
+  server->listenStandalone(qi::Url("tcp://127.0.0.1:0"));
+  qi::Promise<int> result;
+  qi::DynamicObjectBuilder ob;
+  ob.advertiseMethod("block", [=] { return result.future(); });
+  ob.advertiseMethod("reply", &reply);
+  server->registerService("service", ob.object());
+
+  auto busyClient = qi::makeSession();
+  busyClient->connect(server->endpoints()[0]);
+  qi::AnyObject busyService = busyClient->service("service").value();
+  auto blocked = busyService.async<int>("block");
+  auto delayed = busyService.async<std::string>("reply", "busy");
+
+  auto client = qi::makeSession();
+  client->connect(server->endpoints()[0]);
+  qi::AnyObject service = client->service("service").value();
+  EXPECT_EQ("coin", service.call<std::string>("reply", "coin"));
+  EXPECT_EQ(qi::FutureState_Running, delayed.wait(0));
+
+  result.setValue(0);
+  ASSERT_EQ(qi::FutureState_FinishedWithValue, delayed.wait(usualTimeout * 10));
+  EXPECT_EQ("busy", delayed.value());
+}
+
+static qi::SessionPtr pooledClient(unsigned int socketsPerEndpoint, std::size_t bulkPayloadThreshold)
+{
+  qi::SessionConfig config;
+  config.socketPool.socketsPerEndpoint = socketsPerEndpoint;
+  config.socketPool.bulkPayloadThreshold = bulkPayloadThreshold;
+  return qi::makeSession(config);
+}
+
+// The call scheduling is only enabled to count the sockets of the clients.
+static qi::SessionPtr countingServer()
+{
+  qi::SessionConfig config;
+  config.callScheduling.maxInFlightCalls = 1000;
+  auto server = qi::makeSession(config);
+  server->listenStandalone(qi::Url("tcp://127.0.0.1:0"));
+  return server;
+}
+
+TEST(QiService, CallsAreSpreadOverTheSocketPool)
+{
+  auto server = countingServer();
+  qi::Promise<int> result;
+  qi::DynamicObjectBuilder ob;
+  ob.advertiseMethod("block", [=] { return result.future(); });
+  const unsigned int id = server->registerService("service", ob.object()).value();
+
+  auto client = pooledClient(3, 0);
+  client->connect(server->endpoints()[0]);
+  qi::AnyObject service = client->service("service").value();
+
+  // The other sockets of the pool are opened in the background, the calls use
+  // the first one until then.
+  std::vector<qi::Future<int>> calls;
+  const auto deadline = qi::SteadyClock::now() + usualTimeout * 50;
+  while (server->callSchedulingStats(id).clients < 3 && qi::SteadyClock::now() < deadline)
+  {
+    calls.push_back(service.async<int>("block"));
+    qi::sleepFor(qi::MilliSeconds(10));
+  }
+  EXPECT_EQ(3u, server->callSchedulingStats(id).clients);
+
+  result.setValue(42);
+  for (auto& call : calls)
+  {
+    ASSERT_EQ(qi::FutureState_FinishedWithValue, call.wait(usualTimeout * 10));
+    EXPECT_EQ(42, call.value());
+  }
+}
+
+TEST(QiService, LargeCallsUseTheBulkLane)
+{
+  auto server = countingServer();
+  qi::Promise<void> release;
+  qi::DynamicObjectBuilder ob;
+  ob.advertiseMethod("echo", [=](const std::string& s) {
+    return release.future().andThen([=](void*) { return s; });
+  });
+  const unsigned int id = server->registerService("service", ob.object()).value();
+
+  auto client = pooledClient(2, 1024);
+  client->connect(server->endpoints()[0]);
+  qi::AnyObject service = client->service("service").value();
+
+  const std::string small = "coin";
+  const std::string large(4096, 'x');
+  std::vector<qi::Future<std::string>> smallCalls;
+  std::vector<qi::Future<std::string>> largeCalls;
+  smallCalls.push_back(service.async<std::string>("echo", small));
+  const auto deadline = qi::SteadyClock::now() + usualTimeout * 50;
+  while (server->callSchedulingStats(id).clients < 2 && qi::SteadyClock::now() < deadline)
+  {
+    largeCalls.push_back(service.async<std::string>("echo", large));
+    qi::sleepFor(qi::MilliSeconds(10));
+  }
+  EXPECT_EQ(2u, server->callSchedulingStats(id).clients);
+
+  // The small calls keep using the first socket.
+  for (int i = 0; i < 10; ++i)
+    smallCalls.push_back(service.async<std::string>("echo", small));
+  qi::sleepFor(usualTimeout);
+  EXPECT_EQ(2u, server->callSchedulingStats(id).clients);
+
+  release.setValue(nullptr);
+  for (auto& call : smallCalls)
+  {
+    ASSERT_EQ(qi::FutureState_FinishedWithValue, call.wait(usualTimeout * 10));
+    EXPECT_EQ(small, call.value());
+  }
+  for (auto& call : largeCalls)
+  {
+    ASSERT_EQ(qi::FutureState_FinishedWithValue, call.wait(usualTimeout * 10));
+    EXPECT_EQ(large, call.value());
+  }
+}
+
+TEST(QiService, LargeArgumentsAndRepliesAreSentInChunks)
+{
+  auto server = qi::makeSession();
+  server->listenStandalone(qi::Url("tcp://127.0.0.1:0"));
+  qi::DynamicObjectBuilder ob;
+  ob.advertiseMethod("echo", [](const std::string& s) { return s; });
+  server->registerService("service", ob.object()).value();
+
+  auto client = qi::makeSession();
+  client->connect(server->endpoints()[0]);
+  qi::AnyObject service = client->service("service").value();
+
+  std::string large(3 * 1024 * 1024 + 17, 'x');
+  for (std::size_t i = 0; i < large.size(); i += 1000)
+    large[i] = static_cast<char>('a' + i % 26);
+  EXPECT_EQ(large, service.call<std::string>("echo", large));
+}
+
+TEST(QiService, HighPriorityCallsOvertakeLargeTransfers)
+{
+  auto server = qi::makeSession();
+  server->listenStandalone(qi::Url("tcp://127.0.0.1:0"));
+  qi::DynamicObjectBuilder ob;
+  ob.advertiseMethod("echo", [](const std::string& s) { return s; });
+  ob.advertiseMethod("ping", [] { return true; });
+  server->registerService("service", ob.object()).value();
+
+  auto client = qi::makeSession();
+  client->connect(server->endpoints()[0]);
+  qi::AnyObject service = client->service("service").value();
+
+  const std::string large(8 * 1024 * 1024, 'x');
+  std::vector<qi::Future<std::string>> largeCalls;
+  for (int i = 0; i < 10; ++i)
+    largeCalls.push_back(service.async<std::string>("echo", large));
+  qi::Future<bool> ping;
+  {
+    qi::ScopedMessagePriority urgent(qi::MessagePriority_High);
+    ping = service.async<bool>("ping");
+  }
+  ASSERT_EQ(qi::FutureState_FinishedWithValue, ping.wait(usualTimeout * 10));
+  // The ping was not sent after the large calls which were waiting.
+  EXPECT_FALSE(largeCalls.back().isFinished());
+  for (auto& call : largeCalls)
+    ASSERT_EQ(qi::FutureState_FinishedWithValue, call.wait(usualTimeout * 50));
+}
+
+// The chunks of a large reply carry its priority, which the reassembled reply
+// keeps.
+TEST(QiService, LargeRepliesKeepTheirPriority)
+{
+  auto server = qi::makeSession();
+  server->listenStandalone(qi::Url("tcp://127.0.0.1:0"));
+  qi::DynamicObjectBuilder ob;
+  ob.advertiseMethod("echo", [](const std::string& s) { return s; });
+  const unsigned int serviceId = server->registerService("service", ob.object()).value();
+
+  auto client = qi::makeSession();
+  client->connect(server->endpoints()[0]);
+  qi::AnyObject service = client->service("service").value();
+
+  const qi::MessageSocketPtr socket = remoteObject(service)->transportSocket();
+  ASSERT_TRUE(socket);
+  qi::Promise<qi::MessagePriority> priority;
+  const qi::SignalLink link = socket->messageReady.connect([=](const qi::Message& msg) mutable {
+    if (msg.service() == serviceId && msg.type() == qi::Message::Type_Reply)
+      priority.setValue(msg.priority());
+  }).setCallType(qi::MetaCallType_Direct);
+
+  const std::string large(1024 * 1024, 'x');
+  qi::Future<std::string> echo;
+  {
+    qi::ScopedMessagePriority urgent(qi::MessagePriority_High);
+    echo = service.async<std::string>("echo", large);
+  }
+  ASSERT_EQ(qi::FutureState_FinishedWithValue, echo.wait(usualTimeout * 10));
+  EXPECT_EQ(large, echo.value());
+  ASSERT_EQ(qi::FutureState_FinishedWithValue, priority.future().wait(usualTimeout));
+  EXPECT_EQ(qi::MessagePriority_High, priority.future().value());
+  socket->messageReady.disconnect(link);
+}
+
+static qi::SessionConfig resumableConfig(qi::MilliSeconds gracePeriod)
+{
+  qi::SessionConfig config;
+  config.sessionResumption.gracePeriod = gracePeriod;
+  return config;
+}
+
+// The service is not hosted by the session of the service directory, so that
+// the client does not reach it through the socket of its service directory.
+struct ResumableService
+{
+  explicit ResumableService(qi::MilliSeconds gracePeriod)
+    : sd(qi::makeSession())
+    , provider(qi::makeSession(resumableConfig(gracePeriod)))
+  {
+    sd->listenStandalone(qi::Url("tcp://127.0.0.1:0"));
+    provider->connect(sd->endpoints()[0]);
+    provider->listen(qi::Url("tcp://127.0.0.1:0"));
+    qi::DynamicObjectBuilder ob;
+    ob.advertiseMethod("echo", [](int i) { return i; });
+    ob.advertiseSignal<int>("fired");
+    object = ob.object();
+    provider->registerService("service", object).value();
+  }
+
+  qi::SessionPtr sd;
+  qi::SessionPtr provider;
+  qi::AnyObject object;
+};
+
+TEST(QiService, SessionIsResumedAfterTheSocketIsLost)
+{
+  ResumableService server(qi::Seconds(10));
+  auto client = qi::makeSession(resumableConfig(qi::Seconds(10)));
+  client->connect(server.sd->endpoints()[0]);
+  qi::AnyObject service = client->service("service").value();
+  std::atomic<int> received{0};
+  service.connect("fired", boost::function<void(int)>([&](int i) { received = i; })).value();
+
+  const qi::MessageSocketPtr lost = remoteObject(service)->transportSocket();
+  ASSERT_TRUE(lost);
+  lost->disconnect().value();
+
+  qi::MessageSocketPtr resumed;
+  PERSIST_ASSERT(resumed = remoteObject(service)->transportSocket(), resumed && resumed != lost,
+                 std::chrono::milliseconds{2000});
+  EXPECT_EQ(42, service.call<int>("echo", 42));
+  // The subscription was kept by the service.
+  server.object.post("fired", 12);
+  PERSIST_EXPECT(, received == 12, std::chrono::milliseconds{2000});
+}
+
+TEST(QiService, SessionIsNotResumedIfTheServiceDisabledIt)
+{
+  ResumableService server(qi::MilliSeconds(0));
+  auto client = qi::makeSession(resumableConfig(qi::Seconds(10)));
+  client->connect(server.sd->endpoints()[0]);
+  qi::AnyObject service = client->service("service").value();
+
+  const qi::MessageSocketPtr lost = remoteObject(service)->transportSocket();
+  ASSERT_TRUE(lost);
+  lost->disconnect().value();
+
+  PERSIST_ASSERT(, !remoteObject(service)->transportSocket(), std::chrono::milliseconds{2000});
+  qi::sleepFor(usualTimeout);
+  EXPECT_FALSE(remoteObject(service)->transportSocket());
+  EXPECT_ANY_THROW(service.call<int>("echo", 42));
+}
+
 class DoSomething
 {
 public:
@@ -629,3 +629,76 @@ TEST(TestSession, WaitForServiceCanceled)
   future.cancel();
   ASSERT_TRUE(finishesAsCanceled(future));
 }
+
+namespace
+{
+  qi::SessionConfig serviceCacheConfig()
+  {
+    qi::SessionConfig config;
+    config.serviceCache.enabled = true;
+    return config;
+  }
+
+  template<typename Predicate>
+  bool becomesTrue(Predicate predicate)
+  {
+    const auto deadline = qi::SteadyClock::now() + qi::Seconds(2);
+    while (!predicate())
+    {
+      if (qi::SteadyClock::now() > deadline)
+        return false;
+      std::this_thread::sleep_for(defaultWaitLoopDuration);
+    }
+    return true;
+  }
+}
+
+TEST(TestSession, ServiceCacheAnswersLookupsAndFollowsTheDirectory)
+{
+  auto sd = qi::makeSession();
+  sd->listenStandalone(qi::Url("tcp://127.0.0.1:0"));
+  auto provider = qi::makeSession();
+  provider->connect(sd->url());
+  provider->listen(qi::Url("tcp://127.0.0.1:0"));
+  auto client = qi::makeSession(serviceCacheConfig());
+  client->connect(sd->url());
+  ASSERT_TRUE(becomesTrue([&] { return client->serviceCacheStats().synchronized; }));
+  const auto initial = client->serviceCacheStats();
+
+  unsigned int sid = 0;
+  ASSERT_TRUE(finishesWithValue(provider->registerService(dummyServiceName, dummyDynamicObject()),
+                                willAssignValue(sid)));
+  // Pushed by the service directory, fetched without being asked for.
+  ASSERT_TRUE(becomesTrue([&] {
+    const auto stats = client->serviceCacheStats();
+    return stats.services == initial.services + 1 && stats.pending == 0;
+  }));
+  ASSERT_TRUE(finishesWithValue(client->waitForService(dummyServiceName)));
+
+  AnyObject object;
+  ASSERT_TRUE(finishesWithValue(client->service(dummyServiceName), willAssignValue(object)));
+  ASSERT_EQ("foo", object.call<std::string>("reply", "foo"));
+  EXPECT_EQ(initial.hits + 1, client->serviceCacheStats().hits);
+  EXPECT_EQ(initial.misses, client->serviceCacheStats().misses);
+
+  ASSERT_TRUE(finishesWithValue(provider->unregisterService(sid)));
+  ASSERT_TRUE(becomesTrue([&] { return client->serviceCacheStats().services == initial.services; }));
+}
+
+TEST(TestSession, ServiceCacheWaitsForServicesItDoesNotKnow)
+{
+  auto sd = qi::makeSession();
+  sd->listenStandalone(qi::Url("tcp://127.0.0.1:0"));
+  auto client = qi::makeSession(serviceCacheConfig());
+  client->connect(sd->url());
+  ASSERT_TRUE(becomesTrue([&] { return client->serviceCacheStats().synchronized; }));
+
+  auto waiting = client->waitForService(dummyServiceName, qi::Seconds(10)).async();
+  ASSERT_TRUE(waiting.isRunning());
+  ASSERT_TRUE(finishesWithValue(sd->registerService(dummyServiceName, dummyDynamicObject())));
+  ASSERT_TRUE(finishesWithValue(waiting));
+
+  client->close();
+  EXPECT_FALSE(client->serviceCacheStats().synchronized);
+  EXPECT_EQ(0u, client->serviceCacheStats().services);
+}
@@ -739,3 +739,127 @@ TEST(NetMessageSocketAsio, DistantCrashWhileConnected)
   Future<void> fut = socket->disconnect();
   ASSERT_EQ(FutureState_FinishedWithValue, fut.wait(defaultTimeout));
 }
+
+// Whether or not the kernel of the test machine can encrypt the messages, the
+// sockets must exchange them as usual.
+TEST(NetMessageSocketAsio, TlsOffloadKeepsExchangingMessages)
+{
+  using namespace qi;
+  using namespace qi::sock;
+
+  MessageSocketConfig config;
+  config.tlsOffload.enabled = true;
+
+  TransportServer server;
+  server.setSocketConfig(config);
+  server.setIdentity(path::findData("qi", "server.key"), path::findData("qi", "server.crt"));
+  Promise<MessageSocketPtr> promiseServerSideSocket;
+  server.newConnection.connect([=](const std::pair<MessageSocketPtr, Url>& p) mutable {
+    promiseServerSideSocket.setValue(p.first);
+  });
+  ASSERT_EQ(FutureState_FinishedWithValue, server.listen(Url{"tcps://127.0.0.1:0"}).wait(defaultTimeout));
+
+  const unsigned messageCount = 100u;
+  const auto msg0 = makeMessage(MessageAddress{1234, 5, 9876, 107});
+  auto countMessages = [=](Promise<void> promise, std::shared_ptr<std::atomic<unsigned>> count) {
+    return [=](const Message& msg) mutable {
+      if (!messageEqual(msg, msg0))
+        promise.setError("message not equal.");
+      else if (++*count == messageCount)
+        promise.setValue(nullptr);
+    };
+  };
+
+  auto clientSideSocket = makeTcpMessageSocket("tcps", getNetworkEventLoop(), config);
+  const auto _ = ka::scoped([=]{ clientSideSocket->disconnect().wait(defaultTimeout); });
+  Promise<void> promiseClientReceived;
+  clientSideSocket->messageReady.connect(
+      countMessages(promiseClientReceived, std::make_shared<std::atomic<unsigned>>(0u)));
+  ASSERT_EQ(FutureState_FinishedWithValue, clientSideSocket->connect(server.endpoints().front()).wait(defaultTimeout));
+
+  ASSERT_EQ(FutureState_FinishedWithValue, promiseServerSideSocket.future().wait(defaultTimeout));
+  auto serverSideSocket = boost::dynamic_pointer_cast<TcpMessageSocket<>>(promiseServerSideSocket.future().value());
+  ASSERT_TRUE(serverSideSocket);
+  Promise<void> promiseServerReceived;
+  serverSideSocket->messageReady.connect(
+      countMessages(promiseServerReceived, std::make_shared<std::atomic<unsigned>>(0u)));
+  ASSERT_TRUE(serverSideSocket->ensureReading());
+
+  // Both ends run on the same kernel.
+  EXPECT_EQ(clientSideSocket->tlsSendOffloaded(), serverSideSocket->tlsSendOffloaded());
+
+  for (unsigned i = 0; i < messageCount; ++i)
+  {
+    ASSERT_TRUE(clientSideSocket->send(msg0));
+    ASSERT_TRUE(serverSideSocket->send(msg0));
+  }
+  ASSERT_EQ(FutureState_FinishedWithValue, promiseClientReceived.future().wait(defaultTimeout));
+  ASSERT_EQ(FutureState_FinishedWithValue, promiseServerReceived.future().wait(defaultTimeout));
+}
+
+TEST(NetMessageSocketAsio, TunedSocketsKeepExchangingMessagesThroughSeveralAcceptors)
+{
+  using namespace qi;
+  using namespace qi::sock;
+
+  MessageSocketConfig config;
+  config.tuning.defaults.noDelay = false;
+  config.tuning.defaults.corkBatches = true;
+  config.tuning.defaults.sendBufferSize = 64 * 1024;
+  config.tuning.defaults.receiveBufferSize = 64 * 1024;
+  config.tuning.defaults.acceptors = 3;
+
+  TransportServer server;
+  server.setSocketConfig(config);
+  boost::synchronized_value<std::vector<MessageSocketPtr>> serverSideSockets;
+  server.newConnection.connect([&](const std::pair<MessageSocketPtr, Url>& p) {
+    serverSideSockets->push_back(p.first);
+  });
+  ASSERT_EQ(FutureState_FinishedWithValue, server.listen(Url{"tcp://127.0.0.1:0"}).wait(defaultTimeout));
+  // The additional acceptors do not advertise the endpoint again.
+  ASSERT_EQ(1u, server.endpoints().size());
+
+  const unsigned clientCount = 6u;
+  const unsigned messageCount = 100u;
+  const auto msg0 = makeMessage(MessageAddress{1234, 5, 9876, 107});
+  std::vector<MessageSocketPtr> clientSideSockets;
+  std::vector<Future<void>> received;
+  for (unsigned i = 0; i < clientCount; ++i)
+  {
+    auto socket = makeTcpMessageSocket("tcp", getNetworkEventLoop(), config);
+    Promise<void> promise;
+    auto count = std::make_shared<std::atomic<unsigned>>(0u);
+    socket->messageReady.connect([=](const Message& msg) mutable {
+      if (!messageEqual(msg, msg0))
+        promise.setError("message not equal.");
+      else if (++*count == messageCount)
+        promise.setValue(nullptr);
+    });
+    ASSERT_EQ(FutureState_FinishedWithValue, socket->connect(server.endpoints().front()).wait(defaultTimeout));
+    clientSideSockets.push_back(socket);
+    received.push_back(promise.future());
+  }
+  const auto _ = ka::scoped([&]{
+    for (auto& socket : clientSideSockets)
+      socket->disconnect().wait(defaultTimeout);
+  });
+
+  // Each accepted socket echoes the messages in a burst.
+  const auto deadline = SteadyClock::now() + defaultTimeout;
+  while (serverSideSockets->size() < clientCount && SteadyClock::now() < deadline)
+    std::this_thread::sleep_for(std::chrono::milliseconds{10});
+  const auto accepted = serverSideSockets.get();
+  ASSERT_EQ(clientCount, accepted.size());
+  for (auto& socket : accepted)
+  {
+    MessageSocket* raw = socket.get();
+    socket->messageReady.connect([=](const Message& msg) { raw->send(msg); });
+    ASSERT_TRUE(socket->ensureReading());
+  }
+
+  for (unsigned i = 0; i < messageCount; ++i)
+    for (auto& socket : clientSideSockets)
+      ASSERT_TRUE(socket->send(msg0));
+  for (auto& future : received)
+    ASSERT_EQ(FutureState_FinishedWithValue, future.wait(defaultTimeout));
+}
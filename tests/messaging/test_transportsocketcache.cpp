@@ -8,6 +8,8 @@
 
 #include <vector>
 #include <algorithm>
+#include <atomic>
+#include <memory>
 #include <iterator>
 #include <future>
 #include <thread>
@@ -23,6 +25,7 @@
 #include <qi/application.hpp>
 #include <qi/session.hpp>
 
+#include "src/messaging/endpointranking.hpp"
 #include "src/messaging/transportsocketcache.hpp"
 #include "src/messaging/tcpmessagesocket.hpp"
 #include "src/messaging/transportserver.hpp"
@@ -171,6 +174,128 @@ TEST_F(TestTransportSocketCache, SameMachinePublicIp)
   client->disconnect();
 }
 
+TEST_F(TestTransportSocketCache, PooledSocketsAreReusedAndClosedWithTheirOwner)
+{
+  server_.listen("tcp://127.0.0.1:0").wait();
+  const std::vector<qi::Url> endpoints = server_.endpoints();
+  qi::ServiceInfo servInfo;
+  servInfo.setMachineId(qi::os::getMachineId());
+  servInfo.setEndpoints(endpoints);
+
+  const auto authenticated = std::make_shared<std::atomic<int>>(0);
+  cache_.setSocketPool(3, [=](qi::MessageSocketPtr) {
+    ++*authenticated;
+    return qi::Future<void>(nullptr);
+  });
+  qi::MessageSocketPtr sock = cache_.socket(servInfo, endpoints[0].protocol()).value();
+
+  auto pooled = cache_.pooledSockets(sock);
+  ASSERT_EQ(2u, pooled.size());
+  std::vector<qi::MessageSocketPtr> pooledSockets;
+  for (auto& fut : pooled)
+  {
+    pooledSockets.push_back(fut.value());
+    EXPECT_TRUE(pooledSockets.back()->isConnected());
+    EXPECT_NE(sock, pooledSockets.back());
+  }
+  EXPECT_NE(pooledSockets[0], pooledSockets[1]);
+  EXPECT_EQ(2, authenticated->load());
+
+  auto again = cache_.pooledSockets(sock);
+  ASSERT_EQ(2u, again.size());
+  EXPECT_EQ(pooledSockets[0], again[0].value());
+  EXPECT_EQ(pooledSockets[1], again[1].value());
+  EXPECT_EQ(2, authenticated->load());
+
+  sock->disconnect().wait();
+  for (auto& pooledSocket : pooledSockets)
+  {
+    for (int i = 0; i < 100 && pooledSocket->isConnected(); ++i)
+      std::this_thread::sleep_for(std::chrono::milliseconds{ 10 });
+    EXPECT_FALSE(pooledSocket->isConnected());
+  }
+  EXPECT_TRUE(cache_.pooledSockets(sock).empty());
+}
+
+TEST_F(TestTransportSocketCache, NoPooledSocketsByDefault)
+{
+  server_.listen("tcp://127.0.0.1:0").wait();
+  qi::ServiceInfo servInfo;
+  servInfo.setMachineId(qi::os::getMachineId());
+  servInfo.setEndpoints(server_.endpoints());
+  qi::MessageSocketPtr sock = cache_.socket(servInfo, "").value();
+  EXPECT_TRUE(cache_.pooledSockets(sock).empty());
+}
+
+TEST(TestEndpointRanking, LocalityOfHosts)
+{
+  using Ranking = qi::EndpointRanking;
+  const std::vector<std::string> local{ "192.168.1.10" };
+  EXPECT_EQ(Ranking::Locality_Machine, Ranking::locality("127.0.0.1", local));
+  EXPECT_EQ(Ranking::Locality_Machine, Ranking::locality("localhost", local));
+  EXPECT_EQ(Ranking::Locality_Machine, Ranking::locality("192.168.1.10", local));
+  EXPECT_EQ(Ranking::Locality_Subnet, Ranking::locality("192.168.1.77", local));
+  EXPECT_EQ(Ranking::Locality_Subnet, Ranking::locality("169.254.3.4", local));
+  EXPECT_EQ(Ranking::Locality_Remote, Ranking::locality("192.168.2.10", local));
+  EXPECT_EQ(Ranking::Locality_Remote, Ranking::locality("robot.example.com", local));
+}
+
+TEST(TestEndpointRanking, PrefersFastEndpointsAndDeprioritizesFailingOnes)
+{
+  // Documentation addresses, which no machine of the tests has.
+  const qi::Url slow("tcp://198.51.100.1:9559");
+  const qi::Url fast("tcp://198.51.100.2:9559");
+  const qi::Url unknown("tcp://198.51.100.3:9559");
+  const qi::Url loopback("tcp://127.0.0.1:9559");
+  const std::string machine = "machine";
+
+  qi::EndpointRanking ranking;
+  EXPECT_EQ(qi::UrlVector({ slow, fast }), ranking.rank(machine, { slow, fast }));
+  EXPECT_EQ(qi::EndpointRanking::defaultAttemptDelay, ranking.attemptDelay(machine, fast));
+
+  ranking.connected(machine, slow, qi::MilliSeconds(100));
+  ranking.connected(machine, fast, qi::MilliSeconds(20));
+  EXPECT_EQ(qi::UrlVector({ fast, slow, unknown }), ranking.rank(machine, { unknown, slow, fast }));
+  EXPECT_EQ(qi::Duration(qi::MilliSeconds(40)), ranking.attemptDelay(machine, fast));
+  // The ranking is kept per machine.
+  EXPECT_EQ(qi::UrlVector({ slow, fast }), ranking.rank("other machine", { slow, fast }));
+  // Locality comes before the connection times.
+  EXPECT_EQ(qi::UrlVector({ loopback, fast }), ranking.rank(machine, { fast, loopback }));
+
+  ranking.failed(machine, fast);
+  EXPECT_EQ(qi::UrlVector({ slow, unknown, fast }), ranking.rank(machine, { unknown, slow, fast }));
+  ranking.connected(machine, fast, qi::MilliSeconds(20));
+  EXPECT_EQ(qi::UrlVector({ fast, slow }), ranking.rank(machine, { slow, fast }));
+
+  // Connection times are smoothed.
+  ranking.connected(machine, fast, qi::MilliSeconds(100));
+  EXPECT_EQ(qi::Duration(qi::MilliSeconds(30)), *ranking.connectionTime(machine, fast));
+}
+
+TEST_F(TestTransportSocketCache, FailingEndpointIsRankedLast)
+{
+  server_.listen("tcp://127.0.0.1:0").wait();
+  const qi::Url closed("tcp://127.0.0.1:4444");
+  const qi::Url open = server_.endpoints()[0];
+
+  qi::ServiceInfo servInfo;
+  servInfo.setMachineId(qi::os::getMachineId());
+  servInfo.setEndpoints({ closed, open });
+  qi::MessageSocketPtr sock = cache_.socket(servInfo, "").value();
+  ASSERT_TRUE(sock->isConnected());
+  EXPECT_EQ(open, sock->url());
+  sock->disconnect().wait();
+  std::this_thread::sleep_for(std::chrono::milliseconds{ 100 });
+
+  // The open endpoint is tried first, and connects before the delay after
+  // which the closed one would be tried.
+  const auto start = qi::SteadyClock::now();
+  sock = cache_.socket(servInfo, "").value();
+  ASSERT_TRUE(sock->isConnected());
+  EXPECT_EQ(open, sock->url());
+  EXPECT_LT(qi::SteadyClock::now() - start, qi::EndpointRanking::defaultAttemptDelay);
+}
+
 TEST(TestCall, IPV6Accepted)
 {
   // todo: enable whenever qi::Url properly supports ipv6
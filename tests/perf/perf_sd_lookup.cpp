@@ -0,0 +1,157 @@
+/*
+**  Copyright (C) 2018 SoftBank Robotics Europe
+**  See COPYING for the license
+*/
+
+/*
+ * Measures the throughput of the service lookups of a service directory
+ * queried by many clients at once, as when many processes start together,
+ * optionally while services keep being registered and unregistered.
+ *
+ * For instance:
+ *   perf_sd_lookup --clients 40 --services 200
+ *   perf_sd_lookup --clients 40 --services 200 --churn
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/program_options.hpp>
+
+#include <qi/anyobject.hpp>
+#include <qi/clock.hpp>
+#include <qi/os.hpp>
+#include <qi/session.hpp>
+
+namespace po = boost::program_options;
+
+namespace
+{
+  qi::ServiceInfo serviceInfo(const std::string& name, const qi::UrlVector& endpoints)
+  {
+    qi::ServiceInfo info;
+    info.setName(name);
+    info.setMachineId(qi::os::getMachineId());
+    info.setProcessId(qi::os::getpid());
+    info.setSessionId("perf");
+    info.setEndpoints(endpoints);
+    return info;
+  }
+}
+
+int main(int argc, char* argv[])
+{
+  po::options_description desc("perf_sd_lookup options");
+  desc.add_options()
+    ("help,h", "Print this help.")
+    ("clients,c", po::value<unsigned int>()->default_value(40), "Client sessions querying the directory.")
+    ("pending,p", po::value<unsigned int>()->default_value(8), "Lookups kept in progress by each client.")
+    ("services,s", po::value<unsigned int>()->default_value(100), "Services registered in the directory.")
+    ("duration,d", po::value<unsigned int>()->default_value(3), "Duration of the measure in seconds.")
+    ("churn", "Keep registering and unregistering services during the measure.");
+
+  po::variables_map vm;
+  po::store(po::command_line_parser(argc, argv).options(desc).run(), vm);
+  po::notify(vm);
+
+  if (vm.count("help"))
+  {
+    std::cout << desc << std::endl;
+    return EXIT_SUCCESS;
+  }
+
+  const auto clientCount = vm["clients"].as<unsigned int>();
+  const auto pending = std::max(1u, vm["pending"].as<unsigned int>());
+  const auto serviceCount = std::max(1u, vm["services"].as<unsigned int>());
+  const auto duration = qi::Seconds(vm["duration"].as<unsigned int>());
+
+  auto sd = qi::makeSession();
+  sd->listenStandalone(qi::Url("tcp://127.0.0.1:0"));
+
+  // Registered in a single batch.
+  auto registrar = qi::makeSession();
+  registrar->connect(sd->url());
+  qi::AnyObject registrarDirectory = registrar->service(qi::Session::serviceDirectoryServiceName()).value();
+  std::vector<qi::ServiceInfo> infos;
+  for (unsigned int i = 0; i < serviceCount; ++i)
+    infos.push_back(serviceInfo("Service" + std::to_string(i), sd->endpoints()));
+  registrarDirectory.call<void>("servicesReady",
+      registrarDirectory.call<std::vector<unsigned int>>("registerServices", infos));
+
+  std::vector<qi::SessionPtr> clients;
+  std::vector<qi::AnyObject> directories;
+  for (unsigned int i = 0; i < clientCount; ++i)
+  {
+    auto client = qi::makeSession();
+    client->connect(sd->url());
+    directories.push_back(client->service(qi::Session::serviceDirectoryServiceName()).value());
+    clients.push_back(client);
+  }
+
+  std::atomic<bool> stop(false);
+  std::atomic<unsigned int> churned(0);
+  std::thread churn;
+  if (vm.count("churn"))
+  {
+    churn = std::thread([&] {
+      for (unsigned int i = 0; !stop; ++i)
+      {
+        const auto ids = registrarDirectory.call<std::vector<unsigned int>>(
+            "registerServices", std::vector<qi::ServiceInfo>{ serviceInfo("Churn" + std::to_string(i), sd->endpoints()) });
+        registrarDirectory.call<void>("servicesReady", ids);
+        registrarDirectory.call<void>("unregisterService", ids.front());
+        ++churned;
+      }
+    });
+  }
+
+  std::atomic<unsigned long> lookups(0);
+  std::atomic<unsigned long> failures(0);
+  std::vector<std::thread> threads;
+  const auto begin = qi::SteadyClock::now();
+  for (unsigned int c = 0; c < clientCount; ++c)
+  {
+    threads.emplace_back([&, c] {
+      qi::AnyObject directory = directories[c];
+      unsigned int next = c;
+      while (!stop)
+      {
+        std::vector<qi::Future<qi::ServiceInfo>> calls;
+        for (unsigned int i = 0; i < pending; ++i)
+          calls.push_back(directory.async<qi::ServiceInfo>("service", "Service" + std::to_string(next++ % serviceCount)));
+        for (auto& call : calls)
+        {
+          if (call.hasError())
+            ++failures;
+          else
+            ++lookups;
+        }
+      }
+    });
+  }
+
+  qi::sleepFor(duration);
+  stop = true;
+  for (auto& thread : threads)
+    thread.join();
+  const auto elapsed = qi::SteadyClock::now() - begin;
+  if (churn.joinable())
+    churn.join();
+
+  const double seconds = double(boost::chrono::duration_cast<qi::MilliSeconds>(elapsed).count()) / 1e3;
+  std::cout << "clients: " << clientCount << ", pending: " << pending << ", services: " << serviceCount
+            << (vm.count("churn") ? ", churn: " + std::to_string(churned.load()) + " registrations" : std::string())
+            << "\n"
+            << "lookups: " << lookups << " in " << seconds << " s, " << double(lookups) / seconds
+            << " lookups/s, failures: " << failures << std::endl;
+
+  for (auto& client : clients)
+    client->close();
+  registrar->close();
+  sd->close();
+  return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
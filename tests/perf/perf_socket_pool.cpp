@@ -0,0 +1,128 @@
+/*
+**  Copyright (C) 2018 SoftBank Robotics Europe
+**  See COPYING for the license
+*/
+
+/*
+ * Measures the latency of small calls while large replies are being
+ * transferred from the same service, with and without a socket pool.
+ *
+ * For instance, compare:
+ *   perf_socket_pool --sockets 1 --bulk 20000000
+ *   perf_socket_pool --sockets 2 --bulk 20000000
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <vector>
+
+#include <boost/program_options.hpp>
+
+#include <qi/anyobject.hpp>
+#include <qi/clock.hpp>
+#include <qi/perf/measure.hpp>
+#include <qi/session.hpp>
+#include <qi/type/dynamicobjectbuilder.hpp>
+
+namespace po = boost::program_options;
+
+namespace
+{
+  // Keeps a bulk call in progress until `stop` is set.
+  void spawnBulkCalls(qi::AnyObject service, unsigned int size, std::atomic<bool>& stop,
+                      std::atomic<unsigned int>& done)
+  {
+    if (stop)
+      return;
+    service.async<std::string>("bulk", size).connect([=, &stop, &done](const qi::Future<std::string>& f) {
+      if (!f.hasError())
+        ++done;
+      spawnBulkCalls(service, size, stop, done);
+    });
+  }
+}
+
+int main(int argc, char* argv[])
+{
+  po::options_description desc("perf_socket_pool options");
+  desc.add_options()
+    ("help,h", "Print this help.")
+    ("count,n", po::value<unsigned int>()->default_value(2000), "Number of small calls to measure.")
+    ("sockets,s", po::value<unsigned int>()->default_value(2), "Sockets per endpoint of the client.")
+    ("bulk,b", po::value<unsigned int>()->default_value(20 * 1024 * 1024),
+     "Size of the bulk replies in bytes, 0 for no bulk transfer.")
+    ("streams", po::value<unsigned int>()->default_value(1), "Bulk calls kept in progress.")
+    ("threshold,t", po::value<unsigned int>()->default_value(256 * 1024),
+     "Minimum payload size of the calls of the bulk lane.");
+
+  po::variables_map vm;
+  po::store(po::command_line_parser(argc, argv).options(desc).run(), vm);
+  po::notify(vm);
+
+  if (vm.count("help"))
+  {
+    std::cout << desc << std::endl;
+    return EXIT_SUCCESS;
+  }
+
+  const auto count = vm["count"].as<unsigned int>();
+  const auto bulkSize = vm["bulk"].as<unsigned int>();
+  const auto streams = vm["streams"].as<unsigned int>();
+
+  qi::DynamicObjectBuilder builder;
+  builder.advertiseMethod("echo", [](const std::string& s) { return s; });
+  builder.advertiseMethod("bulk", [](unsigned int size) { return std::string(size, 'x'); });
+
+  auto server = qi::makeSession();
+  server->listenStandalone(qi::Url("tcp://127.0.0.1:0"));
+  server->registerService("Service", builder.object());
+
+  qi::SessionConfig config;
+  config.socketPool.socketsPerEndpoint = vm["sockets"].as<unsigned int>();
+  config.socketPool.bulkPayloadThreshold = vm["threshold"].as<unsigned int>();
+  auto client = qi::makeSession(config);
+  client->connect(server->endpoints()[0]);
+  qi::AnyObject service = client->service("Service").value();
+
+  // Warm up the connections, the first large reply tells the client which
+  // method goes on the bulk lane.
+  const std::string payload(64, 'x');
+  for (int i = 0; i < 100; ++i)
+    service.call<std::string>("echo", payload);
+  if (bulkSize)
+    service.call<std::string>("bulk", bulkSize);
+
+  // static, as bulk calls may still be running when main returns
+  static std::atomic<bool> stop(false);
+  static std::atomic<unsigned int> bulkDone(0);
+  if (bulkSize)
+    for (unsigned int i = 0; i < streams; ++i)
+      spawnBulkCalls(service, bulkSize, stop, bulkDone);
+
+  std::vector<double> latencies;
+  latencies.reserve(count);
+  const auto begin = qi::SteadyClock::now();
+  for (unsigned int i = 0; i < count; ++i)
+  {
+    const auto start = qi::SteadyClock::now();
+    service.call<std::string>("echo", payload);
+    latencies.push_back(
+        double(boost::chrono::duration_cast<qi::NanoSeconds>(qi::SteadyClock::now() - start).count()) / 1e3);
+  }
+  const auto elapsed = qi::SteadyClock::now() - begin;
+  stop = true;
+
+  std::sort(latencies.begin(), latencies.end());
+  std::cout << "sockets: " << config.socketPool.socketsPerEndpoint << ", bulk: " << bulkSize << " bytes x "
+            << streams << ", bulk calls done: " << bulkDone << " in "
+            << boost::chrono::duration_cast<qi::MilliSeconds>(elapsed).count() << " ms\n"
+            << "small call latency (us): p50 " << qi::measure::percentile(latencies, 0.5)
+            << "  p90 " << qi::measure::percentile(latencies, 0.9)
+            << "  p99 " << qi::measure::percentile(latencies, 0.99)
+            << "  max " << qi::measure::percentile(latencies, 1.) << std::endl;
+
+  client->close();
+  server->close();
+  return EXIT_SUCCESS;
+}
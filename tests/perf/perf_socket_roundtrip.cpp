@@ -0,0 +1,156 @@
+/*
+**  Copyright (C) 2018 SoftBank Robotics Europe
+**  See COPYING for the license
+*/
+
+/*
+ * Measures the latency distribution of calls going through a local socket,
+ * optionally while the global event loop is kept busy by compute tasks.
+ *
+ * Run it with different thread placements to compare the tail latencies, for
+ * instance:
+ *   perf_socket_roundtrip --load 8
+ *   QI_EVENTLOOP_NETWORK_CPUS=0 perf_socket_roundtrip --load 8
+ *
+ * The options of the sockets, see qi::SocketTuning, are set on both sessions.
+ * With `--burst`, each sample is the time for a burst of concurrent calls to
+ * complete, which shows the effect of batching the small messages:
+ *   perf_socket_roundtrip --burst 32
+ *   perf_socket_roundtrip --burst 32 --cork
+ *   perf_socket_roundtrip --burst 32 --nodelay false
+ *   perf_socket_roundtrip --busy-poll 50
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <vector>
+
+#include <boost/program_options.hpp>
+
+#include <qi/anyobject.hpp>
+#include <qi/clock.hpp>
+#include <qi/eventloop.hpp>
+#include <qi/future.hpp>
+#include <qi/perf/measure.hpp>
+#include <qi/session.hpp>
+#include <qi/type/dynamicobjectbuilder.hpp>
+
+namespace po = boost::program_options;
+
+namespace
+{
+  void busyLoop(const std::atomic<bool>& stop)
+  {
+    const auto end = qi::SteadyClock::now() + qi::MilliSeconds(5);
+    while (!stop && qi::SteadyClock::now() < end)
+      ;
+  }
+
+  // Keeps a task spinning on the global event loop until `stop` is set.
+  void spawnLoad(std::atomic<bool>& stop)
+  {
+    if (stop)
+      return;
+    qi::getEventLoop()->async([&stop] {
+      busyLoop(stop);
+      spawnLoad(stop);
+    });
+  }
+}
+
+int main(int argc, char* argv[])
+{
+  po::options_description desc("perf_socket_roundtrip options");
+  desc.add_options()
+    ("help,h", "Print this help.")
+    ("count,n", po::value<unsigned int>()->default_value(20000), "Number of calls to measure.")
+    ("load,l", po::value<unsigned int>()->default_value(0),
+     "Number of compute tasks kept running on the global event loop.")
+    ("size,s", po::value<unsigned int>()->default_value(64), "Size of the payload in bytes.")
+    ("burst,b", po::value<unsigned int>()->default_value(1), "Number of concurrent calls of each sample.")
+    ("nodelay", po::value<bool>()->default_value(true), "Set TCP_NODELAY.")
+    ("cork", po::bool_switch(), "Cork the sockets while messages are queued.")
+    ("busy-poll", po::value<unsigned int>()->default_value(0), "Busy poll duration of the sockets in microseconds.")
+    ("sndbuf", po::value<int>()->default_value(0), "Send buffer size of the sockets in bytes.")
+    ("rcvbuf", po::value<int>()->default_value(0), "Receive buffer size of the sockets in bytes.");
+
+  po::variables_map vm;
+  po::store(po::command_line_parser(argc, argv).options(desc).run(), vm);
+  po::notify(vm);
+
+  if (vm.count("help"))
+  {
+    std::cout << desc << std::endl;
+    return EXIT_SUCCESS;
+  }
+
+  const auto count = vm["count"].as<unsigned int>();
+  const auto load = vm["load"].as<unsigned int>();
+  const std::string payload(vm["size"].as<unsigned int>(), 'x');
+  const auto burst = std::max(vm["burst"].as<unsigned int>(), 1u);
+
+  qi::SessionConfig config;
+  auto& tuning = config.socketTuning.defaults;
+  tuning.noDelay = vm["nodelay"].as<bool>();
+  tuning.corkBatches = vm["cork"].as<bool>();
+  tuning.busyPollMicroseconds = vm["busy-poll"].as<unsigned int>();
+  tuning.sendBufferSize = vm["sndbuf"].as<int>();
+  tuning.receiveBufferSize = vm["rcvbuf"].as<int>();
+
+  qi::DynamicObjectBuilder builder;
+  builder.advertiseMethod("echo", [](const std::string& s) { return s; });
+
+  auto server = qi::makeSession(config);
+  server->listenStandalone(qi::Url("tcp://127.0.0.1:0"));
+  server->registerService("Echo", builder.object());
+
+  auto client = qi::makeSession(config);
+  client->connect(server->endpoints()[0]);
+  qi::AnyObject echo = client->service("Echo").value();
+
+  // warm up the connection and the event loops
+  for (int i = 0; i < 100; ++i)
+    echo.call<std::string>("echo", payload);
+
+  // static, as load tasks may still be running when main returns
+  static std::atomic<bool> stop(false);
+  for (unsigned int i = 0; i < load; ++i)
+    spawnLoad(stop);
+
+  std::vector<double> latencies;
+  latencies.reserve(count);
+  std::vector<qi::Future<std::string>> calls(burst);
+  for (unsigned int i = 0; i < count; ++i)
+  {
+    const auto start = qi::SteadyClock::now();
+    if (burst == 1)
+      echo.call<std::string>("echo", payload);
+    else
+    {
+      for (auto& call : calls)
+        call = echo.async<std::string>("echo", payload);
+      for (auto& call : calls)
+        call.value();
+    }
+    latencies.push_back(
+        double(boost::chrono::duration_cast<qi::NanoSeconds>(qi::SteadyClock::now() - start).count()) / 1e3);
+  }
+  stop = true;
+
+  std::sort(latencies.begin(), latencies.end());
+  std::cout << "samples: " << count << ", burst: " << burst << ", load: " << load
+            << ", payload: " << payload.size() << " bytes\n"
+            << "nodelay: " << tuning.noDelay << ", cork: " << tuning.corkBatches
+            << ", busy poll: " << tuning.busyPollMicroseconds << " us"
+            << ", sndbuf: " << tuning.sendBufferSize << ", rcvbuf: " << tuning.receiveBufferSize << "\n"
+            << "latency (us): p50 " << qi::measure::percentile(latencies, 0.5)
+            << "  p90 " << qi::measure::percentile(latencies, 0.9)
+            << "  p99 " << qi::measure::percentile(latencies, 0.99)
+            << "  p99.9 " << qi::measure::percentile(latencies, 0.999)
+            << "  max " << qi::measure::percentile(latencies, 1.) << std::endl;
+
+  client->close();
+  server->close();
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,115 @@
+/*
+**  Copyright (C) 2018 SoftBank Robotics Europe
+**  See COPYING for the license
+*/
+
+/*
+ * Measures the throughput of large calls between two sessions, in both
+ * directions, over an encrypted connection.
+ *
+ * For instance, compare:
+ *   perf_tls_throughput --protocol tcp
+ *   perf_tls_throughput --protocol tcps
+ *   perf_tls_throughput --protocol tcps --offload
+ *
+ * The kernel encrypts the messages only if it has TLS support (the `tls`
+ * module on Linux), see qi::TlsOffloadConfig.
+ */
+
+#include <iostream>
+#include <string>
+
+#include <boost/program_options.hpp>
+
+#include <qi/anyobject.hpp>
+#include <qi/clock.hpp>
+#include <qi/path.hpp>
+#include <qi/session.hpp>
+#include <qi/type/dynamicobjectbuilder.hpp>
+
+namespace po = boost::program_options;
+
+namespace
+{
+  double megabytesPerSecond(std::size_t bytes, qi::SteadyClock::duration elapsed)
+  {
+    const auto us = boost::chrono::duration_cast<qi::MicroSeconds>(elapsed).count();
+    return us ? double(bytes) / double(us) : 0.;
+  }
+}
+
+int main(int argc, char* argv[])
+{
+  po::options_description desc("perf_tls_throughput options");
+  desc.add_options()
+    ("help,h", "Print this help.")
+    ("count,n", po::value<unsigned int>()->default_value(200), "Number of calls in each direction.")
+    ("size,s", po::value<unsigned int>()->default_value(4 * 1024 * 1024), "Payload of each call in bytes.")
+    ("protocol,p", po::value<std::string>()->default_value("tcps"), "tcp or tcps.")
+    ("offload", po::bool_switch(), "Let the kernel encrypt the messages sent, on both sessions.")
+    ("key", po::value<std::string>()->default_value(qi::path::findData("qi", "server.key")),
+     "Private key of the server.")
+    ("crt", po::value<std::string>()->default_value(qi::path::findData("qi", "server.crt")),
+     "Certificate of the server.");
+
+  po::variables_map vm;
+  po::store(po::command_line_parser(argc, argv).options(desc).run(), vm);
+  po::notify(vm);
+
+  if (vm.count("help"))
+  {
+    std::cout << desc << std::endl;
+    return EXIT_SUCCESS;
+  }
+
+  const auto count = vm["count"].as<unsigned int>();
+  const auto size = vm["size"].as<unsigned int>();
+  const auto protocol = vm["protocol"].as<std::string>();
+
+  qi::DynamicObjectBuilder builder;
+  builder.advertiseMethod("sink", [](const std::string& s) { return static_cast<unsigned int>(s.size()); });
+  builder.advertiseMethod("source", [](unsigned int size) { return std::string(size, 'x'); });
+
+  qi::SessionConfig config;
+  config.tlsOffload.enabled = vm["offload"].as<bool>();
+
+  auto server = qi::makeSession(config);
+  if (protocol == "tcps" && !server->setIdentity(vm["key"].as<std::string>(), vm["crt"].as<std::string>()))
+  {
+    std::cerr << "invalid key or certificate" << std::endl;
+    return EXIT_FAILURE;
+  }
+  server->listenStandalone(qi::Url(protocol + "://127.0.0.1:0"));
+  server->registerService("Service", builder.object());
+
+  auto client = qi::makeSession(config);
+  client->connect(server->endpoints()[0]);
+  qi::AnyObject service = client->service("Service").value();
+
+  const std::string payload(size, 'x');
+  for (int i = 0; i < 10; ++i)
+  {
+    service.call<unsigned int>("sink", payload);
+    service.call<std::string>("source", size);
+  }
+
+  auto start = qi::SteadyClock::now();
+  for (unsigned int i = 0; i < count; ++i)
+    service.call<unsigned int>("sink", payload);
+  const auto sent = qi::SteadyClock::now() - start;
+
+  start = qi::SteadyClock::now();
+  for (unsigned int i = 0; i < count; ++i)
+    service.call<std::string>("source", size);
+  const auto received = qi::SteadyClock::now() - start;
+
+  const std::size_t total = std::size_t(count) * size;
+  std::cout << protocol << (config.tlsOffload.enabled ? " (offload enabled)" : "") << ", "
+            << count << " calls of " << size << " bytes\n"
+            << "client to server: " << megabytesPerSecond(total, sent) << " MB/s\n"
+            << "server to client: " << megabytesPerSecond(total, received) << " MB/s" << std::endl;
+
+  client->close();
+  server->close();
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,126 @@
+/*
+**  Copyright (C) 2018 SoftBank Robotics Europe
+**  See COPYING for the license
+*/
+
+/*
+ * Stress the asynchronous logging path: several threads log bursts of
+ * messages while the handlers count what they receive. Reports the cost of a
+ * log call on the producer side, the throughput and the dropped messages.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include <boost/program_options.hpp>
+
+#include <qi/clock.hpp>
+#include <qi/log.hpp>
+#include <qi/perf/measure.hpp>
+
+namespace po = boost::program_options;
+
+qiLogCategory("qi.perf.log");
+
+namespace
+{
+  std::atomic<qi::uint64_t> received(0);
+
+  void countingHandler(const qi::LogLevel,
+                       const qi::Clock::time_point,
+                       const qi::SystemClock::time_point,
+                       const char* category,
+                       const char*,
+                       const char*,
+                       const char*,
+                       int)
+  {
+    static const std::string perfCategory = "qi.perf.log";
+    if (perfCategory == category)
+      ++received;
+  }
+
+}
+
+int main(int argc, char* argv[])
+{
+  po::options_description desc("perf_qilog_async options");
+  desc.add_options()
+    ("help,h", "Print this help.")
+    ("threads,t", po::value<unsigned int>()->default_value(4), "Number of logging threads.")
+    ("messages,n", po::value<unsigned int>()->default_value(100000),
+     "Number of messages logged by each thread.")
+    ("burst,b", po::value<unsigned int>()->default_value(1000),
+     "Number of messages logged in a row before pausing 1ms.")
+    ("buffer-size,s", po::value<std::size_t>()->default_value(256 * 1024),
+     "Size in bytes of the buffer of each thread.");
+
+  po::variables_map vm;
+  po::store(po::command_line_parser(argc, argv).options(desc).run(), vm);
+  po::notify(vm);
+
+  if (vm.count("help"))
+  {
+    std::cout << desc << std::endl;
+    return EXIT_SUCCESS;
+  }
+
+  const auto threadCount = vm["threads"].as<unsigned int>();
+  const auto messageCount = vm["messages"].as<unsigned int>();
+  const auto burst = std::max(1u, vm["burst"].as<unsigned int>());
+
+  qi::log::init(qi::LogLevel_Info, 0, false);
+  qi::log::setAsynchronousBufferSize(vm["buffer-size"].as<std::size_t>());
+  qi::log::removeHandler("consoleloghandler");
+  qi::log::addHandler("countinghandler", &countingHandler, qi::LogLevel_Info);
+
+  std::vector<std::vector<double>> latencies(threadCount);
+  std::vector<std::thread> threads;
+  const auto start = qi::SteadyClock::now();
+  for (unsigned int t = 0; t < threadCount; ++t)
+  {
+    threads.emplace_back([&, t] {
+      auto& lat = latencies[t];
+      lat.reserve(messageCount);
+      for (unsigned int i = 0; i < messageCount; ++i)
+      {
+        const auto before = qi::SteadyClock::now();
+        qiLogInfo() << "message " << i << " from thread " << t;
+        lat.push_back(double(boost::chrono::duration_cast<qi::NanoSeconds>(
+                                 qi::SteadyClock::now() - before).count()));
+        if ((i + 1) % burst == 0)
+          std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      }
+    });
+  }
+  for (auto& thread : threads)
+    thread.join();
+  const auto produced = qi::SteadyClock::now();
+  qi::log::flush();
+  const auto consumed = qi::SteadyClock::now();
+
+  std::vector<double> all;
+  for (const auto& lat : latencies)
+    all.insert(all.end(), lat.begin(), lat.end());
+  std::sort(all.begin(), all.end());
+
+  const auto total = static_cast<qi::uint64_t>(threadCount) * messageCount;
+  const auto seconds = [](qi::Duration d) {
+    return double(boost::chrono::duration_cast<qi::MicroSeconds>(d).count()) / 1e6;
+  };
+  std::cout << "threads: " << threadCount << ", messages: " << total << "\n"
+            << "log call (ns): p50 " << qi::measure::percentile(all, 0.5)
+            << "  p99 " << qi::measure::percentile(all, 0.99)
+            << "  p99.9 " << qi::measure::percentile(all, 0.999)
+            << "  max " << qi::measure::percentile(all, 1.) << "\n"
+            << "produced in " << seconds(produced - start) << "s, consumed after "
+            << seconds(consumed - start) << "s\n"
+            << "received: " << received.load()
+            << ", dropped: " << qi::log::droppedMessageCount() << std::endl;
+
+  qi::log::removeHandler("countinghandler");
+  return EXIT_SUCCESS;
+}
@@ -2,6 +2,7 @@
 #include <mutex>
 #include <gtest/gtest.h>
 #include <qi/eventloop.hpp>
+#include <qi/os.hpp>
 #include <src/eventloop_p.hpp>
 #include "test_future.hpp"
 
@@ -245,3 +246,17 @@ TEST(EventLoopAsio, DynamicShrinking)
   // We must have gone down to the minimum thread count.
   ASSERT_EQ(minThreadCount, *(e-1));
 }
+
+#if defined(__linux__) && !defined(ANDROID)
+#include <sched.h>
+
+TEST(EventLoop, ThreadsArePinnedToTheGivenCPUs)
+{
+  const int cpu = static_cast<int>(qi::os::numberOfCPUs()) - 1;
+  qi::EventLoop loop{ gEventLoopName, 2, 2, 2, false, { cpu } };
+  for (int i = 0; i < 10; ++i)
+  {
+    EXPECT_EQ(cpu, loop.async([] { return sched_getcpu(); }).value());
+  }
+}
+#endif
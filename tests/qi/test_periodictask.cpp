@@ -192,3 +192,72 @@ TEST(TestPeriodicTask, DoesNotDeadlockWhenStartedWithStrandInsideStrandContext)
   ASSERT_TRUE(test::finishesWithValue(futStart));
   strand.join(); // join it before PeriodicTask is destroyed
 }
+
+TEST(TestPeriodicTask, AbsoluteDeadlinesDoNotDrift)
+{
+  static const qi::MilliSeconds period{ 20 };
+  static const std::chrono::milliseconds callDuration{ 10 };
+  static const int callCount = 11;
+  qi::Promise<void> done;
+  std::vector<qi::SteadyClockTimePoint> calls;
+  qi::PeriodicTask pt;
+  pt.setCallback([&] {
+    calls.push_back(qi::SteadyClock::now());
+    if (calls.size() == callCount)
+    {
+      pt.asyncStop();
+      done.setValue(nullptr);
+      return;
+    }
+    std::this_thread::sleep_for(callDuration);
+  });
+  pt.setPeriod(period);
+  pt.useAbsoluteDeadlines(true);
+  pt.start();
+  ASSERT_TRUE(test::finishesWithValue(done.future(), test::willDoNothing(), qi::Seconds(10)));
+  pt.stop();
+
+  // Scheduling relatively to the end of each call would take
+  // (callCount - 1) * (period + callDuration) = 300ms.
+  const auto elapsed = calls.back() - calls.front();
+  EXPECT_GE(elapsed, (callCount - 1) * period);
+  EXPECT_LT(elapsed, (callCount - 1) * period + period + period / 2);
+}
+
+TEST(TestPeriodicTask, DedicatedThread)
+{
+  static const int callCount = 10;
+  qi::Promise<void> done;
+  std::vector<std::thread::id> threads;
+  qi::PeriodicTask pt;
+  pt.setCallback([&] {
+    threads.push_back(std::this_thread::get_id());
+    if (threads.size() == callCount)
+    {
+      pt.asyncStop();
+      done.setValue(nullptr);
+    }
+  });
+  pt.setPeriod(qi::MilliSeconds{ 1 });
+  pt.setDedicatedThread({ 0 });
+  pt.start();
+  ASSERT_TRUE(test::finishesWithValue(done.future(), test::willDoNothing(), qi::Seconds(10)));
+  pt.stop();
+
+  ASSERT_EQ(callCount, static_cast<int>(threads.size()));
+  EXPECT_NE(std::this_thread::get_id(), threads.front());
+  EXPECT_TRUE(std::all_of(threads.begin(), threads.end(), [&](const std::thread::id& id) {
+    return id == threads.front();
+  }));
+}
+
+TEST(TestPeriodicTask, CannotSetDedicatedThreadWhileRunning)
+{
+  qi::PeriodicTask pt;
+  pt.setCallback([]{ /* dummy callback */ });
+  pt.setPeriod(qi::MilliSeconds{ 100 });
+  pt.start(false);
+  EXPECT_ANY_THROW(pt.setDedicatedThread());
+  pt.stop();
+  EXPECT_NO_THROW(pt.setDedicatedThread());
+}
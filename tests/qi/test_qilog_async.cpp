@@ -8,8 +8,14 @@
 #include <gtest/gtest.h>
 #include <qi/future.hpp>
 #include <qi/log.hpp>
+#include <qi/log/binaryfileloghandler.hpp>
+#include <qi/os.hpp>
 #include <qi/testutils/testutils.hpp>
+#include <boost/filesystem.hpp>
 #include <atomic>
+#include <cstring>
+#include <thread>
+#include <vector>
 
 namespace
 {
@@ -79,3 +85,270 @@ TEST_F(AsyncLog, cats)
   qiLogCategory("pan");
   qiLogWarningF("canard %s", 12);
 }
+
+TEST_F(AsyncLog, droppedMessagesAreCountedAndReported)
+{
+  std::atomic<int> received{0};
+  std::atomic<bool> dropReported{false};
+  qi::Promise<void> start;
+  LogHandler handler("DroppingHandler",
+                     [&](const qi::LogLevel, const qi::Clock::time_point,
+                         const qi::SystemClock::time_point, const char* category,
+                         const char* msg, const char*, const char*, int) {
+                       start.future().wait();
+                       if (std::strcmp(category, testCategory) == 0)
+                         ++received;
+                       else if (std::strcmp(category, "qi.log") == 0 && std::strstr(msg, "dropped"))
+                         dropReported = true;
+                     },
+                     qi::LogLevel_Verbose);
+
+  const auto droppedBefore = qi::log::droppedMessageCount();
+  // Only applies to new threads.
+  qi::log::setAsynchronousBufferSize(4096);
+  std::thread producer([] {
+    qiLogCategory(testCategory);
+    for (int i = 0; i < iterations; i++)
+      qiLogVerbose() << "Iteration " << i;
+  });
+  producer.join();
+  qi::log::setAsynchronousBufferSize(256 * 1024);
+
+  start.setValue(0);
+  qi::log::flush();
+
+  const auto dropped = qi::log::droppedMessageCount() - droppedBefore;
+  EXPECT_GT(dropped, 0u);
+  EXPECT_EQ(static_cast<qi::uint64_t>(iterations), received + dropped);
+  EXPECT_TRUE(dropReported);
+}
+
+TEST_F(AsyncLog, deferredMessagesAreFormattedByTheLogThread)
+{
+  std::vector<std::string> messages;
+  LogHandler handler("DeferredHandler",
+                     [&](const qi::LogLevel, const qi::Clock::time_point,
+                         const qi::SystemClock::time_point, const char* category,
+                         const char* msg, const char*, const char*, int) {
+                       if (std::strcmp(category, testCategory) == 0)
+                         messages.push_back(msg);
+                     },
+                     qi::LogLevel_Verbose);
+
+  qiLogCategory(testCategory);
+  for (int i = 0; i < 3; i++)
+    qiLogVerboseB("Iteration %1% of %2%", i, "three");
+  qi::log::flush();
+
+  EXPECT_EQ((std::vector<std::string>{ "Iteration 0 of three",
+                                       "Iteration 1 of three",
+                                       "Iteration 2 of three" }),
+            messages);
+}
+
+TEST_F(AsyncLog, binaryLogFileRoundTrip)
+{
+  const boost::filesystem::path dir = qi::os::mktmpdir("BinaryLog");
+  const std::string path = (dir / "log.qilog").string();
+  {
+    qi::log::BinaryFileLogHandler fileHandler(path);
+    qi::log::addBinaryHandler("BinaryFileHandler",
+                              [&](const qi::log::DeferredLogRecord& record) {
+                                if (std::strcmp(record.category, testCategory) == 0)
+                                  fileHandler.log(record);
+                              },
+                              qi::LogLevel_Verbose);
+    qiLogCategory(testCategory);
+    for (int i = 0; i < iterations; i++)
+      qiLogVerboseB("Iteration %1% at %2%", i, 0.5);
+    qiLogWarning() << "done";
+    qi::log::flush();
+    qi::log::removeHandler("BinaryFileHandler");
+  }
+
+  qi::log::BinaryLogFileReader reader(path);
+  qi::log::DeferredLogRecord record;
+  for (int i = 0; i < iterations; i++)
+  {
+    ASSERT_TRUE(reader.next(record));
+    EXPECT_EQ(qi::LogLevel_Verbose, record.level);
+    EXPECT_STREQ(testCategory, record.category);
+    EXPECT_STREQ("Iteration %1% at %2%", record.format);
+    EXPECT_EQ("Iteration " + std::to_string(i) + " at 0.5", qi::log::formatMessage(record));
+  }
+  ASSERT_TRUE(reader.next(record));
+  EXPECT_EQ(qi::LogLevel_Warning, record.level);
+  EXPECT_EQ(nullptr, record.format);
+  EXPECT_STREQ("done", record.message);
+  EXPECT_FALSE(reader.next(record));
+
+  boost::filesystem::remove_all(dir);
+}
+
+TEST_F(AsyncLog, binaryLogFileReaderRejectsOtherFiles)
+{
+  const boost::filesystem::path dir = qi::os::mktmpdir("BinaryLog");
+  const std::string path = (dir / "log.txt").string();
+  {
+    FILE* file = qi::os::fopen(path.c_str(), "w");
+    ASSERT_TRUE(file);
+    fputs("not a binary log file", file);
+    fclose(file);
+  }
+  EXPECT_THROW(qi::log::BinaryLogFileReader{path}, std::runtime_error);
+  EXPECT_THROW(qi::log::BinaryLogFileReader{(dir / "missing").string()}, std::runtime_error);
+  boost::filesystem::remove_all(dir);
+}
+
+TEST_F(AsyncLog, binaryLogFileReaderRejectsCorruptedStrings)
+{
+  const boost::filesystem::path dir = qi::os::mktmpdir("BinaryLog");
+  // Appends a string entry to a binary log file without any entry.
+  const auto writeString = [&](const std::string& name, qi::uint32_t id, qi::uint32_t size) {
+    const std::string path = (dir / name).string();
+    {
+      qi::log::BinaryFileLogHandler fileHandler(path);
+    }
+    FILE* file = qi::os::fopen(path.c_str(), "ab");
+    EXPECT_TRUE(file);
+    fputc('S', file);
+    fwrite(&id, sizeof(id), 1, file);
+    fwrite(&size, sizeof(size), 1, file);
+    fputs("coin", file);
+    fclose(file);
+    return path;
+  };
+
+  qi::log::DeferredLogRecord record;
+  {
+    qi::log::BinaryLogFileReader reader(writeString("wrapping.qilog", 0xFFFFFFFF, 4));
+    EXPECT_FALSE(reader.next(record));
+  }
+  {
+    qi::log::BinaryLogFileReader reader(writeString("sparse.qilog", 1000000000, 4));
+    EXPECT_FALSE(reader.next(record));
+  }
+  {
+    qi::log::BinaryLogFileReader reader(writeString("truncated.qilog", 1, 0xFFFFFFF0));
+    EXPECT_FALSE(reader.next(record));
+  }
+  boost::filesystem::remove_all(dir);
+}
+
+namespace
+{
+  // Counts the messages of the test category, until it is released.
+  struct QueuedHandler
+  {
+    std::atomic<int> count{0};
+    qi::Promise<void> release;
+
+    void operator()(const qi::LogLevel, const qi::Clock::time_point,
+                    const qi::SystemClock::time_point, const char* category,
+                    const char*, const char*, const char*, int)
+    {
+      release.future().wait();
+      if (std::strcmp(category, testCategory) == 0)
+        ++count;
+    }
+  };
+}
+
+TEST_F(AsyncLog, slowQueuedHandlerDoesNotDelayOtherHandlers)
+{
+  static const int messageCount = 100;
+  QueuedHandler slow;
+  qi::log::addHandler("a-slow", std::ref(slow), qi::LogLevel_Verbose,
+                      qi::log::HandlerQueueConfig{});
+
+  qi::Promise<void> allReceived;
+  std::atomic<int> fastCount{0};
+  LogHandler fast("b-fast",
+                  [&](const qi::LogLevel, const qi::Clock::time_point,
+                      const qi::SystemClock::time_point, const char* category,
+                      const char*, const char*, const char*, int) {
+                    if (std::strcmp(category, testCategory) == 0 && ++fastCount == messageCount)
+                      allReceived.setValue(0);
+                  },
+                  qi::LogLevel_Verbose);
+
+  qiLogCategory(testCategory);
+  for (int i = 0; i < messageCount; i++)
+    qiLogVerbose() << "Iteration " << i;
+
+  ASSERT_TRUE(test::finishesWithValue(allReceived.future()));
+  EXPECT_EQ(0, slow.count);
+
+  slow.release.setValue(0);
+  qi::log::flush();
+  EXPECT_EQ(messageCount, slow.count);
+  const auto stats = qi::log::handlerStats().at("a-slow");
+  EXPECT_EQ(static_cast<qi::uint64_t>(messageCount), stats.handled);
+  EXPECT_EQ(0u, stats.dropped);
+  EXPECT_EQ(0u, stats.queued);
+  EXPECT_GT(stats.maxLatency, qi::Duration::zero());
+  qi::log::removeHandler("a-slow");
+}
+
+TEST_F(AsyncLog, fullHandlerQueueDropsMessages)
+{
+  static const int messageCount = 100;
+  QueuedHandler slow;
+  qi::log::HandlerQueueConfig queue;
+  queue.size = 10;
+  queue.policy = qi::log::QueueFullPolicy::Drop;
+  qi::log::addHandler("a-dropping", std::ref(slow), qi::LogLevel_Verbose, queue);
+
+  // Called after the queued handler, as handlers are sorted by name.
+  qi::Promise<void> allDispatched;
+  std::atomic<int> witnessCount{0};
+  LogHandler witness("b-witness",
+                     [&](const qi::LogLevel, const qi::Clock::time_point,
+                         const qi::SystemClock::time_point, const char* category,
+                         const char*, const char*, const char*, int) {
+                       if (std::strcmp(category, testCategory) == 0
+                           && ++witnessCount == messageCount)
+                         allDispatched.setValue(0);
+                     },
+                     qi::LogLevel_Verbose);
+
+  qiLogCategory(testCategory);
+  for (int i = 0; i < messageCount; i++)
+    qiLogVerbose() << "Iteration " << i;
+  ASSERT_TRUE(test::finishesWithValue(allDispatched.future()));
+
+  slow.release.setValue(0);
+  qi::log::flush();
+  const auto stats = qi::log::handlerStats().at("a-dropping");
+  EXPECT_GT(stats.dropped, 0u);
+  EXPECT_EQ(static_cast<qi::uint64_t>(slow.count.load()), stats.handled);
+  EXPECT_EQ(static_cast<qi::uint64_t>(messageCount), stats.handled + stats.dropped);
+  qi::log::removeHandler("a-dropping");
+}
+
+TEST_F(AsyncLog, fullHandlerQueueBlocksWithBlockPolicy)
+{
+  static const int messageCount = 50;
+  std::atomic<int> count{0};
+  qi::log::HandlerQueueConfig queue;
+  queue.size = 1;
+  queue.policy = qi::log::QueueFullPolicy::Block;
+  qi::log::addHandler("blocking",
+                      [&](const qi::LogLevel, const qi::Clock::time_point,
+                          const qi::SystemClock::time_point, const char* category,
+                          const char*, const char*, const char*, int) {
+                        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                        if (std::strcmp(category, testCategory) == 0)
+                          ++count;
+                      },
+                      qi::LogLevel_Verbose, queue);
+
+  qiLogCategory(testCategory);
+  for (int i = 0; i < messageCount; i++)
+    qiLogVerbose() << "Iteration " << i;
+  qi::log::flush();
+
+  EXPECT_EQ(messageCount, count);
+  EXPECT_EQ(0u, qi::log::handlerStats().at("blocking").dropped);
+  qi::log::removeHandler("blocking");
+}
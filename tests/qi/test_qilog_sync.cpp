@@ -18,6 +18,8 @@
 #include <cstring>
 #include <cwchar>
 #include <future>
+#include <memory>
+#include <vector>
 
 #include <gmock/gmock.h>
 
@@ -204,6 +206,63 @@ TEST_F(SyncLog, formatting)
   }
 }
 
+TEST_F(SyncLog, deferredFormatting)
+{
+  qiLogCategory("qi.test");
+
+  MockLogHandler handler("eclairs");
+
+  {
+    const auto _u = scopeMockExpectations(handler);
+    EXPECT_CALL(handler, log(qi::LogLevel_Error, StrEq("qi.test"), StrEq("coin")));
+    qiLogErrorB("coin");
+  }
+
+  {
+    const auto _u = scopeMockExpectations(handler);
+    EXPECT_CALL(handler, log(_, _, StrEq("coin 42 -1 2.5 x 1")));
+    qiLogErrorB("coin %1% %2% %3% %4% %5%", 42u, -1, 2.5, 'x', true);
+  }
+
+  {
+    const auto _u = scopeMockExpectations(handler);
+    EXPECT_CALL(handler, log(_, _, StrEq("coin canard 42")));
+    const std::string canard = "canard";
+    qiLogErrorB("coin %1% %2%", canard, "42");
+  }
+
+  // Test with invalid formats
+  {
+    const auto _u = scopeMockExpectations(handler);
+    EXPECT_CALL(handler, log(_, _, StrEq("coin 42")));
+    qiLogErrorB("coin %1%", 42, 51);
+  }
+}
+
+TEST_F(SyncLog, binaryHandlerReceivesUnformattedMessages)
+{
+  qiLogCategory("qi.test");
+
+  std::vector<std::string> formats;
+  std::vector<std::string> messages;
+  const auto id = qi::log::addBinaryHandler("binary",
+      [&](const qi::log::DeferredLogRecord& record) {
+        if (std::strcmp(record.category, "qi.test") != 0)
+          return;
+        formats.push_back(record.format ? record.format : "");
+        messages.push_back(qi::log::formatMessage(record));
+      });
+
+  qiLogErrorB("coin %1%", 42);
+  qiLogError() << "canard";
+  qi::log::removeHandler("binary");
+  qiLogErrorB("coin %1%", 51);
+
+  EXPECT_EQ((std::vector<std::string>{ "coin %1%", "" }), formats);
+  EXPECT_EQ((std::vector<std::string>{ "coin 42", "canard" }), messages);
+  EXPECT_NE(-1, static_cast<int>(id));
+}
+
 TEST_F(SyncLog, filteringChange)
 {
   MockLogHandler handler("set");
@@ -473,6 +532,40 @@ TEST_F(SyncLog, filteringPerHandler)
   }
 }
 
+TEST_F(SyncLog, filteringManyHandlers)
+{
+  // More handlers than the levels packed in a category.
+  static const int handlerCount = 20;
+  std::vector<std::unique_ptr<LogHandler>> handlers;
+  std::vector<int> received(handlerCount, 0);
+  for (int i = 0; i < handlerCount; ++i)
+  {
+    handlers.emplace_back(new LogHandler(
+        "many" + std::to_string(i),
+        [&received, i](qi::LogLevel, qi::Clock::time_point, qi::SystemClock::time_point,
+                       const char* category, const char*, const char*, const char*, int) {
+          if (std::strcmp(category, "qi.test.many") == 0)
+            ++received[i];
+        }));
+  }
+
+  // Odd handlers only see errors, even handlers see warnings too.
+  for (int i = 0; i < handlerCount; ++i)
+    log::addFilter("qi.test.m*", i % 2 ? LogLevel_Error : LogLevel_Warning, handlers[i]->id);
+
+  qiLogError("qi.test.many") << "coin";
+  qiLogWarning("qi.test.many") << "coin";
+  qiLogVerbose("qi.test.many") << "coin";
+  for (int i = 0; i < handlerCount; ++i)
+    EXPECT_EQ(i % 2 ? 1 : 2, received[i]) << "handler " << i;
+
+  log::addFilter("qi.test.many", LogLevel_Silent, handlers.back()->id);
+  EXPECT_TRUE(log::isVisible("qi.test.many", LogLevel_Warning));
+  qiLogError("qi.test.many") << "coin";
+  EXPECT_EQ(1, received.back());
+  EXPECT_EQ(2, received.front());
+}
+
 TEST_F(SyncLog, globbing)
 {
   MockLogHandler handler("pudding");
@@ -0,0 +1,178 @@
+/*
+**  Copyright (C) 2018 SoftBank Robotics Europe
+**  See COPYING for the license
+*/
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include <boost/filesystem.hpp>
+#include <gtest/gtest.h>
+
+#include <qi/clock.hpp>
+#include <qi/log/rotatingfileloghandler.hpp>
+#include <qi/os.hpp>
+
+namespace bfs = boost::filesystem;
+
+namespace
+{
+  class RotatingFileLog : public ::testing::Test
+  {
+  protected:
+    void SetUp() override
+    {
+      dir = qi::os::mktmpdir("RotatingFileLogHandler");
+      path = (dir / "test.log").string();
+    }
+
+    void TearDown() override
+    {
+      boost::system::error_code ec;
+      bfs::remove_all(dir, ec);
+    }
+
+    static void log(qi::log::RotatingFileLogHandler& handler, const std::string& msg,
+                    qi::LogLevel level = qi::LogLevel_Info)
+    {
+      handler.log(level, qi::Clock::now(), qi::SystemClock::now(), "qi.test", msg.c_str(),
+                  __FILE__, __FUNCTION__, __LINE__);
+    }
+
+    static std::string content(const std::string& path)
+    {
+      std::ifstream file(path.c_str());
+      std::ostringstream ss;
+      ss << file.rdbuf();
+      return ss.str();
+    }
+
+    bfs::path dir;
+    std::string path;
+  };
+}
+
+TEST_F(RotatingFileLog, messagesAreWrittenOnFlush)
+{
+  qi::log::RotatingFileLogHandlerConfig config;
+  config.flushInterval = qi::Seconds(60);
+  qi::log::RotatingFileLogHandler handler(path, config);
+
+  log(handler, "coin");
+  log(handler, "canard");
+  handler.flush();
+
+  const auto written = content(path);
+  EXPECT_NE(std::string::npos, written.find("coin"));
+  EXPECT_NE(std::string::npos, written.find("canard"));
+}
+
+TEST_F(RotatingFileLog, messagesAreWrittenAfterFlushInterval)
+{
+  qi::log::RotatingFileLogHandlerConfig config;
+  config.flushInterval = qi::MilliSeconds(10);
+  qi::log::RotatingFileLogHandler handler(path, config);
+
+  log(handler, "coin");
+  const auto deadline = qi::SteadyClock::now() + qi::Seconds(5);
+  while (content(path).find("coin") == std::string::npos && qi::SteadyClock::now() < deadline)
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  EXPECT_NE(std::string::npos, content(path).find("coin"));
+}
+
+TEST_F(RotatingFileLog, severeMessagesAreWrittenWithoutDelay)
+{
+  qi::log::RotatingFileLogHandlerConfig config;
+  config.flushInterval = qi::Seconds(60);
+  config.flushLevel = qi::LogLevel_Error;
+  qi::log::RotatingFileLogHandler handler(path, config);
+
+  log(handler, "coin", qi::LogLevel_Error);
+  const auto deadline = qi::SteadyClock::now() + qi::Seconds(5);
+  while (content(path).find("coin") == std::string::npos && qi::SteadyClock::now() < deadline)
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  EXPECT_NE(std::string::npos, content(path).find("coin"));
+}
+
+TEST_F(RotatingFileLog, rotatesBySizeAndKeepsTheLastFiles)
+{
+  qi::log::RotatingFileLogHandlerConfig config;
+  config.bufferSize = 256;
+  config.maxFileSize = 1024;
+  config.maxRotatedFiles = 2;
+  {
+    qi::log::RotatingFileLogHandler handler(path, config);
+    for (int i = 0; i < 200; ++i)
+      log(handler, "message " + std::to_string(i));
+  }
+
+  EXPECT_TRUE(bfs::exists(path));
+  int rotated = 0;
+  std::string all = content(path);
+  for (bfs::directory_iterator it(dir), end; it != end; ++it)
+  {
+    if (it->path().filename().string() != "test.log")
+    {
+      ++rotated;
+      EXPECT_LE(bfs::file_size(it->path()), config.maxFileSize + config.bufferSize * 2);
+      all += content(it->path().string());
+    }
+  }
+  EXPECT_EQ(2, rotated);
+  // Only the most recent messages are kept.
+  EXPECT_NE(std::string::npos, all.find("message 199"));
+  EXPECT_EQ(std::string::npos, all.find("message 0"));
+}
+
+TEST_F(RotatingFileLog, rotationContinuesExistingNumbering)
+{
+  qi::log::RotatingFileLogHandlerConfig config;
+  config.bufferSize = 1;
+  config.maxFileSize = 1;
+  {
+    std::ofstream existing((dir / "test.log.41").string().c_str());
+    existing << "old";
+  }
+  {
+    qi::log::RotatingFileLogHandler handler(path, config);
+    log(handler, "coin");
+  }
+  EXPECT_TRUE(bfs::exists(dir / "test.log.41"));
+  EXPECT_NE(std::string::npos, content((dir / "test.log.42").string()).find("coin"));
+}
+
+TEST_F(RotatingFileLog, rotatesByAge)
+{
+  qi::log::RotatingFileLogHandlerConfig config;
+  config.flushInterval = qi::MilliSeconds(10);
+  config.maxFileAge = qi::MilliSeconds(50);
+  qi::log::RotatingFileLogHandler handler(path, config);
+
+  log(handler, "coin");
+  const auto deadline = qi::SteadyClock::now() + qi::Seconds(5);
+  while (!bfs::exists(path + ".1") && qi::SteadyClock::now() < deadline)
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  EXPECT_NE(std::string::npos, content(path + ".1").find("coin"));
+}
+
+#ifdef WITH_ZLIB
+TEST_F(RotatingFileLog, rotatedFilesAreCompressed)
+{
+  qi::log::RotatingFileLogHandlerConfig config;
+  config.bufferSize = 1;
+  config.maxFileSize = 1;
+  config.compressRotatedFiles = true;
+  {
+    qi::log::RotatingFileLogHandler handler(path, config);
+    log(handler, "coin");
+    log(handler, "canard");
+  }
+  // Compressions are finished when the handler is destroyed.
+  EXPECT_TRUE(bfs::exists(path + ".1.gz"));
+  EXPECT_TRUE(bfs::exists(path + ".2.gz"));
+  EXPECT_FALSE(bfs::exists(path + ".1"));
+  EXPECT_FALSE(bfs::exists(path + ".2"));
+}
+#endif
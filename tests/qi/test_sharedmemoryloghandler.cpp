@@ -0,0 +1,252 @@
+/*
+**  Copyright (C) 2018 SoftBank Robotics Europe
+**  See COPYING for the license
+*/
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/function.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <boost/interprocess/shared_memory_object.hpp>
+#include <gtest/gtest.h>
+
+#include <qi/clock.hpp>
+#include <qi/log.hpp>
+#include <qi/log/sharedmemoryloghandler.hpp>
+#include <qi/os.hpp>
+
+namespace
+{
+  class SharedMemoryLog : public ::testing::Test
+  {
+  protected:
+    void SetUp() override
+    {
+      const auto* info = ::testing::UnitTest::GetInstance()->current_test_info();
+      name = std::string("qi-test-") + info->name() + "-" + std::to_string(qi::os::getpid());
+      qi::log::SharedMemoryLogReader::remove(name);
+    }
+
+    void TearDown() override
+    {
+      qi::log::SharedMemoryLogReader::remove(name);
+    }
+
+    static qi::log::DeferredLogRecord textRecord(const char* msg)
+    {
+      qi::log::DeferredLogRecord record = {};
+      record.level = qi::LogLevel_Info;
+      record.date = qi::Clock::now();
+      record.systemDate = qi::SystemClock::now();
+      record.category = "qi.test";
+      record.file = __FILE__;
+      record.function = __FUNCTION__;
+      record.line = __LINE__;
+      record.format = nullptr;
+      record.message = msg;
+      record.messageSize = std::strlen(msg);
+      return record;
+    }
+
+    std::string name;
+  };
+}
+
+TEST_F(SharedMemoryLog, messagesReachTheReader)
+{
+  qi::log::SharedMemoryLogReader reader(name);
+  qi::log::SharedMemoryLogHandler handler(name);
+  ASSERT_TRUE(handler.isAttached());
+
+  const auto sent = textRecord("coin");
+  handler.log(sent);
+
+  qi::log::DeferredLogRecord received;
+  int pid = 0;
+  ASSERT_TRUE(reader.next(received, pid, qi::Seconds(1)));
+  EXPECT_EQ(qi::os::getpid(), pid);
+  EXPECT_EQ(sent.level, received.level);
+  EXPECT_EQ(sent.date, received.date);
+  EXPECT_EQ(sent.systemDate, received.systemDate);
+  EXPECT_STREQ("qi.test", received.category);
+  EXPECT_STREQ(__FILE__, received.file);
+  EXPECT_EQ(sent.line, received.line);
+  EXPECT_EQ(nullptr, received.format);
+  EXPECT_EQ("coin", qi::log::formatMessage(received));
+  EXPECT_FALSE(reader.next(received, pid));
+}
+
+TEST_F(SharedMemoryLog, deferredMessagesAreFormattedByTheReader)
+{
+  qi::log::SharedMemoryLogReader reader(name);
+  qi::log::SharedMemoryLogHandler handler(name);
+  qi::log::setSynchronousLog(true);
+  qi::log::addBinaryHandler("sharedmemory", [&](const qi::log::DeferredLogRecord& record) {
+    if (std::strcmp(record.category, "qi.test.sharedmemory") == 0)
+      handler.log(record);
+  });
+  {
+    qiLogCategory("qi.test.sharedmemory");
+    qiLogErrorB("coin %1% %2%", 42, "canard");
+  }
+  qi::log::removeHandler("sharedmemory");
+
+  qi::log::DeferredLogRecord received;
+  int pid = 0;
+  ASSERT_TRUE(reader.next(received, pid, qi::Seconds(1)));
+  ASSERT_NE(nullptr, received.format);
+  EXPECT_STREQ("coin %1% %2%", received.format);
+  EXPECT_EQ("coin 42 canard", qi::log::formatMessage(received));
+}
+
+TEST_F(SharedMemoryLog, messagesAreDroppedWithoutReader)
+{
+  qi::log::SharedMemoryLogHandler handler(name);
+  EXPECT_FALSE(handler.isAttached());
+  handler.log(textRecord("coin"));
+  EXPECT_EQ(1u, handler.droppedMessageCount());
+}
+
+TEST_F(SharedMemoryLog, handlerAttachesToALaterReader)
+{
+  qi::log::SharedMemoryLogHandler handler(name);
+  qi::log::SharedMemoryLogReader reader(name);
+
+  const auto deadline = qi::SteadyClock::now() + qi::Seconds(5);
+  while (!handler.isAttached() && qi::SteadyClock::now() < deadline)
+  {
+    handler.log(textRecord("coin"));
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  ASSERT_TRUE(handler.isAttached());
+
+  EXPECT_GT(handler.droppedMessageCount(), 0u);
+
+  // The message which attached the handler was sent.
+  qi::log::DeferredLogRecord received;
+  int pid = 0;
+  ASSERT_TRUE(reader.next(received, pid, qi::Seconds(1)));
+  EXPECT_EQ("coin", qi::log::formatMessage(received));
+  handler.log(textRecord("canard"));
+  ASSERT_TRUE(reader.next(received, pid, qi::Seconds(1)));
+  EXPECT_EQ("canard", qi::log::formatMessage(received));
+}
+
+TEST_F(SharedMemoryLog, fullRingDropsMessages)
+{
+  qi::log::SharedMemoryLogReader reader(name, 4096);
+  qi::log::SharedMemoryLogHandler handler(name);
+  const std::string msg(100, 'x');
+  static const int messageCount = 100;
+  for (int i = 0; i < messageCount; ++i)
+    handler.log(textRecord(msg.c_str()));
+
+  int received = 0;
+  qi::log::DeferredLogRecord record;
+  int pid = 0;
+  while (reader.next(record, pid))
+    ++received;
+  EXPECT_GT(received, 0);
+  EXPECT_GT(handler.droppedMessageCount(), 0u);
+  EXPECT_EQ(handler.droppedMessageCount(), reader.droppedMessageCount());
+  EXPECT_EQ(messageCount, received + static_cast<int>(handler.droppedMessageCount()));
+}
+
+TEST_F(SharedMemoryLog, concurrentWritersAcrossRingWraps)
+{
+  qi::log::SharedMemoryLogReader reader(name, 16 * 1024);
+  qi::log::SharedMemoryLogHandler handler(name);
+  static const int threadCount = 4;
+  static const int messageCount = 2000;
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < threadCount; ++t)
+    threads.emplace_back([&, t] {
+      for (int i = 0; i < messageCount; ++i)
+      {
+        const std::string msg = std::to_string(t) + ":" + std::to_string(i);
+        handler.log(textRecord(msg.c_str()));
+      }
+    });
+
+  std::vector<int> last(threadCount, -1);
+  int received = 0;
+  qi::log::DeferredLogRecord record;
+  int pid = 0;
+  while (reader.next(record, pid, qi::MilliSeconds(500)))
+  {
+    const std::string msg = record.message;
+    const auto colon = msg.find(':');
+    ASSERT_NE(std::string::npos, colon) << msg;
+    const int t = std::stoi(msg.substr(0, colon));
+    const int i = std::stoi(msg.substr(colon + 1));
+    // Messages of a thread arrive in order.
+    EXPECT_GT(i, last[t]);
+    last[t] = i;
+    ++received;
+  }
+  for (auto& thread : threads)
+    thread.join();
+  while (reader.next(record, pid))
+    ++received;
+
+  EXPECT_EQ(threadCount * messageCount,
+            received + static_cast<int>(reader.droppedMessageCount()));
+}
+
+TEST_F(SharedMemoryLog, corruptedRecordIsSkipped)
+{
+  qi::log::SharedMemoryLogReader reader(name);
+  qi::log::SharedMemoryLogHandler handler(name);
+  handler.log(textRecord("coin"));
+
+  {
+    // The ring starts after the 192 bytes of the segment header. Give the
+    // first record an empty size, keeping its sequence number.
+    boost::interprocess::shared_memory_object shm(boost::interprocess::open_only, name.c_str(),
+                                                  boost::interprocess::read_write);
+    boost::interprocess::mapped_region region(shm, boost::interprocess::read_write);
+    const std::uint64_t tag = std::uint64_t(1) << 32;
+    std::memcpy(static_cast<char*>(region.get_address()) + 192, &tag, sizeof(tag));
+  }
+
+  qi::log::DeferredLogRecord received;
+  int pid = 0;
+  EXPECT_FALSE(reader.next(received, pid));
+  EXPECT_EQ(1u, reader.droppedMessageCount());
+
+  handler.log(textRecord("canard"));
+  ASSERT_TRUE(reader.next(received, pid, qi::Seconds(1)));
+  EXPECT_EQ("canard", qi::log::formatMessage(received));
+}
+
+TEST_F(SharedMemoryLog, recordOfAProducerDeadAfterItsReservationIsSkipped)
+{
+  qi::log::SharedMemoryLogReader reader(name);
+  qi::log::SharedMemoryLogHandler handler(name);
+  handler.log(textRecord("coin"));
+
+  {
+    // Clear the tag of the first record, as if its producer died right after
+    // moving writePos forward.
+    boost::interprocess::shared_memory_object shm(boost::interprocess::open_only, name.c_str(),
+                                                  boost::interprocess::read_write);
+    boost::interprocess::mapped_region region(shm, boost::interprocess::read_write);
+    const std::uint64_t tag = 0;
+    std::memcpy(static_cast<char*>(region.get_address()) + 192, &tag, sizeof(tag));
+  }
+
+  qi::log::DeferredLogRecord received;
+  int pid = 0;
+  // The reader waits for the tag for one second before skipping the record.
+  EXPECT_FALSE(reader.next(received, pid, qi::Seconds(2)));
+  EXPECT_EQ(1u, reader.droppedMessageCount());
+
+  handler.log(textRecord("canard"));
+  ASSERT_TRUE(reader.next(received, pid, qi::Seconds(1)));
+  EXPECT_EQ("canard", qi::log::formatMessage(received));
+}
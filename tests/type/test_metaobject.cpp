@@ -149,6 +149,37 @@ TEST(MetaObject, findMethod)
   EXPECT_TRUE(true);
 }
 
+TEST(MetaObject, findMethodCachesOverloadResolution)
+{
+  qi::MetaObjectBuilder b;
+  const unsigned int h1i = b.addMethod("i", "h", "(i)").id;
+  const unsigned int h1s = b.addMethod("i", "h", "(s)").id;
+  const unsigned int k1i = b.addMethod("i", "k", "(i)").id;
+  b.addMethod("i", "k", "(ii)");
+  qi::MetaObject mo = b.metaObject();
+
+  EXPECT_EQ((int)h1i, mo.findMethod("h", args(1)));
+  EXPECT_EQ((int)h1s, mo.findMethod("h", args("foo")));
+  auto stats = mo.overloadCacheStats();
+  EXPECT_EQ(0u, stats.hits);
+  EXPECT_EQ(2u, stats.misses);
+  EXPECT_EQ(2u, stats.size);
+
+  for (int i = 0; i < 10; ++i)
+  {
+    EXPECT_EQ((int)h1i, mo.findMethod("h", args(i)));
+    EXPECT_EQ((int)h1s, mo.findMethod("h", args("bar")));
+  }
+  stats = mo.overloadCacheStats();
+  EXPECT_EQ(20u, stats.hits);
+  EXPECT_EQ(2u, stats.misses);
+
+  // Calls which do not need the types of the arguments are not cached.
+  EXPECT_EQ((int)h1i, mo.findMethod("h::(i)", args(1)));
+  EXPECT_EQ((int)k1i, mo.findMethod("k", args(1)));
+  EXPECT_EQ(2u, mo.overloadCacheStats().size);
+}
+
 TEST(MetaObject, defaultConstructedMosAreEqual)
 {
   qi::MetaObject mo1;
@@ -202,6 +202,119 @@ TEST(TestSignal, DisconnectSynchronouslyFromAsyncCallback)
   ASSERT_EQ(qi::FutureState_FinishedWithValue, p.future().wait(usualTimeout));
 }
 
+TEST(TestSignal, ConnectFromCallbackDoesNotAffectOngoingTrigger)
+{
+  qi::Signal<void> signal;
+  std::atomic<int> lateCalls{0};
+  std::atomic<bool> connected{false};
+  signal.connect([&]{
+    if (!connected.exchange(true))
+      signal.connect([&]{ ++lateCalls; });
+  });
+  QI_EMIT signal();
+  EXPECT_EQ(0, lateCalls.load());
+  EXPECT_EQ(2u, signal.subscribers().size());
+  QI_EMIT signal();
+  EXPECT_EQ(1, lateCalls.load());
+}
+
+TEST(TestSignal, AsyncSubscribersShareTheSameArguments)
+{
+  qi::Signal<std::vector<int>> signal;
+  qi::Promise<const int*> p1;
+  qi::Promise<const int*> p2;
+  signal.connect([=](const std::vector<int>& v) mutable { p1.setValue(v.data()); })
+      .setCallType(qi::MetaCallType_Queued);
+  signal.connect([=](const std::vector<int>& v) mutable { p2.setValue(v.data()); })
+      .setCallType(qi::MetaCallType_Queued);
+  QI_EMIT signal(std::vector<int>{1, 2, 3});
+  ASSERT_EQ(qi::FutureState_FinishedWithValue, p1.future().wait(usualTimeout));
+  ASSERT_EQ(qi::FutureState_FinishedWithValue, p2.future().wait(usualTimeout));
+  EXPECT_EQ(p1.future().value(), p2.future().value());
+}
+
+namespace
+{
+  // Triggers the signal with 1..10 while the event loop is busy, then returns
+  // the values received by the subscriber once it is released.
+  std::vector<int> triggerWhileBusy(qi::Signal<int>& signal, qi::DeliveryPolicy policy,
+                                    qi::uint64_t& dropped)
+  {
+    qi::EventLoop loop{ "test_delivery", 1, false };
+    qi::Promise<void> release;
+    std::vector<int> received;
+    qi::Promise<void> lastReceived;
+    auto subscriber = signal.connect(qi::SignalSubscriber(
+        qi::AnyFunction::from(boost::function<void(int)>([&](int i) {
+          received.push_back(i);
+          if (i == 10)
+            lastReceived.setValue(nullptr);
+        })), &loop)).setDeliveryPolicy(policy);
+
+    loop.post([=] { release.future().wait(); });
+    for (int i = 1; i <= 10; ++i)
+      QI_EMIT signal(i);
+    release.setValue(nullptr);
+    EXPECT_EQ(qi::FutureState_FinishedWithValue, lastReceived.future().wait(usualTimeout));
+    dropped = subscriber.droppedDeliveries();
+    signal.disconnectAll();
+    return received;
+  }
+}
+
+TEST(TestSignal, DeliveryPolicyAllDeliversEverything)
+{
+  qi::Signal<int> signal;
+  qi::uint64_t dropped = 0;
+  const auto received = triggerWhileBusy(signal, qi::DeliveryPolicy::all(), dropped);
+  EXPECT_EQ(10u, received.size());
+  EXPECT_EQ(0u, dropped);
+}
+
+TEST(TestSignal, DeliveryPolicyLatestOnlyCollapsesPendingDeliveries)
+{
+  qi::Signal<int> signal;
+  qi::uint64_t dropped = 0;
+  const auto received = triggerWhileBusy(signal, qi::DeliveryPolicy::latestOnly(), dropped);
+  EXPECT_EQ(std::vector<int>{ 10 }, received);
+  EXPECT_EQ(9u, dropped);
+}
+
+TEST(TestSignal, DeliveryPolicyBoundedKeepsTheNewestDeliveries)
+{
+  qi::Signal<int> signal;
+  qi::uint64_t dropped = 0;
+  const auto received = triggerWhileBusy(signal, qi::DeliveryPolicy::bounded(3), dropped);
+  EXPECT_EQ((std::vector<int>{ 8, 9, 10 }), received);
+  EXPECT_EQ(7u, dropped);
+}
+
+TEST(TestSignal, DeliveryPolicyIsInheritedFromTheSignal)
+{
+  qi::Signal<int> signal;
+  signal.setDeliveryPolicy(qi::DeliveryPolicy::latestOnly());
+  auto inheriting = signal.connect([](int){});
+  auto overriding = signal.connect([](int){}).setDeliveryPolicy(qi::DeliveryPolicy::bounded(4));
+  EXPECT_EQ(qi::DeliveryPolicy::latestOnly(), inheriting.deliveryPolicy());
+  EXPECT_EQ(qi::DeliveryPolicy::bounded(4), overriding.deliveryPolicy());
+
+  signal.setDeliveryPolicy(qi::DeliveryPolicy::all());
+  EXPECT_EQ(qi::DeliveryPolicy::all(), inheriting.deliveryPolicy());
+  EXPECT_EQ(qi::DeliveryPolicy::bounded(4), overriding.deliveryPolicy());
+}
+
+TEST(TestSignal, MessagePriorityIsInheritedFromTheSignal)
+{
+  qi::Signal<int> signal;
+  EXPECT_EQ(qi::MessagePriority_Normal, signal.messagePriority());
+  auto before = signal.connect([](int){});
+  signal.setMessagePriority(qi::MessagePriority_High);
+  auto after = signal.connect([](int){});
+  EXPECT_EQ(qi::MessagePriority_High, signal.messagePriority());
+  EXPECT_EQ(qi::MessagePriority_High, before.messagePriority());
+  EXPECT_EQ(qi::MessagePriority_High, after.messagePriority());
+}
+
 void byRef(int& i, bool* done)
 {
   qiLogDebug() <<"byRef " << &i << ' ' << done;